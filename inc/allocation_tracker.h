@@ -0,0 +1,93 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// The allocation tracker counts the heap allocations of each thread, and attributes them to the scopes that are marked with ALLOCATION_SCOPE
+// It only counts when the project is built with TRACK_ALLOCATIONS, which replaces the global operator new and operator delete
+// In other builds the scopes compile to nothing and the counts are always zero
+
+struct AllocationCounts
+{
+   AllocationCounts();
+
+   AllocationCounts& operator+=(const AllocationCounts& other);
+   AllocationCounts  operator-(const AllocationCounts& other) const;
+
+   std::uint64_t numAllocations;
+   std::uint64_t numBytes;
+};
+
+// Scopes are inclusive, so the allocations of a scope are also counted by the scopes that enclose it
+struct AllocationScopeCounts
+{
+   AllocationScopeCounts();
+
+   const char*      name;
+   std::uint64_t    numEntries;
+   AllocationCounts counts;
+};
+
+class AllocationTracker
+{
+public:
+
+   static bool                               isEnabled();
+
+   // The allocations that the calling thread has made since it started
+   static AllocationCounts                   getThreadCounts();
+
+   static void                               recordScope(const char* name, const AllocationCounts& counts);
+
+   // The scopes of the calling thread, in the order in which they were first entered
+   // This allocates, so it shouldn't be called from inside of a scope
+   static std::vector<AllocationScopeCounts> getScopeCounts();
+   static AllocationScopeCounts              getScopeCounts(const char* name);
+   static void                               resetScopeCounts();
+
+   // Prints the entries, the allocations and the bytes of each scope, along with the allocations and the bytes per entry
+   static void                               printScopeTable(std::ostream& stream);
+};
+
+// Adds the allocations that the calling thread makes between its construction and its destruction to a scope
+// The name must be a string literal, since scopes are identified by the pointer
+class AllocationScope
+{
+public:
+
+   explicit AllocationScope(const char* name)
+      : mName(name)
+      , mStartCounts(AllocationTracker::getThreadCounts())
+   {
+
+   }
+
+   ~AllocationScope()
+   {
+      AllocationTracker::recordScope(mName, AllocationTracker::getThreadCounts() - mStartCounts);
+   }
+
+   AllocationScope(const AllocationScope&) = delete;
+   AllocationScope& operator=(const AllocationScope&) = delete;
+
+   AllocationScope(AllocationScope&&) = delete;
+   AllocationScope& operator=(AllocationScope&&) = delete;
+
+private:
+
+   const char*      mName;
+   AllocationCounts mStartCounts;
+};
+
+#define ALLOCATION_TRACKER_CONCATENATE_IMPL(a, b) a##b
+#define ALLOCATION_TRACKER_CONCATENATE(a, b)      ALLOCATION_TRACKER_CONCATENATE_IMPL(a, b)
+
+#ifdef TRACK_ALLOCATIONS
+#define ALLOCATION_SCOPE(name) AllocationScope ALLOCATION_TRACKER_CONCATENATE(allocationScope, __LINE__)(name)
+#else
+#define ALLOCATION_SCOPE(name)
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CAPTURE_SINK_H
+#define CAPTURE_SINK_H
+
+#include <cstdint>
+
+// Receives the frames of a recording on the thread that renders, and writes them on background threads
+// The pixels aren't copied, so the memory of a frame must stay valid until the frame is retired, which it can be as soon as the sink has read it
+// That makes the owner of the memory of the frames the one that bounds the queue: when all its memory is in use, it waits for the oldest frame to be retired before pushing another one
+// There must only be one thread that pushes, retires and closes
+class CaptureSink
+{
+public:
+
+   struct Frame
+   {
+      const unsigned char* pixels;
+      unsigned int         width;
+      unsigned int         height;
+      bool                 flipVertically; // True if the rows go from the bottom of the image to the top, like the ones that glReadPixels returns
+   };
+
+   CaptureSink() = default;
+   virtual ~CaptureSink() = default;
+
+   CaptureSink(const CaptureSink&) = delete;
+   CaptureSink& operator=(const CaptureSink&) = delete;
+
+   CaptureSink(CaptureSink&&) = delete;
+   CaptureSink& operator=(CaptureSink&&) = delete;
+
+   // The number of frames that the sink can read at once, each of which keeps its memory in use
+   virtual unsigned int  getNumThreads() const = 0;
+
+   // Waits for all the frames that were pushed to be written, and finishes the output
+   virtual bool          close() = 0;
+
+   // The frames are RGB with three bytes per pixel, and they must all have the same size
+   virtual void          push(const Frame& frame) = 0;
+
+   virtual bool          hasFramesToRetire() const = 0;
+   virtual bool          oldestFrameIsRead() const = 0;
+   // Waits for the sink to finish reading the oldest frame that hasn't been retired, after which its memory can be reused
+   virtual void          retireOldestFrame() = 0;
+
+   virtual std::uint64_t getNumWrittenFrames() const = 0;
+   virtual std::uint64_t getNumWrittenBytes() const = 0;
+   // The number of times that retireOldestFrame had to wait, which means that the sink couldn't keep up
+   virtual std::uint64_t getNumStalls() const = 0;
+};
+
+#endif
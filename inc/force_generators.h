@@ -0,0 +1,162 @@
+#ifndef FORCE_GENERATORS_H
+#define FORCE_GENERATORS_H
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+// The state of a batch of rigid bodies stored as a structure of arrays
+// Force generators read the kinematic quantities and accumulate into the forces and torques, one array at a time, so that their loops can be vectorized
+
+struct BodyBatch
+{
+   BodyBatch();
+
+   void resize(std::size_t numBodies);
+
+   std::size_t        numBodies;
+
+   std::vector<float> positionsX;
+   std::vector<float> positionsY;
+   std::vector<float> velocitiesX;
+   std::vector<float> velocitiesY;
+   std::vector<float> angularVelocities;
+   std::vector<float> masses;
+
+   std::vector<float> forcesX;
+   std::vector<float> forcesY;
+   std::vector<float> torques;
+};
+
+class ForceGenerator
+{
+public:
+
+   ForceGenerator() = default;
+   virtual ~ForceGenerator() = default;
+
+   ForceGenerator(const ForceGenerator&) = delete;
+   ForceGenerator& operator=(const ForceGenerator&) = delete;
+
+   ForceGenerator(ForceGenerator&&) = delete;
+   ForceGenerator& operator=(ForceGenerator&&) = delete;
+
+   virtual void apply(BodyBatch& batch) const = 0;
+};
+
+// F = M * A
+class UniformForceField : public ForceGenerator
+{
+public:
+
+   explicit UniformForceField(const glm::vec2& acceleration);
+
+   void apply(BodyBatch& batch) const override;
+
+private:
+
+   glm::vec2 mAcceleration;
+};
+
+// F = -K * V
+// T = -K_angular * W
+class LinearDrag : public ForceGenerator
+{
+public:
+
+   LinearDrag(float coefficient, float angularCoefficient);
+
+   void apply(BodyBatch& batch) const override;
+
+private:
+
+   float mCoefficient;
+   float mAngularCoefficient;
+};
+
+// F = -K * |V| * V
+// T = -K_angular * |W| * W
+class QuadraticDrag : public ForceGenerator
+{
+public:
+
+   QuadraticDrag(float coefficient, float angularCoefficient);
+
+   void apply(BodyBatch& batch) const override;
+
+private:
+
+   float mCoefficient;
+   float mAngularCoefficient;
+};
+
+// F = (S * M * D) / (|D|^2 + E^2)^(3/2)
+// Where D is the vector that goes from the center of mass of a body to the attractor
+// And E is a softening length that keeps the force finite when a body gets close to the attractor
+class PointAttractor : public ForceGenerator
+{
+public:
+
+   PointAttractor(const glm::vec2& position, float strength, float softeningLength);
+
+   void apply(BodyBatch& batch) const override;
+
+private:
+
+   glm::vec2 mPosition;
+   float     mStrength;
+   float     mSofteningLengthSquared;
+};
+
+// Damped springs that connect the centers of mass of two bodies, or the center of mass of a body and a fixed anchor
+// F = -((K * (|D| - L)) + (C * dot(V, D / |D|))) * (D / |D|)
+// Where D is the vector that goes from the other end of the spring to the body, and V is the relative velocity of the body
+class SpringNetwork : public ForceGenerator
+{
+public:
+
+   SpringNetwork() = default;
+
+   void addSpring(int bodyAIndex, int bodyBIndex, float restLength, float stiffness, float damping);
+   void addAnchoredSpring(int bodyIndex, const glm::vec2& anchor, float restLength, float stiffness, float damping);
+
+   void apply(BodyBatch& batch) const override;
+
+private:
+
+   // An index of -1 for body B means that the spring is attached to the anchor
+   std::vector<int>       mBodyAIndices;
+   std::vector<int>       mBodyBIndices;
+   std::vector<glm::vec2> mAnchors;
+   std::vector<float>     mRestLengths;
+   std::vector<float>     mStiffnesses;
+   std::vector<float>     mDampings;
+};
+
+class ForceGeneratorRegistry
+{
+public:
+
+   ForceGeneratorRegistry() = default;
+   ~ForceGeneratorRegistry() = default;
+
+   ForceGeneratorRegistry(const ForceGeneratorRegistry&) = delete;
+   ForceGeneratorRegistry& operator=(const ForceGeneratorRegistry&) = delete;
+
+   ForceGeneratorRegistry(ForceGeneratorRegistry&&) = default;
+   ForceGeneratorRegistry& operator=(ForceGeneratorRegistry&&) = default;
+
+   void add(std::unique_ptr<ForceGenerator>&& generator);
+   void clear();
+   bool isEmpty() const;
+
+   // Each generator makes a single pass over the whole batch before the next one runs
+   void applyAll(BodyBatch& batch) const;
+
+private:
+
+   std::vector<std::unique_ptr<ForceGenerator>> mGenerators;
+};
+
+#endif
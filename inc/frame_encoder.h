@@ -0,0 +1,102 @@
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_sink.h"
+#include "gif_encoder.h"
+
+// Encodes recorded frames into two animated GIFs on a pool of background threads, so that the thread that renders doesn't pay for the encoding
+// The slow GIF plays every frame, and the fast GIF plays every fourth frame at the same delay, which makes it four times faster
+//
+// The encoders reduce the colors of the frames in parallel, and then the frames are compressed and written in order, one at a time
+// A frame is read as soon as its colors are reduced
+class FrameEncoder : public CaptureSink
+{
+public:
+
+   enum class PaletteMode : unsigned int
+   {
+      global   = 0, // A single palette that is made from the first frame, which gives the smallest files
+      perFrame = 1, // A palette for each frame, which keeps colors that only appear after the first frame
+   };
+
+   // The delay is the time between the frames of the slow GIF in hundredths of a second, and the files are created when the first frame is written
+   // A number of threads of zero uses half of the hardware threads, since the game loop and the UI need the rest
+   FrameEncoder(const std::string& slowGifFilePath, const std::string& fastGifFilePath, unsigned int delayInCentiseconds, PaletteMode paletteMode, unsigned int numThreads = 0);
+   ~FrameEncoder();
+
+   unsigned int  getNumThreads() const override;
+
+   bool          close() override;
+
+   void          push(const Frame& frame) override;
+
+   bool          hasFramesToRetire() const override;
+   bool          oldestFrameIsRead() const override;
+   void          retireOldestFrame() override;
+
+   std::uint64_t getNumWrittenFrames() const override;
+   // The size of both files, which is only complete once they are closed
+   std::uint64_t getNumWrittenBytes() const override;
+   std::uint64_t getNumStalls() const override;
+
+private:
+
+   struct QueuedFrame
+   {
+      Frame frame;
+      bool  isRead;
+   };
+
+   void          runEncoder();
+   void          writeFrame(std::uint64_t frameNumber, const GifFrame& gifFrame);
+
+   std::vector<std::thread>              mEncoderThreads;
+
+   std::string                           mSlowGifFilePath;
+   std::string                           mFastGifFilePath;
+   unsigned int                          mDelayInCentiseconds;
+   PaletteMode                           mPaletteMode;
+   unsigned int                          mWidth;
+   unsigned int                          mHeight;
+
+   // The frames that haven't been retired yet, where the frame that was pushed in position N is at N - mNumRetiredFrames
+   std::deque<QueuedFrame>               mQueuedFrames;
+   std::uint64_t                         mNumRetiredFrames;
+   std::uint64_t                         mNumTakenFrames;   // By the encoders, including the retired ones
+
+   // The frames whose colors were reduced but that haven't been written yet, where the frame in position N is at N - mNumFramesTakenByWriter
+   // A frame that is still being reduced is null
+   std::deque<std::unique_ptr<GifFrame>> mReducedFrames;
+   std::uint64_t                         mNumFramesTakenByWriter;
+   std::uint64_t                         mNumFramesWrittenByWriter;
+   bool                                  mWriterIsBusy;
+
+   // The palette of the first frame, which the other frames wait for in the global palette mode
+   std::shared_ptr<const GifPalette>     mGlobalPalette;
+
+   bool                                  mStopEncoders;
+
+   mutable std::mutex                    mMutex;
+   std::condition_variable               mWorkCondition;
+   std::condition_variable               mFrameReadCondition;
+   std::condition_variable               mFrameWrittenCondition;
+
+   // Only used by the encoder that is the writer, or by close once all the frames are written
+   GifEncoder                            mSlowGif;
+   GifEncoder                            mFastGif;
+   bool                                  mWriteFailed;
+
+   std::atomic<std::uint64_t>            mNumStalls;
+};
+
+#endif
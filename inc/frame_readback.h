@@ -0,0 +1,74 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Reads frames back from the GPU through a ring of pixel buffer objects, so that glReadPixels returns right away instead of waiting for the GPU to finish rendering
+// The copy of a frame into its buffer completes while the next frames render, and the frame is only mapped once every buffer of the ring is in use
+// A mapped frame is read directly from the memory of its buffer, so it must be unmapped before its buffer can be used again
+//
+// The frames go through the ring in order, and all the functions must be called on the thread that owns the OpenGL context
+class FrameReadback
+{
+public:
+
+   FrameReadback();
+   ~FrameReadback();
+
+   FrameReadback(const FrameReadback&) = delete;
+   FrameReadback& operator=(const FrameReadback&) = delete;
+
+   FrameReadback(FrameReadback&&) = delete;
+   FrameReadback& operator=(FrameReadback&&) = delete;
+
+   // Creates the buffers for frames of the given size, and deletes the ones of a previous size
+   // Two frames of latency need three buffers, and every frame that stays mapped while the next ones are read needs one more
+   bool                 initialize(unsigned int width, unsigned int height, unsigned int numBuffers = 3);
+   // Discards the frames that are still in the ring and deletes the buffers
+   void                 release();
+   bool                 isInitialized() const;
+
+   unsigned int         getWidth() const;
+   unsigned int         getHeight() const;
+
+   // A frame is three bytes per pixel, and its rows go from the bottom of the image to the top
+   std::size_t          getFrameSizeInBytes() const;
+
+   // True when no buffer is free, so the oldest frame must be mapped and unmapped before the next one can be read
+   bool                 isFull() const;
+   bool                 hasPendingFrames() const;
+   bool                 hasMappedFrames() const;
+   std::size_t          getNumPendingFrames() const;
+
+   // Starts copying the framebuffer that is bound for reading into the next free buffer
+   bool                 startReadback(int frameIndex);
+
+   // Waits for the oldest frame that isn't mapped yet to finish copying and maps it
+   // The pointer stays valid until the frame is unmapped, and it's null if the frame couldn't be mapped
+   const unsigned char* mapOldestPendingFrame(int& frameIndex);
+   // Unmaps the oldest mapped frame, which frees its buffer
+   void                 unmapOldestMappedFrame();
+
+private:
+
+   struct Slot
+   {
+      GLuint buffer;
+      GLsync fence;
+      int    frameIndex;
+      bool   isMapped;     // False for a slot that is counted as mapped but whose buffer failed to map
+   };
+
+   std::vector<Slot>    mSlots;
+   unsigned int         mWidth;
+   unsigned int         mHeight;
+
+   // The slots that are in use start at mFirstUsedSlot, with the mapped ones before the pending ones
+   std::size_t          mFirstUsedSlot;
+   std::size_t          mNumMappedSlots;
+   std::size_t          mNumPendingSlots;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include "window.h"
 #include "state.h"
 #include "finite_state_machine.h"
+#include "scene_library.h"
 
 class Game : public QThread
 {
@@ -17,7 +18,7 @@ class Game : public QThread
 
 public:
 
-   Game(QObject* parent, const std::shared_ptr<Window>& glfwWindow);
+   Game(QObject* parent, const std::shared_ptr<Window>& glfwWindow, const std::shared_ptr<SceneLibrary>& sceneLibrary);
    ~Game();
 
    Game(const Game&) = delete;
@@ -41,32 +42,55 @@ public slots:
 
    void changeTimeStep(double timeStep);
    void changeCoefficientOfRestitution(double coefficientOfRestitution);
+   void changeIntegrator(int index);
+   void enableAdaptiveTimeStep(bool enable);
+   void enableContinuousCollisionDetection(bool enable);
 
    void enableWireframeMode(bool enable);
+   void enablePerformanceSampling(bool enable);
    void enableRememberFrames(bool enable);
    void changeRememberFramesFrequency(int frequency);
    void enableAntiAliasing(bool enable);
    void changeAntiAliasingMode(int index);
    void enableRecordGIF(bool enable);
+   void saveReplay();
 
 signals:
 
    void simulationError(int errorCode);
 
+   // The times are in milliseconds, and everything except the frame rate is averaged over the simulated frames of the sampling period
+   void performanceSampled(double physicsStepTime,
+                           double renderTime,
+                           double substepsPerFrame,
+                           double contactsPerFrame,
+                           double solverIterationsPerFrame,
+                           double framesPerSecond);
+
    void simulatorViewerClosed();
 
 private:
 
    void  run() override;
 
+   // Parses a scene and gives it to the world the first time that it's selected
+   bool  loadScene(int index);
+
    bool                                    mInitialized;
    bool                                    mSimulate;
    bool                                    mTerminate;
    float                                   mTimeStep;
+   std::shared_ptr<SceneLibrary>           mSceneLibrary;
+   std::vector<bool>                       mSceneIsLoaded;
    std::vector<glm::vec2>                  mSceneDimensions;
+   int                                     mCurrentSceneIndex;
+   int                                     mSimulatedSceneIndex;
 
    bool                                    mRecordGIF;
 
+   bool                                    mPerformanceSamplingIsEnabled;
+   bool                                    mStepStatisticsAreEnabled;
+
    std::shared_ptr<Window>                 mWindow;
 
    std::shared_ptr<FiniteStateMachine>     mFSM;
@@ -76,6 +100,9 @@ private:
    ResourceManager<Shader>                 mShaderManager;
 
    std::shared_ptr<World>                  mWorld;
+
+   // Null if the instant replay is disabled
+   std::shared_ptr<ReplayBuffer>           mReplayBuffer;
 };
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <glm/glm.hpp>
+
+// Helpers for the narrow phase of the collision detection
+// They are defined in this header so that they can be inlined into the hot loops of World and measured on their own by the microbenchmark
+
+inline bool doesPointProjectOntoSegment(const glm::vec2& pointToTest, const glm::vec2& segmentStartPoint, const glm::vec2& segmentEndPoint)
+{
+   glm::vec2 segment = segmentEndPoint - segmentStartPoint;
+
+   // Project pointToTest onto segment, computing the parameterized position d(t) = segmentStartPoint + distFromSegStartPointToProjectedPointToTest * (segmentEndPoint - segmentStartPoint)
+   float distFromSegStartPointToProjectedPointToTest = glm::dot(pointToTest - segmentStartPoint, segment) / glm::dot(segment, segment);
+
+   // If pointToTest projects outside of the segment, distFromSegStartPointToProjectedPointToTest is smaller than 0 or greater than 1
+   if ((distFromSegStartPointToProjectedPointToTest < 0.0f) || (distFromSegStartPointToProjectedPointToTest > 1.0f))
+   {
+      return false;
+   }
+
+   return true;
+}
+
+inline glm::vec2 calculateClosestPointOnSegmentToPoint(const glm::vec2& pointToTest, const glm::vec2& segmentStartPoint, const glm::vec2& segmentEndPoint)
+{
+   glm::vec2 segment = segmentEndPoint - segmentStartPoint;
+
+   // Project pointToTest onto segment, computing the parameterized position d(t) = segmentStartPoint + distFromSegStartPointToProjectedPointToTest * (segmentEndPoint - segmentStartPoint)
+   float distFromSegStartPointToProjectedPointToTest = glm::dot(pointToTest - segmentStartPoint, segment) / glm::dot(segment, segment);
+
+   // If pointToTest projects outside of the segment, distFromSegStartPointToProjectedPointToTest is smaller than 0 or greater than 1
+   // If this is the case, clamp distFromSegStartPointToProjectedPointToTest to the closest endpoint
+   if (distFromSegStartPointToProjectedPointToTest < 0.0f)
+   {
+      distFromSegStartPointToProjectedPointToTest = 0.0f;
+   }
+   else if (distFromSegStartPointToProjectedPointToTest > 1.0f)
+   {
+      distFromSegStartPointToProjectedPointToTest = 1.0f;
+   }
+
+   glm::vec2 closestPointOnSegmentToPoint = segmentStartPoint + (distFromSegStartPointToProjectedPointToTest * segment);
+
+   return closestPointOnSegmentToPoint;
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef GIF_ENCODER_H
+#define GIF_ENCODER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A frame whose pixels are indices into a palette of at most 256 colors
+struct GifFrame
+{
+   std::vector<unsigned char> palette;   // RGB triplets, and empty if the frame uses the global palette of the file
+   std::vector<unsigned char> indices;   // One per pixel, with the rows from the top of the image to the bottom
+};
+
+// Reduces the colors of RGB images to at most 256
+// Images that have at most 256 colors keep them exactly, and the others get a palette made by median cut on a histogram with 5 bits per channel
+class GifPalette
+{
+public:
+
+   GifPalette();
+
+   // The rows of the image go from the bottom to the top if flipVertically is true, like the ones that glReadPixels returns
+   // If mapAllColors is false, only the colors of this image can be mapped afterwards, which is much faster to build
+   void                              build(const unsigned char* pixels, unsigned int width, unsigned int height, bool mapAllColors);
+
+   // Maps every pixel to the closest color of the palette, and stores the rows from the top of the image to the bottom
+   // It only reads the palette, so many threads can map images with the same palette at once
+   void                              map(const unsigned char* pixels, unsigned int width, unsigned int height, bool flipVertically, std::vector<unsigned char>& indices) const;
+
+   const std::vector<unsigned char>& getColors() const;
+
+private:
+
+   static std::uint32_t              getBinOfColor(std::uint32_t color);
+
+   int                               findExactColor(std::uint32_t color) const;
+   unsigned char                     findClosestColor(std::uint32_t color) const;
+
+   std::vector<unsigned char>        mColors;
+
+   // An open addressing hash table from the exact colors of the palette to their indices, which is empty for palettes made by median cut
+   std::vector<std::uint32_t>        mExactColors;
+   std::vector<unsigned char>        mExactIndices;
+
+   // The index of the closest color of each bin of the histogram
+   std::vector<unsigned char>        mIndexOfBin;
+};
+
+// Writes an animated GIF one frame at a time, so that the frames don't have to be kept in memory
+// Each frame only stores the rectangle that changed since the previous one, and the pixels outside of it are left as they were
+class GifEncoder
+{
+public:
+
+   GifEncoder();
+   ~GifEncoder();
+
+   GifEncoder(const GifEncoder&) = delete;
+   GifEncoder& operator=(const GifEncoder&) = delete;
+
+   GifEncoder(GifEncoder&&) = delete;
+   GifEncoder& operator=(GifEncoder&&) = delete;
+
+   // The delay is the time between frames in hundredths of a second, and most viewers slow down delays under 2
+   // If the global palette is empty, every frame must have its own palette
+   bool          open(const std::string& filePath, unsigned int width, unsigned int height, unsigned int delayInCentiseconds, const std::vector<unsigned char>& globalPalette);
+   // Writes the trailer of the file
+   bool          close();
+   bool          isOpen() const;
+
+   bool          addFrame(const GifFrame& frame);
+
+   std::uint64_t getNumWrittenFrames() const;
+   std::uint64_t getNumWrittenBytes() const;
+
+private:
+
+   void          writeColorTable(const std::vector<unsigned char>& palette);
+   void          writeImageData(const unsigned char* indices, unsigned int left, unsigned int top, unsigned int width, unsigned int height, unsigned int numColors);
+
+   void          writeCode(std::uint32_t code);
+   void          flushBits();
+   void          writeByteOfImageData(unsigned char byte);
+   void          flushBuffer();
+
+   std::ofstream              mFile;
+   std::string                mFilePath;
+   unsigned int               mWidth;
+   unsigned int               mHeight;
+   unsigned int               mDelayInCentiseconds;
+   std::vector<unsigned char> mGlobalPalette;
+
+   // The colors of the previous frame, which are compared with the ones of each new frame to find the rectangle that changed
+   std::vector<std::uint32_t> mPreviousColors;
+
+   // The LZW dictionary, which maps a prefix code followed by an index to a code
+   std::vector<std::int32_t>  mDictionaryKeys;
+   std::vector<std::uint16_t> mDictionaryCodes;
+
+   // The codes are packed into bytes from the least significant bit, and the bytes are grouped into sub-blocks of up to 255 bytes
+   std::uint32_t              mBitBuffer;
+   unsigned int               mNumBitsInBuffer;
+   unsigned int               mCodeSize;
+   unsigned char              mSubBlock[256];
+   unsigned int               mSubBlockSize;
+
+   // The file is written in large chunks
+   std::vector<unsigned char> mBuffer;
+
+   std::uint64_t              mNumWrittenFrames;
+   std::uint64_t              mNumWrittenBytes;
+};
+
+#endif
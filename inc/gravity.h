@@ -0,0 +1,33 @@
+#ifndef GRAVITY_H
+#define GRAVITY_H
+
+#include <glm/glm.hpp>
+
+// The gravity states below are used as compile-time policies by World
+// Each one of them calculates the force that gravity exerts on the center of mass of a rigid body
+
+struct NoGravity
+{
+   static glm::vec2 calculateForce(float /*oneOverMass*/)
+   {
+      return glm::vec2(0.0f, 0.0f);
+   }
+};
+
+struct DownwardGravity
+{
+   static glm::vec2 calculateForce(float oneOverMass)
+   {
+      return glm::vec2(0.0f, -10.0f) / oneOverMass;
+   }
+};
+
+struct UpwardGravity
+{
+   static glm::vec2 calculateForce(float oneOverMass)
+   {
+      return glm::vec2(0.0f, 10.0f) / oneOverMass;
+   }
+};
+
+#endif
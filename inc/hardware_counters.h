@@ -0,0 +1,57 @@
+#ifndef HARDWARE_COUNTERS_H
+#define HARDWARE_COUNTERS_H
+
+#include <cstdint>
+
+struct HardwareCounterValues
+{
+   HardwareCounterValues();
+
+   HardwareCounterValues& operator+=(const HardwareCounterValues& other);
+
+   // Subtracts the raw counts of an earlier read, and then scales the differences by the ratio of the time that the counters were enabled to the time that they were running between the two reads
+   // That estimates what the counters would have counted if the kernel hadn't multiplexed them, without ever making a difference negative
+   HardwareCounterValues  operator-(const HardwareCounterValues& other) const;
+
+   std::uint64_t cycles;
+   std::uint64_t instructions;
+   std::uint64_t cacheMisses;
+   std::uint64_t branchMisses;
+
+   // In nanoseconds
+   std::uint64_t timeEnabled;
+   std::uint64_t timeRunning;
+};
+
+// A group of CPU cycle, instruction, cache miss and branch miss counters that only count the user-space work of the thread that opened them
+// The counters are read together, so the values of a read are consistent with each other
+// This uses perf_event_open on Linux, and on other platforms opening the counters always fails
+// Opening can also fail on Linux when perf_event_paranoid is too restrictive or when the hardware counters aren't exposed, like in many virtual machines
+class HardwareCounters
+{
+public:
+
+   HardwareCounters();
+   ~HardwareCounters();
+
+   HardwareCounters(const HardwareCounters&) = delete;
+   HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+   HardwareCounters(HardwareCounters&&) = delete;
+   HardwareCounters& operator=(HardwareCounters&&) = delete;
+
+   bool                  open();
+   void                  close();
+   bool                  isOpen() const;
+
+   // Returns the raw counts along with the time that the counters were enabled and running, so that only the difference of two reads is scaled
+   HardwareCounterValues read() const;
+
+private:
+
+   static const int numCounters = 4;
+
+   int                   mFileDescriptors[numCounters];
+};
+
+#endif
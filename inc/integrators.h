@@ -0,0 +1,142 @@
+#ifndef INTEGRATORS_H
+#define INTEGRATORS_H
+
+#include "rigid_body_2D.h"
+
+// The integrators below are used as compile-time policies by World
+// Each one of them calculates the future state of a rigid body from its current state, assuming that the force and the torque are constant over the time step
+
+struct RungeKutta4Integrator
+{
+   static void integrate(RigidBody2D& body, float deltaTime)
+   {
+      RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[0];
+      RigidBody2D::KinematicAndDynamicState& futureState  = body.mStates[1];
+
+      float midPointOfDeltaTime = deltaTime / 2.0f;
+
+      // Calculate new position and velocity using the classical 4th order Runge-Kutta method
+
+      // We want to solve this 2nd order ODE:
+      // F = M * X^dotdot
+      // We can solve it by writing it as a system of two 1rst order ODEs:
+      // [X^dot] = [  V  ]
+      // [V^dot]   [F / M]
+      // Where we want to find the position (X) and the velocity (V)
+
+      glm::vec2 k1Pos                     = currentState.velocityOfCenterOfMass;
+      glm::vec2 k1Vel                     = (body.mOneOverMass * currentState.forceOfCenterOfMass);
+
+      glm::vec2 velAtMidPointOfDeltaTime1 = currentState.velocityOfCenterOfMass + (k1Vel * midPointOfDeltaTime);
+
+      glm::vec2 k2Pos                     = velAtMidPointOfDeltaTime1;
+      glm::vec2 k2Vel                     = (body.mOneOverMass * currentState.forceOfCenterOfMass);
+
+      glm::vec2 velAtMidPointOfDeltaTime2 = currentState.velocityOfCenterOfMass + (k2Vel * midPointOfDeltaTime);
+
+      glm::vec2 k3Pos                     = velAtMidPointOfDeltaTime2;
+      glm::vec2 k3Vel                     = (body.mOneOverMass * currentState.forceOfCenterOfMass);
+
+      glm::vec2 velAtDeltaTime            = currentState.velocityOfCenterOfMass + (k3Vel * deltaTime);
+
+      glm::vec2 k4Pos                     = velAtDeltaTime;
+      glm::vec2 k4Vel                     = (body.mOneOverMass * currentState.forceOfCenterOfMass);
+
+      glm::vec2 weightedAverageOfPositionSlopes = ((k1Pos + (2.0f * k2Pos) + (2.0f * k3Pos) + k4Pos) / 6.0f);
+      glm::vec2 weightedAverageOfVelocitySlopes = ((k1Vel + (2.0f * k2Vel) + (2.0f * k3Vel) + k4Vel) / 6.0f);
+
+      // P_n+1 = P_n + (h * weightedAverageOfPositionSlopes)
+      futureState.positionOfCenterOfMass = currentState.positionOfCenterOfMass + (weightedAverageOfPositionSlopes * deltaTime);
+
+      // V_n+1 = V_n + (h * weightedAverageOfVelocitySlopes)
+      futureState.velocityOfCenterOfMass = currentState.velocityOfCenterOfMass + (weightedAverageOfVelocitySlopes * deltaTime);
+
+      // Calculate new orientation and angular velocity using the classical 4th order Runge-Kutta method
+
+      // We want to solve this 2nd order ODE:
+      // T = I * O^dotdot
+      // We can solve it by writing it as a system of two 1rst order ODEs:
+      // [O^dot] = [  W  ]
+      // [W^dot]   [T / I]
+      // Where we want to find the orientation (O) and the angular velocity (W)
+
+      float k1Ori                     = currentState.angularVelocity;
+      float k1Ang                     = (body.mOneOverMomentOfInertia * currentState.torque);
+
+      float angAtMidPointOfDeltaTime1 = currentState.angularVelocity + (k1Ang * midPointOfDeltaTime);
+
+      float k2Ori                     = angAtMidPointOfDeltaTime1;
+      float k2Ang                     = (body.mOneOverMomentOfInertia * currentState.torque);
+
+      float angAtMidPointOfDeltaTime2 = currentState.angularVelocity + (k2Ang * midPointOfDeltaTime);
+
+      float k3Ori                     = angAtMidPointOfDeltaTime2;
+      float k3Ang                     = (body.mOneOverMomentOfInertia * currentState.torque);
+
+      float angAtDeltaTime            = currentState.angularVelocity + (k3Ang * deltaTime);
+
+      float k4Ori                     = angAtDeltaTime;
+      float k4Ang                     = (body.mOneOverMomentOfInertia * currentState.torque);
+
+      float weightedAverageOfOrientationSlopes = ((k1Ori + (2.0f * k2Ori) + (2.0f * k3Ori) + k4Ori) / 6.0f);
+      float weightedAverageOfAngularVelocitySlopes = ((k1Ang + (2.0f * k2Ang) + (2.0f * k3Ang) + k4Ang) / 6.0f);
+
+      // O_n+1 = O_n + (h * weightedAverageOfOrientationSlopes)
+      futureState.orientation = currentState.orientation + (weightedAverageOfOrientationSlopes * deltaTime);
+
+      // W_n+1 = W_n + (h * weightedAverageOfAngularVelocitySlopes)
+      futureState.angularVelocity = currentState.angularVelocity + (weightedAverageOfAngularVelocitySlopes * deltaTime);
+   }
+};
+
+struct SemiImplicitEulerIntegrator
+{
+   static void integrate(RigidBody2D& body, float deltaTime)
+   {
+      RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[0];
+      RigidBody2D::KinematicAndDynamicState& futureState  = body.mStates[1];
+
+      // Calculate new velocity using Euler's method, and then use it to calculate the new position
+      // Unlike the explicit version, this method is symplectic, so it doesn't add energy to the system
+
+      // V_n+1 = V_n + (h * (F / M))
+      futureState.velocityOfCenterOfMass = currentState.velocityOfCenterOfMass + ((deltaTime * body.mOneOverMass) * currentState.forceOfCenterOfMass);
+
+      // X_n+1 = X_n + (h * V_n+1)
+      futureState.positionOfCenterOfMass = currentState.positionOfCenterOfMass + (futureState.velocityOfCenterOfMass * deltaTime);
+
+      // W_n+1 = W_n + (h * (T / I))
+      futureState.angularVelocity = currentState.angularVelocity + ((deltaTime * body.mOneOverMomentOfInertia) * currentState.torque);
+
+      // O_n+1 = O_n + (h * W_n+1)
+      futureState.orientation = currentState.orientation + (futureState.angularVelocity * deltaTime);
+   }
+};
+
+struct VelocityVerletIntegrator
+{
+   static void integrate(RigidBody2D& body, float deltaTime)
+   {
+      RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[0];
+      RigidBody2D::KinematicAndDynamicState& futureState  = body.mStates[1];
+
+      // The forces are constant over a step, so the acceleration at the end of the step is the same as the one at the beginning
+      // That means that we only need to evaluate it once, and that the result is exact for constant forces
+      glm::vec2 linearAcceleration  = body.mOneOverMass * currentState.forceOfCenterOfMass;
+      float     angularAcceleration = body.mOneOverMomentOfInertia * currentState.torque;
+
+      // X_n+1 = X_n + (h * V_n) + ((h^2 / 2) * A_n)
+      futureState.positionOfCenterOfMass = currentState.positionOfCenterOfMass + (currentState.velocityOfCenterOfMass * deltaTime) + (((deltaTime * deltaTime) / 2.0f) * linearAcceleration);
+
+      // V_n+1 = V_n + ((h / 2) * (A_n + A_n+1))
+      futureState.velocityOfCenterOfMass = currentState.velocityOfCenterOfMass + (deltaTime * linearAcceleration);
+
+      // O_n+1 = O_n + (h * W_n) + ((h^2 / 2) * Alpha_n)
+      futureState.orientation = currentState.orientation + (currentState.angularVelocity * deltaTime) + (((deltaTime * deltaTime) / 2.0f) * angularAcceleration);
+
+      // W_n+1 = W_n + ((h / 2) * (Alpha_n + Alpha_n+1))
+      futureState.angularVelocity = currentState.angularVelocity + (deltaTime * angularAcceleration);
+   }
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef MAPPED_SCENE_H
+#define MAPPED_SCENE_H
+
+#include <cstddef>
+#include <string>
+
+#include "scene.h"
+
+// A binary scene file that is mapped into memory, so its walls and bodies can be used where they are without being parsed or copied
+// The bodies are RigidBody2D objects in their initial state, and they stay valid until the file is closed
+// Mapping a file with hundreds of thousands of bodies only costs the page faults of the parts that are read
+// Only files that were written with the memory layout and the byte order of this build can be mapped, and copyTo is then a single bulk copy
+// The header records a signature of the layout rather than the offset of each member, so files with another layout can't be converted field by field
+// Such files are rejected, and they have to be converted from their text form with SceneConverter instead
+class MappedScene
+{
+public:
+
+   MappedScene();
+   ~MappedScene();
+
+   MappedScene(const MappedScene&) = delete;
+   MappedScene& operator=(const MappedScene&) = delete;
+
+   MappedScene(MappedScene&&) = delete;
+   MappedScene& operator=(MappedScene&&) = delete;
+
+   // Returns false if the file isn't a binary scene or if it was written by a build that lays bodies out differently
+   bool                   open(const std::string& filePath);
+   void                   close();
+   bool                   isOpen() const;
+
+   std::string            getName() const;
+   glm::vec2              getDimensions() const;
+   int                    getGravityState() const;
+   float                  getTimeStep() const;
+
+   std::size_t            getNumWalls() const;
+   const SceneWallRecord* getWalls() const;
+
+   std::size_t            getNumRigidBodies() const;
+   const RigidBody2D*     getRigidBodies() const;
+
+   // Creates the walls, and copies all of the bodies at once
+   void                   copyTo(Scene& scene) const;
+
+private:
+
+   const SceneFileHeader* getHeader() const;
+
+   const unsigned char*   mData;
+   std::size_t            mSize;
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   void*                  mFileHandle;
+   void*                  mMappingHandle;
+#endif
+};
+
+#endif
@@ -1,7 +1,14 @@
 #ifndef MENU_STATE_H
 #define MENU_STATE_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <thread>
+
 #include "game.h"
+#include "frame_encoder.h"
+#include "frame_readback.h"
+#include "raw_video_sink.h"
 
 class MenuState : public State
 {
@@ -38,9 +45,23 @@ public:
 
    void enableRecording(bool record) override;
    void generateGIF() override;
+   void enablePerFrameGifPalettes(bool enable) override;
+   void setCaptureFilePath(const std::string& filePath) override;
+   void setCaptureFrameRate(unsigned int framesPerSecond) override;
+   void setCaptureSize(unsigned int width, unsigned int height) override;
 
 private:
 
+   void         startCaptureClock(float simulatedTime);
+   // Returns how many output frames the simulated time went past since the last call, each of which shows the current frame
+   unsigned int advanceCaptureClock(float simulatedTime);
+   void         captureFrame();
+   // Used by recordings with a fixed size, unless remember frames is enabled
+   void         renderWorldIntoCaptureFramebuffer(float lowerLeftCornerOfViewportX, float lowerLeftCornerOfViewportY, float widthOfViewport, float heightOfViewport);
+   void         encodeOldestRecordedFrame();
+   void         retireReadRecordedFrames();
+   void         finishRecording();
+
    bool                                mChangeScene;
    glm::vec2                           mCurrentSceneDimensions;
 
@@ -59,7 +80,26 @@ private:
    bool                                mRecord;
    int                                 mRecordingDirectory;
    int                                 mRecordedFrameCounter;
-   GLubyte*                            mRecordedFrameData;
+   FrameReadback                       mFrameReadback;
+   std::unique_ptr<CaptureSink>        mCaptureSink;
+   FrameEncoder::PaletteMode           mGifPaletteMode;
+   std::string                         mCaptureFilePath;   // Empty if the recordings are GIFs
+   unsigned int                        mCaptureFramesPerSecond;
+   unsigned int                        mCaptureWidth;      // Zero if the recordings have the size of the framebuffer
+   unsigned int                        mCaptureHeight;
+
+   // The frames of a recording are sampled in simulated time, and output frame N shows the state that is closest to the start of the recording plus N periods
+   double                              mCapturePeriod;
+   double                              mCaptureStartTime;
+   float                               mLastCaptureClockTime;
+   std::uint64_t                       mNumCapturedSlots;
+   std::uint64_t                       mNumRenderedFramesWhileRecording;
+   std::uint64_t                       mNumSampledFrames;
+   std::uint64_t                       mNumRepeatedFrames;
+   bool                                mRecordingIsFinished;
+   std::mutex                          mRecordingMutex;
+   std::condition_variable             mRecordingFinishedCondition;
+   std::thread::id                     mRenderThreadID;
 
    std::shared_ptr<FiniteStateMachine> mFSM;
 
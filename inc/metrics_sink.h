@@ -0,0 +1,100 @@
+#ifndef METRICS_SINK_H
+#define METRICS_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A fixed-size record that describes a single call to World::simulate
+// In the binary format the records are written as they are laid out in memory, after a header that contains the magic string "DKMETRIC", a version and the size of a record
+struct StepMetrics
+{
+   StepMetrics();
+
+   std::uint64_t stepIndex;
+   std::int64_t  stepDurationInNs;
+   float         simulatedTime;
+   float         kineticEnergy;
+   float         linearMomentumX;
+   float         linearMomentumY;
+   float         angularMomentum;       // About the origin
+   std::uint32_t numBodyWallContacts;
+   std::uint32_t numBodyBodyContacts;
+   std::uint32_t numSolverIterations;
+   std::uint32_t numSubsteps;
+   std::uint32_t numSubdivisions;
+   std::uint32_t numRejectedSteps;      // Only counted in adaptive time-step mode
+   std::int32_t  errorCode;
+   std::uint64_t stateHash;             // Only calculated in deterministic mode, and zero otherwise
+};
+
+// The binary format writes whole records, so they mustn't contain any padding
+static_assert(sizeof(StepMetrics) == 72, "StepMetrics must not contain padding");
+
+// The simulation thread pushes records into a lock-free ring buffer, and a background thread writes them to a file
+// Pushing never blocks or allocates, and if the writer falls behind the records that don't fit are dropped and counted
+// There must only be one thread that pushes records
+class MetricsSink
+{
+public:
+
+   enum class Format : unsigned int
+   {
+      csv    = 0,
+      binary = 1,
+   };
+
+   // The capacity is rounded up to a power of two
+   explicit MetricsSink(std::size_t capacity = 1 << 14);
+   ~MetricsSink();
+
+   MetricsSink(const MetricsSink&) = delete;
+   MetricsSink& operator=(const MetricsSink&) = delete;
+
+   MetricsSink(MetricsSink&&) = delete;
+   MetricsSink& operator=(MetricsSink&&) = delete;
+
+   // Files that end in .bin use the binary format, and all others use the CSV format
+   static Format getFormatOfFile(const std::string& filePath);
+
+   // Reads back a file in either format, which is detected from its contents
+   static bool   read(const std::string& filePath, std::vector<StepMetrics>& records);
+
+   bool          open(const std::string& filePath, Format format);
+   // Writes the records that are still in the ring buffer and stops the background thread
+   void          close();
+   bool          isOpen() const;
+
+   bool          push(const StepMetrics& metrics);
+
+   std::uint64_t getNumWrittenRecords() const;
+   std::uint64_t getNumDroppedRecords() const;
+
+private:
+
+   void          runWriter();
+   std::size_t   writeAvailableRecords();
+   void          writeRecord(const StepMetrics& metrics);
+
+   std::vector<StepMetrics>   mRecords;
+   std::size_t                mMask;
+
+   // The producer and the consumer indices are kept on different cache lines so that the two threads don't slow each other down
+   std::atomic<std::uint64_t> mWriteIndex;
+   char                       mWriteIndexPadding[64];
+   std::atomic<std::uint64_t> mReadIndex;
+   char                       mReadIndexPadding[64];
+
+   std::atomic<std::uint64_t> mNumWrittenRecords;
+   std::atomic<std::uint64_t> mNumDroppedRecords;
+
+   std::atomic<bool>          mStopWriter;
+   std::thread                mWriterThread;
+   std::ofstream              mFile;
+   Format                     mFormat;
+};
+
+#endif
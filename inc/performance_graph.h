@@ -0,0 +1,38 @@
+#ifndef PERFORMANCE_GRAPH_H
+#define PERFORMANCE_GRAPH_H
+
+#include <QtWidgets/QWidget>
+
+#include <deque>
+
+// A rolling line graph of the most recent samples of a single quantity
+// The vertical axis always starts at zero and is scaled to the largest sample that is visible
+class PerformanceGraph : public QWidget
+{
+public:
+
+   PerformanceGraph(const QString& title,
+                    const QString& unit,
+                    const QColor&  color,
+                    int            maxNumSamples,
+                    QWidget*       parent = Q_NULLPTR);
+
+   void  addSample(double value);
+   void  clear();
+
+   QSize sizeHint() const override;
+
+protected:
+
+   void  paintEvent(QPaintEvent* event) override;
+
+private:
+
+   QString            mTitle;
+   QString            mUnit;
+   QColor             mColor;
+   int                mMaxNumSamples;
+   std::deque<double> mSamples;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PROCEDURAL_SCENES_H
+#define PROCEDURAL_SCENES_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "scene.h"
+
+// Scenes with any number of bodies for stress tests:
+// - rectangleSoup: rectangles of random sizes that move in random directions inside a box without gravity
+// - brickWall:     a wall of bricks in a running bond that stands on the floor under gravity
+// - pyramid:       rows of bricks that get shorter towards the top and stand on the floor under gravity
+// - funnel:        rectangles that fall from the top of a hopper into its narrow bottom under gravity
+// - polygonArena:  rectangles that move in random directions inside a regular polygon without gravity
+//
+// The walls of the funnel form a closed convex shape, since World treats every wall as an infinite plane
+// The collision response averages the contacts of each body, which can't hold up wide stacks, so brick walls that are more than two bricks wide and pyramids
+// with more than five bricks in their bottom row usually end in an unresolvable penetration error within a few hundred steps
+enum class ProceduralSceneType : unsigned int
+{
+   rectangleSoup = 0,
+   brickWall     = 1,
+   pyramid       = 2,
+   funnel        = 3,
+   polygonArena  = 4,
+   numTypes      = 5,
+};
+
+// The names are used in the scene combo box, and the identifiers are used in scene files and on command lines
+const char* getProceduralSceneName(ProceduralSceneType type);
+const char* getProceduralSceneIdentifier(ProceduralSceneType type);
+bool        findProceduralSceneType(const std::string& identifier, ProceduralSceneType& type);
+
+// The bodies never overlap each other or the walls at the start, and the walls are sized to fit the number of bodies
+// Only the random number generator of the call is used, so this can be called from several threads at once
+// The same type, number of bodies and seed always produce the same scene, whichever standard library is used
+Scene       generateProceduralScene(ProceduralSceneType type, int numBodies, std::uint32_t seed);
+
+// The standard specifies the output of std::mt19937, but not the algorithms of the distributions
+// That's why this makes floats in [min, max) from its raw output, so that a seed gives the same numbers with every standard library
+float       generateRandomFloat(std::mt19937& generator, float min, float max);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef RAW_VIDEO_SINK_H
+#define RAW_VIDEO_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_sink.h"
+
+// Streams recorded frames without compression to a file or a named pipe, so that an external encoder can consume them while recording
+// The RGB format is the frames themselves with the rows from the top of the image to the bottom, which ffmpeg reads with -f rawvideo -pixel_format rgb24
+// The Y4M format is a YUV4MPEG2 stream with full resolution chroma (C444), which carries its own size and frame rate
+//
+// A background thread converts the frames into a large buffer, and the buffer is written whenever it's full, so the output only sees large sequential writes
+// The output is opened by the background thread when the first frame arrives, because opening a named pipe waits for a reader
+// A frame is read as soon as it's converted into the buffer, and the buffer is only written after that, so a slow output never holds on to a frame
+class RawVideoSink : public CaptureSink
+{
+public:
+
+   enum class Format : unsigned int
+   {
+      rgb = 0,
+      y4m = 1
+   };
+
+   // Files that end in .y4m use the Y4M format, and everything else, including named pipes, uses the RGB format
+   static Format getFormatOfFile(const std::string& filePath);
+
+   RawVideoSink(const std::string& filePath, Format format, unsigned int framesPerSecond);
+   ~RawVideoSink();
+
+   unsigned int  getNumThreads() const override;
+
+   bool          close() override;
+
+   void          push(const Frame& frame) override;
+
+   bool          hasFramesToRetire() const override;
+   bool          oldestFrameIsRead() const override;
+   void          retireOldestFrame() override;
+
+   std::uint64_t getNumWrittenFrames() const override;
+   std::uint64_t getNumWrittenBytes() const override;
+   std::uint64_t getNumStalls() const override;
+
+private:
+
+   struct QueuedFrame
+   {
+      Frame frame;
+      bool  isRead;
+   };
+
+   void          runWriter();
+   bool          open(unsigned int width, unsigned int height);
+   void          convertFrame(const Frame& frame);
+   void          flushBuffer();
+
+   std::string                mFilePath;
+   Format                     mFormat;
+   unsigned int               mFramesPerSecond;
+
+   // The frames that haven't been retired yet, where the frame that was pushed in position N is at N - mNumRetiredFrames
+   std::deque<QueuedFrame>    mQueuedFrames;
+   std::uint64_t              mNumRetiredFrames;
+   std::uint64_t              mNumTakenFrames;   // By the writer, including the retired ones
+   bool                       mStopWriter;
+
+   mutable std::mutex         mMutex;
+   std::condition_variable    mWorkCondition;
+   std::condition_variable    mFrameReadCondition;
+
+   // Only used by the writer thread, or by close once it has stopped
+   std::ofstream              mFile;
+   std::vector<unsigned char> mBuffer;
+   bool                       mWriteFailed;
+
+   std::atomic<std::uint64_t> mNumWrittenFrames;
+   std::atomic<std::uint64_t> mNumWrittenBytes;
+   std::atomic<std::uint64_t> mNumStalls;
+
+   std::thread                mWriterThread;
+};
+
+#endif
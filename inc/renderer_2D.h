@@ -1,6 +1,8 @@
 #ifndef RENDERER_2D_H
 #define RENDERER_2D_H
 
+#include <memory>
+
 #include "shader.h"
 #include "rigid_body_2D.h"
 #include "wall.h"
@@ -0,0 +1,116 @@
+#ifndef REPLAY_BUFFER_H
+#define REPLAY_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rigid_body_2D.h"
+#include "trajectory_recorder.h"
+
+// Keeps the last seconds of the simulation in memory as compressed trajectory frames, so that they can be saved after something interesting happened
+// The simulation thread copies the bodies into a ring buffer of frames, and a background thread encodes them like TrajectoryRecorder does
+//
+// The encoded frames are grouped into segments that each start with a keyframe, and the oldest segments are dropped once the rest cover the duration of the replay
+// That way the memory use is bounded by the duration, the maximum number of bytes and the capacity of the ring buffer
+// Unlike TrajectoryRecorder, the simulation thread never waits for the encoder: if the ring buffer is full the frame is dropped, and the next frame becomes a keyframe
+// When the step index starts over, because the scene was changed or reset, the frames before it are dropped, since they belong to a different run
+//
+// There must only be one thread that pushes frames, but any thread can save the replay
+class ReplayBuffer
+{
+public:
+
+   // The duration is in seconds of simulated time, and the capacity is a number of frames, which is rounded up to a power of two
+   // The keyframe interval is shorter than the one of TrajectoryRecorder, since it's also how many frames are dropped at once
+   explicit ReplayBuffer(float durationInSeconds = 10.0f, std::size_t maxNumBytes = 64 * 1024 * 1024, std::size_t capacity = 64, std::uint32_t keyframeInterval = 64, float positionQuantum = 1.0f / 256.0f);
+   ~ReplayBuffer();
+
+   ReplayBuffer(const ReplayBuffer&) = delete;
+   ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+   ReplayBuffer(ReplayBuffer&&) = delete;
+   ReplayBuffer& operator=(ReplayBuffer&&) = delete;
+
+   // The current state of each body is recorded
+   // When the number of bodies changes, the ring buffer is resized once the encoder has caught up
+   void          push(std::uint64_t stepIndex, float simulatedTime, const std::vector<RigidBody2D>& rigidBodies);
+
+   // Writes the frames that are in memory to a trajectory file, which TrajectoryReader and OfflineRenderer can read
+   // The frames that are still waiting to be encoded aren't included, and the simulation thread keeps pushing while the file is written
+   bool          save(const std::string& filePath);
+
+   std::uint64_t getNumFrames() const;
+   // The simulated time that the frames in memory cover
+   float         getDuration() const;
+   // The size of the encoded frames in memory, without the ring buffer
+   std::uint64_t getNumBytes() const;
+   // The number of frames that were dropped because the encoder couldn't keep up
+   std::uint64_t getNumDroppedFrames() const;
+   std::uint64_t getNumEncodedFrames() const;
+   // The time that the background thread spent encoding, which is the cost of the replay besides the copies in push
+   double        getEncodingTimeInSeconds() const;
+
+private:
+
+   struct FrameSlot
+   {
+      std::uint64_t stepIndex;
+      float         simulatedTime;
+      std::uint32_t numBodies;
+   };
+
+   struct Segment
+   {
+      std::vector<unsigned char> bytes;
+      std::uint64_t              numFrames;
+      float                      startTime;
+      float                      endTime;
+   };
+
+   void          runEncoder();
+   std::size_t   encodeAvailableFrames();
+   void          encodeFrame(const FrameSlot& slot, const TrajectoryPose* poses);
+   // Drops the oldest segments that aren't needed to cover the duration or that don't fit in the maximum number of bytes
+   void          dropOldSegments();
+
+   float                       mDurationInSeconds;
+   std::size_t                 mMaxNumBytes;
+
+   std::vector<FrameSlot>      mSlots;
+   std::vector<TrajectoryPose> mPoses;
+   std::size_t                 mMask;
+   std::uint32_t               mNumBodies;
+
+   // The producer and the consumer indices are kept on different cache lines so that the two threads don't slow each other down
+   std::atomic<std::uint64_t>  mWriteIndex;
+   char                        mWriteIndexPadding[64];
+   std::atomic<std::uint64_t>  mReadIndex;
+   char                        mReadIndexPadding[64];
+
+   std::atomic<std::uint64_t>  mNumDroppedFrames;
+   std::atomic<std::uint64_t>  mNumEncodedFrames;
+   std::atomic<std::uint64_t>  mEncodingTimeInNanoseconds;
+
+   std::atomic<bool>           mStopEncoder;
+   std::thread                 mEncoderThread;
+
+   // Only used by the encoder thread
+   TrajectoryFrameEncoder      mEncoder;
+   std::vector<unsigned char>  mEncodedFrame;
+   std::uint64_t               mLastStepIndex;
+
+   // The oldest segment is first and the one that the encoder appends to is last
+   // The segments are shared with save, so that it can write the ones that are finished without holding the mutex
+   mutable std::mutex          mMutex;
+   std::deque<std::shared_ptr<Segment>> mSegments;
+   std::uint64_t               mNumFramesInSegments;
+   std::uint64_t               mNumBytesInSegments;
+};
+
+#endif
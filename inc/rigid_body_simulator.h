@@ -4,6 +4,8 @@
 #include <QtWidgets/QWidget>
 
 #include "ui_rigid_body_simulator.h"
+#include "performance_graph.h"
+#include "scene_library.h"
 
 class RigidBodySimulator : public QWidget
 {
@@ -11,11 +13,17 @@ class RigidBodySimulator : public QWidget
 
 public:
 
-   RigidBodySimulator(QWidget *parent = Q_NULLPTR);
+   RigidBodySimulator(const SceneLibrary& sceneLibrary, QWidget *parent = Q_NULLPTR);
 
 public slots:
 
    void processSimulationError(int errorCode);
+   void processPerformanceSample(double physicsStepTime,
+                                 double renderTime,
+                                 double substepsPerFrame,
+                                 double contactsPerFrame,
+                                 double solverIterationsPerFrame,
+                                 double framesPerSecond);
 
 private slots:
 
@@ -30,13 +38,18 @@ private slots:
 
    void onTimeStepSpinBoxValueChanged(double timeStep);
    void onCoefficientOfRestitutionSpinBoxValueChanged(double coefficientOfRestitution);
+   void onIntegratorComboBoxCurrentIndexChanged(int index);
+   void onAdaptiveTimeStepCheckBoxToggled(bool checked);
+   void onContinuousCollisionDetectionCheckBoxToggled(bool checked);
 
    void onWireframeModeCheckBoxToggled(bool checked);
+   void onPerformancePanelCheckBoxToggled(bool checked);
    void onRememberFramesCheckBoxToggled(bool checked);
    void onRememberFramesSpinBoxValueChanged(int frequency);
    void onAntiAliasingModeCheckBoxToggled(bool checked);
    void onAntiAliasingModeComboBoxCurrentIndexChanged(int index);
    void onRecordGIFCheckBoxToggled(bool checked);
+   void onSaveReplayPushButtonClicked();
 
 signals:
 
@@ -50,13 +63,18 @@ signals:
 
    void changeTimeStep(double timeStep);
    void changeCoefficientOfRestitution(double coefficientOfRestitution);
+   void changeIntegrator(int index);
+   void enableAdaptiveTimeStep(bool enable);
+   void enableContinuousCollisionDetection(bool enable);
 
    void enableWireframeMode(bool enable);
+   void enablePerformanceSampling(bool enable);
    void enableRememberFrames(bool enable);
    void changeRememberFramesFrequency(int frequency);
    void enableAntiAliasing(bool enable);
    void changeAntiAliasingMode(int index);
    void enableRecordGIF(bool enable);
+   void saveReplay();
 
 private:
 
@@ -67,6 +85,14 @@ private:
    QPalette                    mRunningPalette;
    QPalette                    mPausedPalette;
    QPalette                    mErrorPalette;
+
+   QWidget*                    mPerformancePanel;
+   PerformanceGraph*           mPhysicsStepTimeGraph;
+   PerformanceGraph*           mRenderTimeGraph;
+   PerformanceGraph*           mSubstepsGraph;
+   PerformanceGraph*           mContactsGraph;
+   PerformanceGraph*           mSolverIterationsGraph;
+   PerformanceGraph*           mFramesPerSecondGraph;
 };
 
 #endif
@@ -0,0 +1,106 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "wall.h"
+#include "rigid_body_2D.h"
+
+// A scene and the settings that it should be simulated with, which can be saved to and loaded from a text file
+// Each line of the file is a keyword followed by its values, and lines that start with # are comments:
+//
+// name       Hexagon
+// dimensions 850 850
+// gravity    0
+// time_step  0.02
+// wall       normalX normalY startX startY endX endY
+// body       mass width height restitution positionX positionY orientation velocityX velocityY angularVelocity red green blue
+// generate   type numBodies seed
+//
+// A generate line adds the walls and bodies of a procedural scene, whose types are listed in procedural_scenes.h
+// Floats are written with enough digits to be read back exactly, so a scene that is saved and loaded again simulates identically
+//
+// The binary format holds the same values, and is laid out so that a file can be memory-mapped and used without parsing or copying it
+// It starts with a SceneFileHeader, which is followed by the name, the walls and the bodies at the offsets that it gives
+// The walls are stored as SceneWallRecords and the bodies are stored as the bytes of RigidBody2D objects, and both arrays start at multiples of 64 bytes
+// A file can only be read by a build that lays RigidBody2D out in the same way and has the same byte order, which the header records
+struct SceneWallRecord
+{
+   glm::vec2 normal;
+   glm::vec2 startPoint;
+   glm::vec2 endPoint;
+};
+
+struct SceneFileHeader
+{
+   // Fills in the magic string, the version and the layout of this build
+   SceneFileHeader();
+
+   bool          hasValidMagicAndVersion() const;
+   bool          hasLayoutOfThisBuild() const;
+
+   char          magic[8];              // "DKSCENE"
+   std::uint32_t version;
+   std::uint32_t headerSize;
+   std::uint32_t byteOrderMark;         // 0x01020304 in the byte order of the machine that wrote the file
+   std::uint32_t wallRecordSize;
+   std::uint32_t bodyRecordSize;
+   std::uint32_t bodyLayoutSignature;   // A hash of the offsets of the members of RigidBody2D
+   std::uint64_t nameOffset;
+   std::uint64_t nameLength;
+   std::uint64_t wallsOffset;
+   std::uint64_t numWalls;
+   std::uint64_t bodiesOffset;
+   std::uint64_t numBodies;
+   glm::vec2     dimensions;
+   std::int32_t  gravityState;
+   float         timeStep;
+};
+
+struct Scene
+{
+   enum class Format : unsigned int
+   {
+      text   = 0,
+      binary = 1,
+   };
+
+   Scene();
+
+   Scene(const Scene&) = delete;
+   Scene& operator=(const Scene&) = delete;
+
+   Scene(Scene&&) = default;
+   Scene& operator=(Scene&&) = default;
+
+   // Files that end in .bin use the binary format, and all others use the text format
+   static Format            getFormatOfFile(const std::string& filePath);
+
+   // Reads only the name of a scene file in either format, which is much faster than loading the whole scene
+   static bool              readName(const std::string& filePath, std::string& name);
+
+   // Loads a file in either format, which is detected from its contents, and binary files are read through a MappedScene
+   bool                     load(const std::string& filePath);
+   // Saves a file in the format that matches its name
+   bool                     save(const std::string& filePath) const;
+
+   bool                     read(std::istream& stream);
+   void                     write(std::ostream& stream) const;
+
+   void                     writeBinary(std::ostream& stream) const;
+
+   std::string              name;
+   glm::vec2                dimensions;
+   int                      gravityState;
+   float                    timeStep;
+   std::vector<Wall>        walls;
+   std::vector<RigidBody2D> rigidBodies;
+};
+
+#endif
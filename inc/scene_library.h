@@ -0,0 +1,39 @@
+#ifndef SCENE_LIBRARY_H
+#define SCENE_LIBRARY_H
+
+#include <string>
+#include <vector>
+
+#include "scene.h"
+
+// The scene files of a directory, in the order of their file names
+// Opening the library only reads the name of each scene, and a scene is only parsed when it's loaded
+// Files that end in .scene use the text format, and files that end in .bin use the binary format
+class SceneLibrary
+{
+public:
+
+   SceneLibrary();
+
+   SceneLibrary(const SceneLibrary&) = delete;
+   SceneLibrary& operator=(const SceneLibrary&) = delete;
+
+   SceneLibrary(SceneLibrary&&) = default;
+   SceneLibrary& operator=(SceneLibrary&&) = default;
+
+   // Returns false if the directory can't be listed or doesn't contain any scenes
+   bool               open(const std::string& directoryPath);
+
+   int                getNumScenes() const;
+   const std::string& getSceneName(int index) const;
+   const std::string& getSceneFilePath(int index) const;
+
+   bool               loadScene(int index, Scene& scene) const;
+
+private:
+
+   std::vector<std::string> mNames;
+   std::vector<std::string> mFilePaths;
+};
+
+#endif
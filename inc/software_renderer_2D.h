@@ -0,0 +1,48 @@
+#ifndef SOFTWARE_RENDERER_2D_H
+#define SOFTWARE_RENDERER_2D_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Rasterizes the bodies and the walls of a scene on the CPU into an RGB image that can be written to a PNG
+// It draws what Renderer2D draws, filled colored rectangles and white lines on a black background, so it doesn't need an OpenGL context and can run on any number of threads at once
+//
+// The scene is scaled to fit the image while keeping its aspect ratio, so an image of any resolution shows the same part of the world as the window does
+// Edges are antialiased by testing a grid of samplesPerPixel points in each pixel near them and blending the color of a shape by the fraction of the points that it covers
+class SoftwareRenderer2D
+{
+public:
+
+   // samplesPerPixel is rounded down to a square number, and it's at least 1
+   SoftwareRenderer2D(int widthInPix, int heightInPix, glm::vec2 sceneDimensions, int samplesPerPixel);
+
+   void                              clear();
+
+   void                              renderRigidBody(glm::vec2 positionOfCenterOfMass, float orientation, float width, float height, glm::vec3 color);
+   // The width of the line is in pixels
+   void                              renderLine(glm::vec2 startPoint, glm::vec2 endPoint, float widthInPix = 1.0f);
+
+   int                               getWidthInPix() const;
+   int                               getHeightInPix() const;
+
+   // The rows go from the top of the image to the bottom, and each pixel is three bytes
+   const std::vector<unsigned char>& getPixels() const;
+
+private:
+
+   glm::vec2                         convertWorldToImage(glm::vec2 worldPosition) const;
+
+   // The signed distance of a point in the image to the edge of the shape is negative inside of it
+   template<typename TSignedDistance>
+   void                              fill(glm::vec2 boundsMin, glm::vec2 boundsMax, glm::vec3 color, TSignedDistance signedDistance);
+
+   int                               mWidthInPix;
+   int                               mHeightInPix;
+   float                             mPixelsPerWorldUnit;
+   int                               mSamplesPerAxis;
+
+   std::vector<unsigned char>        mPixels;
+};
+
+#endif
@@ -35,6 +35,10 @@ public:
 
    virtual void enableRecording(bool enable) {};
    virtual void generateGIF() {};
+   virtual void enablePerFrameGifPalettes(bool enable) {};
+   virtual void setCaptureFilePath(const std::string& filePath) {};
+   virtual void setCaptureFrameRate(unsigned int framesPerSecond) {};
+   virtual void setCaptureSize(unsigned int width, unsigned int height) {};
 };
 
 #endif
@@ -0,0 +1,75 @@
+#ifndef TRAJECTORY_READER_H
+#define TRAJECTORY_READER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "trajectory_recorder.h"
+
+// The poses of the bodies after a recorded step, in the order of the bodies in their scene
+struct TrajectoryFrame
+{
+   TrajectoryFrame();
+
+   std::uint64_t          frameIndex;
+   std::uint64_t          stepIndex;       // The step index of World, which starts over when a scene is changed or reset
+   float                  simulatedTime;
+   std::vector<glm::vec2> positions;
+   std::vector<float>     orientations;    // In the range [0, 2 * pi)
+};
+
+// Reads the files written by TrajectoryRecorder
+// A frame is found by seeking to the closest keyframe before it and decoding the frames from there, so reading any frame only costs at most a keyframe interval of frames
+// Reading the frames in order continues from the previous frame instead of going back to a keyframe
+class TrajectoryReader
+{
+public:
+
+   TrajectoryReader();
+
+   TrajectoryReader(const TrajectoryReader&) = delete;
+   TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+   TrajectoryReader(TrajectoryReader&&) = delete;
+   TrajectoryReader& operator=(TrajectoryReader&&) = delete;
+
+   bool          open(const std::string& filePath);
+   void          close();
+   bool          isOpen() const;
+
+   std::uint64_t getNumFrames() const;
+   std::uint64_t getNumKeyframes() const;
+   float         getPositionQuantum() const;
+
+   // Frames are numbered in the order in which they were recorded, starting at zero
+   bool          readFrame(std::uint64_t frameIndex, TrajectoryFrame& frame);
+   // Reads the frame that follows the one that was read last, or the first frame if none was read yet, and returns false at the end of the file
+   bool          readNextFrame(TrajectoryFrame& frame);
+
+private:
+
+   bool          readIndex();
+   bool          scanFrames();
+   bool          seekToKeyframe(std::size_t keyframeIndex);
+
+   std::ifstream                        mFile;
+   TrajectoryFileHeader                 mHeader;
+   std::vector<TrajectoryKeyframeEntry> mKeyframes;
+   std::uint64_t                        mNumFrames;
+   std::uint64_t                        mFramesEndOffset;
+
+   // The state of the decoder, which predicts each frame from the two frames before it
+   std::uint64_t                        mNextFrameIndex;
+   std::uint64_t                        mNextFrameOffset;
+   std::uint32_t                        mNumFramesSinceKeyframe;
+   std::vector<std::int64_t>            mPreviousValues;
+   std::vector<std::int64_t>            mValuesBeforePrevious;
+   std::vector<std::int64_t>            mResiduals;
+   std::vector<unsigned char>           mPayload;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rigid_body_2D.h"
+
+// A trajectory file holds the position and the orientation of every body after each recorded step
+// It starts with a TrajectoryFileHeader, which is followed by one frame per step and ends with an index of the keyframes and a TrajectoryFileFooter
+//
+// Positions are quantized to multiples of positionQuantum and orientations to 1/65536 of a turn
+// A keyframe stores the quantized values themselves, and the frames after it store the residuals to the values that were predicted from the two frames before them
+// Each frame is a TrajectoryFrameHeader followed by groups of numBodiesPerGroup bodies, and each group is byte aligned
+// A group starts with three bytes that hold the bit widths of its X position, Y position and orientation residuals, followed by the zigzag-encoded residuals packed with those widths
+// Bodies that rest or fly on a parabola are predicted almost exactly, so their residuals only take a few bits
+//
+// Frames are numbered in the order in which they were recorded, which is how TrajectoryReader finds them
+// Each frame also holds the step index of World, which starts over when a scene is changed or reset, and such a restart always begins a keyframe
+//
+// If a recording isn't closed properly the index and the footer are missing, and TrajectoryReader finds the keyframes by walking over the frames instead
+struct TrajectoryFileHeader
+{
+   TrajectoryFileHeader();
+
+   bool          hasValidMagicAndVersion() const;
+
+   char          magic[8];
+   std::uint32_t version;
+   std::uint32_t headerSize;
+   std::uint32_t keyframeInterval;
+   float         positionQuantum;
+};
+
+struct TrajectoryFrameHeader
+{
+   static const std::uint32_t numBodiesPerGroup = 16;
+
+   std::uint64_t stepIndex;
+   float         simulatedTime;
+   std::uint32_t numBodies;
+   std::uint32_t isKeyframe;
+   std::uint32_t payloadSize;
+};
+
+struct TrajectoryKeyframeEntry
+{
+   std::uint64_t frameIndex;
+   std::uint64_t fileOffset;
+};
+
+struct TrajectoryFileFooter
+{
+   TrajectoryFileFooter();
+
+   bool          hasValidMagic() const;
+
+   std::uint64_t indexOffset;
+   std::uint64_t numKeyframes;
+   std::uint64_t numFrames;
+   char          magic[8];
+};
+
+struct TrajectoryPose
+{
+   float positionX;
+   float positionY;
+   float orientation;
+};
+
+// Encodes the frames of a trajectory one after the other, so it keeps the two frames that it predicts from
+// TrajectoryRecorder writes the frames to a file as they are encoded, and ReplayBuffer keeps the most recent ones in memory
+class TrajectoryFrameEncoder
+{
+public:
+
+   TrajectoryFrameEncoder(std::uint32_t keyframeInterval, float positionQuantum);
+
+   std::uint32_t getKeyframeInterval() const;
+   float         getPositionQuantum() const;
+
+   // Makes the next frame a keyframe
+   void          reset();
+
+   // Appends the TrajectoryFrameHeader and the payload of the frame to the output, and returns true if the frame is a keyframe
+   // When the step index doesn't follow the one of the previous frame, or the number of bodies changes, the frame is a keyframe
+   bool          encode(std::uint64_t stepIndex, float simulatedTime, std::uint32_t numBodies, const TrajectoryPose* poses, std::vector<unsigned char>& output);
+
+private:
+
+   std::uint32_t              mKeyframeInterval;
+   float                      mPositionQuantum;
+   std::uint32_t              mNumFramesSinceKeyframe;
+   std::uint32_t              mNumEncodedBodies;
+   std::uint64_t              mLastEncodedStepIndex;
+   std::vector<std::int64_t>  mPreviousValues;
+   std::vector<std::int64_t>  mValuesBeforePrevious;
+   std::vector<std::uint64_t> mResiduals;
+   std::vector<unsigned char> mPayload;
+};
+
+// The simulation thread copies the bodies into a ring buffer of frames, and a background thread encodes them and writes them to a file
+// The memory use is bounded by the capacity of the ring buffer, and the encoder only keeps the two frames that it predicts from
+// A frame can't be dropped without breaking the frames that are predicted from it, so if the writer falls behind the simulation thread waits for it
+// There must only be one thread that pushes frames
+class TrajectoryRecorder
+{
+public:
+
+   // The capacity is a number of frames, and it's rounded up to a power of two
+   explicit TrajectoryRecorder(std::size_t capacity = 64, std::uint32_t keyframeInterval = 256, float positionQuantum = 1.0f / 256.0f);
+   ~TrajectoryRecorder();
+
+   TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+   TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+   TrajectoryRecorder(TrajectoryRecorder&&) = delete;
+   TrajectoryRecorder& operator=(TrajectoryRecorder&&) = delete;
+
+   bool          open(const std::string& filePath);
+   // Writes the frames that are still in the ring buffer, followed by the index of the keyframes, and stops the background thread
+   void          close();
+   bool          isOpen() const;
+
+   // The current state of each body is recorded
+   // When the step index doesn't follow the one of the previous frame, the next frame is a keyframe
+   // When the number of bodies changes, for example because the scene changed, the ring buffer is resized once the writer has caught up and the next frame is a keyframe
+   void          push(std::uint64_t stepIndex, float simulatedTime, const std::vector<RigidBody2D>& rigidBodies);
+
+   std::uint64_t getNumWrittenFrames() const;
+   std::uint64_t getNumWrittenBytes() const;
+   // The number of pushes that had to wait for the writer
+   std::uint64_t getNumStalls() const;
+
+private:
+
+   struct FrameSlot
+   {
+      std::uint64_t stepIndex;
+      float         simulatedTime;
+      std::uint32_t numBodies;
+   };
+
+   void          waitForWriter(std::uint64_t writeIndex, std::uint64_t maxNumPendingFrames);
+
+   void          runWriter();
+   std::size_t   writeAvailableFrames();
+   void          writeFrame(const FrameSlot& slot, const TrajectoryPose* poses);
+   void          writeIndexAndFooter();
+
+   std::vector<FrameSlot>      mSlots;
+   std::vector<TrajectoryPose> mPoses;
+   std::size_t                 mMask;
+   std::uint32_t               mNumBodies;
+
+   // The producer and the consumer indices are kept on different cache lines so that the two threads don't slow each other down
+   std::atomic<std::uint64_t>  mWriteIndex;
+   char                        mWriteIndexPadding[64];
+   std::atomic<std::uint64_t>  mReadIndex;
+   char                        mReadIndexPadding[64];
+
+   std::atomic<std::uint64_t>  mNumWrittenFrames;
+   std::atomic<std::uint64_t>  mNumWrittenBytes;
+   std::atomic<std::uint64_t>  mNumStalls;
+
+   std::atomic<bool>           mStopWriter;
+   std::thread                 mWriterThread;
+   std::ofstream               mFile;
+
+   // Only used by the writer thread
+   TrajectoryFrameEncoder      mEncoder;
+   std::vector<unsigned char>  mEncodedFrame;
+   std::vector<TrajectoryKeyframeEntry> mKeyframes;
+};
+
+#endif
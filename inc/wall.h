@@ -37,15 +37,15 @@ public:
 private:
 
    void      configureVAO(glm::vec2 startPoint,
-                          glm::vec2 endPoint);
+                          glm::vec2 endPoint) const;
 
-   glm::vec2    mNormal;
-   glm::vec2    mStartPoint;
-   glm::vec2    mEndPoint;
-   float        mC;
+   glm::vec2            mNormal;
+   glm::vec2            mStartPoint;
+   glm::vec2            mEndPoint;
+   float                mC;
 
-   unsigned int mVAO;
-   unsigned int mVBO;
+   mutable unsigned int mVAO;
+   mutable unsigned int mVBO;
 };
 
 #endif
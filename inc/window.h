@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 
 #include <mutex>
+#include <tuple>
 
 // TODO: Take advantage of inlining in this class.
 class Window
@@ -63,6 +64,19 @@ public:
    void         bindGifFramebuffer();
    void         copyMultisampleFramebufferIntoGifFramebuffer(unsigned int width, unsigned int height);
 
+   // Capture support
+   bool         configureCaptureSupport();
+   bool         createCaptureFramebuffer();
+   void         resizeCaptureFramebuffer(unsigned int width, unsigned int height);
+   // The world is rendered into the capture multisample framebuffer when it's rendered at the size of the recording, and then it's resolved into the capture framebuffer
+   void         clearAndBindCaptureMultisampleFramebuffer();
+   void         resolveCaptureMultisampleFramebuffer();
+   void         bindCaptureFramebuffer();
+   // Returns the lower left corner, the width and the height of the rectangle that a viewport of the given size is scaled to in the capture framebuffer
+   // The rectangle is centered, so that the aspect ratio of the scene is preserved
+   std::tuple<float, float, float, float> calculateCaptureViewport(float widthOfViewport, float heightOfViewport) const;
+   void         copyGifFramebufferIntoCaptureFramebuffer(float lowerLeftCornerOfViewportX, float lowerLeftCornerOfViewportY, float widthOfViewport, float heightOfViewport);
+
    // Resize support
    void         updateBufferAndViewportSizes();
    float        getLowerLeftCornerOfViewportX() const { return mLowerLeftCornerOfViewportX; };
@@ -100,6 +114,14 @@ private:
    unsigned int                   mGifFBO;
    unsigned int                   mGifTexture;
 
+   // Capture support
+   unsigned int                   mCaptureFBO;
+   unsigned int                   mCaptureTexture;
+   unsigned int                   mWidthOfCaptureFramebufferInPix;
+   unsigned int                   mHeightOfCaptureFramebufferInPix;
+   unsigned int                   mCaptureMultisampleFBO;
+   unsigned int                   mCaptureMultisampleRBO;
+
    unsigned int                   mNumOfSamples;
 
    // Resize support
@@ -1,29 +1,190 @@
 #ifndef WORLD_H
 #define WORLD_H
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
 #include <vector>
 
 #include "wall.h"
 #include "rigid_body_2D.h"
 #include "renderer_2D.h"
+#include "integrators.h"
+#include "gravity.h"
+#include "force_generators.h"
+#include "metrics_sink.h"
+#include "replay_buffer.h"
+#include "trajectory_recorder.h"
+#include "hardware_counters.h"
 
 class World
 {
 public:
 
+   enum class Integrator : unsigned int
+   {
+      rungeKutta4       = 0,
+      semiImplicitEuler = 1,
+      velocityVerlet    = 2,
+   };
+
+   enum class SimulationPhase : unsigned int
+   {
+      forces              = 0,
+      integration         = 1,
+      vertices            = 2,
+      sweeping            = 3,
+      penetrationChecks   = 4,
+      collisionDetection  = 5,
+      collisionResolution = 6,
+      metrics             = 7,
+      numPhases           = 8,
+   };
+
+   static const char* getPhaseName(SimulationPhase phase);
+
+   struct StepStatistics
+   {
+      StepStatistics();
+
+      int   numSteps;
+      int   numAcceptedSteps;
+      int   numRejectedSteps;
+      int   numSubdivisions;
+      float minStepSize;
+      float maxStepSize;
+      float totalSimulatedTime;
+
+      // Wall-clock time spent in each phase, in seconds, which is only measured when phase timing is enabled
+      std::array<double, static_cast<unsigned int>(SimulationPhase::numPhases)> phaseDurations;
+
+      // Hardware counts of each phase, which are only measured when hardware counters are enabled
+      std::array<HardwareCounterValues, static_cast<unsigned int>(SimulationPhase::numPhases)> phaseCounts;
+   };
+
+   // Prints the time and the hardware counts of each phase as a table
+   static void printPhaseTable(const StepStatistics& stepStatistics, std::ostream& stream);
+
+   enum class PenetrationType : unsigned int
+   {
+      bodyWall = 0,
+      bodyBody = 1,
+   };
+
+   // Describes why a substep had to be subdivided
+   struct SubdivisionRecord
+   {
+      SubdivisionRecord();
+
+      PenetrationType penetrationType;
+      int             penetratingBodyIndex;
+      int             penetratingVertexIndex;
+      int             penetratedIndex;        // Index of the wall or of the body that was penetrated
+      float           penetrationDepth;
+      float           substepSize;            // Size of the substep after it was halved
+      double          wastedSeconds;          // Wall-clock time spent on the substep that was thrown away
+   };
+
+   // The subdivisions of a step that were caused by the same wall or body pair
+   struct SubdivisionCulprit
+   {
+      SubdivisionCulprit();
+
+      PenetrationType penetrationType;
+      int             penetratingBodyIndex;
+      int             penetratedIndex;
+      int             numSubdivisions;
+      float           maxPenetrationDepth;
+      float           minSubstepSize;
+      double          wastedSeconds;
+   };
+
    World(std::vector<std::vector<Wall>>&&             wallScenes,
          const std::vector<std::vector<RigidBody2D>>& rigidBodyScenes);
 
+   // Selects the integrator and the gravity state at run time, and then calls the version of simulate that is specialized for them
+   int  simulate(float deltaTime);
+
+   template<typename TIntegrator, typename TGravity>
    int  simulate(float deltaTime);
+
    void render(const Renderer2D& renderer2D, bool wireframe);
 
    void changeScene(int index);
    void resetScene();
+   // Fills in a scene after the world has been created, so that scenes can be loaded when they are first selected
+   // The scene mustn't be the current one, since its walls may be in use by the thread that renders them
+   void loadScene(int index, std::vector<Wall>&& walls, const std::vector<RigidBody2D>& rigidBodies);
+   // Copies the initial states of the bodies from an array, such as the one of a MappedScene, in a single copy
+   void loadScene(int index, std::vector<Wall>&& walls, const RigidBody2D* rigidBodies, std::size_t numRigidBodies);
    void setGravityState(int state);
+   void setIntegrator(Integrator integrator);
    void setCoefficientOfRestitution(float coefficientOfRestitution);
+   void enableContinuousCollisionDetection(bool enable);
+   // The adaptive time-step integrates with the Bogacki-Shampine 3(2) pair instead of the selected integrator, and evaluates the forces at each of its stages
+   // Steps whose error estimate is too large are rejected, and the step grows while the motion is smooth, up to a multiple of the time step
+   // The step and the time that a call simulates past the end of its time step are carried over to the next one, so smooth motion takes fewer, longer steps
+   // Each step also ends when the first vertex is predicted to reach a wall, while contacts between bodies are found by subdividing time and by sweeping
+   void enableAdaptiveTimeStep(bool enable);
+   // Sets the multiple of the time step that the adaptive step can grow to, which is 4 by default
+   // Longer steps are faster when the motion is smooth, but bodies that aren't swept can travel further into each other before a penetration is found
+   void setMaxAdaptiveStepSizeScale(float scale);
+   void enablePhaseTiming(bool enable);
+
+   // Hardware counters only count the thread that enables them, so this must be called from the thread that calls simulate
+   // Returns false if the counters couldn't be opened
+   bool enableHardwareCounters(bool enable);
+   bool hardwareCountersAreEnabled() const;
+
+   // Force generators run over all the bodies in the current scene before each integration step, in the order in which they were added
+   void addForceGenerator(std::unique_ptr<ForceGenerator>&& generator);
+   void clearForceGenerators();
+
+   const std::vector<RigidBody2D>& getRigidBodies() const;
+
+   // When a metrics sink is set, each call to simulate pushes a record with the energy, the momentum and the contact and substep counts of the step
+   void setMetricsSink(const std::shared_ptr<MetricsSink>& metricsSink);
+
+   // When a trajectory recorder is set, the position and the orientation of every body are recorded after each call to simulate
+   void setTrajectoryRecorder(const std::shared_ptr<TrajectoryRecorder>& trajectoryRecorder);
+
+   // When a replay buffer is set, the last seconds of the position and the orientation of every body are kept in memory so that they can be saved at any time
+   void setReplayBuffer(const std::shared_ptr<ReplayBuffer>& replayBuffer);
+
+   // The contact, solver iteration and substep counts of the most recent step are always available, but the rest of the record is only filled in when a metrics sink is set
+   const StepMetrics& getStepMetrics() const;
+
+   // Deterministic mode runs each step in the default floating-point environment, so that the results don't depend on the rounding and denormal modes that other code left behind
+   // The bodies, walls, force generators and contacts are always visited in the order in which they were added, so two runs of the same scene then produce bitwise identical states
+   // In deterministic mode the metrics records also carry a hash of the state at the end of each step, and MetricsDiff reports the first step where two runs diverge
+   void          enableDeterministicMode(bool enable);
+   bool          deterministicModeIsEnabled() const;
+
+   // Hashes the bits of the position, orientation and velocities of every body in the current scene
+   std::uint64_t calculateStateHash() const;
+
+   const StepStatistics& getStepStatistics() const;
+   void                  resetStepStatistics();
+
+   // When subdivision diagnostics are enabled, every subdivision of the most recent step is recorded along with the wall or body pair that caused it
+   void                                   enableSubdivisionDiagnostics(bool enable);
+   bool                                   subdivisionDiagnosticsAreEnabled() const;
+   const std::vector<SubdivisionRecord>&  getSubdivisionRecords() const;
+
+   // Groups the subdivisions of the most recent step by culprit, with the culprits that wasted the most time first
+   std::vector<SubdivisionCulprit>        getSubdivisionReport() const;
+   void                                   printSubdivisionReport() const;
+
+   // A step that is subdivided at least this many times is slow enough that its report is printed even if the step succeeds
+   static const std::size_t               minNumSubdivisionsToReport = 8;
 
 private:
 
+   // Gives the primitive microbenchmark access to the narrow-phase methods and to the forces phase, so that they can be measured on their own
+   friend class WorldPrimitives;
+
    enum class CollisionState : unsigned int
    {
       penetrating = 0,
@@ -80,9 +241,45 @@ private:
       glm::vec2 collidingBodyBPoint;
    };
 
-   void                                           computeForces();
+   // The time derivative of the state of a body, which each stage of the embedded Runge-Kutta pair evaluates
+   struct StateDerivative
+   {
+      glm::vec2 velocity;
+      float     angularVelocity;
+      glm::vec2 acceleration;
+      float     angularAcceleration;
+   };
+
+   static const int numAdaptiveStages = 4;
 
+   // Sizes the collision buffers for the bodies of the current scene
+   void                                           resizeCollisionBuffers();
+
+   // Sizes the body batch for the bodies of the current scene and gathers their masses, which don't change until the scene does
+   void                                           resetBodyBatch();
+
+   // Reads the positions and the velocities of the given state of each body, and writes the forces into that state
+   template<typename TGravity>
+   void                                           computeForces(RigidBodyState state);
+
+   template<typename TIntegrator>
    void                                           integrate(float deltaTime);
+   // Integrates the bodies with the embedded pair, and returns the largest error estimate relative to the tolerances
+   template<typename TGravity>
+   float                                          integrateAdaptive(float deltaTime);
+   float                                          calculateAdaptiveTargetTime(float currentTime) const;
+   float                                          calculateTimeUntilBodyWallContact() const;
+   void                                           recordAcceptedStep(float stepSize);
+   void                                           recordSubdivision(float substepSize, double wastedSeconds);
+   int                                            finishStep(int errorCode);
+
+   // Sweeping is undone by going back to the state before the first substep that it shortened
+   void                                           saveSweptState(float currentTime);
+   void                                           restoreSweptState();
+   bool                                           isBodyMovingFast(const RigidBody2D& body) const;
+   float                                          calculateTimeOfImpact();
+   float                                          calculateBodyWallTimeOfImpact(const RigidBody2D& body) const;
+   float                                          calculateBodyBodyTimeOfImpact(const RigidBody2D& bodyA, const RigidBody2D& bodyB) const;
 
    CollisionState                                 checkForBodyWallPenetration();
    CollisionState                                 checkForBodyWallCollision();
@@ -132,11 +329,57 @@ private:
    std::vector<std::vector<VertexVertexCollision>> mVertexVertexCollisions;
    std::vector<std::vector<VertexEdgeCollision>>   mVertexEdgeCollisions;
 
+   // The velocities and normals of the resolved collisions of each body, which are averaged to find its new velocities
+   std::vector<std::vector<glm::vec2>>             mResolvedLinearVelocities;
+   std::vector<std::vector<float>>                 mResolvedAngularVelocities;
+   std::vector<std::vector<glm::vec2>>             mResolvedCollisionNormals;
+
    bool                                            mChangeScene;
    int                                             mSceneIndex;
    int                                             mGravityState;
+   Integrator                                      mIntegrator;
 
    float                                           mCoefficientOfRestitution;
+
+   bool                                            mContinuousCollisionDetectionIsEnabled;
+   std::vector<RigidBody2D::KinematicAndDynamicState> mSweptStates;
+   float                                           mSweptStateTime;
+   StepStatistics                                  mSweptStateStatistics;
+   std::uint32_t                                   mSweptStateNumSubsteps;
+   float                                           mSweptStateAdaptiveStepSize;
+
+   // Which bodies are moving fast in the current substep, which the sweep finds once before it visits the pairs
+   std::vector<bool>                               mBodyIsMovingFast;
+   std::vector<int>                                mFastBodyIndices;
+
+   bool                                            mAdaptiveTimeStepIsEnabled;
+   float                                           mMaxAdaptiveStepSizeScale;
+   float                                           mAdaptiveStepSize;
+   // The time that the previous calls left to simulate, which is negative when they simulated past the ends of their time steps
+   float                                           mAdaptiveLeftoverTime;
+   std::vector<std::array<StateDerivative, numAdaptiveStages>> mStageDerivatives;
+
+   bool                                            mDeterministicModeIsEnabled;
+
+   StepStatistics                                  mStepStatistics;
+   bool                                            mPhaseTimingIsEnabled;
+   std::unique_ptr<HardwareCounters>               mHardwareCounters;
+
+   bool                                            mSubdivisionDiagnosticsAreEnabled;
+   std::vector<SubdivisionRecord>                  mSubdivisionRecords;
+
+   // Filled in by the penetration checks when they find a penetration
+   SubdivisionRecord                               mLastPenetration;
+
+   std::shared_ptr<MetricsSink>                    mMetricsSink;
+   StepMetrics                                     mStepMetrics;
+   std::chrono::steady_clock::time_point           mStepStart;
+
+   std::shared_ptr<TrajectoryRecorder>             mTrajectoryRecorder;
+   std::shared_ptr<ReplayBuffer>                   mReplayBuffer;
+
+   ForceGeneratorRegistry                          mForceGeneratorRegistry;
+   BodyBatch                                       mBodyBatch;
 };
 
 #endif
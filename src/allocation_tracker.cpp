@@ -0,0 +1,243 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+#include "allocation_tracker.h"
+
+namespace
+{
+   // These are plain integers, so using them from operator new doesn't run any thread-local initialization that could allocate
+   thread_local std::uint64_t tNumAllocations = 0;
+   thread_local std::uint64_t tNumBytes       = 0;
+
+   struct ScopeEntry
+   {
+      const char*   name;
+      std::uint64_t numEntries;
+      std::uint64_t numAllocations;
+      std::uint64_t numBytes;
+   };
+
+   // Recording a scope can't allocate, so each thread has a fixed number of them
+   const int               maxNumScopes = 64;
+   thread_local ScopeEntry tScopes[maxNumScopes];
+   thread_local int        tNumScopes   = 0;
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+namespace
+{
+   void* allocate(std::size_t size)
+   {
+      ++tNumAllocations;
+      tNumBytes += size;
+      return std::malloc((size != 0) ? size : 1);
+   }
+}
+
+void* operator new(std::size_t size)
+{
+   void* pointer = allocate(size);
+   if (!pointer)
+   {
+      throw std::bad_alloc();
+   }
+
+   return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+   void* pointer = allocate(size);
+   if (!pointer)
+   {
+      throw std::bad_alloc();
+   }
+
+   return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+   return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+   return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+   std::free(pointer);
+}
+
+#endif
+
+AllocationCounts::AllocationCounts()
+   : numAllocations(0)
+   , numBytes(0)
+{
+
+}
+
+AllocationCounts& AllocationCounts::operator+=(const AllocationCounts& other)
+{
+   numAllocations += other.numAllocations;
+   numBytes       += other.numBytes;
+   return *this;
+}
+
+AllocationCounts AllocationCounts::operator-(const AllocationCounts& other) const
+{
+   AllocationCounts difference;
+   difference.numAllocations = numAllocations - other.numAllocations;
+   difference.numBytes       = numBytes       - other.numBytes;
+   return difference;
+}
+
+AllocationScopeCounts::AllocationScopeCounts()
+   : name(nullptr)
+   , numEntries(0)
+   , counts()
+{
+
+}
+
+bool AllocationTracker::isEnabled()
+{
+#ifdef TRACK_ALLOCATIONS
+   return true;
+#else
+   return false;
+#endif
+}
+
+AllocationCounts AllocationTracker::getThreadCounts()
+{
+   AllocationCounts counts;
+   counts.numAllocations = tNumAllocations;
+   counts.numBytes       = tNumBytes;
+   return counts;
+}
+
+void AllocationTracker::recordScope(const char* name, const AllocationCounts& counts)
+{
+   // There are only a handful of scopes, so a linear search is faster than anything that would need to allocate
+   int index = 0;
+   while ((index < tNumScopes) && (tScopes[index].name != name))
+   {
+      ++index;
+   }
+
+   if (index == tNumScopes)
+   {
+      if (tNumScopes == maxNumScopes)
+      {
+         return;
+      }
+
+      tScopes[index]      = ScopeEntry();
+      tScopes[index].name = name;
+      ++tNumScopes;
+   }
+
+   tScopes[index].numEntries++;
+   tScopes[index].numAllocations += counts.numAllocations;
+   tScopes[index].numBytes       += counts.numBytes;
+}
+
+std::vector<AllocationScopeCounts> AllocationTracker::getScopeCounts()
+{
+   std::vector<AllocationScopeCounts> scopeCounts(tNumScopes);
+   for (int i = 0; i < tNumScopes; ++i)
+   {
+      scopeCounts[i].name                  = tScopes[i].name;
+      scopeCounts[i].numEntries            = tScopes[i].numEntries;
+      scopeCounts[i].counts.numAllocations = tScopes[i].numAllocations;
+      scopeCounts[i].counts.numBytes       = tScopes[i].numBytes;
+   }
+
+   return scopeCounts;
+}
+
+AllocationScopeCounts AllocationTracker::getScopeCounts(const char* name)
+{
+   AllocationScopeCounts scopeCounts;
+   scopeCounts.name = name;
+
+   // Scopes are identified by their pointers, but the same literal can have different pointers in different translation units
+   for (int i = 0; i < tNumScopes; ++i)
+   {
+      if (std::strcmp(tScopes[i].name, name) == 0)
+      {
+         scopeCounts.numEntries            += tScopes[i].numEntries;
+         scopeCounts.counts.numAllocations += tScopes[i].numAllocations;
+         scopeCounts.counts.numBytes       += tScopes[i].numBytes;
+      }
+   }
+
+   return scopeCounts;
+}
+
+void AllocationTracker::resetScopeCounts()
+{
+   tNumScopes = 0;
+}
+
+void AllocationTracker::printScopeTable(std::ostream& stream)
+{
+   std::ios::fmtflags oldFlags     = stream.flags();
+   std::streamsize    oldPrecision = stream.precision();
+
+   stream << std::left  << std::setw(40) << "Scope"
+          << std::right << std::setw(12) << "Entries"
+          << std::setw(14) << "Allocations"
+          << std::setw(14) << "Bytes"
+          << std::setw(14) << "Allocs/entry"
+          << std::setw(14) << "Bytes/entry" << "\n";
+
+   std::vector<AllocationScopeCounts> scopeCounts = getScopeCounts();
+   for (const AllocationScopeCounts& scope : scopeCounts)
+   {
+      double numEntries = (scope.numEntries > 0) ? static_cast<double>(scope.numEntries) : 1.0;
+
+      stream << std::left  << std::setw(40) << scope.name
+             << std::right << std::setw(12) << scope.numEntries
+             << std::setw(14) << scope.counts.numAllocations
+             << std::setw(14) << scope.counts.numBytes
+             << std::fixed << std::setprecision(2)
+             << std::setw(14) << (scope.counts.numAllocations / numEntries)
+             << std::setw(14) << (scope.counts.numBytes / numEntries) << "\n";
+   }
+
+   stream.flags(oldFlags);
+   stream.precision(oldPrecision);
+}
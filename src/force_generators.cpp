@@ -0,0 +1,255 @@
+#include <cmath>
+#include <utility>
+
+#include "force_generators.h"
+
+namespace
+{
+   // A spring whose ends are closer than this has no direction to push them apart along, so it doesn't apply a force until they separate
+   const float minSpringLength = 1e-6f;
+}
+
+BodyBatch::BodyBatch()
+   : numBodies(0)
+{
+
+}
+
+void BodyBatch::resize(std::size_t numBodies)
+{
+   this->numBodies = numBodies;
+
+   positionsX.resize(numBodies);
+   positionsY.resize(numBodies);
+   velocitiesX.resize(numBodies);
+   velocitiesY.resize(numBodies);
+   angularVelocities.resize(numBodies);
+   masses.resize(numBodies);
+
+   forcesX.resize(numBodies);
+   forcesY.resize(numBodies);
+   torques.resize(numBodies);
+}
+
+UniformForceField::UniformForceField(const glm::vec2& acceleration)
+   : mAcceleration(acceleration)
+{
+
+}
+
+void UniformForceField::apply(BodyBatch& batch) const
+{
+   const float* masses        = batch.masses.data();
+   float*       forcesX       = batch.forcesX.data();
+   float*       forcesY       = batch.forcesY.data();
+   const float  accelerationX = mAcceleration.x;
+   const float  accelerationY = mAcceleration.y;
+
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      forcesX[i] += masses[i] * accelerationX;
+      forcesY[i] += masses[i] * accelerationY;
+   }
+}
+
+LinearDrag::LinearDrag(float coefficient, float angularCoefficient)
+   : mCoefficient(coefficient)
+   , mAngularCoefficient(angularCoefficient)
+{
+
+}
+
+void LinearDrag::apply(BodyBatch& batch) const
+{
+   const float* velocitiesX        = batch.velocitiesX.data();
+   const float* velocitiesY        = batch.velocitiesY.data();
+   const float* angularVelocities  = batch.angularVelocities.data();
+   float*       forcesX            = batch.forcesX.data();
+   float*       forcesY            = batch.forcesY.data();
+   float*       torques            = batch.torques.data();
+   const float  coefficient        = mCoefficient;
+   const float  angularCoefficient = mAngularCoefficient;
+
+   // The forces and the torques are separate loops, because the compiler only vectorizes a loop if it can check that its arrays don't overlap, and it gives up when a loop has too many of them
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      forcesX[i] -= coefficient * velocitiesX[i];
+      forcesY[i] -= coefficient * velocitiesY[i];
+   }
+
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      torques[i] -= angularCoefficient * angularVelocities[i];
+   }
+}
+
+QuadraticDrag::QuadraticDrag(float coefficient, float angularCoefficient)
+   : mCoefficient(coefficient)
+   , mAngularCoefficient(angularCoefficient)
+{
+
+}
+
+void QuadraticDrag::apply(BodyBatch& batch) const
+{
+   const float* velocitiesX        = batch.velocitiesX.data();
+   const float* velocitiesY        = batch.velocitiesY.data();
+   const float* angularVelocities  = batch.angularVelocities.data();
+   float*       forcesX            = batch.forcesX.data();
+   float*       forcesY            = batch.forcesY.data();
+   float*       torques            = batch.torques.data();
+   const float  coefficient        = mCoefficient;
+   const float  angularCoefficient = mAngularCoefficient;
+
+   // Separate loops for the same reason as in LinearDrag::apply
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      float speed = std::sqrt((velocitiesX[i] * velocitiesX[i]) + (velocitiesY[i] * velocitiesY[i]));
+
+      forcesX[i] -= coefficient * speed * velocitiesX[i];
+      forcesY[i] -= coefficient * speed * velocitiesY[i];
+   }
+
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      torques[i] -= angularCoefficient * std::abs(angularVelocities[i]) * angularVelocities[i];
+   }
+}
+
+PointAttractor::PointAttractor(const glm::vec2& position, float strength, float softeningLength)
+   : mPosition(position)
+   , mStrength(strength)
+   , mSofteningLengthSquared(softeningLength * softeningLength)
+{
+
+}
+
+void PointAttractor::apply(BodyBatch& batch) const
+{
+   const float* positionsX             = batch.positionsX.data();
+   const float* positionsY             = batch.positionsY.data();
+   const float* masses                 = batch.masses.data();
+   float*       forcesX                = batch.forcesX.data();
+   float*       forcesY                = batch.forcesY.data();
+   const float  attractorX             = mPosition.x;
+   const float  attractorY             = mPosition.y;
+   const float  strength               = mStrength;
+   const float  softeningLengthSquared = mSofteningLengthSquared;
+
+   for (std::size_t i = 0; i < batch.numBodies; ++i)
+   {
+      float toAttractorX    = attractorX - positionsX[i];
+      float toAttractorY    = attractorY - positionsY[i];
+      float distanceSquared = (toAttractorX * toAttractorX) + (toAttractorY * toAttractorY) + softeningLengthSquared;
+      float scale           = (strength * masses[i]) / (distanceSquared * std::sqrt(distanceSquared));
+
+      forcesX[i] += scale * toAttractorX;
+      forcesY[i] += scale * toAttractorY;
+   }
+}
+
+void SpringNetwork::addSpring(int bodyAIndex, int bodyBIndex, float restLength, float stiffness, float damping)
+{
+   mBodyAIndices.push_back(bodyAIndex);
+   mBodyBIndices.push_back(bodyBIndex);
+   mAnchors.push_back(glm::vec2(0.0f));
+   mRestLengths.push_back(restLength);
+   mStiffnesses.push_back(stiffness);
+   mDampings.push_back(damping);
+}
+
+void SpringNetwork::addAnchoredSpring(int bodyIndex, const glm::vec2& anchor, float restLength, float stiffness, float damping)
+{
+   mBodyAIndices.push_back(bodyIndex);
+   mBodyBIndices.push_back(-1);
+   mAnchors.push_back(anchor);
+   mRestLengths.push_back(restLength);
+   mStiffnesses.push_back(stiffness);
+   mDampings.push_back(damping);
+}
+
+void SpringNetwork::apply(BodyBatch& batch) const
+{
+   const float* positionsX  = batch.positionsX.data();
+   const float* positionsY  = batch.positionsY.data();
+   const float* velocitiesX = batch.velocitiesX.data();
+   const float* velocitiesY = batch.velocitiesY.data();
+   float*       forcesX     = batch.forcesX.data();
+   float*       forcesY     = batch.forcesY.data();
+
+   // The springs can share bodies, so unlike the loops of the other generators this one can't be vectorized, and it's written to do as little as possible per spring instead
+   for (std::size_t springIndex = 0; springIndex < mBodyAIndices.size(); ++springIndex)
+   {
+      int bodyAIndex = mBodyAIndices[springIndex];
+      int bodyBIndex = mBodyBIndices[springIndex];
+
+      bool bodyAIsValid = (bodyAIndex >= 0) && (static_cast<std::size_t>(bodyAIndex) < batch.numBodies);
+      bool bodyBIsValid = (bodyBIndex == -1) || ((bodyBIndex >= 0) && (static_cast<std::size_t>(bodyBIndex) < batch.numBodies));
+      if (!bodyAIsValid || !bodyBIsValid)
+      {
+         // The spring refers to a body that is not in this batch
+         continue;
+      }
+
+      float otherEndPositionX = mAnchors[springIndex].x;
+      float otherEndPositionY = mAnchors[springIndex].y;
+      float otherEndVelocityX = 0.0f;
+      float otherEndVelocityY = 0.0f;
+      if (bodyBIndex != -1)
+      {
+         otherEndPositionX = positionsX[bodyBIndex];
+         otherEndPositionY = positionsY[bodyBIndex];
+         otherEndVelocityX = velocitiesX[bodyBIndex];
+         otherEndVelocityY = velocitiesY[bodyBIndex];
+      }
+
+      float displacementX = positionsX[bodyAIndex] - otherEndPositionX;
+      float displacementY = positionsY[bodyAIndex] - otherEndPositionY;
+      float length        = std::sqrt((displacementX * displacementX) + (displacementY * displacementY));
+      if (length < minSpringLength)
+      {
+         continue;
+      }
+
+      float oneOverLength     = 1.0f / length;
+      float directionX        = displacementX * oneOverLength;
+      float directionY        = displacementY * oneOverLength;
+      float relativeVelocityX = velocitiesX[bodyAIndex] - otherEndVelocityX;
+      float relativeVelocityY = velocitiesY[bodyAIndex] - otherEndVelocityY;
+      float magnitude         = (mStiffnesses[springIndex] * (length - mRestLengths[springIndex])) + (mDampings[springIndex] * ((relativeVelocityX * directionX) + (relativeVelocityY * directionY)));
+      float forceX            = -magnitude * directionX;
+      float forceY            = -magnitude * directionY;
+
+      forcesX[bodyAIndex] += forceX;
+      forcesY[bodyAIndex] += forceY;
+
+      if (bodyBIndex != -1)
+      {
+         forcesX[bodyBIndex] -= forceX;
+         forcesY[bodyBIndex] -= forceY;
+      }
+   }
+}
+
+void ForceGeneratorRegistry::add(std::unique_ptr<ForceGenerator>&& generator)
+{
+   mGenerators.push_back(std::move(generator));
+}
+
+void ForceGeneratorRegistry::clear()
+{
+   mGenerators.clear();
+}
+
+bool ForceGeneratorRegistry::isEmpty() const
+{
+   return mGenerators.empty();
+}
+
+void ForceGeneratorRegistry::applyAll(BodyBatch& batch) const
+{
+   for (std::vector<std::unique_ptr<ForceGenerator>>::const_iterator iter = mGenerators.begin(); iter != mGenerators.end(); ++iter)
+   {
+      (*iter)->apply(batch);
+   }
+}
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <iostream>
+
+#include "frame_encoder.h"
+#include "profiler.h"
+
+namespace
+{
+   // Every fourth frame goes into the fast GIF, because the viewers of GIFs slow down delays under two hundredths of a second
+   const std::uint64_t fastGifFrameInterval = 4;
+
+   // The frames that wait for the writer are kept in memory, so each encoder can only get this many frames ahead of it
+   const std::uint64_t numReducedFramesPerEncoder = 2;
+}
+
+FrameEncoder::FrameEncoder(const std::string& slowGifFilePath, const std::string& fastGifFilePath, unsigned int delayInCentiseconds, PaletteMode paletteMode, unsigned int numThreads)
+   : mEncoderThreads()
+   , mSlowGifFilePath(slowGifFilePath)
+   , mFastGifFilePath(fastGifFilePath)
+   , mDelayInCentiseconds(delayInCentiseconds)
+   , mPaletteMode(paletteMode)
+   , mWidth(0)
+   , mHeight(0)
+   , mQueuedFrames()
+   , mNumRetiredFrames(0)
+   , mNumTakenFrames(0)
+   , mReducedFrames()
+   , mNumFramesTakenByWriter(0)
+   , mNumFramesWrittenByWriter(0)
+   , mWriterIsBusy(false)
+   , mGlobalPalette()
+   , mStopEncoders(false)
+   , mMutex()
+   , mWorkCondition()
+   , mFrameReadCondition()
+   , mFrameWrittenCondition()
+   , mSlowGif()
+   , mFastGif()
+   , mWriteFailed(false)
+   , mNumStalls(0)
+{
+   if (numThreads == 0)
+   {
+      numThreads = std::max(std::thread::hardware_concurrency() / 2, 1u);
+   }
+
+   for (unsigned int i = 0; i < numThreads; ++i)
+   {
+      mEncoderThreads.emplace_back(&FrameEncoder::runEncoder, this);
+   }
+}
+
+FrameEncoder::~FrameEncoder()
+{
+   {
+      std::lock_guard<std::mutex> guard(mMutex);
+      mStopEncoders = true;
+   }
+
+   mWorkCondition.notify_all();
+
+   // The encoders write the frames that are still queued before they stop
+   for (std::thread& encoderThread : mEncoderThreads)
+   {
+      encoderThread.join();
+   }
+
+   close();
+}
+
+unsigned int FrameEncoder::getNumThreads() const
+{
+   return static_cast<unsigned int>(mEncoderThreads.size());
+}
+
+bool FrameEncoder::close()
+{
+   PROFILE_ZONE("FrameEncoder::close");
+
+   {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mFrameWrittenCondition.wait(lock, [this]() { return mNumFramesWrittenByWriter == mNumRetiredFrames + mQueuedFrames.size(); });
+   }
+
+   bool slowGifIsClosed = mSlowGif.close();
+   bool fastGifIsClosed = mFastGif.close();
+
+   return slowGifIsClosed && fastGifIsClosed && !mWriteFailed;
+}
+
+void FrameEncoder::push(const Frame& frame)
+{
+   {
+      std::lock_guard<std::mutex> guard(mMutex);
+
+      if (mNumRetiredFrames + mQueuedFrames.size() == 0)
+      {
+         mWidth  = frame.width;
+         mHeight = frame.height;
+      }
+
+      mQueuedFrames.push_back(QueuedFrame{frame, false});
+   }
+
+   mWorkCondition.notify_one();
+}
+
+bool FrameEncoder::hasFramesToRetire() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return !mQueuedFrames.empty();
+}
+
+bool FrameEncoder::oldestFrameIsRead() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return !mQueuedFrames.empty() && mQueuedFrames.front().isRead;
+}
+
+void FrameEncoder::retireOldestFrame()
+{
+   PROFILE_ZONE("FrameEncoder::retireOldestFrame");
+
+   std::unique_lock<std::mutex> lock(mMutex);
+
+   if (mQueuedFrames.empty())
+   {
+      return;
+   }
+
+   if (!mQueuedFrames.front().isRead)
+   {
+      mNumStalls.fetch_add(1, std::memory_order_relaxed);
+      mFrameReadCondition.wait(lock, [this]() { return mQueuedFrames.front().isRead; });
+   }
+
+   mQueuedFrames.pop_front();
+   mNumRetiredFrames++;
+}
+
+std::uint64_t FrameEncoder::getNumWrittenFrames() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return mNumFramesWrittenByWriter;
+}
+
+std::uint64_t FrameEncoder::getNumWrittenBytes() const
+{
+   return mSlowGif.getNumWrittenBytes() + mFastGif.getNumWrittenBytes();
+}
+
+std::uint64_t FrameEncoder::getNumStalls() const
+{
+   return mNumStalls.load(std::memory_order_relaxed);
+}
+
+void FrameEncoder::runEncoder()
+{
+   std::unique_lock<std::mutex> lock(mMutex);
+
+   while (true)
+   {
+      bool hasFrameToTake = false;
+      mWorkCondition.wait(lock, [this, &hasFrameToTake]()
+      {
+         bool hasUntakenFrame = mNumTakenFrames < mNumRetiredFrames + mQueuedFrames.size();
+         hasFrameToTake       = hasUntakenFrame && (mNumTakenFrames - mNumFramesWrittenByWriter < numReducedFramesPerEncoder * mEncoderThreads.size());
+         return hasFrameToTake || (mStopEncoders && !hasUntakenFrame);
+      });
+
+      if (!hasFrameToTake)
+      {
+         // There is nothing left to encode and the encoder was asked to stop
+         return;
+      }
+
+      // A frame can't be retired before it's read, so its position in the queue only changes by the number of frames that are retired in the meantime
+      std::uint64_t frameNumber = mNumTakenFrames++;
+      Frame         frame       = mQueuedFrames[frameNumber - mNumRetiredFrames].frame;
+
+      bool usesGlobalPalette = (mPaletteMode == PaletteMode::global);
+      if (usesGlobalPalette && (frameNumber > 0))
+      {
+         mWorkCondition.wait(lock, [this]() { return mGlobalPalette != nullptr; });
+      }
+
+      std::shared_ptr<const GifPalette> globalPalette = mGlobalPalette;
+
+      lock.unlock();
+
+      std::unique_ptr<GifFrame>   gifFrame(new GifFrame());
+      std::shared_ptr<GifPalette> newGlobalPalette;
+      {
+         PROFILE_ZONE("FrameEncoder - Color reduction");
+
+         if (globalPalette)
+         {
+            globalPalette->map(frame.pixels, frame.width, frame.height, frame.flipVertically, gifFrame->indices);
+         }
+         else
+         {
+            // The global palette has to map the colors of the frames that come after the first one too
+            std::shared_ptr<GifPalette> palette = std::make_shared<GifPalette>();
+            palette->build(frame.pixels, frame.width, frame.height, usesGlobalPalette);
+            palette->map(frame.pixels, frame.width, frame.height, frame.flipVertically, gifFrame->indices);
+
+            if (usesGlobalPalette)
+            {
+               newGlobalPalette = palette;
+            }
+            else
+            {
+               gifFrame->palette = palette->getColors();
+            }
+         }
+      }
+
+      lock.lock();
+
+      if (newGlobalPalette)
+      {
+         mGlobalPalette = newGlobalPalette;
+         mWorkCondition.notify_all();
+      }
+
+      mQueuedFrames[frameNumber - mNumRetiredFrames].isRead = true;
+      mFrameReadCondition.notify_all();
+
+      std::size_t positionOfReducedFrame = static_cast<std::size_t>(frameNumber - mNumFramesTakenByWriter);
+      if (mReducedFrames.size() <= positionOfReducedFrame)
+      {
+         mReducedFrames.resize(positionOfReducedFrame + 1);
+      }
+
+      mReducedFrames[positionOfReducedFrame] = std::move(gifFrame);
+
+      // The frames are compressed in order by one encoder at a time, which is whichever finds the next frame ready while no other encoder is writing
+      while (!mWriterIsBusy && !mReducedFrames.empty() && mReducedFrames.front())
+      {
+         mWriterIsBusy = true;
+
+         std::unique_ptr<GifFrame> frameToWrite       = std::move(mReducedFrames.front());
+         std::uint64_t             numberOfFrameToWrite = mNumFramesTakenByWriter++;
+         mReducedFrames.pop_front();
+
+         lock.unlock();
+         writeFrame(numberOfFrameToWrite, *frameToWrite);
+         lock.lock();
+
+         mNumFramesWrittenByWriter++;
+         mWriterIsBusy = false;
+
+         mWorkCondition.notify_all();
+         mFrameWrittenCondition.notify_all();
+      }
+   }
+}
+
+void FrameEncoder::writeFrame(std::uint64_t frameNumber, const GifFrame& gifFrame)
+{
+   PROFILE_ZONE("FrameEncoder - GIF compression");
+
+   if (frameNumber == 0)
+   {
+      std::vector<unsigned char> globalColors;
+      if (mPaletteMode == PaletteMode::global)
+      {
+         globalColors = mGlobalPalette->getColors();
+      }
+
+      bool slowGifIsOpen = mSlowGif.open(mSlowGifFilePath, mWidth, mHeight, mDelayInCentiseconds, globalColors);
+      bool fastGifIsOpen = mFastGif.open(mFastGifFilePath, mWidth, mHeight, mDelayInCentiseconds, globalColors);
+      mWriteFailed       = !slowGifIsOpen || !fastGifIsOpen;
+   }
+
+   if (mWriteFailed)
+   {
+      return;
+   }
+
+   if (!mSlowGif.addFrame(gifFrame))
+   {
+      mWriteFailed = true;
+   }
+
+   if ((frameNumber % fastGifFrameInterval == 0) && !mFastGif.addFrame(gifFrame))
+   {
+      mWriteFailed = true;
+   }
+}
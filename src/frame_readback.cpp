@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <iostream>
+
+#include "frame_readback.h"
+#include "profiler.h"
+
+FrameReadback::FrameReadback()
+   : mSlots()
+   , mWidth(0)
+   , mHeight(0)
+   , mFirstUsedSlot(0)
+   , mNumMappedSlots(0)
+   , mNumPendingSlots(0)
+{
+
+}
+
+FrameReadback::~FrameReadback()
+{
+   release();
+}
+
+bool FrameReadback::initialize(unsigned int width, unsigned int height, unsigned int numBuffers)
+{
+   release();
+
+   if ((width == 0) || (height == 0))
+   {
+      std::cout << "Error - FrameReadback::initialize - The frames can't be empty" << "\n";
+      return false;
+   }
+
+   mWidth  = width;
+   mHeight = height;
+   mSlots.assign(std::max(numBuffers, 1u), Slot{0, nullptr, 0, false});
+
+   for (Slot& slot : mSlots)
+   {
+      glGenBuffers(1, &slot.buffer);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+      glBufferData(GL_PIXEL_PACK_BUFFER, getFrameSizeInBytes(), NULL, GL_STREAM_READ);
+   }
+
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   return true;
+}
+
+void FrameReadback::release()
+{
+   if (!isInitialized())
+   {
+      return;
+   }
+
+   while (mNumMappedSlots > 0)
+   {
+      unmapOldestMappedFrame();
+   }
+
+   for (Slot& slot : mSlots)
+   {
+      if (slot.fence)
+      {
+         glDeleteSync(slot.fence);
+         slot.fence = nullptr;
+      }
+
+      glDeleteBuffers(1, &slot.buffer);
+      slot.buffer = 0;
+   }
+
+   mWidth           = 0;
+   mHeight          = 0;
+   mFirstUsedSlot   = 0;
+   mNumPendingSlots = 0;
+}
+
+bool FrameReadback::isInitialized() const
+{
+   return mWidth != 0;
+}
+
+unsigned int FrameReadback::getWidth() const
+{
+   return mWidth;
+}
+
+unsigned int FrameReadback::getHeight() const
+{
+   return mHeight;
+}
+
+std::size_t FrameReadback::getFrameSizeInBytes() const
+{
+   return 3 * static_cast<std::size_t>(mWidth) * static_cast<std::size_t>(mHeight);
+}
+
+bool FrameReadback::isFull() const
+{
+   return (mNumMappedSlots + mNumPendingSlots) == mSlots.size();
+}
+
+bool FrameReadback::hasPendingFrames() const
+{
+   return mNumPendingSlots > 0;
+}
+
+bool FrameReadback::hasMappedFrames() const
+{
+   return mNumMappedSlots > 0;
+}
+
+std::size_t FrameReadback::getNumPendingFrames() const
+{
+   return mNumPendingSlots;
+}
+
+bool FrameReadback::startReadback(int frameIndex)
+{
+   PROFILE_ZONE("FrameReadback::startReadback");
+
+   if (!isInitialized() || isFull())
+   {
+      std::cout << "Error - FrameReadback::startReadback - There is no free buffer" << "\n";
+      return false;
+   }
+
+   Slot& slot = mSlots[(mFirstUsedSlot + mNumMappedSlots + mNumPendingSlots) % mSlots.size()];
+
+   // With a pixel pack buffer bound, the last argument of glReadPixels is an offset into the buffer and the call doesn't wait for the copy
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+   glPixelStorei(GL_PACK_ALIGNMENT, 1);
+   glReadPixels(0, 0, mWidth, mHeight, GL_RGB, GL_UNSIGNED_BYTE, 0);
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   slot.fence      = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   slot.frameIndex = frameIndex;
+
+   mNumPendingSlots++;
+
+   return true;
+}
+
+const unsigned char* FrameReadback::mapOldestPendingFrame(int& frameIndex)
+{
+   PROFILE_ZONE("FrameReadback::mapOldestPendingFrame");
+
+   if (mNumPendingSlots == 0)
+   {
+      std::cout << "Error - FrameReadback::mapOldestPendingFrame - There is no pending frame" << "\n";
+      return nullptr;
+   }
+
+   Slot& slot = mSlots[(mFirstUsedSlot + mNumMappedSlots) % mSlots.size()];
+
+   // By the time the ring is full the copy has usually finished, so this rarely waits
+   const GLuint64 timeoutInNs = 100000000;
+   GLenum         waitResult  = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutInNs);
+   while (waitResult == GL_TIMEOUT_EXPIRED)
+   {
+      waitResult = glClientWaitSync(slot.fence, 0, timeoutInNs);
+   }
+
+   glDeleteSync(slot.fence);
+   slot.fence = nullptr;
+
+   mNumPendingSlots--;
+   mNumMappedSlots++;
+
+   frameIndex = slot.frameIndex;
+
+   if (waitResult == GL_WAIT_FAILED)
+   {
+      std::cout << "Error - FrameReadback::mapOldestPendingFrame - Failed to wait for frame " << slot.frameIndex << "\n";
+      return nullptr;
+   }
+
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+   void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, getFrameSizeInBytes(), GL_MAP_READ_BIT);
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   slot.isMapped = (data != nullptr);
+   if (!data)
+   {
+      std::cout << "Error - FrameReadback::mapOldestPendingFrame - Failed to map frame " << slot.frameIndex << "\n";
+   }
+
+   return static_cast<const unsigned char*>(data);
+}
+
+void FrameReadback::unmapOldestMappedFrame()
+{
+   if (mNumMappedSlots == 0)
+   {
+      return;
+   }
+
+   Slot& slot = mSlots[mFirstUsedSlot];
+
+   if (slot.isMapped)
+   {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      slot.isMapped = false;
+   }
+
+   mFirstUsedSlot = (mFirstUsedSlot + 1) % mSlots.size();
+   mNumMappedSlots--;
+}
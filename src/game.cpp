@@ -1,24 +1,45 @@
 #include <glm/gtc/matrix_transform.hpp>
 
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 
 #include "shader_loader.h"
 #include "menu_state.h"
 #include "game.h"
+#include "allocation_tracker.h"
+#include "mapped_scene.h"
+#include "profiler.h"
 
-Game::Game(QObject* parent, const std::shared_ptr<Window>& glfwWindow)
+Game::Game(QObject* parent, const std::shared_ptr<Window>& glfwWindow, const std::shared_ptr<SceneLibrary>& sceneLibrary)
    : QThread(parent)
    , mInitialized(false)
    , mSimulate(false)
    , mTerminate(false)
    , mTimeStep(0.02f)
+   , mSceneLibrary(sceneLibrary)
+   , mSceneIsLoaded()
    , mSceneDimensions()
+   , mCurrentSceneIndex(0)
+   , mSimulatedSceneIndex(0)
    , mRecordGIF(false)
+   , mPerformanceSamplingIsEnabled(false)
+   , mStepStatisticsAreEnabled(false)
    , mWindow(glfwWindow)
    , mFSM()
    , mRenderer2D()
    , mShaderManager()
    , mWorld()
+   , mReplayBuffer()
 {
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeScene,     this, &Game::changeScene);
 
@@ -28,17 +49,23 @@ Game::Game(QObject* parent, const std::shared_ptr<Window>& glfwWindow)
 
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeGravity, this, &Game::changeGravity);
 
-   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeTimeStep,                 this, &Game::changeTimeStep);
-   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeCoefficientOfRestitution, this, &Game::changeCoefficientOfRestitution);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeTimeStep,                     this, &Game::changeTimeStep);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeCoefficientOfRestitution,     this, &Game::changeCoefficientOfRestitution);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeIntegrator,                   this, &Game::changeIntegrator);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableAdaptiveTimeStep,             this, &Game::enableAdaptiveTimeStep);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableContinuousCollisionDetection, this, &Game::enableContinuousCollisionDetection);
 
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableWireframeMode,           this, &Game::enableWireframeMode);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enablePerformanceSampling,     this, &Game::enablePerformanceSampling);
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableRememberFrames,          this, &Game::enableRememberFrames);
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeRememberFramesFrequency, this, &Game::changeRememberFramesFrequency);
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableAntiAliasing,            this, &Game::enableAntiAliasing);
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::changeAntiAliasingMode,        this, &Game::changeAntiAliasingMode);
    QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::enableRecordGIF,               this, &Game::enableRecordGIF);
+   QObject::connect(dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::saveReplay,                    this, &Game::saveReplay);
 
-   QObject::connect(this, &Game::simulationError, dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::processSimulationError);
+   QObject::connect(this, &Game::simulationError,    dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::processSimulationError);
+   QObject::connect(this, &Game::performanceSampled, dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::processPerformanceSample);
 
    QObject::connect(this, &Game::simulatorViewerClosed, dynamic_cast<RigidBodySimulator*>(parent), &RigidBodySimulator::close);
 }
@@ -49,45 +76,6 @@ Game::~Game()
    wait();
 }
 
-glm::mat2 calc2DRotMat(float angleInDeg)
-{
-   glm::mat2 rotationMatrix;
-
-   float cosVal = cos(glm::radians(angleInDeg));
-   float sinVal = sin(glm::radians(angleInDeg));
-
-   rotationMatrix[0][0] =  cosVal; // Top left
-   rotationMatrix[1][0] = -sinVal; // Top right
-   rotationMatrix[0][1] =  sinVal; // Bottom left
-   rotationMatrix[1][1] =  cosVal; // Bottom right
-
-   return rotationMatrix;
-}
-
-float calcRandFloat(float max)
-{
-   return static_cast<float>(rand()) / static_cast<float>(RAND_MAX / max);
-}
-
-float calcRandFloat(float min, float max)
-{
-   return min + static_cast<float>(rand()) / static_cast<float>(RAND_MAX / (max - min));
-}
-
-glm::vec2 calcNormal(glm::vec2 deltas, bool invert = false)
-{
-   float dx = deltas.x;
-   float dy = deltas.y;
-   if (invert)
-   {
-      return glm::normalize(glm::vec2(-dy, dx));
-   }
-   else
-   {
-      return glm::normalize(glm::vec2(dy, -dx));
-   }
-}
-
 bool Game::initialize()
 {
    mWindow->makeContextCurrent(true);
@@ -122,306 +110,84 @@ bool Game::initialize()
 
    mRenderer2D = std::make_unique<Renderer2D>(texture2DShader, color2DShader, line2DShader);
 
-   // Creat the scene dimensions
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Single
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Pair
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 300.0f + 50.0f)); // Momentum
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 300.0f + 50.0f)); // Torque
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Plus Sign
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Multiplication Sign
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Star
-   mSceneDimensions.push_back(glm::vec2(400.0f + 50.0f, 400.0f + 50.0f)); // Stack
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 400.0f + 50.0f)); // Stack Being Hit
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 800.0f + 50.0f)); // Hexagon
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 800.0f + 50.0f)); // Octagon
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 400.0f + 50.0f)); // Downward slope
-   mSceneDimensions.push_back(glm::vec2(800.0f + 50.0f, 400.0f + 50.0f)); // Upward slope
-
-   // Create the walls
-   std::vector<std::vector<Wall>> walls(13);
-
-   float halfWidth  = 200.0f;
-   float halfHeight = 200.0f;
-
-   // Single
-   walls[0].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[0].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[0].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[0].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Pair
-   walls[1].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[1].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[1].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[1].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Momentum
-   walls[2].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -400.0f,  150.0f), glm::vec2(  400.0f,  150.0f))); // Top wall
-   walls[2].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  400.0f, -150.0f), glm::vec2( -400.0f, -150.0f))); // Bottom wall
-   walls[2].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  400.0f,  150.0f), glm::vec2(  400.0f, -150.0f))); // Right wall
-   walls[2].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -400.0f, -150.0f), glm::vec2( -400.0f,  150.0f))); // Left wall
-
-   // Torque
-   walls[3].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -400.0f,  150.0f), glm::vec2(  400.0f,  150.0f))); // Top wall
-   walls[3].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  400.0f, -150.0f), glm::vec2( -400.0f, -150.0f))); // Bottom wall
-   walls[3].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  400.0f,  150.0f), glm::vec2(  400.0f, -150.0f))); // Right wall
-   walls[3].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -400.0f, -150.0f), glm::vec2( -400.0f,  150.0f))); // Left wall
-
-   // Plus Sign
-   walls[4].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[4].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[4].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[4].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Multiplication Sign
-   walls[5].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[5].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[5].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[5].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Star
-   walls[6].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[6].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[6].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[6].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Stack
-   walls[7].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -halfWidth,  halfHeight), glm::vec2(  halfWidth,  halfHeight))); // Top wall
-   walls[7].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  halfWidth, -halfHeight), glm::vec2( -halfWidth, -halfHeight))); // Bottom wall
-   walls[7].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  halfWidth,  halfHeight), glm::vec2(  halfWidth, -halfHeight))); // Right wall
-   walls[7].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -halfWidth, -halfHeight), glm::vec2( -halfWidth,  halfHeight))); // Left wall
-
-   // Stack Being Hit
-   walls[8].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -400.0f,  200.0f), glm::vec2(  400.0f,  200.0f))); // Top wall
-   walls[8].push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2(  400.0f, -200.0f), glm::vec2( -400.0f, -200.0f))); // Bottom wall
-   walls[8].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  400.0f,  200.0f), glm::vec2(  400.0f, -200.0f))); // Right wall
-   walls[8].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -400.0f, -200.0f), glm::vec2( -400.0f,  200.0f))); // Left wall
-
-   glm::vec2 vertA(400.0f, 0.0f);
-   glm::vec2 vertB(400.0f / 2.0f, 400.0f * sin(glm::radians(60.0f)));
-   glm::vec2 normalAB = glm::normalize(glm::vec2(0.0f) - ((vertA + vertB) / 2.0f));
-   glm::mat2 rotation = calc2DRotMat(30.0f);
-
-   // Hexagon
-   walls[9].push_back(Wall(rotation * normalAB,                            rotation * vertA,                         rotation * vertB));
-   walls[9].push_back(Wall(rotation * glm::vec2(0.0f, -1.0f),              rotation * vertB,                         rotation * glm::vec2(-vertB.x, vertB.y)));
-   walls[9].push_back(Wall(rotation * glm::vec2(-normalAB.x, normalAB.y),  rotation * glm::vec2(-vertB.x, vertB.y),  rotation * glm::vec2(-vertA.x, vertA.y)));
-   walls[9].push_back(Wall(rotation * glm::vec2(-normalAB.x, -normalAB.y), rotation * glm::vec2(-vertA.x, vertA.y),  rotation * glm::vec2(-vertB.x, -vertB.y)));
-   walls[9].push_back(Wall(rotation * glm::vec2(0.0f, 1.0f),               rotation * glm::vec2(-vertB.x, -vertB.y), rotation * glm::vec2(vertB.x, -vertB.y)));
-   walls[9].push_back(Wall(rotation * glm::vec2(normalAB.x,-normalAB.y),   rotation * glm::vec2(vertB.x, -vertB.y),  rotation * vertA));
-
-   // Octagon
-   glm::vec2 vert1(400.0f, 0.0f);
-   glm::vec2 vert2 = calc2DRotMat(45.0f) * vert1;
-   glm::vec2 normal12 = glm::normalize(glm::vec2(0.0f) - ((vert1 + vert2) / 2.0f));
-
-   walls[10].push_back(Wall(normal12,                                               vert1,                        vert2));
-   walls[10].push_back(Wall(calc2DRotMat(45.0)   * normal12, calc2DRotMat(45.0)   * vert1, calc2DRotMat(90.0f)  * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(90.0f)  * normal12, calc2DRotMat(90.0f)  * vert1, calc2DRotMat(135.0f) * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(135.0f) * normal12, calc2DRotMat(135.0f) * vert1, calc2DRotMat(180.0f) * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(180.0f) * normal12, calc2DRotMat(180.0f) * vert1, calc2DRotMat(225.0f) * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(225.0f) * normal12, calc2DRotMat(225.0f) * vert1, calc2DRotMat(270.0f) * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(270.0f) * normal12, calc2DRotMat(270.0f) * vert1, calc2DRotMat(315.0f) * vert1));
-   walls[10].push_back(Wall(calc2DRotMat(315.0f) * normal12, calc2DRotMat(315.0f) * vert1, calc2DRotMat(360.0f) * vert1));
-
-   float dx = -800.0f;
-   float dy = 300.0f;
-   glm::vec2 normalOfBottomPlane = glm::normalize(glm::vec2(dy, -dx));
-
-   // Donward Slope
-   walls[11].push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2( -400.0f,  200.0f), glm::vec2(  400.0f,  200.0f))); // Top wall
-   walls[11].push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2(  400.0f,  200.0f), glm::vec2(  400.0f, -200.0f))); // Right wall
-   walls[11].push_back(Wall(normalOfBottomPlane,     glm::vec2(  400.0f, -200.0f), glm::vec2( -400.0f,  100.0f))); // Bottom wall
-   walls[11].push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2( -400.0f,  100.0f), glm::vec2( -400.0f,  200.0f))); // Left wall
-
-   // Upward Slope
-   walls[12].push_back(Wall(glm::vec2( 0.0f, -1.0f),                                  glm::vec2( -400.0f,  200.0f), glm::vec2(  400.0f,  200.0f))); // Top wall
-   walls[12].push_back(Wall(glm::vec2(-1.0f,  0.0f),                                  glm::vec2(  400.0f,  200.0f), glm::vec2(  400.0f,  100.0f))); // Right wall
-   walls[12].push_back(Wall(glm::vec2(-normalOfBottomPlane.x, normalOfBottomPlane.y), glm::vec2(  400.0f,  100.0f), glm::vec2( -400.0f, -200.0f))); // Bottom wall
-   walls[12].push_back(Wall(glm::vec2( 1.0f,  0.0f),                                  glm::vec2( -400.0f, -200.0f), glm::vec2( -400.0f,  200.0f))); // Left wall
-
-   // Create the rigid bodies
-   std::vector<std::vector<RigidBody2D>> scenes(13);
-
-   // Single
-   scenes[0].push_back(RigidBody2D(10.0f, 60.0f, 30.0f, 1.0f, glm::vec2(0.0f, 0.0f), -3.14159265358979323846f / 4, glm::vec2(20.0f, 5.0f), 0.0f,  glm::vec3(1.0f, 0.0f, 0.0f))); // Red
-
-   // Pair
-   scenes[1].push_back(RigidBody2D(10.0f, 60.0f, 30.0f, 1.0f, glm::vec2(15.0f, 15.0f), -3.14159265358979323846f / 4, glm::vec2(17.0f, 14.0f), 0.0f,  glm::vec3(0.0f, 1.0f, 0.0f))); // Green
-   scenes[1].push_back(RigidBody2D(10.0f, 60.0f, 30.0f, 1.0f, glm::vec2(-15.0f, -15.0f), -3.14159265358979323846f / 4, glm::vec2(-20.0f, -12.5f), 0.0f,  glm::vec3(0.0f, 1.0f, 1.0f))); // Turquoise
-
-   // Momentum
-   scenes[2].push_back(RigidBody2D(100.0f, 40.0f, 20.0f, 1.0f, glm::vec2(-370.0f, 0.0f), glm::radians(10.0f), glm::vec2(25.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[2].push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, glm::vec2(370.0f, 0.0f), glm::radians(25.0f), glm::vec2(-25.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 1.0f, 0.0f))); // Yellow
-
-   // Torque
-   scenes[3].push_back(RigidBody2D(20.0f, 30.0f, 20.0f, 1.0f,  glm::vec2(-370.0f, 82.5f), glm::radians(0.0f), glm::vec2(25.0f, 0.0f), 0.0f,  glm::vec3(0.0f, 1.0f, 1.0f))); // Turquoise
-   scenes[3].push_back(RigidBody2D(10.0f, 10.0f, 150.0f, 1.0f, glm::vec2(0.0f, 0.0f), glm::radians(0.0f), glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.0f, 1.0f))); // Pink
-
-   // Plus Sign
-   scenes[4].push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, glm::vec2(100.0f, 0.0f), 0.0f, glm::vec2(-20.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 0.0f)));  // Red
-   scenes[4].push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, glm::vec2(-100.0f, 0.0f), 0.0f, glm::vec2(20.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[4].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(0.0f, 100.0f), 0.0f, glm::vec2(0.0f, -20.0f), 0.0f, glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[4].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(0.0f, -100.0f), 0.0f, glm::vec2(0.0f, 20.0f), 0.0f, glm::vec3(1.f, 1.0f, 1.0f)));   // White
-
-   // Multiplication Sign
-   scenes[5].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(-100.0f, -100.0f), -3.14159265358979323846f / 4, glm::vec2(20.0f, 20.0f), 0.0f,  glm::vec3(0.0f, 0.0f, 1.0f))); // Blue
-   scenes[5].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(100.0f, -100.0f),   3.14159265358979323846f / 4, glm::vec2(-20.0f, 20.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f))); // Green
-   scenes[5].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(100.0f, 100.0f),   -3.14159265358979323846f / 4, glm::vec2(-20.0f, -20.0f), 0.0f,glm::vec3(0.0f, 1.0f, 1.0f))); // Turquoise
-   scenes[5].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(-100.0f, 100.0f),   3.14159265358979323846f / 4, glm::vec2(20.0f, -20.0f), 0.0f, glm::vec3(1.0f, 0.0f, 1.0f))); // Pink
-
-   // Star
-   // Plus bodies
-   scenes[6].push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, glm::vec2(100.0f, 0.0f), 0.0f, glm::vec2(-20.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 0.0f)));  // Red
-   scenes[6].push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, glm::vec2(-100.0f, 0.0f), 0.0f, glm::vec2(20.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(0.0f, 100.0f), 0.0f, glm::vec2(0.0f, -20.0f), 0.0f, glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(0.0f, -100.0f), 0.0f, glm::vec2(0.0f, 20.0f), 0.0f, glm::vec3(1.f, 1.0f, 1.0f)));   // White
-   // X bodies
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(-100.0f, -100.0f), -3.14159265358979323846f / 4, glm::vec2(20.0f, 20.0f), 0.0f,  glm::vec3(0.0f, 0.0f, 1.0f))); // Blue
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(100.0f, -100.0f),   3.14159265358979323846f / 4, glm::vec2(-20.0f, 20.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f))); // Green
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(100.0f, 100.0f),   -3.14159265358979323846f / 4, glm::vec2(-20.0f, -20.0f), 0.0f,glm::vec3(0.0f, 1.0f, 1.0f))); // Turquoise
-   scenes[6].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(-100.0f, 100.0f),   3.14159265358979323846f / 4, glm::vec2(20.0f, -20.0f), 0.0f, glm::vec3(1.0f, 0.0f, 1.0f))); // Pink
-
-   // Stack
-
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -165.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f)));   // Turquoise
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -135.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f)));  // Orange
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -105.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f)));   // Green
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -75.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f)));   // Turquoise
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -45.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f)));  // Orange
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f, -15.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f)));   // Green
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  15.0f),   0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f)));  // Turquoise
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  45.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f)));  // Orange
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  75.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f)));   // Green
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  105.0f),   0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f))); // Turquoise
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  135.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[7].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(0.0f,  165.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f)));  // Green
-
-   // Stack Being Hit
-
-   scenes[8].push_back(RigidBody2D(10.0f, 20.0f, 40.0f, 1.0f, glm::vec2(-350.0f, -100.0f), glm::radians(-45.0f), glm::vec2(135.0f, 35.0f), glm::radians(45.0f), glm::vec3(1.0f, 0.0f, 0.0f))); // Red
-
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -190.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -169.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -148.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -127.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -106.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -85.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -64.0f),   0.0f, glm::vec2(0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -43.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f, -22.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  -1.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  20.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,   glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  41.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,   glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  62.0f),  0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  83.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,   glm::vec3(1.0f, 1.0f, 0.0f)));  // Yellow
-   scenes[8].push_back(RigidBody2D(1.0f, 40.0f, 20.0f, 0.1f, glm::vec2(200.0f,  104.0f), 0.0f, glm::vec2(0.0f, 0.0f), 0.0f,  glm::vec3(1.0f, 0.65f, 0.0f))); // Orange
-
-   // Hexagon
-
-   float velocityScaleFactor = 2.0f;
-   float minWidth = 14.0f;
-
-   // Middle
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -350.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -300.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -250.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),       velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 250.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 300.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(0.0f + calcRandFloat(-30.0f, 30.0f), 350.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),      velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-
-   // Right side
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -300.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -250.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 250.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(100.0f + calcRandFloat(-30.0f, 30.0f), 300.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), -250.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(200.0f + calcRandFloat(-30.0f, 30.0f), 250.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),     velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(300.0f + calcRandFloat(-30.0f, 10.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-
-   // Left side
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -300.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -250.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)), velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 250.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-100.0f + calcRandFloat(-30.0f, 30.0f), 300.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), -250.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)), velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-200.0f + calcRandFloat(-30.0f, 30.0f), 250.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), -200.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), -150.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), -100.0f + calcRandFloat(-10.0f, 10.0f)), glm::radians(calcRandFloat(360.0f)),    velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), -50.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), 0.0f    + calcRandFloat(-10.0f, 10.0f)),    glm::radians(calcRandFloat(360.0f)), velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), 50.0f   + calcRandFloat(-10.0f, 10.0f)),   glm::radians(calcRandFloat(360.0f)),  velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), 100.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), 150.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-   scenes[9].push_back(RigidBody2D(10.0f, calcRandFloat(minWidth, 20.0f), 10.0f, 1.0f, glm::vec2(-300.0f + calcRandFloat(-10.0f, 30.0f), 200.0f  + calcRandFloat(-10.0f, 10.0f)),  glm::radians(calcRandFloat(360.0f)),   velocityScaleFactor * glm::vec2(calcRandFloat(-10.0f, 10.0f), calcRandFloat(-10.0f, 10.0f)), 0.0f, calcRandFloat(1.0f) > 0.5f ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.65f, 0.0f)));  // Yellow
-
-   // Octagon
-   scenes[10].push_back(RigidBody2D(1000000.0f, 10.0f, 700.0f, 1.0f, glm::vec2( 0.0f,    0.0f),   -glm::radians(67.5f), glm::vec2( 0.0f,  0.0f), glm::radians(2.5f), glm::vec3(160.0f / 256.0f, 24.0f / 256.0f, 243.0f / 256.0f))); // Pink
-   scenes[10].push_back(RigidBody2D(1.0f, 20.0f, 40.0f,  1.0f, glm::vec2(-150.0f, -150.0f), -3.14159265358979323846f / 4, glm::vec2( 0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 1.0f)));    // Turquoise
-   scenes[10].push_back(RigidBody2D(1.0f, 20.0f, 40.0f,  1.0f, glm::vec2( 150.0f,  150.0f), -3.14159265358979323846f / 4, glm::vec2( 0.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 1.0f)));    // Violet
-
-   // Downard Slope
-   scenes[11].push_back(RigidBody2D(10.0f, 20.0f, 10.0f, 1.0f, glm::vec2(-380.0f, 150.0f), -3.14159265358979323846f / 4, glm::vec2(10.0f, 0.0f), 0.0f, glm::vec3(1.0f, 0.0f, 0.0f))); // Red
-
-   // Upward Slope
-   scenes[12].push_back(RigidBody2D(10.0f, 20.0f, 10.0f, 1.0f, glm::vec2(-380.0f, -150.0f), -3.14159265358979323846f / 4, glm::vec2(85.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f))); // Green
-
-   // Create the world
-   mWorld = std::make_shared<World>(std::move(walls), scenes);
+   // Create the world with empty scenes, which are filled in from the scene library when they are first selected
+   int numScenes = mSceneLibrary->getNumScenes();
+   mSceneIsLoaded.assign(numScenes, false);
+   mSceneDimensions.assign(numScenes, glm::vec2(widthInPix, heightInPix));
+
+   mWorld = std::make_shared<World>(std::vector<std::vector<Wall>>(numScenes), std::vector<std::vector<RigidBody2D>>(numScenes));
+
+   if (!loadScene(0))
+   {
+      return false;
+   }
+
+   mWorld->changeScene(0);
+
+   // Setting DYNA_KINEMATICS_METRICS to a file path streams a record per step to that file, in the binary format if the path ends in .bin and in the CSV format otherwise
+   const char* metricsFilePath = std::getenv("DYNA_KINEMATICS_METRICS");
+   if (metricsFilePath)
+   {
+      std::shared_ptr<MetricsSink> metricsSink = std::make_shared<MetricsSink>();
+      if (metricsSink->open(metricsFilePath, MetricsSink::getFormatOfFile(metricsFilePath)))
+      {
+         mWorld->setMetricsSink(metricsSink);
+      }
+   }
+
+   // Setting DYNA_KINEMATICS_TRAJECTORY to a file path records the position and the orientation of every body after each step to that file
+   const char* trajectoryFilePath = std::getenv("DYNA_KINEMATICS_TRAJECTORY");
+   if (trajectoryFilePath)
+   {
+      std::shared_ptr<TrajectoryRecorder> trajectoryRecorder = std::make_shared<TrajectoryRecorder>();
+      if (trajectoryRecorder->open(trajectoryFilePath))
+      {
+         mWorld->setTrajectoryRecorder(trajectoryRecorder);
+      }
+   }
+
+   // The last seconds of the simulation are always kept in memory so that the Save Replay button can write them to a trajectory file
+   // Setting DYNA_KINEMATICS_REPLAY_SECONDS changes how many seconds of simulated time are kept, and setting it to 0 disables the replay
+   const char* replaySeconds  = std::getenv("DYNA_KINEMATICS_REPLAY_SECONDS");
+   float       replayDuration = replaySeconds ? static_cast<float>(std::atof(replaySeconds)) : 10.0f;
+   if (replayDuration > 0.0f)
+   {
+      mReplayBuffer = std::make_shared<ReplayBuffer>(replayDuration);
+      mWorld->setReplayBuffer(mReplayBuffer);
+   }
+
+   // Setting DYNA_KINEMATICS_DETERMINISTIC simulates in deterministic mode, which also adds a hash of the state of each step to the metrics records
+   if (std::getenv("DYNA_KINEMATICS_DETERMINISTIC"))
+   {
+      mWorld->enableDeterministicMode(true);
+   }
+
+   // Setting DYNA_KINEMATICS_ADAPTIVE_MAX_STEP_SCALE changes the multiple of the time step that the adaptive time-step can grow to
+   const char* maxAdaptiveStepSizeScale = std::getenv("DYNA_KINEMATICS_ADAPTIVE_MAX_STEP_SCALE");
+   if (maxAdaptiveStepSizeScale)
+   {
+      mWorld->setMaxAdaptiveStepSizeScale(std::max(1.0f, static_cast<float>(std::atof(maxAdaptiveStepSizeScale))));
+   }
+
+   // Setting DYNA_KINEMATICS_STEP_STATISTICS prints the number and the sizes of the accepted steps when the simulation is paused
+   if (std::getenv("DYNA_KINEMATICS_STEP_STATISTICS"))
+   {
+      mStepStatisticsAreEnabled = true;
+   }
+
+   // Setting DYNA_KINEMATICS_HARDWARE_COUNTERS measures the time and the hardware counts of each phase, and prints them when the simulation is paused
+   // This is done here because the counters only count the thread that opens them
+   if (std::getenv("DYNA_KINEMATICS_HARDWARE_COUNTERS"))
+   {
+      mWorld->enablePhaseTiming(true);
+      mWorld->enableHardwareCounters(true);
+   }
+
+   // Setting DYNA_KINEMATICS_SUBDIVISION_DIAGNOSTICS reports the bodies that cause subdivision storms
+   if (std::getenv("DYNA_KINEMATICS_SUBDIVISION_DIAGNOSTICS"))
+   {
+      mWorld->enableSubdivisionDiagnostics(true);
+   }
 
    // Create the FSM
    mFSM = std::make_shared<FiniteStateMachine>();
@@ -437,8 +203,47 @@ bool Game::initialize()
    // Initialize the FSM
    mFSM->initialize(std::move(mStates), "menu");
 
+   mFSM->getCurrentState()->changeScene(mSceneDimensions[0]);
    mFSM->getCurrentState()->pauseRememberFrames(true);
 
+   // Setting DYNA_KINEMATICS_PER_FRAME_GIF_PALETTES gives each frame of the recorded GIFs its own palette instead of the one of the first frame
+   if (std::getenv("DYNA_KINEMATICS_PER_FRAME_GIF_PALETTES"))
+   {
+      mFSM->getCurrentState()->enablePerFrameGifPalettes(true);
+   }
+
+   // Setting DYNA_KINEMATICS_CAPTURE to a file path or a named pipe streams the recordings there without compression instead of encoding them into GIFs
+   // The stream is in the Y4M format if the path ends in .y4m and in the raw RGB format otherwise, and each recording starts the file over
+   const char* captureFilePath = std::getenv("DYNA_KINEMATICS_CAPTURE");
+   if (captureFilePath)
+   {
+      mFSM->getCurrentState()->setCaptureFilePath(captureFilePath);
+   }
+
+   // The recordings sample the simulation at 50 frames per second of simulated time, whatever the time step, and setting DYNA_KINEMATICS_CAPTURE_FPS changes that rate
+   // The GIFs round the period to hundredths of a second, which is the unit of their delays
+   const char* captureFramesPerSecond = std::getenv("DYNA_KINEMATICS_CAPTURE_FPS");
+   if (captureFramesPerSecond)
+   {
+      mFSM->getCurrentState()->setCaptureFrameRate(static_cast<unsigned int>(std::max(1, std::atoi(captureFramesPerSecond))));
+   }
+
+   // Setting DYNA_KINEMATICS_CAPTURE_SIZE to WIDTHxHEIGHT records at that size instead of the size of the window, with the scene scaled to fit
+   const char* captureSize = std::getenv("DYNA_KINEMATICS_CAPTURE_SIZE");
+   if (captureSize)
+   {
+      unsigned int captureWidth  = 0;
+      unsigned int captureHeight = 0;
+      if (std::sscanf(captureSize, "%ux%u", &captureWidth, &captureHeight) == 2)
+      {
+         mFSM->getCurrentState()->setCaptureSize(captureWidth, captureHeight);
+      }
+      else
+      {
+         std::cout << "Error - Game::initialize - DYNA_KINEMATICS_CAPTURE_SIZE must look like 1280x720" << "\n";
+      }
+   }
+
    return true;
 }
 
@@ -448,17 +253,57 @@ void Game::executeGameLoop()
    //double lastFrame    = 0.0;
    //float  deltaTime    = 0.0f;
 
+   // The performance of the frames is accumulated and sent to the control panel a few times per second, so that it isn't flooded with signals
+   const double                          performanceSamplingPeriod = 0.25;
+   std::chrono::steady_clock::time_point samplingPeriodStart       = std::chrono::steady_clock::now();
+   int                                   numFrames                 = 0;
+   int                                   numSimulatedFrames        = 0;
+   double                                physicsStepSeconds        = 0.0;
+   double                                renderSeconds             = 0.0;
+   double                                numSubsteps               = 0.0;
+   double                                numContacts               = 0.0;
+   double                                numSolverIterations       = 0.0;
+
    while (!mWindow->shouldClose() && !mTerminate)
    {
+      PROFILE_ZONE("Game::executeGameLoop - Frame");
+      ALLOCATION_SCOPE("Game::executeGameLoop - Frame");
+
       //currentFrame = glfwGetTime();
       //deltaTime    = static_cast<float>(currentFrame - lastFrame);
       //lastFrame    = currentFrame;
 
+      bool samplePerformance = mPerformanceSamplingIsEnabled;
+
       mFSM->processInputInCurrentState(mTimeStep);
 
       if (mSimulate)
       {
+         std::chrono::steady_clock::time_point physicsStepStart;
+         if (samplePerformance)
+         {
+            physicsStepStart = std::chrono::steady_clock::now();
+         }
+
          int errorCode = mFSM->updateCurrentState(mTimeStep);
+
+         if (samplePerformance)
+         {
+            const StepMetrics& stepMetrics = mWorld->getStepMetrics();
+
+            physicsStepSeconds  += std::chrono::duration<double>(std::chrono::steady_clock::now() - physicsStepStart).count();
+            numSubsteps         += stepMetrics.numSubsteps;
+            numContacts         += stepMetrics.numBodyWallContacts + stepMetrics.numBodyBodyContacts;
+            numSolverIterations += stepMetrics.numSolverIterations;
+            numSimulatedFrames++;
+         }
+
+         if (mWorld->subdivisionDiagnosticsAreEnabled() &&
+             ((errorCode == 1) || (mWorld->getSubdivisionRecords().size() >= World::minNumSubdivisionsToReport)))
+         {
+            mWorld->printSubdivisionReport();
+         }
+
          if (errorCode != 0)
          {
             pauseSimulation();
@@ -466,12 +311,68 @@ void Game::executeGameLoop()
          }
       }
 
+      std::chrono::steady_clock::time_point renderStart;
+      if (samplePerformance)
+      {
+         renderStart = std::chrono::steady_clock::now();
+      }
+
       mFSM->renderCurrentState();
+
+      if (samplePerformance)
+      {
+         std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+
+         // The render time includes the time spent waiting for the buffers to be swapped
+         renderSeconds += std::chrono::duration<double>(frameEnd - renderStart).count();
+         numFrames++;
+
+         double samplingPeriodSeconds = std::chrono::duration<double>(frameEnd - samplingPeriodStart).count();
+         if (samplingPeriodSeconds >= performanceSamplingPeriod)
+         {
+            double oneOverNumSimulatedFrames = (numSimulatedFrames > 0) ? (1.0 / numSimulatedFrames) : 0.0;
+
+            emit performanceSampled(1000.0 * physicsStepSeconds * oneOverNumSimulatedFrames,
+                                    1000.0 * renderSeconds / numFrames,
+                                    numSubsteps * oneOverNumSimulatedFrames,
+                                    numContacts * oneOverNumSimulatedFrames,
+                                    numSolverIterations * oneOverNumSimulatedFrames,
+                                    numFrames / samplingPeriodSeconds);
+
+            samplingPeriodStart = frameEnd;
+            numFrames           = 0;
+            numSimulatedFrames  = 0;
+            physicsStepSeconds  = 0.0;
+            renderSeconds       = 0.0;
+            numSubsteps         = 0.0;
+            numContacts         = 0.0;
+            numSolverIterations = 0.0;
+         }
+      }
+      else
+      {
+         // Start a new sampling period when sampling is enabled again
+         samplingPeriodStart = std::chrono::steady_clock::now();
+      }
+   }
+
+   // The scopes are counted per thread, so the table is printed by the thread that runs the game loop
+   if (AllocationTracker::isEnabled())
+   {
+      AllocationTracker::printScopeTable(std::cout);
    }
 }
 
 void Game::changeScene(int index)
 {
+   // The current scene stays selected if the new one can't be loaded
+   if (!loadScene(index))
+   {
+      return;
+   }
+
+   mCurrentSceneIndex = index;
+
    bool oldSimulationStatus = mSimulate;
 
    mSimulate = false;
@@ -502,6 +403,9 @@ void Game::startSimulation()
       mFSM->getCurrentState()->enableRecording(true);
    }
 
+   // The replay holds the frames of the scene that was simulated last, even after another scene is selected
+   mSimulatedSceneIndex = mCurrentSceneIndex;
+
    mSimulate = true;
 }
 
@@ -513,6 +417,27 @@ void Game::pauseSimulation()
 
    mFSM->getCurrentState()->pauseRememberFrames(true);
 
+   if (oldSimulationStatus)
+   {
+      const World::StepStatistics& stepStatistics = mWorld->getStepStatistics();
+      if (mStepStatisticsAreEnabled)
+      {
+         float meanStepSize = (stepStatistics.numAcceptedSteps > 0) ? (stepStatistics.totalSimulatedTime / stepStatistics.numAcceptedSteps) : 0.0f;
+         std::cout << "Step statistics - accepted: " << stepStatistics.numAcceptedSteps
+                   << ", rejected: "                 << stepStatistics.numRejectedSteps
+                   << ", subdivisions: "             << stepStatistics.numSubdivisions
+                   << ", min step size: "            << stepStatistics.minStepSize
+                   << ", mean step size: "           << meanStepSize
+                   << ", max step size: "            << stepStatistics.maxStepSize
+                   << ", simulated time: "           << stepStatistics.totalSimulatedTime << "\n";
+      }
+
+      if (mWorld->hardwareCountersAreEnabled())
+      {
+         World::printPhaseTable(stepStatistics, std::cout);
+      }
+   }
+
    if (mRecordGIF && oldSimulationStatus)
    {
       mFSM->getCurrentState()->enableRecording(false);
@@ -552,11 +477,31 @@ void Game::changeCoefficientOfRestitution(double coefficientOfRestitution)
    mWorld->setCoefficientOfRestitution(static_cast<float>(coefficientOfRestitution));
 }
 
+void Game::changeIntegrator(int index)
+{
+   mWorld->setIntegrator(static_cast<World::Integrator>(index));
+}
+
+void Game::enableAdaptiveTimeStep(bool enable)
+{
+   mWorld->enableAdaptiveTimeStep(enable);
+}
+
+void Game::enableContinuousCollisionDetection(bool enable)
+{
+   mWorld->enableContinuousCollisionDetection(enable);
+}
+
 void Game::enableWireframeMode(bool enable)
 {
    mFSM->getCurrentState()->enableWireframeMode(enable);
 }
 
+void Game::enablePerformanceSampling(bool enable)
+{
+   mPerformanceSamplingIsEnabled = enable;
+}
+
 void Game::enableRememberFrames(bool enable)
 {
    mFSM->getCurrentState()->enableRememberFrames(enable);
@@ -582,6 +527,94 @@ void Game::enableRecordGIF(bool enable)
    mRecordGIF = enable;
 }
 
+void Game::saveReplay()
+{
+   if (!mReplayBuffer)
+   {
+      std::cout << "Error - Game::saveReplay - The replay is disabled" << "\n";
+      return;
+   }
+
+   std::string replaysDirectory = "Replays";
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   _mkdir(replaysDirectory.c_str());
+#else
+   mkdir(replaysDirectory.c_str() , 0775);
+#endif
+
+   // The replays are numbered like the GIFs, and the first number that isn't taken is used
+   int         replayNumber   = 1;
+   std::string replayFilePath = replaysDirectory + "/Replay_" + std::to_string(replayNumber) + ".traj";
+   while (std::ifstream(replayFilePath))
+   {
+      replayNumber++;
+      replayFilePath = replaysDirectory + "/Replay_" + std::to_string(replayNumber) + ".traj";
+   }
+
+   // The simulation keeps running while the file is written, since only the frames that were already encoded are saved
+   if (!mReplayBuffer->save(replayFilePath))
+   {
+      return;
+   }
+
+   std::uint64_t numEncodedFrames = std::max<std::uint64_t>(mReplayBuffer->getNumEncodedFrames(), 1);
+   std::cout << "Saved " << mReplayBuffer->getDuration() << " seconds of the simulation to " << replayFilePath
+             << ", which can be rendered with OfflineRenderer " << mSceneLibrary->getSceneFilePath(mSimulatedSceneIndex) << " " << replayFilePath << " output_directory" << "\n"
+             << "Replay cost - frames in memory: " << mReplayBuffer->getNumFrames()
+             << ", bytes in memory: "              << mReplayBuffer->getNumBytes()
+             << ", encoding time per frame: "      << (mReplayBuffer->getEncodingTimeInSeconds() * 1.0e6 / numEncodedFrames) << " us"
+             << ", dropped frames: "               << mReplayBuffer->getNumDroppedFrames() << "\n";
+}
+
+bool Game::loadScene(int index)
+{
+   if (mSceneIsLoaded[index])
+   {
+      return true;
+   }
+
+   // The gravity and the time step of the scene are ignored, since they are set from the control panel
+   // The walls are only uploaded to the GPU when they are first rendered
+   const std::string& filePath = mSceneLibrary->getSceneFilePath(index);
+   if (Scene::getFormatOfFile(filePath) == Scene::Format::binary)
+   {
+      // The bodies of a binary scene are copied straight from the mapped file into the initial states of the world
+      MappedScene mappedScene;
+      if (!mappedScene.open(filePath))
+      {
+         std::cout << "Error - Game::loadScene - Failed to load " << filePath << "\n";
+         return false;
+      }
+
+      std::vector<Wall> walls;
+      walls.reserve(mappedScene.getNumWalls());
+      for (std::size_t i = 0; i < mappedScene.getNumWalls(); ++i)
+      {
+         const SceneWallRecord& wallRecord = mappedScene.getWalls()[i];
+         walls.push_back(Wall(wallRecord.normal, wallRecord.startPoint, wallRecord.endPoint));
+      }
+
+      mSceneDimensions[index] = mappedScene.getDimensions();
+      mWorld->loadScene(index, std::move(walls), mappedScene.getRigidBodies(), mappedScene.getNumRigidBodies());
+   }
+   else
+   {
+      Scene scene;
+      if (!mSceneLibrary->loadScene(index, scene))
+      {
+         std::cout << "Error - Game::loadScene - Failed to load " << filePath << "\n";
+         return false;
+      }
+
+      mSceneDimensions[index] = scene.dimensions;
+      mWorld->loadScene(index, std::move(scene.walls), scene.rigidBodies);
+   }
+
+   mSceneIsLoaded[index] = true;
+
+   return true;
+}
+
 void Game::run()
 {
    if (!mInitialized)
@@ -596,10 +629,27 @@ void Game::run()
       }
    }
 
+   // Setting DYNA_KINEMATICS_TRACE to a file path records the profiler zones and exports them to that file when the simulation viewer is closed
+   const char* traceFilePath = std::getenv("DYNA_KINEMATICS_TRACE");
+   if (traceFilePath)
+   {
+      Profiler::setThreadName("Game loop");
+      Profiler::enable(true);
+   }
+
    if (mInitialized)
    {
       executeGameLoop();
    }
 
+   if (traceFilePath)
+   {
+      Profiler::enable(false);
+      if (Profiler::exportChromeTrace(traceFilePath))
+      {
+         std::cout << "Wrote the profiler trace to " << traceFilePath << "\n";
+      }
+   }
+
    emit simulatorViewerClosed();
 }
@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <iostream>
+
+#include "gif_encoder.h"
+#include "profiler.h"
+
+namespace
+{
+   const std::uint32_t emptyColorSlot       = 0xFFFFFFFF;
+   const std::size_t   exactColorTableSize  = 1024;      // A power of two that is well above 256, so that the probe sequences stay short
+   const std::size_t   dictionarySize       = 5003;      // A prime that is larger than the 4096 codes of the dictionary
+   const std::uint32_t maxNumCodes          = 4096;
+   const std::size_t   bufferSize           = 1 << 20;
+
+   inline std::uint32_t packColor(const unsigned char* rgb)
+   {
+      return (static_cast<std::uint32_t>(rgb[0]) << 16) | (static_cast<std::uint32_t>(rgb[1]) << 8) | rgb[2];
+   }
+
+   inline std::size_t hashColor(std::uint32_t color)
+   {
+      return (color * 2654435761u) >> 22;
+   }
+
+   // The number of bits of the indices of a color table, which must have a power of two colors and at least 2 of them
+   unsigned int calculateNumBitsOfColorTable(std::size_t numColors)
+   {
+      unsigned int numBits = 1;
+      while ((std::size_t(1) << numBits) < numColors)
+      {
+         ++numBits;
+      }
+
+      return numBits;
+   }
+
+   void appendUInt16(std::vector<unsigned char>& buffer, unsigned int value)
+   {
+      buffer.push_back(static_cast<unsigned char>(value & 0xFF));
+      buffer.push_back(static_cast<unsigned char>((value >> 8) & 0xFF));
+   }
+
+   struct HistogramBin
+   {
+      std::uint32_t bin;
+      std::uint32_t count;
+      std::uint64_t sumOfRed;
+      std::uint64_t sumOfGreen;
+      std::uint64_t sumOfBlue;
+   };
+
+   struct ColorBox
+   {
+      std::size_t  begin;
+      std::size_t  end;
+      unsigned int widestChannel;
+      unsigned int widestRange;
+   };
+
+   inline unsigned int getChannelOfBin(std::uint32_t bin, unsigned int channel)
+   {
+      return (bin >> (10 - (5 * channel))) & 31;
+   }
+
+   ColorBox makeColorBox(const std::vector<HistogramBin>& bins, std::size_t begin, std::size_t end)
+   {
+      ColorBox box = {begin, end, 0, 0};
+      for (unsigned int channel = 0; channel < 3; ++channel)
+      {
+         unsigned int minValue = 31;
+         unsigned int maxValue = 0;
+         for (std::size_t i = begin; i < end; ++i)
+         {
+            unsigned int value = getChannelOfBin(bins[i].bin, channel);
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+         }
+
+         if (maxValue - minValue > box.widestRange)
+         {
+            box.widestChannel = channel;
+            box.widestRange   = maxValue - minValue;
+         }
+      }
+
+      return box;
+   }
+}
+
+GifPalette::GifPalette()
+   : mColors()
+   , mExactColors()
+   , mExactIndices()
+   , mIndexOfBin()
+{
+
+}
+
+void GifPalette::build(const unsigned char* pixels, unsigned int width, unsigned int height, bool mapAllColors)
+{
+   PROFILE_ZONE("GifPalette::build");
+
+   std::size_t numPixels = static_cast<std::size_t>(width) * height;
+
+   mColors.clear();
+   mExactColors.assign(exactColorTableSize, emptyColorSlot);
+   mExactIndices.assign(exactColorTableSize, 0);
+   mIndexOfBin.clear();
+
+   // Most frames of a simulation only have a few colors, so first try to keep all of them
+   bool          isExact       = true;
+   std::uint32_t previousColor = emptyColorSlot;
+   for (std::size_t i = 0; (i < numPixels) && isExact; ++i)
+   {
+      std::uint32_t color = packColor(&pixels[3 * i]);
+      if ((color == previousColor) || (findExactColor(color) >= 0))
+      {
+         previousColor = color;
+         continue;
+      }
+
+      if (mColors.size() == 3 * 256)
+      {
+         isExact = false;
+         break;
+      }
+
+      std::size_t slot = hashColor(color);
+      while (mExactColors[slot] != emptyColorSlot)
+      {
+         slot = (slot + 1) & (exactColorTableSize - 1);
+      }
+
+      mExactColors[slot]  = color;
+      mExactIndices[slot] = static_cast<unsigned char>(mColors.size() / 3);
+      mColors.push_back(pixels[3 * i]);
+      mColors.push_back(pixels[(3 * i) + 1]);
+      mColors.push_back(pixels[(3 * i) + 2]);
+
+      previousColor = color;
+   }
+
+   std::vector<std::uint32_t> countOfBin;
+   if (!isExact)
+   {
+      mColors.clear();
+      mExactColors.clear();
+      mExactIndices.clear();
+
+      // Median cut on a histogram with 5 bits per channel
+      countOfBin.assign(32768, 0);
+      std::vector<HistogramBin> bins;
+      std::vector<std::int32_t> positionOfBin(32768, -1);
+      for (std::size_t i = 0; i < numPixels; ++i)
+      {
+         const unsigned char* rgb = &pixels[3 * i];
+         std::uint32_t        bin = getBinOfColor(packColor(rgb));
+         if (positionOfBin[bin] < 0)
+         {
+            positionOfBin[bin] = static_cast<std::int32_t>(bins.size());
+            bins.push_back(HistogramBin{bin, 0, 0, 0, 0});
+         }
+
+         HistogramBin& histogramBin = bins[positionOfBin[bin]];
+         histogramBin.count++;
+         histogramBin.sumOfRed   += rgb[0];
+         histogramBin.sumOfGreen += rgb[1];
+         histogramBin.sumOfBlue  += rgb[2];
+         countOfBin[bin]++;
+      }
+
+      std::vector<ColorBox> boxes(1, makeColorBox(bins, 0, bins.size()));
+      while (boxes.size() < 256)
+      {
+         // Split the box with the widest range of colors along its widest channel
+         std::size_t boxToSplit = boxes.size();
+         for (std::size_t i = 0; i < boxes.size(); ++i)
+         {
+            if ((boxes[i].widestRange > 0) && ((boxToSplit == boxes.size()) || (boxes[i].widestRange > boxes[boxToSplit].widestRange)))
+            {
+               boxToSplit = i;
+            }
+         }
+
+         if (boxToSplit == boxes.size())
+         {
+            break;
+         }
+
+         ColorBox     box     = boxes[boxToSplit];
+         unsigned int channel = box.widestChannel;
+         std::sort(bins.begin() + box.begin, bins.begin() + box.end, [channel](const HistogramBin& lhs, const HistogramBin& rhs)
+         {
+            return getChannelOfBin(lhs.bin, channel) < getChannelOfBin(rhs.bin, channel);
+         });
+
+         std::uint64_t countOfBox = 0;
+         for (std::size_t i = box.begin; i < box.end; ++i)
+         {
+            countOfBox += bins[i].count;
+         }
+
+         // Split at the median pixel, but always leave at least one bin on each side
+         std::size_t   split           = box.begin + 1;
+         std::uint64_t countBeforeSplit = bins[box.begin].count;
+         while ((split < box.end - 1) && (2 * countBeforeSplit < countOfBox))
+         {
+            countBeforeSplit += bins[split].count;
+            ++split;
+         }
+
+         boxes[boxToSplit] = makeColorBox(bins, box.begin, split);
+         boxes.push_back(makeColorBox(bins, split, box.end));
+      }
+
+      for (const ColorBox& box : boxes)
+      {
+         std::uint64_t count      = 0;
+         std::uint64_t sumOfRed   = 0;
+         std::uint64_t sumOfGreen = 0;
+         std::uint64_t sumOfBlue  = 0;
+         for (std::size_t i = box.begin; i < box.end; ++i)
+         {
+            count      += bins[i].count;
+            sumOfRed   += bins[i].sumOfRed;
+            sumOfGreen += bins[i].sumOfGreen;
+            sumOfBlue  += bins[i].sumOfBlue;
+         }
+
+         mColors.push_back(static_cast<unsigned char>((sumOfRed   + (count / 2)) / count));
+         mColors.push_back(static_cast<unsigned char>((sumOfGreen + (count / 2)) / count));
+         mColors.push_back(static_cast<unsigned char>((sumOfBlue  + (count / 2)) / count));
+      }
+   }
+
+   // An exact palette only needs the bins to map the colors of other images
+   if (!isExact || mapAllColors)
+   {
+      mIndexOfBin.assign(32768, 0);
+      for (std::uint32_t bin = 0; bin < 32768; ++bin)
+      {
+         if (mapAllColors || countOfBin[bin] > 0)
+         {
+            // The center of the bin stands for all the colors in it
+            std::uint32_t centerOfBin = (((bin >> 10) & 31) << 19) | (((bin >> 5) & 31) << 11) | ((bin & 31) << 3) | 0x040404;
+            mIndexOfBin[bin] = findClosestColor(centerOfBin);
+         }
+      }
+   }
+}
+
+void GifPalette::map(const unsigned char* pixels, unsigned int width, unsigned int height, bool flipVertically, std::vector<unsigned char>& indices) const
+{
+   PROFILE_ZONE("GifPalette::map");
+
+   indices.resize(static_cast<std::size_t>(width) * height);
+
+   // Consecutive pixels usually have the same color, so the last lookup is remembered
+   std::uint32_t previousColor = emptyColorSlot;
+   unsigned char previousIndex = 0;
+
+   for (unsigned int y = 0; y < height; ++y)
+   {
+      const unsigned char* row        = pixels + (3 * static_cast<std::size_t>(flipVertically ? (height - 1 - y) : y) * width);
+      unsigned char*       indicesRow = &indices[static_cast<std::size_t>(y) * width];
+      for (unsigned int x = 0; x < width; ++x)
+      {
+         std::uint32_t color = packColor(&row[3 * x]);
+         if (color != previousColor)
+         {
+            int exactIndex = findExactColor(color);
+            if (exactIndex >= 0)
+            {
+               previousIndex = static_cast<unsigned char>(exactIndex);
+            }
+            else if (!mIndexOfBin.empty())
+            {
+               previousIndex = mIndexOfBin[getBinOfColor(color)];
+            }
+            else
+            {
+               previousIndex = findClosestColor(color);
+            }
+
+            previousColor = color;
+         }
+
+         indicesRow[x] = previousIndex;
+      }
+   }
+}
+
+const std::vector<unsigned char>& GifPalette::getColors() const
+{
+   return mColors;
+}
+
+std::uint32_t GifPalette::getBinOfColor(std::uint32_t color)
+{
+   return ((color >> 9) & 0x7C00) | ((color >> 6) & 0x03E0) | ((color >> 3) & 0x001F);
+}
+
+int GifPalette::findExactColor(std::uint32_t color) const
+{
+   if (mExactColors.empty())
+   {
+      return -1;
+   }
+
+   std::size_t slot = hashColor(color);
+   while (mExactColors[slot] != emptyColorSlot)
+   {
+      if (mExactColors[slot] == color)
+      {
+         return mExactIndices[slot];
+      }
+
+      slot = (slot + 1) & (exactColorTableSize - 1);
+   }
+
+   return -1;
+}
+
+unsigned char GifPalette::findClosestColor(std::uint32_t color) const
+{
+   int red   = (color >> 16) & 0xFF;
+   int green = (color >> 8) & 0xFF;
+   int blue  = color & 0xFF;
+
+   std::size_t closestIndex    = 0;
+   int         closestDistance = 3 * 256 * 256;
+   for (std::size_t i = 0; i < mColors.size() / 3; ++i)
+   {
+      int differenceOfRed   = red   - mColors[3 * i];
+      int differenceOfGreen = green - mColors[(3 * i) + 1];
+      int differenceOfBlue  = blue  - mColors[(3 * i) + 2];
+      int distance          = (differenceOfRed * differenceOfRed) + (differenceOfGreen * differenceOfGreen) + (differenceOfBlue * differenceOfBlue);
+      if (distance < closestDistance)
+      {
+         closestIndex    = i;
+         closestDistance = distance;
+      }
+   }
+
+   return static_cast<unsigned char>(closestIndex);
+}
+
+GifEncoder::GifEncoder()
+   : mFile()
+   , mFilePath()
+   , mWidth(0)
+   , mHeight(0)
+   , mDelayInCentiseconds(0)
+   , mGlobalPalette()
+   , mPreviousColors()
+   , mDictionaryKeys(dictionarySize, -1)
+   , mDictionaryCodes(dictionarySize, 0)
+   , mBitBuffer(0)
+   , mNumBitsInBuffer(0)
+   , mCodeSize(0)
+   , mSubBlock()
+   , mSubBlockSize(0)
+   , mBuffer()
+   , mNumWrittenFrames(0)
+   , mNumWrittenBytes(0)
+{
+
+}
+
+GifEncoder::~GifEncoder()
+{
+   close();
+}
+
+bool GifEncoder::open(const std::string& filePath, unsigned int width, unsigned int height, unsigned int delayInCentiseconds, const std::vector<unsigned char>& globalPalette)
+{
+   close();
+
+   if ((width == 0) || (height == 0) || (width > 65535) || (height > 65535))
+   {
+      std::cout << "Error - GifEncoder::open - A GIF can't be " << width << "x" << height << " pixels" << "\n";
+      return false;
+   }
+
+   mFile.open(filePath, std::ios::binary | std::ios::trunc);
+   if (!mFile)
+   {
+      std::cout << "Error - GifEncoder::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   mFilePath            = filePath;
+   mWidth               = width;
+   mHeight              = height;
+   mDelayInCentiseconds = delayInCentiseconds;
+   mGlobalPalette       = globalPalette;
+   mNumWrittenFrames    = 0;
+   mNumWrittenBytes     = 0;
+
+   // No pixel of the first frame matches these colors, so it's written whole
+   mPreviousColors.assign(static_cast<std::size_t>(width) * height, emptyColorSlot);
+
+   mBuffer.clear();
+   mBuffer.reserve(bufferSize);
+
+   const unsigned char signature[] = {'G', 'I', 'F', '8', '9', 'a'};
+   mBuffer.insert(mBuffer.end(), signature, signature + sizeof(signature));
+
+   // Logical screen descriptor
+   appendUInt16(mBuffer, width);
+   appendUInt16(mBuffer, height);
+   if (mGlobalPalette.empty())
+   {
+      mBuffer.push_back(0x70);
+   }
+   else
+   {
+      mBuffer.push_back(static_cast<unsigned char>(0xF0 | (calculateNumBitsOfColorTable(mGlobalPalette.size() / 3) - 1)));
+   }
+   mBuffer.push_back(0); // Background color
+   mBuffer.push_back(0); // Pixel aspect ratio
+
+   if (!mGlobalPalette.empty())
+   {
+      writeColorTable(mGlobalPalette);
+   }
+
+   // The Netscape extension makes the animation loop forever
+   const unsigned char loopExtension[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+   mBuffer.insert(mBuffer.end(), loopExtension, loopExtension + sizeof(loopExtension));
+
+   return true;
+}
+
+bool GifEncoder::close()
+{
+   if (!isOpen())
+   {
+      return true;
+   }
+
+   mBuffer.push_back(0x3B);
+   flushBuffer();
+
+   bool succeeded = static_cast<bool>(mFile);
+   mFile.close();
+
+   if (!succeeded)
+   {
+      std::cout << "Error - GifEncoder::close - Failed to write " << mFilePath << "\n";
+   }
+
+   return succeeded;
+}
+
+bool GifEncoder::isOpen() const
+{
+   return mFile.is_open();
+}
+
+bool GifEncoder::addFrame(const GifFrame& frame)
+{
+   PROFILE_ZONE("GifEncoder::addFrame");
+
+   const std::vector<unsigned char>& palette = frame.palette.empty() ? mGlobalPalette : frame.palette;
+   if (!isOpen() || palette.empty() || (frame.indices.size() != mPreviousColors.size()))
+   {
+      std::cout << "Error - GifEncoder::addFrame - The frame doesn't match " << mFilePath << "\n";
+      return false;
+   }
+
+   std::uint32_t colors[256];
+   std::size_t   numColors = std::min(palette.size() / 3, std::size_t(256));
+   for (std::size_t i = 0; i < numColors; ++i)
+   {
+      colors[i] = packColor(&palette[3 * i]);
+   }
+
+   // Find the rectangle of the pixels whose color changed
+   unsigned int minX = mWidth;
+   unsigned int minY = mHeight;
+   unsigned int maxX = 0;
+   unsigned int maxY = 0;
+   for (unsigned int y = 0; y < mHeight; ++y)
+   {
+      const unsigned char* indicesRow = &frame.indices[static_cast<std::size_t>(y) * mWidth];
+      std::uint32_t*       colorsRow  = &mPreviousColors[static_cast<std::size_t>(y) * mWidth];
+      for (unsigned int x = 0; x < mWidth; ++x)
+      {
+         std::uint32_t color = colors[indicesRow[x]];
+         if (color != colorsRow[x])
+         {
+            colorsRow[x] = color;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+         }
+      }
+   }
+
+   // A frame that doesn't change anything still needs a pixel to hold its delay
+   if (minX > maxX)
+   {
+      minX = maxX = 0;
+      minY = maxY = 0;
+   }
+
+   // Graphics control extension, where each frame is drawn over the previous one
+   const unsigned char graphicsControlExtension[] = {0x21, 0xF9, 0x04, 0x04};
+   mBuffer.insert(mBuffer.end(), graphicsControlExtension, graphicsControlExtension + sizeof(graphicsControlExtension));
+   appendUInt16(mBuffer, mDelayInCentiseconds);
+   mBuffer.push_back(0); // Transparent color index, which isn't used
+   mBuffer.push_back(0);
+
+   // Image descriptor
+   mBuffer.push_back(0x2C);
+   appendUInt16(mBuffer, minX);
+   appendUInt16(mBuffer, minY);
+   appendUInt16(mBuffer, maxX - minX + 1);
+   appendUInt16(mBuffer, maxY - minY + 1);
+   if (frame.palette.empty())
+   {
+      mBuffer.push_back(0);
+   }
+   else
+   {
+      mBuffer.push_back(static_cast<unsigned char>(0x80 | (calculateNumBitsOfColorTable(numColors) - 1)));
+      writeColorTable(frame.palette);
+   }
+
+   writeImageData(frame.indices.data(), minX, minY, maxX - minX + 1, maxY - minY + 1, static_cast<unsigned int>(numColors));
+
+   if (mBuffer.size() >= bufferSize)
+   {
+      flushBuffer();
+   }
+
+   mNumWrittenFrames++;
+
+   return static_cast<bool>(mFile);
+}
+
+std::uint64_t GifEncoder::getNumWrittenFrames() const
+{
+   return mNumWrittenFrames;
+}
+
+std::uint64_t GifEncoder::getNumWrittenBytes() const
+{
+   return mNumWrittenBytes + mBuffer.size();
+}
+
+void GifEncoder::writeColorTable(const std::vector<unsigned char>& palette)
+{
+   std::size_t numColors = std::min(palette.size() / 3, std::size_t(256));
+   std::size_t tableSize = std::size_t(1) << calculateNumBitsOfColorTable(numColors);
+
+   mBuffer.insert(mBuffer.end(), palette.begin(), palette.begin() + (3 * numColors));
+   mBuffer.insert(mBuffer.end(), 3 * (tableSize - numColors), 0);
+}
+
+void GifEncoder::writeImageData(const unsigned char* indices, unsigned int left, unsigned int top, unsigned int width, unsigned int height, unsigned int numColors)
+{
+   PROFILE_ZONE("GifEncoder::writeImageData");
+
+   unsigned int  minCodeSize = std::max(calculateNumBitsOfColorTable(numColors), 2u);
+   std::uint32_t clearCode   = 1u << minCodeSize;
+   std::uint32_t endCode     = clearCode + 1;
+
+   mBuffer.push_back(static_cast<unsigned char>(minCodeSize));
+
+   std::fill(mDictionaryKeys.begin(), mDictionaryKeys.end(), -1);
+   std::uint32_t nextCode = endCode + 1;
+
+   mCodeSize        = minCodeSize + 1;
+   mBitBuffer       = 0;
+   mNumBitsInBuffer = 0;
+   mSubBlockSize    = 0;
+
+   writeCode(clearCode);
+
+   std::uint32_t prefix = indices[(static_cast<std::size_t>(top) * mWidth) + left];
+   for (unsigned int y = 0; y < height; ++y)
+   {
+      const unsigned char* row = indices + (static_cast<std::size_t>(top + y) * mWidth) + left;
+      for (unsigned int x = (y == 0) ? 1 : 0; x < width; ++x)
+      {
+         std::uint32_t index = row[x];
+         std::int32_t  key   = static_cast<std::int32_t>((prefix << 8) | index);
+         std::size_t   slot  = ((index << 12) ^ prefix) % dictionarySize;
+
+         while ((mDictionaryKeys[slot] != -1) && (mDictionaryKeys[slot] != key))
+         {
+            slot = (slot + 1 == dictionarySize) ? 0 : (slot + 1);
+         }
+
+         if (mDictionaryKeys[slot] == key)
+         {
+            prefix = mDictionaryCodes[slot];
+            continue;
+         }
+
+         writeCode(prefix);
+
+         std::uint32_t code = nextCode++;
+         mDictionaryKeys[slot]  = key;
+         mDictionaryCodes[slot] = static_cast<std::uint16_t>(code);
+
+         // The decoder adds its codes one code later, so it widens them when the code that was just added no longer fits
+         if (code >= (1u << mCodeSize))
+         {
+            mCodeSize++;
+         }
+
+         // Start over when the dictionary is full
+         if (code == maxNumCodes - 1)
+         {
+            writeCode(clearCode);
+            std::fill(mDictionaryKeys.begin(), mDictionaryKeys.end(), -1);
+            nextCode  = endCode + 1;
+            mCodeSize = minCodeSize + 1;
+         }
+
+         prefix = index;
+      }
+   }
+
+   writeCode(prefix);
+   writeCode(endCode);
+   flushBits();
+
+   if (mSubBlockSize > 0)
+   {
+      mBuffer.push_back(static_cast<unsigned char>(mSubBlockSize));
+      mBuffer.insert(mBuffer.end(), mSubBlock, mSubBlock + mSubBlockSize);
+      mSubBlockSize = 0;
+   }
+
+   mBuffer.push_back(0); // Block terminator
+}
+
+void GifEncoder::writeCode(std::uint32_t code)
+{
+   mBitBuffer       |= code << mNumBitsInBuffer;
+   mNumBitsInBuffer += mCodeSize;
+
+   while (mNumBitsInBuffer >= 8)
+   {
+      writeByteOfImageData(static_cast<unsigned char>(mBitBuffer & 0xFF));
+      mBitBuffer       >>= 8;
+      mNumBitsInBuffer  -= 8;
+   }
+}
+
+void GifEncoder::flushBits()
+{
+   // The remaining bits are padded with zeros
+   if (mNumBitsInBuffer > 0)
+   {
+      writeByteOfImageData(static_cast<unsigned char>(mBitBuffer & 0xFF));
+      mBitBuffer       = 0;
+      mNumBitsInBuffer = 0;
+   }
+}
+
+void GifEncoder::writeByteOfImageData(unsigned char byte)
+{
+   mSubBlock[mSubBlockSize++] = byte;
+   if (mSubBlockSize == 255)
+   {
+      mBuffer.push_back(255);
+      mBuffer.insert(mBuffer.end(), mSubBlock, mSubBlock + mSubBlockSize);
+      mSubBlockSize = 0;
+   }
+}
+
+void GifEncoder::flushBuffer()
+{
+   mFile.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+   mNumWrittenBytes += mBuffer.size();
+   mBuffer.clear();
+}
@@ -0,0 +1,158 @@
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "hardware_counters.h"
+
+HardwareCounterValues::HardwareCounterValues()
+   : cycles(0)
+   , instructions(0)
+   , cacheMisses(0)
+   , branchMisses(0)
+   , timeEnabled(0)
+   , timeRunning(0)
+{
+
+}
+
+HardwareCounterValues& HardwareCounterValues::operator+=(const HardwareCounterValues& other)
+{
+   cycles       += other.cycles;
+   instructions += other.instructions;
+   cacheMisses  += other.cacheMisses;
+   branchMisses += other.branchMisses;
+   timeEnabled  += other.timeEnabled;
+   timeRunning  += other.timeRunning;
+   return *this;
+}
+
+HardwareCounterValues HardwareCounterValues::operator-(const HardwareCounterValues& other) const
+{
+   HardwareCounterValues difference;
+   difference.timeEnabled = timeEnabled - other.timeEnabled;
+   difference.timeRunning = timeRunning - other.timeRunning;
+
+   // The raw counts never decrease, so their differences can't wrap
+   double scale = ((difference.timeRunning > 0) && (difference.timeRunning < difference.timeEnabled)) ? (static_cast<double>(difference.timeEnabled) / difference.timeRunning) : 1.0;
+
+   difference.cycles       = static_cast<std::uint64_t>((cycles       - other.cycles)       * scale);
+   difference.instructions = static_cast<std::uint64_t>((instructions - other.instructions) * scale);
+   difference.cacheMisses  = static_cast<std::uint64_t>((cacheMisses  - other.cacheMisses)  * scale);
+   difference.branchMisses = static_cast<std::uint64_t>((branchMisses - other.branchMisses) * scale);
+   return difference;
+}
+
+HardwareCounters::HardwareCounters()
+{
+   for (int i = 0; i < numCounters; ++i)
+   {
+      mFileDescriptors[i] = -1;
+   }
+}
+
+HardwareCounters::~HardwareCounters()
+{
+   close();
+}
+
+bool HardwareCounters::open()
+{
+   if (isOpen())
+   {
+      return true;
+   }
+
+#ifdef __linux__
+   const std::uint64_t configs[numCounters] = {PERF_COUNT_HW_CPU_CYCLES,
+                                               PERF_COUNT_HW_INSTRUCTIONS,
+                                               PERF_COUNT_HW_CACHE_MISSES,
+                                               PERF_COUNT_HW_BRANCH_MISSES};
+
+   for (int i = 0; i < numCounters; ++i)
+   {
+      perf_event_attr attributes;
+      std::memset(&attributes, 0, sizeof(attributes));
+      attributes.size           = sizeof(attributes);
+      attributes.type           = PERF_TYPE_HARDWARE;
+      attributes.config         = configs[i];
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv     = 1;
+      attributes.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // The first counter is the leader of the group, and the whole group is enabled through it
+      attributes.disabled       = (i == 0) ? 1 : 0;
+
+      // Count the calling thread on any CPU
+      mFileDescriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, (i == 0) ? -1 : mFileDescriptors[0], 0));
+      if (mFileDescriptors[i] == -1)
+      {
+         std::cout << "Error - HardwareCounters::open - perf_event_open failed for counter " << i << ": " << std::strerror(errno) << "\n";
+         close();
+         return false;
+      }
+   }
+
+   ioctl(mFileDescriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+   ioctl(mFileDescriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+   return true;
+#else
+   std::cout << "Error - HardwareCounters::open - Hardware counters are only supported on Linux" << "\n";
+   return false;
+#endif
+}
+
+void HardwareCounters::close()
+{
+#ifdef __linux__
+   // Close the members of the group before the leader
+   for (int i = numCounters - 1; i >= 0; --i)
+   {
+      if (mFileDescriptors[i] != -1)
+      {
+         ::close(mFileDescriptors[i]);
+         mFileDescriptors[i] = -1;
+      }
+   }
+#endif
+}
+
+bool HardwareCounters::isOpen() const
+{
+   return mFileDescriptors[0] != -1;
+}
+
+HardwareCounterValues HardwareCounters::read() const
+{
+   HardwareCounterValues values;
+
+#ifdef __linux__
+   if (!isOpen())
+   {
+      return values;
+   }
+
+   // With PERF_FORMAT_GROUP the layout is the number of counters, the time enabled, the time running and then the value of each counter
+   std::uint64_t buffer[3 + numCounters];
+   if (::read(mFileDescriptors[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)))
+   {
+      return values;
+   }
+
+   values.timeEnabled  = buffer[1];
+   values.timeRunning  = buffer[2];
+   values.cycles       = buffer[3];
+   values.instructions = buffer[4];
+   values.cacheMisses  = buffer[5];
+   values.branchMisses = buffer[6];
+#endif
+
+   return values;
+}
@@ -39,9 +39,18 @@ int main(int argc, char *argv[])
    darkPalette.setColor(QPalette::Disabled,        QPalette::HighlightedText, QColor(127, 127, 127));
    a.setPalette(darkPalette);
 
-   RigidBodySimulator w;
+   // Only the names of the scenes are read here, and each scene is parsed when it's first selected
+   std::shared_ptr<SceneLibrary> sceneLibrary = std::make_shared<SceneLibrary>();
+   if (!sceneLibrary->open("resources/scenes"))
+   {
+      std::cout << "Error - main - Failed to open the scene library" << "\n";
+      return 1;
+   }
+
+   RigidBodySimulator w(*sceneLibrary);
 #if !defined(WIN32) && !defined(_WIN32) && !defined(__WIN32__) && !defined(__NT__)
-   w.setFixedSize(430, 425);
+   // The size comes from the layout, so that rows that are added to the control panel are never squeezed or clipped
+   w.setFixedSize(w.sizeHint());
 #endif
    w.show();
    w.move(830, 180);
@@ -57,7 +66,7 @@ int main(int argc, char *argv[])
 
    glfwMakeContextCurrent(NULL);
 
-   Game game(&w, glfwWindow);
+   Game game(&w, glfwWindow, sceneLibrary);
    game.start();
 
    w.raise();
@@ -0,0 +1,233 @@
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <iostream>
+
+#include "mapped_scene.h"
+
+namespace
+{
+   // The offsets and the counts come from the file, so the check divides instead of multiplying, which could overflow and let a corrupt header pass
+   bool sectionFitsInFile(std::uint64_t offset, std::uint64_t numElements, std::size_t elementSize, std::size_t fileSize)
+   {
+      return (offset <= fileSize) && (numElements <= (fileSize - offset) / elementSize);
+   }
+}
+
+MappedScene::MappedScene()
+   : mData(nullptr)
+   , mSize(0)
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   , mFileHandle(INVALID_HANDLE_VALUE)
+   , mMappingHandle(nullptr)
+#endif
+{
+
+}
+
+MappedScene::~MappedScene()
+{
+   close();
+}
+
+bool MappedScene::open(const std::string& filePath)
+{
+   close();
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   mFileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (mFileHandle == INVALID_HANDLE_VALUE)
+   {
+      std::cout << "Error - MappedScene::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(mFileHandle, &fileSize) || (fileSize.QuadPart == 0))
+   {
+      std::cout << "Error - MappedScene::open - Failed to get the size of " << filePath << "\n";
+      close();
+      return false;
+   }
+
+   mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!mMappingHandle)
+   {
+      std::cout << "Error - MappedScene::open - Failed to map " << filePath << "\n";
+      close();
+      return false;
+   }
+
+   mData = static_cast<const unsigned char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+   mSize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+   int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+   if (fileDescriptor == -1)
+   {
+      std::cout << "Error - MappedScene::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   struct stat fileStatus;
+   if ((fstat(fileDescriptor, &fileStatus) == -1) || (fileStatus.st_size == 0))
+   {
+      std::cout << "Error - MappedScene::open - Failed to get the size of " << filePath << "\n";
+      ::close(fileDescriptor);
+      return false;
+   }
+
+   // The mapping stays valid after the file descriptor is closed
+   void* data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+   ::close(fileDescriptor);
+
+   if (data != MAP_FAILED)
+   {
+      mData = static_cast<const unsigned char*>(data);
+      mSize = static_cast<std::size_t>(fileStatus.st_size);
+   }
+#endif
+
+   if (!mData)
+   {
+      std::cout << "Error - MappedScene::open - Failed to map " << filePath << "\n";
+      close();
+      return false;
+   }
+
+   // The sections are checked against the size of the file, so that a truncated file can't be read past its end
+   const SceneFileHeader* header = getHeader();
+   if ((mSize < sizeof(SceneFileHeader)) || !header->hasValidMagicAndVersion())
+   {
+      std::cout << "Error - MappedScene::open - " << filePath << " isn't a binary scene of a supported version\n";
+      close();
+      return false;
+   }
+
+   if (!header->hasLayoutOfThisBuild())
+   {
+      std::cout << "Error - MappedScene::open - The bodies of " << filePath << " were written with a different memory layout, so the scene has to be converted from its text form\n";
+      close();
+      return false;
+   }
+
+   if (!sectionFitsInFile(header->nameOffset,   header->nameLength, sizeof(char),            mSize) ||
+       !sectionFitsInFile(header->wallsOffset,  header->numWalls,   sizeof(SceneWallRecord), mSize) ||
+       !sectionFitsInFile(header->bodiesOffset, header->numBodies,  sizeof(RigidBody2D),     mSize) ||
+       (header->wallsOffset  % alignof(SceneWallRecord) != 0)                                      ||
+       (header->bodiesOffset % alignof(RigidBody2D)     != 0))
+   {
+      std::cout << "Error - MappedScene::open - " << filePath << " is truncated or has misaligned sections\n";
+      close();
+      return false;
+   }
+
+   return true;
+}
+
+void MappedScene::close()
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   if (mData)
+   {
+      UnmapViewOfFile(mData);
+   }
+
+   if (mMappingHandle)
+   {
+      CloseHandle(mMappingHandle);
+      mMappingHandle = nullptr;
+   }
+
+   if (mFileHandle != INVALID_HANDLE_VALUE)
+   {
+      CloseHandle(mFileHandle);
+      mFileHandle = INVALID_HANDLE_VALUE;
+   }
+#else
+   if (mData)
+   {
+      munmap(const_cast<unsigned char*>(mData), mSize);
+   }
+#endif
+
+   mData = nullptr;
+   mSize = 0;
+}
+
+bool MappedScene::isOpen() const
+{
+   return mData != nullptr;
+}
+
+std::string MappedScene::getName() const
+{
+   const SceneFileHeader* header = getHeader();
+   return std::string(reinterpret_cast<const char*>(mData + header->nameOffset), static_cast<std::size_t>(header->nameLength));
+}
+
+glm::vec2 MappedScene::getDimensions() const
+{
+   return getHeader()->dimensions;
+}
+
+int MappedScene::getGravityState() const
+{
+   return getHeader()->gravityState;
+}
+
+float MappedScene::getTimeStep() const
+{
+   return getHeader()->timeStep;
+}
+
+std::size_t MappedScene::getNumWalls() const
+{
+   return static_cast<std::size_t>(getHeader()->numWalls);
+}
+
+const SceneWallRecord* MappedScene::getWalls() const
+{
+   return reinterpret_cast<const SceneWallRecord*>(mData + getHeader()->wallsOffset);
+}
+
+std::size_t MappedScene::getNumRigidBodies() const
+{
+   return static_cast<std::size_t>(getHeader()->numBodies);
+}
+
+const RigidBody2D* MappedScene::getRigidBodies() const
+{
+   return reinterpret_cast<const RigidBody2D*>(mData + getHeader()->bodiesOffset);
+}
+
+void MappedScene::copyTo(Scene& scene) const
+{
+   scene.name         = getName();
+   scene.dimensions   = getDimensions();
+   scene.gravityState = getGravityState();
+   scene.timeStep     = getTimeStep();
+
+   scene.walls.clear();
+   scene.walls.reserve(getNumWalls());
+   for (std::size_t i = 0; i < getNumWalls(); ++i)
+   {
+      const SceneWallRecord& wallRecord = getWalls()[i];
+      scene.walls.push_back(Wall(wallRecord.normal, wallRecord.startPoint, wallRecord.endPoint));
+   }
+
+   // RigidBody2D is trivially copyable, so this is a single memmove
+   scene.rigidBodies.assign(getRigidBodies(), getRigidBodies() + getNumRigidBodies());
+}
+
+const SceneFileHeader* MappedScene::getHeader() const
+{
+   return reinterpret_cast<const SceneFileHeader*>(mData);
+}
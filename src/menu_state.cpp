@@ -5,9 +5,29 @@
 #include <direct.h>
 #endif
 
-#include <stb_image_write.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <tuple>
 
 #include "menu_state.h"
+#include "allocation_tracker.h"
+#include "profiler.h"
+
+namespace
+{
+   // A recorded frame is read back into a pixel buffer object and only mapped two frames later, which gives the GPU time to copy it
+   const unsigned int numRecordedFramesInFlight = 3;
+
+   // A step that is much longer than the period of a recording repeats its frame at most this many times, so that a single step can't flood the capture sink
+   const unsigned int maxNumCapturedFramesPerRender = 50;
+
+   // The delays of GIFs are in hundredths of a second, so the period of a GIF recording is rounded to one of them to keep its playback in real time
+   unsigned int calculateGifFrameDelayInCentiseconds(unsigned int framesPerSecond)
+   {
+      return std::max(1u, (100 + (framesPerSecond / 2)) / framesPerSecond);
+   }
+}
 
 MenuState::MenuState(const std::shared_ptr<FiniteStateMachine>& finiteStateMachine,
                      const std::shared_ptr<Window>&             window,
@@ -28,7 +48,24 @@ MenuState::MenuState(const std::shared_ptr<FiniteStateMachine>& finiteStateMachi
    , mRecord(false)
    , mRecordingDirectory(-1)
    , mRecordedFrameCounter(0)
-   , mRecordedFrameData(nullptr)
+   , mFrameReadback()
+   , mCaptureSink()
+   , mGifPaletteMode(FrameEncoder::PaletteMode::global)
+   , mCaptureFilePath()
+   , mCaptureFramesPerSecond(50)
+   , mCaptureWidth(0)
+   , mCaptureHeight(0)
+   , mCapturePeriod(0.02)
+   , mCaptureStartTime(0.0)
+   , mLastCaptureClockTime(0.0f)
+   , mNumCapturedSlots(0)
+   , mNumRenderedFramesWhileRecording(0)
+   , mNumSampledFrames(0)
+   , mNumRepeatedFrames(0)
+   , mRecordingIsFinished(true)
+   , mRecordingMutex()
+   , mRecordingFinishedCondition()
+   , mRenderThreadID(std::this_thread::get_id()) // The state is created by the game loop, which is the thread that renders
    , mFSM(finiteStateMachine)
    , mWindow(window)
    , mRenderer2D(renderer2D)
@@ -39,7 +76,7 @@ MenuState::MenuState(const std::shared_ptr<FiniteStateMachine>& finiteStateMachi
 
 MenuState::~MenuState()
 {
-   delete [] mRecordedFrameData;
+
 }
 
 void MenuState::enter()
@@ -117,6 +154,9 @@ int MenuState::update(float deltaTime)
 
 void MenuState::render()
 {
+   PROFILE_ZONE("MenuState::render");
+   ALLOCATION_SCOPE("MenuState::render");
+
    unsigned int widthOfFramebuffer;
    unsigned int heightOfFramebuffer;
    float        lowerLeftCornerOfViewportX;
@@ -169,7 +209,10 @@ void MenuState::render()
          mWindow->bindMultisampleFramebuffer();
       }
 
-      mWorld->render(*mRenderer2D, mWireframeModeIsEnabled);
+      {
+         PROFILE_ZONE("MenuState::render - World");
+         mWorld->render(*mRenderer2D, mWireframeModeIsEnabled);
+      }
 
       if (mFrameCounter % mRememberFramesFrequency == 0 && !mPauseRememberFrames)
       {
@@ -193,31 +236,103 @@ void MenuState::render()
 
       // Render objects
 
+      PROFILE_ZONE("MenuState::render - World");
       mWorld->render(*mRenderer2D, mWireframeModeIsEnabled);
    }
 
-   if (mRecord && mRecordedFrameData)
+   bool record;
+   bool finishRecordingNow;
    {
-      mWindow->copyMultisampleFramebufferIntoGifFramebuffer(widthOfFramebuffer, heightOfFramebuffer);
+      std::lock_guard<std::mutex> guard(mRecordingMutex);
+      record             = mRecord;
+      finishRecordingNow = !mRecord && !mRecordingIsFinished;
+   }
 
-      stbi_flip_vertically_on_write(true);
+   if (record)
+   {
+      PROFILE_ZONE("MenuState::render - Recording");
+      ALLOCATION_SCOPE("MenuState::render - Recording");
 
-      memset(mRecordedFrameData, 0, 3 * widthOfFramebuffer * heightOfFramebuffer);
+      float simulatedTime = mWorld->getStepStatistics().totalSimulatedTime;
 
-      mWindow->bindGifFramebuffer();
+      // Resizing is disabled while recording, so the buffers and the capture sink are only created when a recording starts
+      if (!mCaptureSink)
+      {
+         if (mCaptureFilePath.empty())
+         {
+            unsigned int gifFrameDelayInCentiseconds = calculateGifFrameDelayInCentiseconds(mCaptureFramesPerSecond);
+            std::string  gifFilePath                 = "GIFs/GIF_" + std::to_string(mRecordingDirectory) + "/GIF_" + std::to_string(mRecordingDirectory);
+            mCaptureSink   = std::unique_ptr<CaptureSink>(new FrameEncoder(gifFilePath + "_Slow.gif", gifFilePath + "_Fast.gif", gifFrameDelayInCentiseconds, mGifPaletteMode));
+            mCapturePeriod = gifFrameDelayInCentiseconds / 100.0;
+         }
+         else
+         {
+            mCaptureSink   = std::unique_ptr<CaptureSink>(new RawVideoSink(mCaptureFilePath, RawVideoSink::getFormatOfFile(mCaptureFilePath), mCaptureFramesPerSecond));
+            mCapturePeriod = 1.0 / mCaptureFramesPerSecond;
+         }
 
-      glPixelStorei(GL_PACK_ALIGNMENT, 1);
-      glReadPixels(0, 0, widthOfFramebuffer, heightOfFramebuffer, GL_RGB, GL_UNSIGNED_BYTE, mRecordedFrameData);
+         // A recording with a fixed size is rendered into the capture framebuffer, and any other recording is read straight from the Gif framebuffer
+         unsigned int widthOfRecording  = widthOfFramebuffer;
+         unsigned int heightOfRecording = heightOfFramebuffer;
+         if (mCaptureWidth > 0)
+         {
+            widthOfRecording  = mCaptureWidth;
+            heightOfRecording = mCaptureHeight;
+            mWindow->resizeCaptureFramebuffer(widthOfRecording, heightOfRecording);
+         }
 
-      std::string imgName = "GIFs/GIF_" + std::to_string(mRecordingDirectory) + "/Frames/" + std::to_string(mRecordedFrameCounter) + ".png";
+         // Each thread of the capture sink keeps the buffer of the frame that it's reading mapped
+         mFrameReadback.initialize(widthOfRecording, heightOfRecording, numRecordedFramesInFlight + mCaptureSink->getNumThreads());
 
-      stbi_write_png(imgName.c_str(), widthOfFramebuffer, heightOfFramebuffer, 3, mRecordedFrameData, widthOfFramebuffer * 3);
-      mRecordedFrameCounter++;
+         mNumRenderedFramesWhileRecording = 0;
+         mNumSampledFrames                = 0;
+         mNumRepeatedFrames               = 0;
+         startCaptureClock(simulatedTime);
+      }
+
+      mNumRenderedFramesWhileRecording++;
+
+      retireReadRecordedFrames();
+
+      // Only the frames that the output needs are copied and read back, so small time steps don't make recordings larger or slower
+      unsigned int numFramesToCapture = advanceCaptureClock(simulatedTime);
+      if (numFramesToCapture > 0)
+      {
+         if (mCaptureWidth == 0)
+         {
+            mWindow->copyMultisampleFramebufferIntoGifFramebuffer(widthOfFramebuffer, heightOfFramebuffer);
+         }
+         else if (mRememberFramesIsEnabled)
+         {
+            // The remembered frames only exist at the size of the window, so the image on the screen is scaled into the capture framebuffer
+            mWindow->copyMultisampleFramebufferIntoGifFramebuffer(widthOfFramebuffer, heightOfFramebuffer);
+            mWindow->copyGifFramebufferIntoCaptureFramebuffer(lowerLeftCornerOfViewportX, lowerLeftCornerOfViewportY, widthOfViewport, heightOfViewport);
+         }
+         else
+         {
+            renderWorldIntoCaptureFramebuffer(lowerLeftCornerOfViewportX, lowerLeftCornerOfViewportY, widthOfViewport, heightOfViewport);
+         }
+
+         mNumSampledFrames++;
+         mNumRepeatedFrames += numFramesToCapture - 1;
+
+         for (unsigned int i = 0; i < numFramesToCapture; ++i)
+         {
+            captureFrame();
+         }
+      }
+   }
+   else if (finishRecordingNow)
+   {
+      finishRecording();
    }
 
    mWindow->generateAntiAliasedImage(widthOfFramebuffer, heightOfFramebuffer);
 
-   mWindow->swapBuffers();
+   {
+      PROFILE_ZONE("MenuState::render - Swap buffers");
+      mWindow->swapBuffers();
+   }
 }
 
 void MenuState::exit()
@@ -289,10 +404,6 @@ void MenuState::enableRecording(bool enable)
       mRecordedFrameCounter = 0;
       mRecordingDirectory++;
 
-      delete [] mRecordedFrameData;
-      mRecordedFrameData = nullptr;
-      mRecordedFrameData = new GLubyte[3 * mWindow->getWidthOfFramebufferInPix() * mWindow->getHeightOfFramebufferInPix()];
-
       std::string gifsDirectory = "GIFs";
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
       _mkdir(gifsDirectory.c_str());
@@ -319,28 +430,235 @@ void MenuState::enableRecording(bool enable)
 #endif
       }
 
-      std::string framesFilePath = gifFilePath + "/Frames";
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
-      _mkdir(framesFilePath.c_str());
-#else
-      mkdir(framesFilePath.c_str() , 0775);
-#endif
    }
    else
    {
       mWindow->enableResizing(true);
    }
 
+   std::lock_guard<std::mutex> guard(mRecordingMutex);
+
    mRecord = enable;
+   if (enable)
+   {
+      mRecordingIsFinished = false;
+   }
 }
 
 void MenuState::generateGIF()
 {
-   std::string changeDirectoryCmd = "cd GIFs/GIF_" + std::to_string(mRecordingDirectory) + " && ";
-   std::string generateGifCmd     = "ffmpeg -y -framerate 50 -i Frames/%d.png GIF_" + std::to_string(mRecordingDirectory) + "_Slow.gif && \
-                                     ffmpeg -y -i GIF_" + std::to_string(mRecordingDirectory) + "_Slow.gif -filter:v \"setpts=0.25*PTS\" \
-                                     GIF_" + std::to_string(mRecordingDirectory) + "_Fast.gif";
-   std::string fullCmd            = changeDirectoryCmd + generateGifCmd;
+   // The frames are written while recording, and the output is finished by the thread that renders once it has captured the frames that are still in the ring of pixel buffer objects
+   if (std::this_thread::get_id() == mRenderThreadID)
+   {
+      // The game loop pauses the simulation when it fails, which happens between the update and the render
+      bool recordingIsFinished;
+      {
+         std::lock_guard<std::mutex> guard(mRecordingMutex);
+         recordingIsFinished = mRecordingIsFinished;
+      }
+
+      if (!recordingIsFinished)
+      {
+         finishRecording();
+      }
+   }
+   else
+   {
+      std::unique_lock<std::mutex> lock(mRecordingMutex);
+      if (!mRecordingFinishedCondition.wait_for(lock, std::chrono::seconds(5), [this]() { return mRecordingIsFinished; }))
+      {
+         std::cout << "Error - MenuState::generateGIF - Timed out waiting for the recording to be finished" << "\n";
+      }
+   }
+}
+
+void MenuState::enablePerFrameGifPalettes(bool enable)
+{
+   mGifPaletteMode = enable ? FrameEncoder::PaletteMode::perFrame : FrameEncoder::PaletteMode::global;
+}
+
+void MenuState::setCaptureFilePath(const std::string& filePath)
+{
+   mCaptureFilePath = filePath;
+}
+
+void MenuState::setCaptureFrameRate(unsigned int framesPerSecond)
+{
+   mCaptureFramesPerSecond = std::max(1u, framesPerSecond);
+}
+
+void MenuState::setCaptureSize(unsigned int width, unsigned int height)
+{
+   // A size with a zero in it goes back to the size of the framebuffer
+   bool sizeIsValid = (width > 0) && (height > 0);
+   mCaptureWidth    = sizeIsValid ? width : 0;
+   mCaptureHeight   = sizeIsValid ? height : 0;
+}
+
+void MenuState::startCaptureClock(float simulatedTime)
+{
+   mCaptureStartTime     = simulatedTime;
+   mLastCaptureClockTime = simulatedTime;
+   mNumCapturedSlots     = 0;
+}
+
+unsigned int MenuState::advanceCaptureClock(float simulatedTime)
+{
+   // The simulated time starts over when the scene is changed or reset, and so does the clock, so that the output continues without a gap
+   if (simulatedTime < mLastCaptureClockTime)
+   {
+      startCaptureClock(simulatedTime);
+   }
+
+   mLastCaptureClockTime = simulatedTime;
+
+   // The time is rounded to the closest output frame instead of the next one, because the simulated time is a sum of floats,
+   // and a step that is as long as the period would otherwise land on either side of it and alternate between skipping and repeating frames
+   std::uint64_t numSlots = static_cast<std::uint64_t>(((simulatedTime - mCaptureStartTime) / mCapturePeriod) + 0.5) + 1;
+   if (numSlots <= mNumCapturedSlots)
+   {
+      return 0;
+   }
+
+   std::uint64_t numFrames = numSlots - mNumCapturedSlots;
+   mNumCapturedSlots       = numSlots;
+
+   return static_cast<unsigned int>(std::min<std::uint64_t>(numFrames, maxNumCapturedFramesPerRender));
+}
+
+void MenuState::captureFrame()
+{
+   // The frames that were read back a few frames ago have normally finished copying, so they can be handed to the capture sink
+   while (mFrameReadback.getNumPendingFrames() >= numRecordedFramesInFlight - 1)
+   {
+      encodeOldestRecordedFrame();
+   }
+
+   // When every buffer is in use the capture sink can't keep up, so the render thread waits for the oldest frame to be read
+   if (mFrameReadback.isFull())
+   {
+      mCaptureSink->retireOldestFrame();
+      mFrameReadback.unmapOldestMappedFrame();
+   }
+
+   if (mCaptureWidth > 0)
+   {
+      mWindow->bindCaptureFramebuffer();
+   }
+   else
+   {
+      mWindow->bindGifFramebuffer();
+   }
+
+   PROFILE_ZONE("MenuState::render - Readback");
+   if (mFrameReadback.isInitialized() && mFrameReadback.startReadback(mRecordedFrameCounter))
+   {
+      mRecordedFrameCounter++;
+   }
+}
+
+void MenuState::renderWorldIntoCaptureFramebuffer(float lowerLeftCornerOfViewportX, float lowerLeftCornerOfViewportY, float widthOfViewport, float heightOfViewport)
+{
+   PROFILE_ZONE("MenuState::render - Capture");
+
+   // The world is rendered again at the size of the recording, so that its resolution doesn't depend on the size of the window
+   float lowerLeftCornerOfCaptureViewportX, lowerLeftCornerOfCaptureViewportY, widthOfCaptureViewport, heightOfCaptureViewport;
+   std::tie(lowerLeftCornerOfCaptureViewportX, lowerLeftCornerOfCaptureViewportY, widthOfCaptureViewport, heightOfCaptureViewport) = mWindow->calculateCaptureViewport(widthOfViewport, heightOfViewport);
+
+   // It's rendered into a multisample framebuffer and resolved, so that it's anti-aliased like the scene in the window
+   mWindow->clearAndBindCaptureMultisampleFramebuffer();
+   mRenderer2D->updateViewportDimensions(lowerLeftCornerOfCaptureViewportX, lowerLeftCornerOfCaptureViewportY, widthOfCaptureViewport, heightOfCaptureViewport);
+   mWorld->render(*mRenderer2D, mWireframeModeIsEnabled);
+   mWindow->resolveCaptureMultisampleFramebuffer();
+
+   mRenderer2D->updateViewportDimensions(lowerLeftCornerOfViewportX, lowerLeftCornerOfViewportY, widthOfViewport, heightOfViewport);
+}
+
+void MenuState::encodeOldestRecordedFrame()
+{
+   PROFILE_ZONE("MenuState::encodeOldestRecordedFrame");
+   ALLOCATION_SCOPE("MenuState::render - Capture");
+
+   // The capture sink reads the frame straight from the memory of its pixel buffer object, which stays mapped until the frame is retired
+   int                  frameIndex = 0;
+   const unsigned char* frameData  = mFrameReadback.mapOldestPendingFrame(frameIndex);
+   if (!frameData)
+   {
+      // The frames are unmapped in order, so the ones that are being read must be retired before the one that failed
+      while (mCaptureSink->hasFramesToRetire())
+      {
+         mCaptureSink->retireOldestFrame();
+         mFrameReadback.unmapOldestMappedFrame();
+      }
+
+      mFrameReadback.unmapOldestMappedFrame();
+      return;
+   }
+
+   // The frames are captured in the order in which they were read back, so their index isn't needed
+   CaptureSink::Frame frame;
+   frame.pixels         = frameData;
+   frame.width          = mFrameReadback.getWidth();
+   frame.height         = mFrameReadback.getHeight();
+   frame.flipVertically = true;
+
+   mCaptureSink->push(frame);
+}
+
+void MenuState::retireReadRecordedFrames()
+{
+   while (mCaptureSink->oldestFrameIsRead())
+   {
+      mCaptureSink->retireOldestFrame();
+      mFrameReadback.unmapOldestMappedFrame();
+   }
+}
+
+void MenuState::finishRecording()
+{
+   PROFILE_ZONE("MenuState::finishRecording");
+
+   if (mCaptureSink)
+   {
+      while (mFrameReadback.hasPendingFrames())
+      {
+         encodeOldestRecordedFrame();
+      }
+
+      while (mCaptureSink->hasFramesToRetire())
+      {
+         mCaptureSink->retireOldestFrame();
+         mFrameReadback.unmapOldestMappedFrame();
+      }
+
+      if (!mCaptureSink->close())
+      {
+         std::cout << "Error - MenuState::finishRecording - Failed to write recording " << mRecordingDirectory << "\n";
+      }
+
+      std::cout << "Recording " << mRecordingDirectory << " wrote " << mCaptureSink->getNumWrittenFrames() << " frames and " << mCaptureSink->getNumWrittenBytes() << " bytes"
+                << ", and sampled " << mNumSampledFrames << " of the " << mNumRenderedFramesWhileRecording << " frames that were rendered while recording" << "\n";
+
+      if (mNumRepeatedFrames > 0)
+      {
+         std::cout << "The time step is longer than the period of the recording, so " << mNumRepeatedFrames << " frames were repeated to keep its playback in real time" << "\n";
+      }
+
+      if (mCaptureSink->getNumStalls() > 0)
+      {
+         std::cout << "The recording waited " << mCaptureSink->getNumStalls() << " times for the capture sink to read its frames" << "\n";
+      }
+
+      // The threads of the capture sink are only kept while recording
+      mCaptureSink.reset();
+   }
+
+   mFrameReadback.release();
+
+   {
+      std::lock_guard<std::mutex> guard(mRecordingMutex);
+      mRecordingIsFinished = true;
+   }
 
-   system(fullCmd.c_str());
+   mRecordingFinishedCondition.notify_all();
 }
@@ -0,0 +1,306 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "metrics_sink.h"
+
+StepMetrics::StepMetrics()
+   : stepIndex(0)
+   , stepDurationInNs(0)
+   , simulatedTime(0.0f)
+   , kineticEnergy(0.0f)
+   , linearMomentumX(0.0f)
+   , linearMomentumY(0.0f)
+   , angularMomentum(0.0f)
+   , numBodyWallContacts(0)
+   , numBodyBodyContacts(0)
+   , numSolverIterations(0)
+   , numSubsteps(0)
+   , numSubdivisions(0)
+   , numRejectedSteps(0)
+   , errorCode(0)
+   , stateHash(0)
+{
+
+}
+
+MetricsSink::MetricsSink(std::size_t capacity)
+   : mRecords()
+   , mMask(0)
+   , mWriteIndex(0)
+   , mWriteIndexPadding()
+   , mReadIndex(0)
+   , mReadIndexPadding()
+   , mNumWrittenRecords(0)
+   , mNumDroppedRecords(0)
+   , mStopWriter(false)
+   , mWriterThread()
+   , mFile()
+   , mFormat(Format::csv)
+{
+   std::size_t roundedCapacity = 1;
+   while (roundedCapacity < capacity)
+   {
+      roundedCapacity *= 2;
+   }
+
+   mRecords.resize(roundedCapacity);
+   mMask = roundedCapacity - 1;
+}
+
+MetricsSink::~MetricsSink()
+{
+   close();
+}
+
+MetricsSink::Format MetricsSink::getFormatOfFile(const std::string& filePath)
+{
+   const std::string binaryExtension = ".bin";
+
+   if ((filePath.size() >= binaryExtension.size()) &&
+       (filePath.compare(filePath.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension) == 0))
+   {
+      return Format::binary;
+   }
+
+   return Format::csv;
+}
+
+bool MetricsSink::read(const std::string& filePath, std::vector<StepMetrics>& records)
+{
+   std::ifstream file(filePath, std::ios::in | std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - MetricsSink::read - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   records.clear();
+
+   char magic[8] = {};
+   file.read(magic, sizeof(magic));
+   if (file && (std::memcmp(magic, "DKMETRIC", sizeof(magic)) == 0))
+   {
+      std::uint32_t version    = 0;
+      std::uint32_t recordSize = 0;
+      file.read(reinterpret_cast<char*>(&version), sizeof(version));
+      file.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+      if (!file || (version != 4) || (recordSize != sizeof(StepMetrics)))
+      {
+         std::cout << "Error - MetricsSink::read - " << filePath << " has version " << version << " and records of " << recordSize << " bytes, which aren't supported" << "\n";
+         return false;
+      }
+
+      StepMetrics metrics;
+      while (file.read(reinterpret_cast<char*>(&metrics), sizeof(StepMetrics)))
+      {
+         records.push_back(metrics);
+      }
+
+      return true;
+   }
+
+   // CSV files start with a header line
+   file.clear();
+   file.seekg(0);
+
+   std::string line;
+   std::getline(file, line);
+   if (line.compare(0, 5, "step,") != 0)
+   {
+      std::cout << "Error - MetricsSink::read - " << filePath << " isn't a metrics file" << "\n";
+      return false;
+   }
+
+   while (std::getline(file, line))
+   {
+      if (line.empty())
+      {
+         continue;
+      }
+
+      std::vector<std::string> fields;
+      std::stringstream        stream(line);
+      std::string              field;
+      while (std::getline(stream, field, ','))
+      {
+         fields.push_back(field);
+      }
+
+      if (fields.size() != 15)
+      {
+         std::cout << "Error - MetricsSink::read - " << filePath << " has a line with " << fields.size() << " fields instead of 15" << "\n";
+         return false;
+      }
+
+      StepMetrics metrics;
+      metrics.stepIndex           = std::strtoull(fields[0].c_str(), nullptr, 10);
+      metrics.stepDurationInNs    = std::strtoll(fields[1].c_str(), nullptr, 10);
+      metrics.simulatedTime       = std::strtof(fields[2].c_str(), nullptr);
+      metrics.kineticEnergy       = std::strtof(fields[3].c_str(), nullptr);
+      metrics.linearMomentumX     = std::strtof(fields[4].c_str(), nullptr);
+      metrics.linearMomentumY     = std::strtof(fields[5].c_str(), nullptr);
+      metrics.angularMomentum     = std::strtof(fields[6].c_str(), nullptr);
+      metrics.numBodyWallContacts = static_cast<std::uint32_t>(std::strtoul(fields[7].c_str(), nullptr, 10));
+      metrics.numBodyBodyContacts = static_cast<std::uint32_t>(std::strtoul(fields[8].c_str(), nullptr, 10));
+      metrics.numSolverIterations = static_cast<std::uint32_t>(std::strtoul(fields[9].c_str(), nullptr, 10));
+      metrics.numSubsteps         = static_cast<std::uint32_t>(std::strtoul(fields[10].c_str(), nullptr, 10));
+      metrics.numSubdivisions     = static_cast<std::uint32_t>(std::strtoul(fields[11].c_str(), nullptr, 10));
+      metrics.numRejectedSteps    = static_cast<std::uint32_t>(std::strtoul(fields[12].c_str(), nullptr, 10));
+      metrics.errorCode           = static_cast<std::int32_t>(std::strtol(fields[13].c_str(), nullptr, 10));
+      metrics.stateHash           = std::strtoull(fields[14].c_str(), nullptr, 16);
+      records.push_back(metrics);
+   }
+
+   return true;
+}
+
+bool MetricsSink::open(const std::string& filePath, Format format)
+{
+   if (isOpen())
+   {
+      std::cout << "Error - MetricsSink::open - The sink is already open" << "\n";
+      return false;
+   }
+
+   mFormat = format;
+   mFile.open(filePath, (format == Format::binary) ? (std::ios::out | std::ios::binary) : std::ios::out);
+   if (!mFile)
+   {
+      std::cout << "Error - MetricsSink::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   if (mFormat == Format::binary)
+   {
+      const char    magic[8]   = {'D', 'K', 'M', 'E', 'T', 'R', 'I', 'C'};
+      std::uint32_t version    = 4;
+      std::uint32_t recordSize = sizeof(StepMetrics);
+
+      mFile.write(magic, sizeof(magic));
+      mFile.write(reinterpret_cast<const char*>(&version), sizeof(version));
+      mFile.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+   }
+   else
+   {
+      mFile << "step,step_duration_ns,simulated_time,kinetic_energy,linear_momentum_x,linear_momentum_y,angular_momentum,"
+            << "body_wall_contacts,body_body_contacts,solver_iterations,substeps,subdivisions,rejected_steps,error_code,state_hash\n";
+   }
+
+   mWriteIndex.store(0, std::memory_order_relaxed);
+   mReadIndex.store(0, std::memory_order_relaxed);
+   mNumWrittenRecords.store(0, std::memory_order_relaxed);
+   mNumDroppedRecords.store(0, std::memory_order_relaxed);
+   mStopWriter.store(false, std::memory_order_relaxed);
+
+   mWriterThread = std::thread(&MetricsSink::runWriter, this);
+
+   return true;
+}
+
+void MetricsSink::close()
+{
+   if (!isOpen())
+   {
+      return;
+   }
+
+   mStopWriter.store(true, std::memory_order_release);
+   mWriterThread.join();
+
+   mFile.close();
+}
+
+bool MetricsSink::isOpen() const
+{
+   return mWriterThread.joinable();
+}
+
+bool MetricsSink::push(const StepMetrics& metrics)
+{
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+   std::uint64_t readIndex  = mReadIndex.load(std::memory_order_acquire);
+
+   if ((writeIndex - readIndex) > mMask)
+   {
+      // The ring buffer is full
+      mNumDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+      return false;
+   }
+
+   mRecords[writeIndex & mMask] = metrics;
+   mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+
+   return true;
+}
+
+std::uint64_t MetricsSink::getNumWrittenRecords() const
+{
+   return mNumWrittenRecords.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MetricsSink::getNumDroppedRecords() const
+{
+   return mNumDroppedRecords.load(std::memory_order_relaxed);
+}
+
+void MetricsSink::runWriter()
+{
+   while (!mStopWriter.load(std::memory_order_acquire))
+   {
+      if (writeAvailableRecords() == 0)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+   }
+
+   // Write the records that were pushed before the sink was closed
+   writeAvailableRecords();
+   mFile.flush();
+}
+
+std::size_t MetricsSink::writeAvailableRecords()
+{
+   std::uint64_t readIndex  = mReadIndex.load(std::memory_order_relaxed);
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+
+   for (std::uint64_t index = readIndex; index < writeIndex; ++index)
+   {
+      writeRecord(mRecords[index & mMask]);
+   }
+
+   // Give the slots back to the producer
+   mReadIndex.store(writeIndex, std::memory_order_release);
+   mNumWrittenRecords.fetch_add(writeIndex - readIndex, std::memory_order_relaxed);
+
+   return static_cast<std::size_t>(writeIndex - readIndex);
+}
+
+void MetricsSink::writeRecord(const StepMetrics& metrics)
+{
+   if (mFormat == Format::binary)
+   {
+      mFile.write(reinterpret_cast<const char*>(&metrics), sizeof(StepMetrics));
+   }
+   else
+   {
+      mFile << metrics.stepIndex           << ","
+            << metrics.stepDurationInNs    << ","
+            << metrics.simulatedTime       << ","
+            << metrics.kineticEnergy       << ","
+            << metrics.linearMomentumX     << ","
+            << metrics.linearMomentumY     << ","
+            << metrics.angularMomentum     << ","
+            << metrics.numBodyWallContacts << ","
+            << metrics.numBodyBodyContacts << ","
+            << metrics.numSolverIterations << ","
+            << metrics.numSubsteps         << ","
+            << metrics.numSubdivisions     << ","
+            << metrics.numRejectedSteps    << ","
+            << metrics.errorCode           << ","
+            << std::hex << std::setw(16) << std::setfill('0') << metrics.stateHash << std::dec << std::setfill(' ') << "\n";
+   }
+}
@@ -0,0 +1,110 @@
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+
+#include "performance_graph.h"
+
+PerformanceGraph::PerformanceGraph(const QString& title,
+                                   const QString& unit,
+                                   const QColor&  color,
+                                   int            maxNumSamples,
+                                   QWidget*       parent)
+   : QWidget(parent)
+   , mTitle(title)
+   , mUnit(unit)
+   , mColor(color)
+   , mMaxNumSamples(maxNumSamples)
+   , mSamples()
+{
+   setMinimumSize(200, 90);
+}
+
+void PerformanceGraph::addSample(double value)
+{
+   mSamples.push_back(value);
+   if (static_cast<int>(mSamples.size()) > mMaxNumSamples)
+   {
+      mSamples.pop_front();
+   }
+
+   update();
+}
+
+void PerformanceGraph::clear()
+{
+   mSamples.clear();
+   update();
+}
+
+QSize PerformanceGraph::sizeHint() const
+{
+   return QSize(280, 110);
+}
+
+void PerformanceGraph::paintEvent(QPaintEvent* /*event*/)
+{
+   QPainter painter(this);
+   painter.setRenderHint(QPainter::Antialiasing);
+
+   painter.fillRect(rect(), QColor(42, 42, 42));
+   painter.setPen(QColor(80, 80, 80));
+   painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+   double latestValue  = mSamples.empty() ? 0.0 : mSamples.back();
+   double largestValue = mSamples.empty() ? 0.0 : *std::max_element(mSamples.begin(), mSamples.end());
+
+   // Title, latest value and largest value
+   QFontMetrics fontMetrics = painter.fontMetrics();
+   int          textHeight  = fontMetrics.height();
+
+   painter.setPen(Qt::white);
+   painter.drawText(QRect(6, 2, width() - 12, textHeight), Qt::AlignLeft | Qt::AlignVCenter, mTitle);
+
+   painter.setPen(mColor);
+   painter.drawText(QRect(6, 2, width() - 12, textHeight), Qt::AlignRight | Qt::AlignVCenter,
+                    QString::number(latestValue, 'f', 2) + " " + mUnit);
+
+   painter.setPen(QColor(127, 127, 127));
+   painter.drawText(QRect(6, 2 + textHeight, width() - 12, textHeight), Qt::AlignRight | Qt::AlignVCenter,
+                    "max " + QString::number(largestValue, 'f', 2));
+
+   if (mSamples.size() < 2)
+   {
+      return;
+   }
+
+   QRectF plotArea(6.0, 4.0 + (2.0 * textHeight), width() - 12.0, height() - 10.0 - (2.0 * textHeight));
+   if ((plotArea.width() <= 0.0) || (plotArea.height() <= 0.0))
+   {
+      return;
+   }
+
+   // Leave some headroom above the largest sample
+   double verticalScale   = (largestValue > 0.0) ? (plotArea.height() / (1.1 * largestValue)) : 0.0;
+   double horizontalScale = plotArea.width() / (mMaxNumSamples - 1);
+
+   // The newest sample is always on the right edge
+   double       x = plotArea.right() - ((mSamples.size() - 1) * horizontalScale);
+   QPainterPath path;
+   for (std::deque<double>::const_iterator iter = mSamples.begin(); iter != mSamples.end(); ++iter)
+   {
+      QPointF point(x, plotArea.bottom() - (*iter * verticalScale));
+      if (iter == mSamples.begin())
+      {
+         path.moveTo(point);
+      }
+      else
+      {
+         path.lineTo(point);
+      }
+
+      x += horizontalScale;
+   }
+
+   painter.setPen(QColor(66, 66, 66));
+   painter.drawLine(plotArea.bottomLeft(), plotArea.bottomRight());
+
+   painter.setPen(QPen(mColor, 1.5));
+   painter.drawPath(path);
+}
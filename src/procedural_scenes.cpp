@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "procedural_scenes.h"
+
+namespace
+{
+   const float pi = 3.14159265f;
+
+   // The space that is left between bodies, and between bodies and walls
+   const float margin = 1.0f;
+
+   const glm::vec3 palette[] = {glm::vec3(1.0f, 1.0f,  0.0f),  // Yellow
+                                glm::vec3(1.0f, 0.65f, 0.0f),  // Orange
+                                glm::vec3(0.0f, 1.0f,  0.0f),  // Green
+                                glm::vec3(0.0f, 1.0f,  1.0f),  // Cyan
+                                glm::vec3(1.0f, 0.0f,  1.0f),  // Magenta
+                                glm::vec3(1.0f, 1.0f,  1.0f)}; // White
+
+   glm::vec3 generateColor(std::mt19937& generator)
+   {
+      return palette[generator() % (sizeof(palette) / sizeof(palette[0]))];
+   }
+
+   // The corners must be given in clockwise order, so that the normals point inwards
+   std::vector<Wall> createPolygonWalls(const std::vector<glm::vec2>& corners)
+   {
+      std::vector<Wall> walls;
+      walls.reserve(corners.size());
+      for (std::size_t i = 0; i < corners.size(); ++i)
+      {
+         glm::vec2 startPoint = corners[i];
+         glm::vec2 endPoint   = corners[(i + 1) % corners.size()];
+         glm::vec2 deltas     = endPoint - startPoint;
+         walls.push_back(Wall(glm::vec2(deltas.y, -deltas.x), startPoint, endPoint));
+      }
+
+      return walls;
+   }
+
+   std::vector<glm::vec2> createBoxCorners(float left, float right, float bottom, float top)
+   {
+      return {glm::vec2(left, top), glm::vec2(right, top), glm::vec2(right, bottom), glm::vec2(left, bottom)};
+   }
+
+   bool circleIsInsideWalls(const std::vector<Wall>& walls, glm::vec2 center, float radius)
+   {
+      for (const Wall& wall : walls)
+      {
+         if ((glm::dot(center, wall.getNormal()) + wall.getC()) < radius)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // The order of std::shuffle is unspecified, so this is a Fisher-Yates shuffle that only uses the raw output of the generator
+   void shuffle(std::vector<glm::vec2>& items, std::mt19937& generator)
+   {
+      for (std::size_t i = items.size(); i > 1; --i)
+      {
+         std::swap(items[i - 1], items[generator() % i]);
+      }
+   }
+
+   struct BodyRanges
+   {
+      float minSize;
+      float maxSize;
+      float maxSpeed;
+      float maxAngularSpeed;
+      float coefficientOfRestitution;
+   };
+
+   struct Arena
+   {
+      std::vector<glm::vec2> corners;
+      float                  minCellY; // Cells below this height aren't used
+      int                    gravityState;
+   };
+
+   // Every rectangle fits inside the inscribed circle of a cell, so rectangles in different cells can't overlap whatever their orientations
+   float calculateCellSize(const BodyRanges& ranges)
+   {
+      return (std::sqrt(2.0f) * ranges.maxSize) + (2.0f * margin);
+   }
+
+   // Finds the centers of the cells of a grid whose inscribed circles are inside the arena, from the top row to the bottom row
+   std::vector<glm::vec2> findCellCenters(const Arena& arena, const std::vector<Wall>& walls, float cellSize)
+   {
+      glm::vec2 minCorner = arena.corners[0];
+      glm::vec2 maxCorner = arena.corners[0];
+      for (const glm::vec2& corner : arena.corners)
+      {
+         minCorner = glm::min(minCorner, corner);
+         maxCorner = glm::max(maxCorner, corner);
+      }
+
+      std::vector<glm::vec2> cellCenters;
+      int numColumns = static_cast<int>((maxCorner.x - minCorner.x) / cellSize);
+      int numRows    = static_cast<int>((maxCorner.y - minCorner.y) / cellSize);
+      for (int row = numRows - 1; row >= 0; --row)
+      {
+         for (int column = 0; column < numColumns; ++column)
+         {
+            glm::vec2 center = minCorner + (glm::vec2(column + 0.5f, row + 0.5f) * cellSize);
+            if ((center.y - (0.5f * cellSize) >= arena.minCellY) && circleIsInsideWalls(walls, center, 0.5f * cellSize))
+            {
+               cellCenters.push_back(center);
+            }
+         }
+      }
+
+      return cellCenters;
+   }
+
+   RigidBody2D generateBodyInCell(glm::vec2 cellCenter, float cellSize, const BodyRanges& ranges, std::mt19937& generator)
+   {
+      // The random numbers are drawn one statement at a time, because the order in which function arguments are evaluated is unspecified
+      float     width           = generateRandomFloat(generator, ranges.minSize, ranges.maxSize);
+      float     height          = generateRandomFloat(generator, ranges.minSize, ranges.maxSize);
+      float     orientation     = generateRandomFloat(generator, 0.0f, 2.0f * pi);
+      float     direction       = generateRandomFloat(generator, 0.0f, 2.0f * pi);
+      float     speed           = generateRandomFloat(generator, 0.0f, ranges.maxSpeed);
+      float     angularVelocity = generateRandomFloat(generator, -ranges.maxAngularSpeed, ranges.maxAngularSpeed);
+      glm::vec3 color           = generateColor(generator);
+
+      // The body can move around its cell as long as its bounding circle stays inside the inscribed circle of the cell
+      float     radius          = 0.5f * std::sqrt((width * width) + (height * height));
+      float     slack           = std::max((0.5f * cellSize) - margin - radius, 0.0f) / std::sqrt(2.0f);
+      float     offsetX         = generateRandomFloat(generator, -slack, slack);
+      float     offsetY         = generateRandomFloat(generator, -slack, slack);
+      glm::vec2 velocity        = speed * glm::vec2(std::cos(direction), std::sin(direction));
+
+      return RigidBody2D(10.0f, width, height, ranges.coefficientOfRestitution, cellCenter + glm::vec2(offsetX, offsetY), orientation, velocity, angularVelocity, color);
+   }
+
+   // Grows the arena until it has enough cells for the bodies, and then puts the bodies in randomly chosen cells or in the top cells
+   template<typename TCreateArena>
+   Scene generateBodiesInArena(int numBodies, const BodyRanges& ranges, bool fillFromTop, TCreateArena createArena, std::mt19937& generator)
+   {
+      float cellSize = calculateCellSize(ranges);
+      float scale    = 0.5f * cellSize * std::sqrt(static_cast<float>(std::max(numBodies, 1)));
+
+      Arena                  arena;
+      std::vector<Wall>      walls;
+      std::vector<glm::vec2> cellCenters;
+      while (true)
+      {
+         arena       = createArena(scale);
+         walls       = createPolygonWalls(arena.corners);
+         cellCenters = findCellCenters(arena, walls, cellSize);
+         if (cellCenters.size() >= static_cast<std::size_t>(numBodies))
+         {
+            break;
+         }
+
+         scale *= 1.1f;
+      }
+
+      if (!fillFromTop)
+      {
+         shuffle(cellCenters, generator);
+      }
+
+      Scene scene;
+      scene.gravityState = arena.gravityState;
+      scene.rigidBodies.reserve(numBodies);
+      for (int i = 0; i < numBodies; ++i)
+      {
+         scene.rigidBodies.push_back(generateBodyInCell(cellCenters[i], cellSize, ranges, generator));
+      }
+
+      glm::vec2 extent(0.0f);
+      for (const glm::vec2& corner : arena.corners)
+      {
+         extent = glm::max(extent, glm::abs(corner));
+      }
+
+      scene.dimensions = (2.0f * extent) + glm::vec2(50.0f);
+      scene.walls      = std::move(walls);
+      return scene;
+   }
+
+   // The rows of bricks stand on the floor of a box, and each row holds the number of bricks that its function returns
+   template<typename TBricksInRow>
+   Scene generateBrickRows(int numBodies, float brickWidth, float brickHeight, int maxBricksInRow, TBricksInRow bricksInRow, std::mt19937& generator)
+   {
+      // The rows start apart like the bricks of the Stack scene, so that each row settles before the next one lands on it
+      const float rowGap    = 10.0f;
+      const float pitch     = brickWidth + margin;
+      const float rowHeight = brickHeight + rowGap;
+
+      int numRows   = 0;
+      int numBricks = 0;
+      while (numBricks < numBodies)
+      {
+         numBricks += bricksInRow(numRows);
+         ++numRows;
+      }
+
+      float halfWidth  = (0.5f * (maxBricksInRow + 1) * pitch) + 40.0f;
+      float halfHeight = (0.5f * numRows * rowHeight) + 60.0f;
+
+      Scene scene;
+      scene.gravityState = 1;
+      scene.walls        = createPolygonWalls(createBoxCorners(-halfWidth, halfWidth, -halfHeight, halfHeight));
+      scene.dimensions   = glm::vec2(2.0f * halfWidth, 2.0f * halfHeight) + glm::vec2(50.0f);
+      scene.rigidBodies.reserve(numBodies);
+
+      for (int row = 0; (row < numRows) && (static_cast<int>(scene.rigidBodies.size()) < numBodies); ++row)
+      {
+         int   numBricksInRow = bricksInRow(row);
+         float y              = -halfHeight + rowGap + (0.5f * brickHeight) + (row * rowHeight);
+         float firstX         = -0.5f * (numBricksInRow - 1) * pitch;
+
+         // The rows of a wall are offset by half a brick, like in a running bond
+         if ((numBricksInRow == maxBricksInRow) && (row % 2 == 1))
+         {
+            firstX += 0.5f * pitch;
+         }
+
+         for (int i = 0; (i < numBricksInRow) && (static_cast<int>(scene.rigidBodies.size()) < numBodies); ++i)
+         {
+            glm::vec3 color = generateColor(generator);
+            scene.rigidBodies.push_back(RigidBody2D(1.0f, brickWidth, brickHeight, 0.1f, glm::vec2(firstX + (i * pitch), y), 0.0f, glm::vec2(0.0f), 0.0f, color));
+         }
+      }
+
+      return scene;
+   }
+}
+
+float generateRandomFloat(std::mt19937& generator, float min, float max)
+{
+   return min + ((max - min) * (static_cast<float>(generator() >> 8) * (1.0f / 16777216.0f)));
+}
+
+const char* getProceduralSceneName(ProceduralSceneType type)
+{
+   switch (type)
+   {
+   case ProceduralSceneType::rectangleSoup: return "Rectangle Soup";
+   case ProceduralSceneType::brickWall:     return "Brick Wall";
+   case ProceduralSceneType::pyramid:       return "Pyramid";
+   case ProceduralSceneType::funnel:        return "Funnel";
+   case ProceduralSceneType::polygonArena:  return "Polygon Arena";
+   default:                                 return "Unknown";
+   }
+}
+
+const char* getProceduralSceneIdentifier(ProceduralSceneType type)
+{
+   switch (type)
+   {
+   case ProceduralSceneType::rectangleSoup: return "rectangle_soup";
+   case ProceduralSceneType::brickWall:     return "brick_wall";
+   case ProceduralSceneType::pyramid:       return "pyramid";
+   case ProceduralSceneType::funnel:        return "funnel";
+   case ProceduralSceneType::polygonArena:  return "polygon_arena";
+   default:                                 return "unknown";
+   }
+}
+
+bool findProceduralSceneType(const std::string& identifier, ProceduralSceneType& type)
+{
+   for (unsigned int i = 0; i < static_cast<unsigned int>(ProceduralSceneType::numTypes); ++i)
+   {
+      if (identifier == getProceduralSceneIdentifier(static_cast<ProceduralSceneType>(i)))
+      {
+         type = static_cast<ProceduralSceneType>(i);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+Scene generateProceduralScene(ProceduralSceneType type, int numBodies, std::uint32_t seed)
+{
+   std::mt19937 generator(seed);
+
+   Scene scene;
+   switch (type)
+   {
+   case ProceduralSceneType::rectangleSoup:
+   {
+      BodyRanges ranges = {8.0f, 24.0f, 80.0f, 1.0f, 1.0f};
+      scene = generateBodiesInArena(numBodies, ranges, false, [](float scale)
+      {
+         Arena arena;
+         arena.corners      = createBoxCorners(-scale, scale, -scale, scale);
+         arena.minCellY     = -scale;
+         arena.gravityState = 0;
+         return arena;
+      }, generator);
+      break;
+   }
+   case ProceduralSceneType::brickWall:
+   {
+      // A wall of bricks that are twice as wide as they are tall is about as wide as it is tall with this many bricks per row
+      int bricksPerRow = std::max(static_cast<int>(std::round(std::sqrt(0.5f * numBodies))), 1);
+      scene = generateBrickRows(numBodies, 40.0f, 20.0f, bricksPerRow, [bricksPerRow](int)
+      {
+         return bricksPerRow;
+      }, generator);
+      break;
+   }
+   case ProceduralSceneType::pyramid:
+   {
+      int bricksInBottomRow = 1;
+      while ((bricksInBottomRow * (bricksInBottomRow + 1)) / 2 < numBodies)
+      {
+         ++bricksInBottomRow;
+      }
+
+      scene = generateBrickRows(numBodies, 40.0f, 20.0f, bricksInBottomRow, [bricksInBottomRow](int row)
+      {
+         return std::max(bricksInBottomRow - row, 1);
+      }, generator);
+      break;
+   }
+   case ProceduralSceneType::funnel:
+   {
+      BodyRanges ranges = {8.0f, 16.0f, 5.0f, 0.5f, 0.5f};
+      scene = generateBodiesInArena(numBodies, ranges, true, [](float scale)
+      {
+         // The bodies start above the shoulders, and fall through the sloped walls into the narrow bottom
+         Arena arena;
+         arena.corners      = {glm::vec2(-scale,          1.5f * scale), glm::vec2(scale,          1.5f * scale),
+                               glm::vec2( scale,         -0.25f * scale), glm::vec2(0.15f * scale, -1.5f * scale),
+                               glm::vec2(-0.15f * scale, -1.5f * scale),  glm::vec2(-scale,        -0.25f * scale)};
+         arena.minCellY     = -0.25f * scale;
+         arena.gravityState = 1;
+         return arena;
+      }, generator);
+      break;
+   }
+   case ProceduralSceneType::polygonArena:
+   {
+      BodyRanges ranges   = {8.0f, 20.0f, 60.0f, 1.0f, 1.0f};
+      int        numSides = 5 + static_cast<int>(generator() % 8);
+      scene = generateBodiesInArena(numBodies, ranges, false, [numSides](float scale)
+      {
+         // The corners go clockwise from the top
+         Arena arena;
+         for (int i = 0; i < numSides; ++i)
+         {
+            float angle = (0.5f * pi) - ((2.0f * pi * i) / numSides);
+            arena.corners.push_back(1.2f * scale * glm::vec2(std::cos(angle), std::sin(angle)));
+         }
+         arena.minCellY     = -2.0f * scale;
+         arena.gravityState = 0;
+         return arena;
+      }, generator);
+      break;
+   }
+   default:
+      break;
+   }
+
+   scene.name = getProceduralSceneName(type);
+   return scene;
+}
@@ -0,0 +1,226 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "profiler.h"
+
+std::atomic<bool> Profiler::sEnabled(false);
+
+namespace
+{
+   struct ZoneEvent
+   {
+      const char*  name;
+      std::int64_t startInNs;
+      std::int64_t durationInNs;
+   };
+
+   // Only the thread that owns a buffer writes to it
+   // The number of written events is atomic so that an exporting thread can see the events that were completely written
+   struct ThreadBuffer
+   {
+      static const std::size_t capacity = 1 << 16;
+
+      explicit ThreadBuffer(int threadID)
+         : threadID(threadID)
+         , name("Thread " + std::to_string(threadID))
+         , events(capacity)
+         , numWrittenEvents(0)
+         , isInUse(true)
+      {
+
+      }
+
+      int                        threadID;
+      std::string                name;
+      std::vector<ZoneEvent>     events;
+      std::atomic<std::uint64_t> numWrittenEvents;
+      bool                       isInUse; // Guarded by the mutex of the registry
+   };
+
+   // The buffers are owned by the registry instead of by their threads, so that the zones of threads that have finished can still be exported
+   // When a thread exits its buffer is handed to the next thread that records a zone, so that threads that are started over and over, like the encoders of each recording, don't add a buffer each
+   // The new thread continues the ring buffer under the same thread ID, so the zones of the thread that exited can still be exported until they're overwritten
+   struct ThreadBufferRegistry
+   {
+      std::mutex                                 mutex;
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+   };
+
+   ThreadBufferRegistry& getRegistry()
+   {
+      static ThreadBufferRegistry registry;
+      return registry;
+   }
+
+   // Gives the buffer of a thread back to the registry when the thread exits
+   class ThreadBufferOwner
+   {
+   public:
+
+      ThreadBufferOwner()
+         : buffer(nullptr)
+      {
+
+      }
+
+      ~ThreadBufferOwner()
+      {
+         if (buffer != nullptr)
+         {
+            std::lock_guard<std::mutex> guard(getRegistry().mutex);
+            buffer->isInUse = false;
+         }
+      }
+
+      ThreadBufferOwner(const ThreadBufferOwner&) = delete;
+      ThreadBufferOwner& operator=(const ThreadBufferOwner&) = delete;
+
+      ThreadBuffer* buffer;
+   };
+
+   ThreadBuffer& getThreadBuffer()
+   {
+      thread_local ThreadBufferOwner owner;
+
+      if (owner.buffer == nullptr)
+      {
+         ThreadBufferRegistry&       registry = getRegistry();
+         std::lock_guard<std::mutex> guard(registry.mutex);
+
+         for (const std::shared_ptr<ThreadBuffer>& threadBuffer : registry.buffers)
+         {
+            if (!threadBuffer->isInUse)
+            {
+               threadBuffer->isInUse = true;
+               threadBuffer->name    = "Thread " + std::to_string(threadBuffer->threadID);
+               owner.buffer          = threadBuffer.get();
+               break;
+            }
+         }
+
+         if (owner.buffer == nullptr)
+         {
+            registry.buffers.push_back(std::make_shared<ThreadBuffer>(static_cast<int>(registry.buffers.size())));
+            owner.buffer = registry.buffers.back().get();
+         }
+      }
+
+      return *owner.buffer;
+   }
+
+   const std::chrono::steady_clock::time_point& getEpoch()
+   {
+      static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+      return epoch;
+   }
+
+   void writeEscapedString(std::ostream& stream, const std::string& text)
+   {
+      stream << '"';
+      for (char character : text)
+      {
+         if ((character == '"') || (character == '\\'))
+         {
+            stream << '\\';
+         }
+
+         stream << character;
+      }
+      stream << '"';
+   }
+}
+
+void Profiler::enable(bool enable)
+{
+   // Make sure that the epoch is set before the first timestamp is taken
+   getEpoch();
+
+   sEnabled.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+   ThreadBuffer&               threadBuffer = getThreadBuffer();
+   std::lock_guard<std::mutex> guard(getRegistry().mutex);
+   threadBuffer.name = name;
+}
+
+void Profiler::recordZone(const char* name, std::int64_t startInNs, std::int64_t endInNs)
+{
+   ThreadBuffer& threadBuffer = getThreadBuffer();
+
+   // When the buffer is full we overwrite the oldest events
+   std::uint64_t numWrittenEvents = threadBuffer.numWrittenEvents.load(std::memory_order_relaxed);
+   ZoneEvent&    event            = threadBuffer.events[numWrittenEvents % ThreadBuffer::capacity];
+
+   event.name         = name;
+   event.startInNs    = startInNs;
+   event.durationInNs = endInNs - startInNs;
+
+   threadBuffer.numWrittenEvents.store(numWrittenEvents + 1, std::memory_order_release);
+}
+
+bool Profiler::exportChromeTrace(const std::string& filePath)
+{
+   std::ofstream traceFile(filePath);
+   if (!traceFile)
+   {
+      std::cout << "Error - Profiler::exportChromeTrace - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   ThreadBufferRegistry&       registry = getRegistry();
+   std::lock_guard<std::mutex> guard(registry.mutex);
+
+   traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+   bool firstEvent = true;
+   for (const std::shared_ptr<ThreadBuffer>& threadBuffer : registry.buffers)
+   {
+      // Name the thread
+      traceFile << (firstEvent ? "\n" : ",\n");
+      traceFile << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << threadBuffer->threadID << ",\"args\":{\"name\":";
+      writeEscapedString(traceFile, threadBuffer->name);
+      traceFile << "}}";
+      firstEvent = false;
+
+      std::uint64_t numWrittenEvents = threadBuffer->numWrittenEvents.load(std::memory_order_acquire);
+      std::uint64_t firstEventIndex  = (numWrittenEvents > ThreadBuffer::capacity) ? (numWrittenEvents - ThreadBuffer::capacity) : 0;
+
+      for (std::uint64_t eventIndex = firstEventIndex; eventIndex < numWrittenEvents; ++eventIndex)
+      {
+         const ZoneEvent& event = threadBuffer->events[eventIndex % ThreadBuffer::capacity];
+
+         // Chrome expects timestamps and durations in microseconds
+         traceFile << ",\n{\"ph\":\"X\",\"name\":";
+         writeEscapedString(traceFile, event.name);
+         traceFile << ",\"pid\":1,\"tid\":" << threadBuffer->threadID
+                   << ",\"ts\":"  << (event.startInNs / 1000) << "." << (event.startInNs % 1000 / 100)
+                   << ",\"dur\":" << (event.durationInNs / 1000) << "." << (event.durationInNs % 1000 / 100) << "}";
+      }
+   }
+
+   traceFile << "\n]}\n";
+
+   return static_cast<bool>(traceFile);
+}
+
+void Profiler::clear()
+{
+   ThreadBufferRegistry&       registry = getRegistry();
+   std::lock_guard<std::mutex> guard(registry.mutex);
+
+   for (const std::shared_ptr<ThreadBuffer>& threadBuffer : registry.buffers)
+   {
+      threadBuffer->numWrittenEvents.store(0, std::memory_order_relaxed);
+   }
+}
+
+std::int64_t Profiler::getTimestampInNs()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getEpoch()).count();
+}
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <iostream>
+
+#include "raw_video_sink.h"
+#include "profiler.h"
+
+namespace
+{
+   // The buffer is written once it holds at least this many bytes, which is a few frames at the usual sizes of the window
+   const std::size_t bufferSizeInBytes = 8 * 1024 * 1024;
+
+   // BT.601 with the video range, which is what YUV4MPEG2 readers assume when the stream doesn't say otherwise
+   unsigned char calculateLuma(int r, int g, int b)
+   {
+      return static_cast<unsigned char>((((66 * r) + (129 * g) + (25 * b) + 128) >> 8) + 16);
+   }
+
+   unsigned char calculateBlueDifference(int r, int g, int b)
+   {
+      return static_cast<unsigned char>((((-38 * r) - (74 * g) + (112 * b) + 128) >> 8) + 128);
+   }
+
+   unsigned char calculateRedDifference(int r, int g, int b)
+   {
+      return static_cast<unsigned char>((((112 * r) - (94 * g) - (18 * b) + 128) >> 8) + 128);
+   }
+}
+
+RawVideoSink::Format RawVideoSink::getFormatOfFile(const std::string& filePath)
+{
+   const std::string y4mExtension = ".y4m";
+
+   if ((filePath.size() >= y4mExtension.size()) &&
+       (filePath.compare(filePath.size() - y4mExtension.size(), y4mExtension.size(), y4mExtension) == 0))
+   {
+      return Format::y4m;
+   }
+
+   return Format::rgb;
+}
+
+RawVideoSink::RawVideoSink(const std::string& filePath, Format format, unsigned int framesPerSecond)
+   : mFilePath(filePath)
+   , mFormat(format)
+   , mFramesPerSecond(framesPerSecond)
+   , mQueuedFrames()
+   , mNumRetiredFrames(0)
+   , mNumTakenFrames(0)
+   , mStopWriter(false)
+   , mMutex()
+   , mWorkCondition()
+   , mFrameReadCondition()
+   , mFile()
+   , mBuffer()
+   , mWriteFailed(false)
+   , mNumWrittenFrames(0)
+   , mNumWrittenBytes(0)
+   , mNumStalls(0)
+   , mWriterThread()
+{
+   mWriterThread = std::thread(&RawVideoSink::runWriter, this);
+}
+
+RawVideoSink::~RawVideoSink()
+{
+   close();
+}
+
+unsigned int RawVideoSink::getNumThreads() const
+{
+   return 1;
+}
+
+bool RawVideoSink::close()
+{
+   PROFILE_ZONE("RawVideoSink::close");
+
+   if (!mWriterThread.joinable())
+   {
+      return !mWriteFailed;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(mMutex);
+      mStopWriter = true;
+   }
+
+   mWorkCondition.notify_all();
+
+   // The writer converts the frames that are still queued before it stops
+   mWriterThread.join();
+
+   if (mFile.is_open())
+   {
+      flushBuffer();
+      mFile.close();
+   }
+
+   return !mWriteFailed;
+}
+
+void RawVideoSink::push(const Frame& frame)
+{
+   {
+      std::lock_guard<std::mutex> guard(mMutex);
+      mQueuedFrames.push_back(QueuedFrame{frame, false});
+   }
+
+   mWorkCondition.notify_one();
+}
+
+bool RawVideoSink::hasFramesToRetire() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return !mQueuedFrames.empty();
+}
+
+bool RawVideoSink::oldestFrameIsRead() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return !mQueuedFrames.empty() && mQueuedFrames.front().isRead;
+}
+
+void RawVideoSink::retireOldestFrame()
+{
+   PROFILE_ZONE("RawVideoSink::retireOldestFrame");
+
+   std::unique_lock<std::mutex> lock(mMutex);
+
+   if (mQueuedFrames.empty())
+   {
+      return;
+   }
+
+   if (!mQueuedFrames.front().isRead)
+   {
+      mNumStalls.fetch_add(1, std::memory_order_relaxed);
+      mFrameReadCondition.wait(lock, [this]() { return mQueuedFrames.front().isRead; });
+   }
+
+   mQueuedFrames.pop_front();
+   mNumRetiredFrames++;
+}
+
+std::uint64_t RawVideoSink::getNumWrittenFrames() const
+{
+   return mNumWrittenFrames.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RawVideoSink::getNumWrittenBytes() const
+{
+   return mNumWrittenBytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RawVideoSink::getNumStalls() const
+{
+   return mNumStalls.load(std::memory_order_relaxed);
+}
+
+void RawVideoSink::runWriter()
+{
+   std::unique_lock<std::mutex> lock(mMutex);
+
+   while (true)
+   {
+      mWorkCondition.wait(lock, [this]() { return (mNumTakenFrames < mNumRetiredFrames + mQueuedFrames.size()) || mStopWriter; });
+
+      if (mNumTakenFrames == mNumRetiredFrames + mQueuedFrames.size())
+      {
+         // There is nothing left to write and the writer was asked to stop
+         return;
+      }
+
+      // A frame can't be retired before it's read, so its position in the queue only changes by the number of frames that are retired in the meantime
+      std::uint64_t frameNumber = mNumTakenFrames++;
+      Frame         frame       = mQueuedFrames[frameNumber - mNumRetiredFrames].frame;
+
+      lock.unlock();
+
+      if ((frameNumber == 0) && !open(frame.width, frame.height))
+      {
+         mWriteFailed = true;
+      }
+
+      if (!mWriteFailed)
+      {
+         convertFrame(frame);
+      }
+
+      lock.lock();
+
+      mQueuedFrames[frameNumber - mNumRetiredFrames].isRead = true;
+      mFrameReadCondition.notify_all();
+
+      // The frame is already in the buffer, so the render thread can reuse its memory however long the output takes to write the buffer
+      if (!mWriteFailed && (mBuffer.size() >= bufferSizeInBytes))
+      {
+         lock.unlock();
+         flushBuffer();
+         lock.lock();
+      }
+   }
+}
+
+bool RawVideoSink::open(unsigned int width, unsigned int height)
+{
+   mFile.open(mFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+   if (!mFile)
+   {
+      std::cout << "Error - RawVideoSink::open - Failed to open " << mFilePath << "\n";
+      return false;
+   }
+
+   // The buffer is written after the frame that fills it, so it holds up to one frame more than its size
+   mBuffer.reserve(bufferSizeInBytes + (3 * static_cast<std::size_t>(width) * height) + 64);
+
+   if (mFormat == Format::y4m)
+   {
+      std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + std::to_string(mFramesPerSecond) + ":1 Ip A1:1 C444\n";
+      mBuffer.insert(mBuffer.end(), header.begin(), header.end());
+   }
+   else
+   {
+      std::cout << "Streaming " << width << "x" << height << " frames at " << mFramesPerSecond << " frames per second to " << mFilePath
+                << ", which ffmpeg can read with -f rawvideo -pixel_format rgb24 -video_size " << width << "x" << height << " -framerate " << mFramesPerSecond << " -i " << mFilePath << "\n";
+   }
+
+   return true;
+}
+
+void RawVideoSink::convertFrame(const Frame& frame)
+{
+   PROFILE_ZONE("RawVideoSink - Conversion");
+
+   const std::string frameHeader = "FRAME\n";
+   std::size_t       numPixels   = static_cast<std::size_t>(frame.width) * frame.height;
+   std::size_t       frameSize   = (3 * numPixels) + ((mFormat == Format::y4m) ? frameHeader.size() : 0);
+   std::size_t       bytesPerRow = 3 * static_cast<std::size_t>(frame.width);
+
+   std::size_t frameStart = mBuffer.size();
+   mBuffer.resize(frameStart + frameSize);
+   unsigned char* output = mBuffer.data() + frameStart;
+
+   if (mFormat == Format::y4m)
+   {
+      output = std::copy(frameHeader.begin(), frameHeader.end(), output);
+
+      // The three planes are written one after the other
+      unsigned char* lumaPlane           = output;
+      unsigned char* blueDifferencePlane = lumaPlane + numPixels;
+      unsigned char* redDifferencePlane  = blueDifferencePlane + numPixels;
+
+      for (unsigned int y = 0; y < frame.height; ++y)
+      {
+         unsigned int         sourceRow = frame.flipVertically ? (frame.height - 1 - y) : y;
+         const unsigned char* source    = frame.pixels + (sourceRow * bytesPerRow);
+         std::size_t          rowStart  = static_cast<std::size_t>(y) * frame.width;
+
+         for (unsigned int x = 0; x < frame.width; ++x)
+         {
+            int r = source[(3 * x) + 0];
+            int g = source[(3 * x) + 1];
+            int b = source[(3 * x) + 2];
+
+            lumaPlane[rowStart + x]           = calculateLuma(r, g, b);
+            blueDifferencePlane[rowStart + x] = calculateBlueDifference(r, g, b);
+            redDifferencePlane[rowStart + x]  = calculateRedDifference(r, g, b);
+         }
+      }
+   }
+   else
+   {
+      for (unsigned int y = 0; y < frame.height; ++y)
+      {
+         unsigned int         sourceRow = frame.flipVertically ? (frame.height - 1 - y) : y;
+         const unsigned char* source    = frame.pixels + (sourceRow * bytesPerRow);
+         std::copy(source, source + bytesPerRow, output + (y * bytesPerRow));
+      }
+   }
+
+   mNumWrittenFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RawVideoSink::flushBuffer()
+{
+   PROFILE_ZONE("RawVideoSink - Write");
+
+   if (mBuffer.empty())
+   {
+      return;
+   }
+
+   mFile.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+   if (!mFile)
+   {
+      std::cout << "Error - RawVideoSink::flushBuffer - Failed to write " << mFilePath << "\n";
+      mWriteFailed = true;
+   }
+
+   mNumWrittenBytes.fetch_add(mBuffer.size(), std::memory_order_relaxed);
+   mBuffer.clear();
+}
@@ -2,6 +2,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <array>
+#include <utility>
 
 #include "renderer_2D.h"
 
@@ -0,0 +1,278 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "replay_buffer.h"
+
+ReplayBuffer::ReplayBuffer(float durationInSeconds, std::size_t maxNumBytes, std::size_t capacity, std::uint32_t keyframeInterval, float positionQuantum)
+   : mDurationInSeconds(durationInSeconds)
+   , mMaxNumBytes(maxNumBytes)
+   , mSlots()
+   , mPoses()
+   , mMask(0)
+   , mNumBodies(0)
+   , mWriteIndex(0)
+   , mWriteIndexPadding()
+   , mReadIndex(0)
+   , mReadIndexPadding()
+   , mNumDroppedFrames(0)
+   , mNumEncodedFrames(0)
+   , mEncodingTimeInNanoseconds(0)
+   , mStopEncoder(false)
+   , mEncoderThread()
+   , mEncoder(keyframeInterval, positionQuantum)
+   , mEncodedFrame()
+   , mLastStepIndex(0)
+   , mMutex()
+   , mSegments()
+   , mNumFramesInSegments(0)
+   , mNumBytesInSegments(0)
+{
+   std::size_t roundedCapacity = 1;
+   while (roundedCapacity < capacity)
+   {
+      roundedCapacity *= 2;
+   }
+
+   mSlots.resize(roundedCapacity);
+   mMask = roundedCapacity - 1;
+
+   mEncoderThread = std::thread(&ReplayBuffer::runEncoder, this);
+}
+
+ReplayBuffer::~ReplayBuffer()
+{
+   mStopEncoder.store(true, std::memory_order_release);
+   mEncoderThread.join();
+}
+
+void ReplayBuffer::push(std::uint64_t stepIndex, float simulatedTime, const std::vector<RigidBody2D>& rigidBodies)
+{
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+   std::uint32_t numBodies  = static_cast<std::uint32_t>(rigidBodies.size());
+
+   if (numBodies != mNumBodies)
+   {
+      // The encoder reads the poses of every slot, so they can only be resized once it has encoded all of them
+      while (writeIndex != mReadIndex.load(std::memory_order_acquire))
+      {
+         std::this_thread::yield();
+      }
+
+      mNumBodies = numBodies;
+      mPoses.resize(mSlots.size() * numBodies);
+   }
+   else if ((writeIndex - mReadIndex.load(std::memory_order_acquire)) > mMask)
+   {
+      // The step index of the next frame won't follow the one of the last frame that was pushed, so it will be a keyframe
+      mNumDroppedFrames.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+
+   FrameSlot& slot    = mSlots[writeIndex & mMask];
+   slot.stepIndex     = stepIndex;
+   slot.simulatedTime = simulatedTime;
+   slot.numBodies     = numBodies;
+
+   TrajectoryPose* poses = mPoses.data() + ((writeIndex & mMask) * numBodies);
+   for (std::uint32_t i = 0; i < numBodies; ++i)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = rigidBodies[i].mStates[0];
+      poses[i].positionX   = currentState.positionOfCenterOfMass.x;
+      poses[i].positionY   = currentState.positionOfCenterOfMass.y;
+      poses[i].orientation = currentState.orientation;
+   }
+
+   mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+bool ReplayBuffer::save(const std::string& filePath)
+{
+   // The finished segments are never modified, but the encoder keeps appending to the last one, so that one is copied
+   std::deque<std::shared_ptr<Segment>> segments;
+   {
+      std::lock_guard<std::mutex> guard(mMutex);
+      segments = mSegments;
+      if (!segments.empty())
+      {
+         segments.back() = std::make_shared<Segment>(*segments.back());
+      }
+   }
+
+   if (segments.empty())
+   {
+      std::cout << "Error - ReplayBuffer::save - There are no frames to save" << "\n";
+      return false;
+   }
+
+   std::ofstream file(filePath, std::ios::out | std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - ReplayBuffer::save - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   TrajectoryFileHeader header;
+   header.keyframeInterval = mEncoder.getKeyframeInterval();
+   header.positionQuantum  = mEncoder.getPositionQuantum();
+   file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+   // Each segment starts with the only keyframe in it
+   std::vector<TrajectoryKeyframeEntry> keyframes;
+   keyframes.reserve(segments.size());
+
+   TrajectoryFileFooter footer;
+   footer.indexOffset = sizeof(header);
+   for (const std::shared_ptr<Segment>& segment : segments)
+   {
+      TrajectoryKeyframeEntry entry;
+      entry.frameIndex = footer.numFrames;
+      entry.fileOffset = footer.indexOffset;
+      keyframes.push_back(entry);
+
+      file.write(reinterpret_cast<const char*>(segment->bytes.data()), segment->bytes.size());
+
+      footer.numFrames   += segment->numFrames;
+      footer.indexOffset += segment->bytes.size();
+   }
+
+   footer.numKeyframes = keyframes.size();
+   file.write(reinterpret_cast<const char*>(keyframes.data()), keyframes.size() * sizeof(TrajectoryKeyframeEntry));
+   file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+
+   file.close();
+   if (!file)
+   {
+      std::cout << "Error - ReplayBuffer::save - Failed to write " << filePath << "\n";
+      return false;
+   }
+
+   return true;
+}
+
+std::uint64_t ReplayBuffer::getNumFrames() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return mNumFramesInSegments;
+}
+
+float ReplayBuffer::getDuration() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return mSegments.empty() ? 0.0f : mSegments.back()->endTime - mSegments.front()->startTime;
+}
+
+std::uint64_t ReplayBuffer::getNumBytes() const
+{
+   std::lock_guard<std::mutex> guard(mMutex);
+   return mNumBytesInSegments;
+}
+
+std::uint64_t ReplayBuffer::getNumDroppedFrames() const
+{
+   return mNumDroppedFrames.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ReplayBuffer::getNumEncodedFrames() const
+{
+   return mNumEncodedFrames.load(std::memory_order_relaxed);
+}
+
+double ReplayBuffer::getEncodingTimeInSeconds() const
+{
+   return mEncodingTimeInNanoseconds.load(std::memory_order_relaxed) * 1.0e-9;
+}
+
+void ReplayBuffer::runEncoder()
+{
+   while (!mStopEncoder.load(std::memory_order_acquire))
+   {
+      if (encodeAvailableFrames() == 0)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+   }
+}
+
+std::size_t ReplayBuffer::encodeAvailableFrames()
+{
+   std::uint64_t readIndex  = mReadIndex.load(std::memory_order_relaxed);
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+
+   if (readIndex == writeIndex)
+   {
+      return 0;
+   }
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   for (std::uint64_t index = readIndex; index < writeIndex; ++index)
+   {
+      const FrameSlot& slot = mSlots[index & mMask];
+      encodeFrame(slot, mPoses.data() + ((index & mMask) * slot.numBodies));
+   }
+
+   // Give the slots back to the producer
+   mReadIndex.store(writeIndex, std::memory_order_release);
+
+   std::chrono::nanoseconds encodingTime = std::chrono::steady_clock::now() - start;
+   mEncodingTimeInNanoseconds.fetch_add(static_cast<std::uint64_t>(encodingTime.count()), std::memory_order_relaxed);
+   mNumEncodedFrames.fetch_add(writeIndex - readIndex, std::memory_order_relaxed);
+
+   return static_cast<std::size_t>(writeIndex - readIndex);
+}
+
+void ReplayBuffer::encodeFrame(const FrameSlot& slot, const TrajectoryPose* poses)
+{
+   bool stepIndexStartedOver = (slot.stepIndex <= mLastStepIndex);
+   mLastStepIndex            = slot.stepIndex;
+
+   mEncodedFrame.clear();
+   bool isKeyframe = mEncoder.encode(slot.stepIndex, slot.simulatedTime, slot.numBodies, poses, mEncodedFrame);
+
+   std::lock_guard<std::mutex> guard(mMutex);
+
+   if (stepIndexStartedOver)
+   {
+      mSegments.clear();
+      mNumFramesInSegments = 0;
+      mNumBytesInSegments  = 0;
+   }
+
+   if (isKeyframe || mSegments.empty())
+   {
+      std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+      segment->numFrames = 0;
+      segment->startTime = slot.simulatedTime;
+      segment->endTime   = slot.simulatedTime;
+      mSegments.push_back(segment);
+   }
+
+   Segment& segment = *mSegments.back();
+   segment.bytes.insert(segment.bytes.end(), mEncodedFrame.begin(), mEncodedFrame.end());
+   segment.numFrames++;
+   segment.endTime = slot.simulatedTime;
+
+   mNumFramesInSegments++;
+   mNumBytesInSegments += mEncodedFrame.size();
+
+   dropOldSegments();
+}
+
+void ReplayBuffer::dropOldSegments()
+{
+   while (mSegments.size() > 1)
+   {
+      // The second oldest segment and the ones after it still cover the duration without the oldest one
+      bool oldestIsNotNeeded = (mSegments.back()->endTime - mSegments[1]->startTime) >= mDurationInSeconds;
+      bool tooManyBytes      = mNumBytesInSegments > mMaxNumBytes;
+      if (!oldestIsNotNeeded && !tooManyBytes)
+      {
+         break;
+      }
+
+      mNumFramesInSegments -= mSegments.front()->numFrames;
+      mNumBytesInSegments  -= mSegments.front()->bytes.size();
+      mSegments.pop_front();
+   }
+}
@@ -1,11 +1,19 @@
 #include <QComboBox>
 #include <QDoubleSpinBox>
+#include <QGridLayout>
 
 #include "rigid_body_simulator.h"
 
-RigidBodySimulator::RigidBodySimulator(QWidget *parent)
+RigidBodySimulator::RigidBodySimulator(const SceneLibrary& sceneLibrary, QWidget *parent)
    : QWidget(parent)
    , mSimulationIsRunning(false)
+   , mPerformancePanel(Q_NULLPTR)
+   , mPhysicsStepTimeGraph(Q_NULLPTR)
+   , mRenderTimeGraph(Q_NULLPTR)
+   , mSubstepsGraph(Q_NULLPTR)
+   , mContactsGraph(Q_NULLPTR)
+   , mSolverIterationsGraph(Q_NULLPTR)
+   , mFramesPerSecondGraph(Q_NULLPTR)
 {
    ui.setupUi(this);
 
@@ -32,26 +40,41 @@ RigidBodySimulator::RigidBodySimulator(QWidget *parent)
    ui.resetPushButton->setIcon(QIcon(":RigidBodySimulator/icons/reset.png"));
    ui.resetPushButton->setIconSize(QSize(20, 20));
 
-   ui.sceneComboBox->addItem("Single");
-   ui.sceneComboBox->addItem("Pair");
-   ui.sceneComboBox->addItem("Momentum");
-   ui.sceneComboBox->addItem("Torque");
-   ui.sceneComboBox->addItem("Plus Sign");
-   ui.sceneComboBox->addItem("Multiplication Sign");
-   ui.sceneComboBox->addItem("Star");
-   ui.sceneComboBox->addItem("Stack");
-   ui.sceneComboBox->addItem("Stack Being Hit");
-   ui.sceneComboBox->addItem("Hexagon");
-   ui.sceneComboBox->addItem("Octagon");
-   ui.sceneComboBox->addItem("Downward Slope");
-   ui.sceneComboBox->addItem("Upward Slope");
+   for (int i = 0; i < sceneLibrary.getNumScenes(); ++i)
+   {
+      ui.sceneComboBox->addItem(QString::fromStdString(sceneLibrary.getSceneName(i)));
+   }
 
    ui.antiAliasingModeComboBox->addItem("2x MSAA");
    ui.antiAliasingModeComboBox->addItem("4x MSAA");
    ui.antiAliasingModeComboBox->addItem("8x MSAA");
 
+   ui.integratorComboBox->addItem("Runge-Kutta 4");
+   ui.integratorComboBox->addItem("Semi-Implicit Euler");
+   ui.integratorComboBox->addItem("Velocity Verlet");
+
    setWindowFlags(Qt::Widget | Qt::MSWindowsFixedSizeDialogHint);
 
+   // The performance panel is a separate window that is shown and hidden with its check box, so it doesn't have a close button
+   // The Game thread sends it a sample four times per second, and each graph shows the last 30 seconds
+   mPerformancePanel = new QWidget(this, Qt::Window | Qt::WindowTitleHint | Qt::CustomizeWindowHint);
+   mPerformancePanel->setWindowTitle("Performance");
+
+   mPhysicsStepTimeGraph  = new PerformanceGraph("Physics Step Time", "ms",        QColor(46, 204, 113), 120, mPerformancePanel);
+   mRenderTimeGraph       = new PerformanceGraph("Render Time",       "ms",        QColor(33, 150, 243), 120, mPerformancePanel);
+   mSubstepsGraph         = new PerformanceGraph("Substeps",          "per frame", QColor(255, 193, 7),  120, mPerformancePanel);
+   mContactsGraph         = new PerformanceGraph("Contacts",          "per frame", QColor(255, 61, 0),   120, mPerformancePanel);
+   mSolverIterationsGraph = new PerformanceGraph("Solver Iterations", "per frame", QColor(156, 39, 176), 120, mPerformancePanel);
+   mFramesPerSecondGraph  = new PerformanceGraph("Frames Per Second", "FPS",       Qt::white,            120, mPerformancePanel);
+
+   QGridLayout* performancePanelLayout = new QGridLayout(mPerformancePanel);
+   performancePanelLayout->addWidget(mPhysicsStepTimeGraph,  0, 0);
+   performancePanelLayout->addWidget(mRenderTimeGraph,       0, 1);
+   performancePanelLayout->addWidget(mSubstepsGraph,         1, 0);
+   performancePanelLayout->addWidget(mContactsGraph,         1, 1);
+   performancePanelLayout->addWidget(mSolverIterationsGraph, 2, 0);
+   performancePanelLayout->addWidget(mFramesPerSecondGraph,  2, 1);
+
    // Simulation
    connect(ui.sceneComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &RigidBodySimulator::onSceneComboBoxCurrentIndexChanged);
 
@@ -65,16 +88,21 @@ RigidBodySimulator::RigidBodySimulator(QWidget *parent)
    connect(ui.invertedGravityRadioButton, &QAbstractButton::toggled, this, &RigidBodySimulator::onInvertedGravityRadioButtonToggled);
 
    // Constants
-   connect(ui.timeStepSpinBox,                 qOverload<double>(&QDoubleSpinBox::valueChanged), this, &RigidBodySimulator::onTimeStepSpinBoxValueChanged);
-   connect(ui.coefficientOfRestitutionSpinBox, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &RigidBodySimulator::onCoefficientOfRestitutionSpinBoxValueChanged);
+   connect(ui.timeStepSpinBox,                      qOverload<double>(&QDoubleSpinBox::valueChanged), this, &RigidBodySimulator::onTimeStepSpinBoxValueChanged);
+   connect(ui.coefficientOfRestitutionSpinBox,      qOverload<double>(&QDoubleSpinBox::valueChanged), this, &RigidBodySimulator::onCoefficientOfRestitutionSpinBoxValueChanged);
+   connect(ui.integratorComboBox,                   qOverload<int>(&QComboBox::currentIndexChanged),  this, &RigidBodySimulator::onIntegratorComboBoxCurrentIndexChanged);
+   connect(ui.adaptiveTimeStepCheckBox,             &QAbstractButton::toggled,                        this, &RigidBodySimulator::onAdaptiveTimeStepCheckBoxToggled);
+   connect(ui.continuousCollisionDetectionCheckBox, &QAbstractButton::toggled,                        this, &RigidBodySimulator::onContinuousCollisionDetectionCheckBoxToggled);
 
    // Display
    connect(ui.wireFrameModeCheckBox,    &QAbstractButton::toggled,                       this, &RigidBodySimulator::onWireframeModeCheckBoxToggled);
+   connect(ui.performancePanelCheckBox, &QAbstractButton::toggled,                       this, &RigidBodySimulator::onPerformancePanelCheckBoxToggled);
    connect(ui.rememberFramesCheckBox,   &QAbstractButton::toggled,                       this, &RigidBodySimulator::onRememberFramesCheckBoxToggled);
    connect(ui.rememberFramesSpinBox,    qOverload<int>(&QSpinBox::valueChanged),         this, &RigidBodySimulator::onRememberFramesSpinBoxValueChanged);
    connect(ui.antiAliasingModeCheckBox, &QAbstractButton::toggled,                       this, &RigidBodySimulator::onAntiAliasingModeCheckBoxToggled);
    connect(ui.antiAliasingModeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &RigidBodySimulator::onAntiAliasingModeComboBoxCurrentIndexChanged);
    connect(ui.recordGIFCheckBox,        &QAbstractButton::toggled,                       this, &RigidBodySimulator::onRecordGIFCheckBoxToggled);
+   connect(ui.saveReplayPushButton,     &QAbstractButton::clicked,                       this, &RigidBodySimulator::onSaveReplayPushButtonClicked);
 }
 
 void RigidBodySimulator::onSceneComboBoxCurrentIndexChanged(int index)
@@ -273,11 +301,44 @@ void RigidBodySimulator::onCoefficientOfRestitutionSpinBoxValueChanged(double co
    emit changeCoefficientOfRestitution(coefficientOfRestitution);
 }
 
+void RigidBodySimulator::onIntegratorComboBoxCurrentIndexChanged(int index)
+{
+   emit changeIntegrator(index);
+}
+
+void RigidBodySimulator::onAdaptiveTimeStepCheckBoxToggled(bool checked)
+{
+   // The adaptive time-step integrates with its own embedded Runge-Kutta pair, so the selected integrator isn't used while it's enabled
+   ui.integratorComboBox->setEnabled(!checked);
+
+   emit enableAdaptiveTimeStep(checked);
+}
+
+void RigidBodySimulator::onContinuousCollisionDetectionCheckBoxToggled(bool checked)
+{
+   emit enableContinuousCollisionDetection(checked);
+}
+
 void RigidBodySimulator::onWireframeModeCheckBoxToggled(bool checked)
 {
    emit enableWireframeMode(checked);
 }
 
+void RigidBodySimulator::onPerformancePanelCheckBoxToggled(bool checked)
+{
+   if (checked)
+   {
+      mPerformancePanel->show();
+      mPerformancePanel->raise();
+   }
+   else
+   {
+      mPerformancePanel->hide();
+   }
+
+   emit enablePerformanceSampling(checked);
+}
+
 void RigidBodySimulator::onRememberFramesCheckBoxToggled(bool checked)
 {
    emit enableRememberFrames(checked);
@@ -303,6 +364,11 @@ void RigidBodySimulator::onRecordGIFCheckBoxToggled(bool checked)
    emit enableRecordGIF(checked);
 }
 
+void RigidBodySimulator::onSaveReplayPushButtonClicked()
+{
+   emit saveReplay();
+}
+
 void RigidBodySimulator::processSimulationError(int errorCode)
 {
    ui.startPausePushButton->setIcon(QIcon(":RigidBodySimulator/icons/play.png"));
@@ -317,3 +383,18 @@ void RigidBodySimulator::processSimulationError(int errorCode)
 
    mSimulationIsRunning = false;
 }
+
+void RigidBodySimulator::processPerformanceSample(double physicsStepTime,
+                                                  double renderTime,
+                                                  double substepsPerFrame,
+                                                  double contactsPerFrame,
+                                                  double solverIterationsPerFrame,
+                                                  double framesPerSecond)
+{
+   mPhysicsStepTimeGraph->addSample(physicsStepTime);
+   mRenderTimeGraph->addSample(renderTime);
+   mSubstepsGraph->addSample(substepsPerFrame);
+   mContactsGraph->addSample(contactsPerFrame);
+   mSolverIterationsGraph->addSample(solverIterationsPerFrame);
+   mFramesPerSecondGraph->addSample(framesPerSecond);
+}
@@ -0,0 +1,430 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "scene.h"
+#include "mapped_scene.h"
+#include "procedural_scenes.h"
+
+namespace
+{
+   const char          binaryMagic[8]    = {'D', 'K', 'S', 'C', 'E', 'N', 'E', '\0'};
+   const std::uint32_t binaryVersion     = 2;
+   const std::uint32_t thisByteOrderMark = 0x01020304;
+
+   // The arrays start at multiples of a cache line, which is also enough for the alignment of any of their members
+   const std::uint64_t sectionAlignment = 64;
+
+   std::uint64_t alignOffset(std::uint64_t offset)
+   {
+      return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+   }
+
+   std::uint32_t calculateBodyLayoutSignature()
+   {
+      const std::uint32_t layout[] = {static_cast<std::uint32_t>(sizeof(RigidBody2D)),
+                                      static_cast<std::uint32_t>(alignof(RigidBody2D)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mOneOverMass)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mWidth)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mHeight)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mOneOverMomentOfInertia)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mCoefficientOfRestitution)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mStates)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D, mColor)),
+                                      static_cast<std::uint32_t>(sizeof(RigidBody2D::KinematicAndDynamicState)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, positionOfCenterOfMass)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, orientation)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, velocityOfCenterOfMass)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, angularVelocity)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, forceOfCenterOfMass)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, torque)),
+                                      static_cast<std::uint32_t>(offsetof(RigidBody2D::KinematicAndDynamicState, vertices))};
+
+      // FNV-1a
+      std::uint32_t signature = 2166136261u;
+      for (std::uint32_t value : layout)
+      {
+         signature ^= value;
+         signature *= 16777619u;
+      }
+
+      return signature;
+   }
+
+   void writePadding(std::ostream& stream, std::uint64_t currentOffset, std::uint64_t targetOffset)
+   {
+      const char zeros[sectionAlignment] = {};
+      stream.write(zeros, static_cast<std::streamsize>(targetOffset - currentOffset));
+   }
+
+   // Checks the magic string, so the stream is left after it if the data is in the binary format
+   bool isBinary(std::istream& stream)
+   {
+      char magic[sizeof(binaryMagic)] = {};
+      stream.read(magic, sizeof(magic));
+      return stream && (std::memcmp(magic, binaryMagic, sizeof(magic)) == 0);
+   }
+
+   // Text files are opened in binary mode to detect their format, so lines that end in \r\n keep their \r
+   void readTextName(std::istream& lineStream, std::string& name)
+   {
+      std::getline(lineStream >> std::ws, name);
+      if (!name.empty() && (name.back() == '\r'))
+      {
+         name.pop_back();
+      }
+   }
+
+   // Reads the header from the start of the stream, and only checks the magic string and the version
+   bool readBinaryHeader(std::istream& stream, SceneFileHeader& header)
+   {
+      stream.clear();
+      stream.seekg(0);
+      return stream.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.hasValidMagicAndVersion();
+   }
+
+   // The name is only read if it fits in the stream, so that a corrupt header can't make us allocate an arbitrary amount of memory
+   bool readBinaryName(std::istream& stream, const SceneFileHeader& header, std::string& name)
+   {
+      stream.seekg(0, std::ios::end);
+      std::streamoff streamSize = stream.tellg();
+      if ((streamSize < 0) || (header.nameOffset > static_cast<std::uint64_t>(streamSize)) || (header.nameLength > (static_cast<std::uint64_t>(streamSize) - header.nameOffset)))
+      {
+         return false;
+      }
+
+      name.resize(static_cast<std::size_t>(header.nameLength));
+      stream.seekg(static_cast<std::streamoff>(header.nameOffset));
+      return (header.nameLength == 0) || static_cast<bool>(stream.read(&name[0], static_cast<std::streamsize>(header.nameLength)));
+   }
+}
+
+SceneFileHeader::SceneFileHeader()
+   : magic()
+   , version(binaryVersion)
+   , headerSize(sizeof(SceneFileHeader))
+   , byteOrderMark(thisByteOrderMark)
+   , wallRecordSize(sizeof(SceneWallRecord))
+   , bodyRecordSize(sizeof(RigidBody2D))
+   , bodyLayoutSignature(calculateBodyLayoutSignature())
+   , nameOffset(0)
+   , nameLength(0)
+   , wallsOffset(0)
+   , numWalls(0)
+   , bodiesOffset(0)
+   , numBodies(0)
+   , dimensions(0.0f)
+   , gravityState(0)
+   , timeStep(0.0f)
+{
+   std::memcpy(magic, binaryMagic, sizeof(magic));
+}
+
+bool SceneFileHeader::hasValidMagicAndVersion() const
+{
+   return (std::memcmp(magic, binaryMagic, sizeof(magic)) == 0) && (version == binaryVersion) && (headerSize == sizeof(SceneFileHeader));
+}
+
+bool SceneFileHeader::hasLayoutOfThisBuild() const
+{
+   return (byteOrderMark       == thisByteOrderMark)       &&
+          (wallRecordSize      == sizeof(SceneWallRecord)) &&
+          (bodyRecordSize      == sizeof(RigidBody2D))     &&
+          (bodyLayoutSignature == calculateBodyLayoutSignature());
+}
+
+Scene::Scene()
+   : name()
+   , dimensions(450.0f, 450.0f)
+   , gravityState(0)
+   , timeStep(0.02f)
+   , walls()
+   , rigidBodies()
+{
+
+}
+
+Scene::Format Scene::getFormatOfFile(const std::string& filePath)
+{
+   const std::string binaryExtension = ".bin";
+
+   if ((filePath.size() >= binaryExtension.size()) &&
+       (filePath.compare(filePath.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension) == 0))
+   {
+      return Format::binary;
+   }
+
+   return Format::text;
+}
+
+bool Scene::readName(const std::string& filePath, std::string& name)
+{
+   std::ifstream file(filePath, std::ios::in | std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - Scene::readName - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   if (isBinary(file))
+   {
+      SceneFileHeader header;
+      if (!readBinaryHeader(file, header) || !readBinaryName(file, header, name))
+      {
+         std::cout << "Error - Scene::readName - Failed to read " << filePath << "\n";
+         return false;
+      }
+
+      return true;
+   }
+
+   // Only the lines up to the name are read, and the name is usually on one of the first lines
+   file.clear();
+   file.seekg(0);
+
+   std::string line;
+   while (std::getline(file, line))
+   {
+      std::istringstream lineStream(line);
+      std::string        keyword;
+      if ((lineStream >> keyword) && (keyword == "name"))
+      {
+         readTextName(lineStream, name);
+         return true;
+      }
+   }
+
+   std::cout << "Error - Scene::readName - " << filePath << " doesn't have a name\n";
+   return false;
+}
+
+bool Scene::load(const std::string& filePath)
+{
+   std::ifstream file(filePath, std::ios::in | std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - Scene::load - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   // Binary files are mapped instead of read, so that their bodies are copied only once
+   bool isValid;
+   if (isBinary(file))
+   {
+      file.close();
+
+      MappedScene mappedScene;
+      isValid = mappedScene.open(filePath);
+      if (isValid)
+      {
+         mappedScene.copyTo(*this);
+      }
+   }
+   else
+   {
+      file.clear();
+      file.seekg(0);
+      isValid = read(file);
+   }
+
+   if (!isValid)
+   {
+      std::cout << "Error - Scene::load - Failed to read " << filePath << "\n";
+      return false;
+   }
+
+   return true;
+}
+
+bool Scene::save(const std::string& filePath) const
+{
+   Format        format = getFormatOfFile(filePath);
+   std::ofstream file(filePath, (format == Format::binary) ? (std::ios::out | std::ios::binary) : std::ios::out);
+   if (!file)
+   {
+      std::cout << "Error - Scene::save - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   if (format == Format::binary)
+   {
+      writeBinary(file);
+   }
+   else
+   {
+      write(file);
+   }
+
+   return static_cast<bool>(file);
+}
+
+bool Scene::read(std::istream& stream)
+{
+   name.clear();
+   walls.clear();
+   rigidBodies.clear();
+
+   std::string line;
+   int         lineNumber = 0;
+   while (std::getline(stream, line))
+   {
+      ++lineNumber;
+
+      std::istringstream lineStream(line);
+      std::string        keyword;
+      if (!(lineStream >> keyword) || (keyword[0] == '#'))
+      {
+         continue;
+      }
+
+      bool isValid = true;
+      if (keyword == "name")
+      {
+         readTextName(lineStream, name);
+      }
+      else if (keyword == "dimensions")
+      {
+         isValid = static_cast<bool>(lineStream >> dimensions.x >> dimensions.y);
+      }
+      else if (keyword == "gravity")
+      {
+         isValid = static_cast<bool>(lineStream >> gravityState);
+      }
+      else if (keyword == "time_step")
+      {
+         isValid = static_cast<bool>(lineStream >> timeStep);
+      }
+      else if (keyword == "wall")
+      {
+         glm::vec2 normal;
+         glm::vec2 startPoint;
+         glm::vec2 endPoint;
+         isValid = static_cast<bool>(lineStream >> normal.x >> normal.y >> startPoint.x >> startPoint.y >> endPoint.x >> endPoint.y);
+         if (isValid)
+         {
+            walls.push_back(Wall(normal, startPoint, endPoint));
+         }
+      }
+      else if (keyword == "generate")
+      {
+         std::string         identifier;
+         int                 numBodies;
+         std::uint32_t       seed;
+         ProceduralSceneType type;
+         isValid = static_cast<bool>(lineStream >> identifier >> numBodies >> seed) && findProceduralSceneType(identifier, type) && (numBodies >= 0);
+         if (isValid)
+         {
+            // The generated scene sets the dimensions and the gravity state, which the lines that follow can change
+            Scene generatedScene = generateProceduralScene(type, numBodies, seed);
+            dimensions   = generatedScene.dimensions;
+            gravityState = generatedScene.gravityState;
+            for (Wall& wall : generatedScene.walls)
+            {
+               walls.push_back(std::move(wall));
+            }
+            rigidBodies.insert(rigidBodies.end(), generatedScene.rigidBodies.begin(), generatedScene.rigidBodies.end());
+         }
+      }
+      else if (keyword == "body")
+      {
+         float     mass;
+         float     width;
+         float     height;
+         float     coefficientOfRestitution;
+         glm::vec2 position;
+         float     orientation;
+         glm::vec2 velocity;
+         float     angularVelocity;
+         glm::vec3 color;
+         isValid = static_cast<bool>(lineStream >> mass >> width >> height >> coefficientOfRestitution
+                                                >> position.x >> position.y >> orientation
+                                                >> velocity.x >> velocity.y >> angularVelocity
+                                                >> color.r >> color.g >> color.b);
+         if (isValid)
+         {
+            rigidBodies.push_back(RigidBody2D(mass, width, height, coefficientOfRestitution, position, orientation, velocity, angularVelocity, color));
+         }
+      }
+      else
+      {
+         std::cout << "Error - Scene::read - Unknown keyword " << keyword << " on line " << lineNumber << "\n";
+         return false;
+      }
+
+      if (!isValid)
+      {
+         std::cout << "Error - Scene::read - Invalid values for " << keyword << " on line " << lineNumber << "\n";
+         return false;
+      }
+   }
+
+   return true;
+}
+
+void Scene::write(std::ostream& stream) const
+{
+   std::streamsize oldPrecision = stream.precision(std::numeric_limits<float>::max_digits10);
+
+   stream << "# Dyna-Kinematics scene\n";
+   stream << "name "       << name << "\n";
+   stream << "dimensions " << dimensions.x << " " << dimensions.y << "\n";
+   stream << "gravity "    << gravityState << "\n";
+   stream << "time_step "  << timeStep << "\n";
+
+   for (const Wall& wall : walls)
+   {
+      stream << "wall "
+             << wall.getNormal().x     << " " << wall.getNormal().y     << " "
+             << wall.getStartPoint().x << " " << wall.getStartPoint().y << " "
+             << wall.getEndPoint().x   << " " << wall.getEndPoint().y   << "\n";
+   }
+
+   // The initial state of a body is its current state
+   for (const RigidBody2D& body : rigidBodies)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[0];
+
+      stream << "body "
+             << (1.0f / body.mOneOverMass) << " " << body.mWidth << " " << body.mHeight << " " << body.mCoefficientOfRestitution << " "
+             << currentState.positionOfCenterOfMass.x << " " << currentState.positionOfCenterOfMass.y << " " << currentState.orientation << " "
+             << currentState.velocityOfCenterOfMass.x << " " << currentState.velocityOfCenterOfMass.y << " " << currentState.angularVelocity << " "
+             << body.mColor.r << " " << body.mColor.g << " " << body.mColor.b << "\n";
+   }
+
+   stream.precision(oldPrecision);
+}
+
+void Scene::writeBinary(std::ostream& stream) const
+{
+   SceneFileHeader header;
+   header.nameOffset   = sizeof(SceneFileHeader);
+   header.nameLength   = name.size();
+   header.wallsOffset  = alignOffset(header.nameOffset + header.nameLength);
+   header.numWalls     = walls.size();
+   header.bodiesOffset = alignOffset(header.wallsOffset + (header.numWalls * sizeof(SceneWallRecord)));
+   header.numBodies    = rigidBodies.size();
+   header.dimensions   = dimensions;
+   header.gravityState = gravityState;
+   header.timeStep     = timeStep;
+
+   stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+   stream.write(name.data(), static_cast<std::streamsize>(name.size()));
+   writePadding(stream, header.nameOffset + header.nameLength, header.wallsOffset);
+
+   for (const Wall& wall : walls)
+   {
+      SceneWallRecord wallRecord;
+      wallRecord.normal     = wall.getNormal();
+      wallRecord.startPoint = wall.getStartPoint();
+      wallRecord.endPoint   = wall.getEndPoint();
+      stream.write(reinterpret_cast<const char*>(&wallRecord), sizeof(wallRecord));
+   }
+   writePadding(stream, header.wallsOffset + (header.numWalls * sizeof(SceneWallRecord)), header.bodiesOffset);
+
+   // The initial state of a body is its current state, and the bodies are written as they are laid out in memory
+   stream.write(reinterpret_cast<const char*>(rigidBodies.data()), static_cast<std::streamsize>(rigidBodies.size() * sizeof(RigidBody2D)));
+}
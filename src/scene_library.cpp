@@ -0,0 +1,135 @@
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <iostream>
+
+#include "scene_library.h"
+
+namespace
+{
+   bool endsWith(const std::string& string, const std::string& suffix)
+   {
+      return (string.size() >= suffix.size()) && (string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0);
+   }
+
+   bool listFiles(const std::string& directoryPath, std::vector<std::string>& fileNames)
+   {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+      WIN32_FIND_DATAA findData;
+      HANDLE           findHandle = FindFirstFileA((directoryPath + "/*").c_str(), &findData);
+      if (findHandle == INVALID_HANDLE_VALUE)
+      {
+         return false;
+      }
+
+      do
+      {
+         if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+         {
+            fileNames.push_back(findData.cFileName);
+         }
+      }
+      while (FindNextFileA(findHandle, &findData));
+
+      FindClose(findHandle);
+#else
+      DIR* directory = opendir(directoryPath.c_str());
+      if (!directory)
+      {
+         return false;
+      }
+
+      while (dirent* entry = readdir(directory))
+      {
+         if (entry->d_name[0] != '.')
+         {
+            fileNames.push_back(entry->d_name);
+         }
+      }
+
+      closedir(directory);
+#endif
+
+      return true;
+   }
+}
+
+SceneLibrary::SceneLibrary()
+   : mNames()
+   , mFilePaths()
+{
+
+}
+
+bool SceneLibrary::open(const std::string& directoryPath)
+{
+   mNames.clear();
+   mFilePaths.clear();
+
+   std::vector<std::string> fileNames;
+   if (!listFiles(directoryPath, fileNames))
+   {
+      std::cout << "Error - SceneLibrary::open - Failed to list " << directoryPath << "\n";
+      return false;
+   }
+
+   // The order of the entries of a directory depends on the file system, so the files are sorted to give the scenes a stable order
+   std::sort(fileNames.begin(), fileNames.end());
+
+   for (const std::string& fileName : fileNames)
+   {
+      if (!endsWith(fileName, ".scene") && !endsWith(fileName, ".bin"))
+      {
+         continue;
+      }
+
+      std::string filePath = directoryPath + "/" + fileName;
+      std::string name;
+      if (!Scene::readName(filePath, name))
+      {
+         continue;
+      }
+
+      mNames.push_back(name);
+      mFilePaths.push_back(filePath);
+   }
+
+   if (mFilePaths.empty())
+   {
+      std::cout << "Error - SceneLibrary::open - " << directoryPath << " doesn't contain any scenes\n";
+      return false;
+   }
+
+   return true;
+}
+
+int SceneLibrary::getNumScenes() const
+{
+   return static_cast<int>(mFilePaths.size());
+}
+
+const std::string& SceneLibrary::getSceneName(int index) const
+{
+   return mNames[index];
+}
+
+const std::string& SceneLibrary::getSceneFilePath(int index) const
+{
+   return mFilePaths[index];
+}
+
+bool SceneLibrary::loadScene(int index, Scene& scene) const
+{
+   if ((index < 0) || (index >= getNumScenes()))
+   {
+      std::cout << "Error - SceneLibrary::loadScene - There is no scene with index " << index << "\n";
+      return false;
+   }
+
+   return scene.load(mFilePaths[index]);
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <utility>
 
 #include "shader.h"
 
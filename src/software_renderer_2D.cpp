@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+
+#include "software_renderer_2D.h"
+
+SoftwareRenderer2D::SoftwareRenderer2D(int widthInPix, int heightInPix, glm::vec2 sceneDimensions, int samplesPerPixel)
+   : mWidthInPix(std::max(widthInPix, 1))
+   , mHeightInPix(std::max(heightInPix, 1))
+   , mPixelsPerWorldUnit(std::min(mWidthInPix / sceneDimensions.x, mHeightInPix / sceneDimensions.y))
+   , mSamplesPerAxis(std::max(static_cast<int>(std::sqrt(static_cast<float>(samplesPerPixel))), 1))
+   , mPixels(3 * static_cast<std::size_t>(mWidthInPix) * static_cast<std::size_t>(mHeightInPix), 0)
+{
+
+}
+
+void SoftwareRenderer2D::clear()
+{
+   std::fill(mPixels.begin(), mPixels.end(), static_cast<unsigned char>(0));
+}
+
+void SoftwareRenderer2D::renderRigidBody(glm::vec2 positionOfCenterOfMass, float orientation, float width, float height, glm::vec3 color)
+{
+   // The Y axis of the image points down, so the rotation is mirrored
+   glm::vec2 center     = convertWorldToImage(positionOfCenterOfMass);
+   glm::vec2 axisX      = glm::vec2(std::cos(orientation), -std::sin(orientation));
+   glm::vec2 axisY      = glm::vec2(-axisX.y, axisX.x);
+   glm::vec2 halfExtent = 0.5f * mPixelsPerWorldUnit * glm::vec2(width, height);
+
+   glm::vec2 boundsHalfSize = (glm::abs(axisX) * halfExtent.x) + (glm::abs(axisY) * halfExtent.y);
+
+   fill(center - boundsHalfSize, center + boundsHalfSize, color, [center, axisX, axisY, halfExtent](glm::vec2 point)
+   {
+      glm::vec2 offset         = point - center;
+      glm::vec2 distanceToEdge = glm::abs(glm::vec2(glm::dot(offset, axisX), glm::dot(offset, axisY))) - halfExtent;
+      return glm::length(glm::max(distanceToEdge, glm::vec2(0.0f))) + std::min(std::max(distanceToEdge.x, distanceToEdge.y), 0.0f);
+   });
+}
+
+void SoftwareRenderer2D::renderLine(glm::vec2 startPoint, glm::vec2 endPoint, float widthInPix)
+{
+   glm::vec2 start     = convertWorldToImage(startPoint);
+   glm::vec2 end       = convertWorldToImage(endPoint);
+   glm::vec2 direction = end - start;
+   float     length2   = std::max(glm::dot(direction, direction), 1e-12f);
+   float     halfWidth = 0.5f * widthInPix;
+
+   fill(glm::min(start, end) - glm::vec2(halfWidth), glm::max(start, end) + glm::vec2(halfWidth), glm::vec3(1.0f), [start, direction, length2, halfWidth](glm::vec2 point)
+   {
+      float     t       = glm::clamp(glm::dot(point - start, direction) / length2, 0.0f, 1.0f);
+      glm::vec2 closest = start + (t * direction);
+      return glm::length(point - closest) - halfWidth;
+   });
+}
+
+int SoftwareRenderer2D::getWidthInPix() const
+{
+   return mWidthInPix;
+}
+
+int SoftwareRenderer2D::getHeightInPix() const
+{
+   return mHeightInPix;
+}
+
+const std::vector<unsigned char>& SoftwareRenderer2D::getPixels() const
+{
+   return mPixels;
+}
+
+glm::vec2 SoftwareRenderer2D::convertWorldToImage(glm::vec2 worldPosition) const
+{
+   return glm::vec2((0.5f * mWidthInPix)  + (worldPosition.x * mPixelsPerWorldUnit),
+                    (0.5f * mHeightInPix) - (worldPosition.y * mPixelsPerWorldUnit));
+}
+
+template<typename TSignedDistance>
+void SoftwareRenderer2D::fill(glm::vec2 boundsMin, glm::vec2 boundsMax, glm::vec3 color, TSignedDistance signedDistance)
+{
+   int minX = std::max(static_cast<int>(std::floor(boundsMin.x)), 0);
+   int minY = std::max(static_cast<int>(std::floor(boundsMin.y)), 0);
+   int maxX = std::min(static_cast<int>(std::ceil(boundsMax.x)), mWidthInPix  - 1);
+   int maxY = std::min(static_cast<int>(std::ceil(boundsMax.y)), mHeightInPix - 1);
+
+   float     sampleSpacing = 1.0f / mSamplesPerAxis;
+   float     numSamples    = static_cast<float>(mSamplesPerAxis * mSamplesPerAxis);
+   glm::vec3 color255      = 255.0f * glm::clamp(color, glm::vec3(0.0f), glm::vec3(1.0f));
+
+   // A pixel whose center is further than half its diagonal from the edge of a shape is either fully covered or not covered at all
+   const float halfPixelDiagonal = 0.7072f;
+
+   for (int y = minY; y <= maxY; ++y)
+   {
+      for (int x = minX; x <= maxX; ++x)
+      {
+         float distanceOfCenter = signedDistance(glm::vec2(x + 0.5f, y + 0.5f));
+         if (distanceOfCenter >= halfPixelDiagonal)
+         {
+            continue;
+         }
+
+         int numCoveredSamples = mSamplesPerAxis * mSamplesPerAxis;
+         if (distanceOfCenter > -halfPixelDiagonal)
+         {
+            numCoveredSamples = 0;
+            for (int sampleY = 0; sampleY < mSamplesPerAxis; ++sampleY)
+            {
+               for (int sampleX = 0; sampleX < mSamplesPerAxis; ++sampleX)
+               {
+                  glm::vec2 samplePoint(x + ((sampleX + 0.5f) * sampleSpacing), y + ((sampleY + 0.5f) * sampleSpacing));
+                  if (signedDistance(samplePoint) <= 0.0f)
+                  {
+                     ++numCoveredSamples;
+                  }
+               }
+            }
+
+            if (numCoveredSamples == 0)
+            {
+               continue;
+            }
+         }
+
+         float          coverage = numCoveredSamples / numSamples;
+         unsigned char* pixel    = &mPixels[3 * ((static_cast<std::size_t>(y) * mWidthInPix) + x)];
+         for (int channel = 0; channel < 3; ++channel)
+         {
+            float blendedChannel = (pixel[channel] * (1.0f - coverage)) + (color255[channel] * coverage);
+            pixel[channel]       = static_cast<unsigned char>(std::lround(blendedChannel));
+         }
+      }
+   }
+}
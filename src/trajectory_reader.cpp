@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <iostream>
+
+#include "trajectory_reader.h"
+
+namespace
+{
+   const float twoPi = 6.28318530718f;
+
+   std::int64_t decodeZigzag(std::uint64_t value)
+   {
+      return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+   }
+
+   // Reads the values that TrajectoryRecorder packs into a payload, and fails instead of reading past its end
+   class BitUnpacker
+   {
+   public:
+
+      explicit BitUnpacker(const std::vector<unsigned char>& payload)
+         : mPayload(payload)
+         , mPosition(0)
+         , mBuffer(0)
+         , mNumBits(0)
+      {
+
+      }
+
+      bool readByte(unsigned int& value)
+      {
+         if (mPosition >= mPayload.size())
+         {
+            return false;
+         }
+
+         value = mPayload[mPosition++];
+         return true;
+      }
+
+      bool read(unsigned int bitWidth, std::uint64_t& value)
+      {
+         if (bitWidth > 32)
+         {
+            std::uint64_t lowBits;
+            std::uint64_t highBits;
+            if (!read(32, lowBits) || !read(bitWidth - 32, highBits))
+            {
+               return false;
+            }
+
+            value = lowBits | (highBits << 32);
+            return true;
+         }
+
+         while (mNumBits < bitWidth)
+         {
+            if (mPosition >= mPayload.size())
+            {
+               return false;
+            }
+
+            mBuffer  |= static_cast<std::uint64_t>(mPayload[mPosition++]) << mNumBits;
+            mNumBits += 8;
+         }
+
+         value      = mBuffer & ((bitWidth == 32) ? 0xFFFFFFFFull : ((1ull << bitWidth) - 1));
+         mBuffer  >>= bitWidth;
+         mNumBits  -= bitWidth;
+         return true;
+      }
+
+      // Groups start on a byte boundary
+      void skipToNextByte()
+      {
+         mBuffer  = 0;
+         mNumBits = 0;
+      }
+
+   private:
+
+      const std::vector<unsigned char>& mPayload;
+      std::size_t                       mPosition;
+      std::uint64_t                     mBuffer;
+      unsigned int                      mNumBits;
+   };
+}
+
+TrajectoryFrame::TrajectoryFrame()
+   : frameIndex(0)
+   , stepIndex(0)
+   , simulatedTime(0.0f)
+   , positions()
+   , orientations()
+{
+
+}
+
+TrajectoryReader::TrajectoryReader()
+   : mFile()
+   , mHeader()
+   , mKeyframes()
+   , mNumFrames(0)
+   , mFramesEndOffset(0)
+   , mNextFrameIndex(0)
+   , mNextFrameOffset(0)
+   , mNumFramesSinceKeyframe(0)
+   , mPreviousValues()
+   , mValuesBeforePrevious()
+   , mResiduals()
+   , mPayload()
+{
+
+}
+
+bool TrajectoryReader::open(const std::string& filePath)
+{
+   close();
+
+   mFile.open(filePath, std::ios::in | std::ios::binary);
+   if (!mFile)
+   {
+      std::cout << "Error - TrajectoryReader::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   mFile.read(reinterpret_cast<char*>(&mHeader), sizeof(mHeader));
+   if (!mFile || !mHeader.hasValidMagicAndVersion() || !(mHeader.positionQuantum > 0.0f))
+   {
+      std::cout << "Error - TrajectoryReader::open - " << filePath << " isn't a trajectory of a supported version\n";
+      close();
+      return false;
+   }
+
+   if (!readIndex() && !scanFrames())
+   {
+      std::cout << "Error - TrajectoryReader::open - " << filePath << " doesn't contain any complete frames\n";
+      close();
+      return false;
+   }
+
+   if (mKeyframes.empty() || (mKeyframes.front().frameIndex != 0))
+   {
+      std::cout << "Error - TrajectoryReader::open - " << filePath << " doesn't start with a keyframe\n";
+      close();
+      return false;
+   }
+
+   seekToKeyframe(0);
+
+   return true;
+}
+
+void TrajectoryReader::close()
+{
+   if (mFile.is_open())
+   {
+      mFile.close();
+   }
+
+   mFile.clear();
+   mKeyframes.clear();
+   mNumFrames       = 0;
+   mFramesEndOffset = 0;
+   mNextFrameIndex  = 0;
+   mNextFrameOffset = 0;
+}
+
+bool TrajectoryReader::isOpen() const
+{
+   return mFile.is_open();
+}
+
+std::uint64_t TrajectoryReader::getNumFrames() const
+{
+   return mNumFrames;
+}
+
+std::uint64_t TrajectoryReader::getNumKeyframes() const
+{
+   return mKeyframes.size();
+}
+
+float TrajectoryReader::getPositionQuantum() const
+{
+   return mHeader.positionQuantum;
+}
+
+bool TrajectoryReader::readFrame(std::uint64_t frameIndex, TrajectoryFrame& frame)
+{
+   if (frameIndex >= mNumFrames)
+   {
+      return false;
+   }
+
+   // Find the last keyframe at or before the frame
+   std::vector<TrajectoryKeyframeEntry>::const_iterator keyframe = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), frameIndex,
+                                                                                    [](std::uint64_t index, const TrajectoryKeyframeEntry& entry)
+   {
+      return index < entry.frameIndex;
+   });
+   --keyframe;
+
+   // Decoding can only continue from the previous frame if the keyframe was already decoded and the frame wasn't passed yet
+   if ((mNextFrameIndex > frameIndex) || (mNextFrameIndex <= keyframe->frameIndex))
+   {
+      seekToKeyframe(static_cast<std::size_t>(keyframe - mKeyframes.begin()));
+   }
+
+   while (mNextFrameIndex <= frameIndex)
+   {
+      if (!readNextFrame(frame))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool TrajectoryReader::readNextFrame(TrajectoryFrame& frame)
+{
+   if (mNextFrameIndex >= mNumFrames)
+   {
+      return false;
+   }
+
+   TrajectoryFrameHeader frameHeader;
+   mFile.clear();
+   mFile.seekg(static_cast<std::streamoff>(mNextFrameOffset));
+   mFile.read(reinterpret_cast<char*>(&frameHeader), sizeof(frameHeader));
+   if (!mFile || (mNextFrameOffset + sizeof(frameHeader) + frameHeader.payloadSize > mFramesEndOffset))
+   {
+      std::cout << "Error - TrajectoryReader::readNextFrame - Frame " << mNextFrameIndex << " is truncated\n";
+      return false;
+   }
+
+   bool isKeyframe = (frameHeader.isKeyframe != 0);
+   if (!isKeyframe && (3 * static_cast<std::size_t>(frameHeader.numBodies) != mPreviousValues.size()))
+   {
+      std::cout << "Error - TrajectoryReader::readNextFrame - Frame " << mNextFrameIndex << " doesn't have the number of bodies of the frame before it\n";
+      return false;
+   }
+
+   mPayload.resize(frameHeader.payloadSize);
+   mFile.read(reinterpret_cast<char*>(mPayload.data()), frameHeader.payloadSize);
+   if (!mFile)
+   {
+      std::cout << "Error - TrajectoryReader::readNextFrame - Failed to read frame " << mNextFrameIndex << "\n";
+      return false;
+   }
+
+   if (isKeyframe)
+   {
+      mNumFramesSinceKeyframe = 0;
+      mPreviousValues.assign(3 * static_cast<std::size_t>(frameHeader.numBodies), 0);
+      mValuesBeforePrevious.assign(3 * static_cast<std::size_t>(frameHeader.numBodies), 0);
+   }
+
+   frame.frameIndex    = mNextFrameIndex;
+   frame.stepIndex     = frameHeader.stepIndex;
+   frame.simulatedTime = frameHeader.simulatedTime;
+   frame.positions.resize(frameHeader.numBodies);
+   frame.orientations.resize(frameHeader.numBodies);
+
+   // This mirrors the packing and the predictions of TrajectoryFrameEncoder::encode
+   mResiduals.resize(3 * static_cast<std::size_t>(frameHeader.numBodies));
+   BitUnpacker bitUnpacker(mPayload);
+   for (std::uint32_t groupStart = 0; groupStart < frameHeader.numBodies; groupStart += TrajectoryFrameHeader::numBodiesPerGroup)
+   {
+      std::uint32_t groupEnd = std::min(groupStart + TrajectoryFrameHeader::numBodiesPerGroup, frameHeader.numBodies);
+
+      unsigned int bitWidths[3];
+      bool         isValid = bitUnpacker.readByte(bitWidths[0]) && bitUnpacker.readByte(bitWidths[1]) && bitUnpacker.readByte(bitWidths[2]) &&
+                             (bitWidths[0] <= 64) && (bitWidths[1] <= 64) && (bitWidths[2] <= 64);
+
+      for (std::uint32_t j = 0; (j < 3) && isValid; ++j)
+      {
+         for (std::uint32_t i = groupStart; (i < groupEnd) && isValid; ++i)
+         {
+            std::uint64_t zigzag = 0;
+            isValid = bitUnpacker.read(bitWidths[j], zigzag);
+            mResiduals[(3 * i) + j] = decodeZigzag(zigzag);
+         }
+      }
+
+      if (!isValid)
+      {
+         std::cout << "Error - TrajectoryReader::readNextFrame - Frame " << mNextFrameIndex << " is corrupt\n";
+         return false;
+      }
+
+      bitUnpacker.skipToNextByte();
+   }
+
+   for (std::uint32_t i = 0; i < frameHeader.numBodies; ++i)
+   {
+      std::int64_t values[3];
+      for (std::uint32_t j = 0; j < 3; ++j)
+      {
+         std::int64_t& previousValue       = mPreviousValues[(3 * i) + j];
+         std::int64_t& valueBeforePrevious = mValuesBeforePrevious[(3 * i) + j];
+
+         std::int64_t prediction = isKeyframe ? 0 : ((mNumFramesSinceKeyframe == 1) ? previousValue : (2 * previousValue) - valueBeforePrevious);
+         values[j]               = prediction + mResiduals[(3 * i) + j];
+         if (j == 2)
+         {
+            values[j] &= 0xFFFF;
+         }
+
+         valueBeforePrevious = previousValue;
+         previousValue       = values[j];
+      }
+
+      frame.positions[i]    = glm::vec2(static_cast<float>(values[0] * static_cast<double>(mHeader.positionQuantum)),
+                                        static_cast<float>(values[1] * static_cast<double>(mHeader.positionQuantum)));
+      frame.orientations[i] = static_cast<float>((values[2] / 65536.0) * twoPi);
+   }
+
+   ++mNumFramesSinceKeyframe;
+   ++mNextFrameIndex;
+   mNextFrameOffset += sizeof(frameHeader) + frameHeader.payloadSize;
+
+   return true;
+}
+
+bool TrajectoryReader::readIndex()
+{
+   mFile.clear();
+   mFile.seekg(0, std::ios::end);
+   std::uint64_t fileSize = static_cast<std::uint64_t>(mFile.tellg());
+   if (fileSize < sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFileFooter))
+   {
+      return false;
+   }
+
+   TrajectoryFileFooter footer;
+   mFile.seekg(static_cast<std::streamoff>(fileSize - sizeof(footer)));
+   mFile.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+   if (!mFile || !footer.hasValidMagic() ||
+       (footer.indexOffset < sizeof(TrajectoryFileHeader)) ||
+       (footer.indexOffset + (footer.numKeyframes * sizeof(TrajectoryKeyframeEntry)) + sizeof(footer) != fileSize))
+   {
+      return false;
+   }
+
+   mKeyframes.resize(static_cast<std::size_t>(footer.numKeyframes));
+   mFile.seekg(static_cast<std::streamoff>(footer.indexOffset));
+   mFile.read(reinterpret_cast<char*>(mKeyframes.data()), mKeyframes.size() * sizeof(TrajectoryKeyframeEntry));
+   if (!mFile)
+   {
+      mKeyframes.clear();
+      return false;
+   }
+
+   mNumFrames       = footer.numFrames;
+   mFramesEndOffset = footer.indexOffset;
+
+   return true;
+}
+
+bool TrajectoryReader::scanFrames()
+{
+   mFile.clear();
+   mFile.seekg(0, std::ios::end);
+   std::uint64_t fileSize = static_cast<std::uint64_t>(mFile.tellg());
+
+   mKeyframes.clear();
+   mNumFrames = 0;
+
+   // Only the frames that were written completely are kept
+   std::uint64_t         offset = sizeof(TrajectoryFileHeader);
+   TrajectoryFrameHeader frameHeader;
+   while (offset + sizeof(frameHeader) <= fileSize)
+   {
+      mFile.seekg(static_cast<std::streamoff>(offset));
+      mFile.read(reinterpret_cast<char*>(&frameHeader), sizeof(frameHeader));
+      if (!mFile || (offset + sizeof(frameHeader) + frameHeader.payloadSize > fileSize))
+      {
+         break;
+      }
+
+      if (frameHeader.isKeyframe != 0)
+      {
+         TrajectoryKeyframeEntry entry;
+         entry.frameIndex = mNumFrames;
+         entry.fileOffset = offset;
+         mKeyframes.push_back(entry);
+      }
+
+      offset += sizeof(frameHeader) + frameHeader.payloadSize;
+      ++mNumFrames;
+   }
+
+   mFramesEndOffset = offset;
+
+   return mNumFrames != 0;
+}
+
+bool TrajectoryReader::seekToKeyframe(std::size_t keyframeIndex)
+{
+   if (keyframeIndex >= mKeyframes.size())
+   {
+      return false;
+   }
+
+   mNextFrameIndex  = mKeyframes[keyframeIndex].frameIndex;
+   mNextFrameOffset = mKeyframes[keyframeIndex].fileOffset;
+
+   return true;
+}
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "trajectory_recorder.h"
+
+namespace
+{
+   const float twoPi = 6.28318530718f;
+
+   std::int64_t quantizePosition(float position, float positionQuantum)
+   {
+      if (!std::isfinite(position))
+      {
+         return 0;
+      }
+
+      return std::llround(static_cast<double>(position) / positionQuantum);
+   }
+
+   // Orientations are wrapped into a single turn, since bodies that spin keep adding to theirs
+   std::int64_t quantizeOrientation(float orientation)
+   {
+      if (!std::isfinite(orientation))
+      {
+         return 0;
+      }
+
+      double turns = static_cast<double>(orientation) / twoPi;
+      turns -= std::floor(turns);
+      return std::llround(turns * 65536.0) & 0xFFFF;
+   }
+
+   // Zigzag encoding maps small negative values to small unsigned ones
+   std::uint64_t encodeZigzag(std::int64_t value)
+   {
+      return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+   }
+
+   unsigned int calculateBitWidth(std::uint64_t value)
+   {
+      unsigned int bitWidth = 0;
+      while (value != 0)
+      {
+         ++bitWidth;
+         value >>= 1;
+      }
+
+      return bitWidth;
+   }
+
+   // Appends values of any width up to 64 bits to a payload, starting with the lowest bit of each value
+   class BitPacker
+   {
+   public:
+
+      explicit BitPacker(std::vector<unsigned char>& payload)
+         : mPayload(payload)
+         , mBuffer(0)
+         , mNumBits(0)
+      {
+
+      }
+
+      void write(std::uint64_t value, unsigned int bitWidth)
+      {
+         // The buffer holds less than a byte between calls, so it has room for 32 more bits
+         if (bitWidth > 32)
+         {
+            write(value & 0xFFFFFFFF, 32);
+            write(value >> 32, bitWidth - 32);
+            return;
+         }
+
+         mBuffer  |= value << mNumBits;
+         mNumBits += bitWidth;
+         while (mNumBits >= 8)
+         {
+            mPayload.push_back(static_cast<unsigned char>(mBuffer & 0xFF));
+            mBuffer  >>= 8;
+            mNumBits -= 8;
+         }
+      }
+
+      void flush()
+      {
+         if (mNumBits > 0)
+         {
+            mPayload.push_back(static_cast<unsigned char>(mBuffer & 0xFF));
+         }
+
+         mBuffer  = 0;
+         mNumBits = 0;
+      }
+
+   private:
+
+      std::vector<unsigned char>& mPayload;
+      std::uint64_t               mBuffer;
+      unsigned int                mNumBits;
+   };
+}
+
+TrajectoryFileHeader::TrajectoryFileHeader()
+   : magic{'D', 'K', 'T', 'R', 'A', 'J', 'E', 'C'}
+   , version(1)
+   , headerSize(sizeof(TrajectoryFileHeader))
+   , keyframeInterval(0)
+   , positionQuantum(0.0f)
+{
+
+}
+
+bool TrajectoryFileHeader::hasValidMagicAndVersion() const
+{
+   TrajectoryFileHeader expectedHeader;
+   return (std::memcmp(magic, expectedHeader.magic, sizeof(magic)) == 0) &&
+          (version == expectedHeader.version) &&
+          (headerSize == expectedHeader.headerSize);
+}
+
+TrajectoryFileFooter::TrajectoryFileFooter()
+   : indexOffset(0)
+   , numKeyframes(0)
+   , numFrames(0)
+   , magic{'D', 'K', 'T', 'R', 'A', 'J', 'I', 'X'}
+{
+
+}
+
+bool TrajectoryFileFooter::hasValidMagic() const
+{
+   TrajectoryFileFooter expectedFooter;
+   return std::memcmp(magic, expectedFooter.magic, sizeof(magic)) == 0;
+}
+
+TrajectoryFrameEncoder::TrajectoryFrameEncoder(std::uint32_t keyframeInterval, float positionQuantum)
+   : mKeyframeInterval(std::max(keyframeInterval, 1u))
+   , mPositionQuantum(positionQuantum)
+   , mNumFramesSinceKeyframe(0)
+   , mNumEncodedBodies(0)
+   , mLastEncodedStepIndex(0)
+   , mPreviousValues()
+   , mValuesBeforePrevious()
+   , mResiduals()
+   , mPayload()
+{
+
+}
+
+std::uint32_t TrajectoryFrameEncoder::getKeyframeInterval() const
+{
+   return mKeyframeInterval;
+}
+
+float TrajectoryFrameEncoder::getPositionQuantum() const
+{
+   return mPositionQuantum;
+}
+
+void TrajectoryFrameEncoder::reset()
+{
+   mNumFramesSinceKeyframe = 0;
+   mNumEncodedBodies       = 0;
+   mLastEncodedStepIndex   = 0;
+}
+
+bool TrajectoryFrameEncoder::encode(std::uint64_t stepIndex, float simulatedTime, std::uint32_t numBodies, const TrajectoryPose* poses, std::vector<unsigned char>& output)
+{
+   bool isKeyframe = (mNumFramesSinceKeyframe % mKeyframeInterval == 0) ||
+                     (numBodies != mNumEncodedBodies)                   ||
+                     (stepIndex != mLastEncodedStepIndex + 1);
+   if (isKeyframe)
+   {
+      // Keyframes are predicted from zero, so they can be decoded without the frames before them
+      mNumFramesSinceKeyframe = 0;
+      mNumEncodedBodies       = numBodies;
+      mPreviousValues.assign(3 * numBodies, 0);
+      mValuesBeforePrevious.assign(3 * numBodies, 0);
+   }
+
+   mResiduals.resize(3 * numBodies);
+   for (std::uint32_t i = 0; i < numBodies; ++i)
+   {
+      std::int64_t values[3] = {quantizePosition(poses[i].positionX, mPositionQuantum),
+                                quantizePosition(poses[i].positionY, mPositionQuantum),
+                                quantizeOrientation(poses[i].orientation)};
+
+      for (std::uint32_t j = 0; j < 3; ++j)
+      {
+         std::int64_t& previousValue       = mPreviousValues[(3 * i) + j];
+         std::int64_t& valueBeforePrevious = mValuesBeforePrevious[(3 * i) + j];
+
+         // The first frame after a keyframe is predicted to stay where the keyframe is, and the ones after that to keep their velocity
+         std::int64_t prediction = isKeyframe ? 0 : ((mNumFramesSinceKeyframe == 1) ? previousValue : (2 * previousValue) - valueBeforePrevious);
+         std::int64_t residual   = values[j] - prediction;
+
+         // Orientations wrap around, so their residuals are taken modulo a turn
+         if (j == 2)
+         {
+            residual &= 0xFFFF;
+            if (residual >= 0x8000)
+            {
+               residual -= 0x10000;
+            }
+         }
+
+         mResiduals[(3 * i) + j] = encodeZigzag(residual);
+
+         valueBeforePrevious = previousValue;
+         previousValue       = values[j];
+      }
+   }
+
+   // Each group of bodies stores its residuals with the fewest bits that fit the largest one of each kind
+   // That way a collision only makes the residuals of the bodies in its group wider
+   mPayload.clear();
+   BitPacker bitPacker(mPayload);
+   for (std::uint32_t groupStart = 0; groupStart < numBodies; groupStart += TrajectoryFrameHeader::numBodiesPerGroup)
+   {
+      std::uint32_t groupEnd     = std::min(groupStart + TrajectoryFrameHeader::numBodiesPerGroup, numBodies);
+      unsigned int  bitWidths[3] = {0, 0, 0};
+      for (std::uint32_t i = groupStart; i < groupEnd; ++i)
+      {
+         for (std::uint32_t j = 0; j < 3; ++j)
+         {
+            bitWidths[j] = std::max(bitWidths[j], calculateBitWidth(mResiduals[(3 * i) + j]));
+         }
+      }
+
+      for (std::uint32_t j = 0; j < 3; ++j)
+      {
+         mPayload.push_back(static_cast<unsigned char>(bitWidths[j]));
+      }
+
+      for (std::uint32_t j = 0; j < 3; ++j)
+      {
+         for (std::uint32_t i = groupStart; i < groupEnd; ++i)
+         {
+            bitPacker.write(mResiduals[(3 * i) + j], bitWidths[j]);
+         }
+      }
+
+      bitPacker.flush();
+   }
+
+   TrajectoryFrameHeader frameHeader;
+   frameHeader.stepIndex     = stepIndex;
+   frameHeader.simulatedTime = simulatedTime;
+   frameHeader.numBodies     = numBodies;
+   frameHeader.isKeyframe    = isKeyframe ? 1 : 0;
+   frameHeader.payloadSize   = static_cast<std::uint32_t>(mPayload.size());
+
+   const unsigned char* headerBytes = reinterpret_cast<const unsigned char*>(&frameHeader);
+   output.insert(output.end(), headerBytes, headerBytes + sizeof(frameHeader));
+   output.insert(output.end(), mPayload.begin(), mPayload.end());
+
+   ++mNumFramesSinceKeyframe;
+   mLastEncodedStepIndex = stepIndex;
+
+   return isKeyframe;
+}
+
+TrajectoryRecorder::TrajectoryRecorder(std::size_t capacity, std::uint32_t keyframeInterval, float positionQuantum)
+   : mSlots()
+   , mPoses()
+   , mMask(0)
+   , mNumBodies(0)
+   , mWriteIndex(0)
+   , mWriteIndexPadding()
+   , mReadIndex(0)
+   , mReadIndexPadding()
+   , mNumWrittenFrames(0)
+   , mNumWrittenBytes(0)
+   , mNumStalls(0)
+   , mStopWriter(false)
+   , mWriterThread()
+   , mFile()
+   , mEncoder(keyframeInterval, positionQuantum)
+   , mEncodedFrame()
+   , mKeyframes()
+{
+   std::size_t roundedCapacity = 1;
+   while (roundedCapacity < capacity)
+   {
+      roundedCapacity *= 2;
+   }
+
+   mSlots.resize(roundedCapacity);
+   mMask = roundedCapacity - 1;
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+   close();
+}
+
+bool TrajectoryRecorder::open(const std::string& filePath)
+{
+   if (isOpen())
+   {
+      std::cout << "Error - TrajectoryRecorder::open - The recorder is already open" << "\n";
+      return false;
+   }
+
+   mFile.open(filePath, std::ios::out | std::ios::binary);
+   if (!mFile)
+   {
+      std::cout << "Error - TrajectoryRecorder::open - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   TrajectoryFileHeader header;
+   header.keyframeInterval = mEncoder.getKeyframeInterval();
+   header.positionQuantum  = mEncoder.getPositionQuantum();
+   mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+   mNumBodies = 0;
+   mEncoder.reset();
+   mKeyframes.clear();
+
+   mWriteIndex.store(0, std::memory_order_relaxed);
+   mReadIndex.store(0, std::memory_order_relaxed);
+   mNumWrittenFrames.store(0, std::memory_order_relaxed);
+   mNumWrittenBytes.store(sizeof(header), std::memory_order_relaxed);
+   mNumStalls.store(0, std::memory_order_relaxed);
+   mStopWriter.store(false, std::memory_order_relaxed);
+
+   mWriterThread = std::thread(&TrajectoryRecorder::runWriter, this);
+
+   return true;
+}
+
+void TrajectoryRecorder::close()
+{
+   if (!isOpen())
+   {
+      return;
+   }
+
+   mStopWriter.store(true, std::memory_order_release);
+   mWriterThread.join();
+
+   mFile.close();
+}
+
+bool TrajectoryRecorder::isOpen() const
+{
+   return mWriterThread.joinable();
+}
+
+void TrajectoryRecorder::push(std::uint64_t stepIndex, float simulatedTime, const std::vector<RigidBody2D>& rigidBodies)
+{
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+   std::uint32_t numBodies  = static_cast<std::uint32_t>(rigidBodies.size());
+
+   if (numBodies != mNumBodies)
+   {
+      // The writer reads the poses of every slot, so they can only be resized once it has written all of them
+      waitForWriter(writeIndex, 0);
+      mNumBodies = numBodies;
+      mPoses.resize(mSlots.size() * numBodies);
+   }
+   else
+   {
+      waitForWriter(writeIndex, mMask);
+   }
+
+   FrameSlot& slot    = mSlots[writeIndex & mMask];
+   slot.stepIndex     = stepIndex;
+   slot.simulatedTime = simulatedTime;
+   slot.numBodies     = numBodies;
+
+   TrajectoryPose* poses = mPoses.data() + ((writeIndex & mMask) * numBodies);
+   for (std::uint32_t i = 0; i < numBodies; ++i)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = rigidBodies[i].mStates[0];
+      poses[i].positionX   = currentState.positionOfCenterOfMass.x;
+      poses[i].positionY   = currentState.positionOfCenterOfMass.y;
+      poses[i].orientation = currentState.orientation;
+   }
+
+   mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+std::uint64_t TrajectoryRecorder::getNumWrittenFrames() const
+{
+   return mNumWrittenFrames.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TrajectoryRecorder::getNumWrittenBytes() const
+{
+   return mNumWrittenBytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TrajectoryRecorder::getNumStalls() const
+{
+   return mNumStalls.load(std::memory_order_relaxed);
+}
+
+void TrajectoryRecorder::waitForWriter(std::uint64_t writeIndex, std::uint64_t maxNumPendingFrames)
+{
+   if ((writeIndex - mReadIndex.load(std::memory_order_acquire)) <= maxNumPendingFrames)
+   {
+      return;
+   }
+
+   mNumStalls.fetch_add(1, std::memory_order_relaxed);
+   while ((writeIndex - mReadIndex.load(std::memory_order_acquire)) > maxNumPendingFrames)
+   {
+      std::this_thread::yield();
+   }
+}
+
+void TrajectoryRecorder::runWriter()
+{
+   while (!mStopWriter.load(std::memory_order_acquire))
+   {
+      if (writeAvailableFrames() == 0)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+   }
+
+   // Write the frames that were pushed before the recorder was closed
+   writeAvailableFrames();
+   writeIndexAndFooter();
+   mFile.flush();
+}
+
+std::size_t TrajectoryRecorder::writeAvailableFrames()
+{
+   std::uint64_t readIndex  = mReadIndex.load(std::memory_order_relaxed);
+   std::uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+
+   for (std::uint64_t index = readIndex; index < writeIndex; ++index)
+   {
+      const FrameSlot& slot = mSlots[index & mMask];
+      writeFrame(slot, mPoses.data() + ((index & mMask) * slot.numBodies));
+   }
+
+   // Give the slots back to the producer
+   mReadIndex.store(writeIndex, std::memory_order_release);
+
+   return static_cast<std::size_t>(writeIndex - readIndex);
+}
+
+void TrajectoryRecorder::writeFrame(const FrameSlot& slot, const TrajectoryPose* poses)
+{
+   mEncodedFrame.clear();
+   if (mEncoder.encode(slot.stepIndex, slot.simulatedTime, slot.numBodies, poses, mEncodedFrame))
+   {
+      TrajectoryKeyframeEntry entry;
+      entry.frameIndex = mNumWrittenFrames.load(std::memory_order_relaxed);
+      entry.fileOffset = mNumWrittenBytes.load(std::memory_order_relaxed);
+      mKeyframes.push_back(entry);
+   }
+
+   mFile.write(reinterpret_cast<const char*>(mEncodedFrame.data()), mEncodedFrame.size());
+
+   mNumWrittenFrames.fetch_add(1, std::memory_order_relaxed);
+   mNumWrittenBytes.fetch_add(mEncodedFrame.size(), std::memory_order_relaxed);
+}
+
+void TrajectoryRecorder::writeIndexAndFooter()
+{
+   TrajectoryFileFooter footer;
+   footer.indexOffset  = mNumWrittenBytes.load(std::memory_order_relaxed);
+   footer.numKeyframes = mKeyframes.size();
+   footer.numFrames    = mNumWrittenFrames.load(std::memory_order_relaxed);
+
+   mFile.write(reinterpret_cast<const char*>(mKeyframes.data()), mKeyframes.size() * sizeof(TrajectoryKeyframeEntry));
+   mFile.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+
+   mNumWrittenBytes.fetch_add((mKeyframes.size() * sizeof(TrajectoryKeyframeEntry)) + sizeof(footer), std::memory_order_relaxed);
+}
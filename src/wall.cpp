@@ -1,4 +1,5 @@
 #include <array>
+#include <utility>
 
 #include "wall.h"
 
@@ -12,13 +13,17 @@ Wall::Wall(glm::vec2 normal,
    , mVAO(0)
    , mVBO(0)
 {
-   configureVAO(startPoint, endPoint);
+
 }
 
 Wall::~Wall()
 {
-   glDeleteVertexArrays(1, &mVAO);
-   glDeleteBuffers(1, &mVBO);
+   // The VAO is only created when the wall is first rendered, so walls that are only simulated never touch OpenGL
+   if (mVAO != 0)
+   {
+      glDeleteVertexArrays(1, &mVAO);
+      glDeleteBuffers(1, &mVBO);
+   }
 }
 
 Wall::Wall(Wall&& rhs) noexcept
@@ -65,10 +70,15 @@ float Wall::getC() const
 
 void Wall::bindVAO() const
 {
+   if (mVAO == 0)
+   {
+      configureVAO(mStartPoint, mEndPoint);
+   }
+
    glBindVertexArray(mVAO);
 }
 
-void Wall::configureVAO(glm::vec2 startPoint, glm::vec2 endPoint)
+void Wall::configureVAO(glm::vec2 startPoint, glm::vec2 endPoint) const
 {
    glGenVertexArrays(1, &mVAO);
    glGenBuffers(1, &mVBO);
@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "window.h"
+#include "profiler.h"
 
 Window::Window(const std::string& title)
    : mWindow(nullptr)
@@ -17,6 +20,12 @@ Window::Window(const std::string& title)
    , mMemoryRBO(0)
    , mGifFBO(0)
    , mGifTexture(0)
+   , mCaptureFBO(0)
+   , mCaptureTexture(0)
+   , mWidthOfCaptureFramebufferInPix(0)
+   , mHeightOfCaptureFramebufferInPix(0)
+   , mCaptureMultisampleFBO(0)
+   , mCaptureMultisampleRBO(0)
    , mNumOfSamples(1)
    , mWidthOfScene(450)
    , mHeightOfScene(450)
@@ -43,6 +52,12 @@ Window::~Window()
    glDeleteFramebuffers(1, &mGifFBO);
    glDeleteTextures(1, &mGifTexture);
 
+   glDeleteFramebuffers(1, &mCaptureFBO);
+   glDeleteTextures(1, &mCaptureTexture);
+
+   glDeleteFramebuffers(1, &mCaptureMultisampleFBO);
+   glDeleteRenderbuffers(1, &mCaptureMultisampleRBO);
+
    if (mWindow)
    {
       glfwTerminate();
@@ -131,6 +146,14 @@ bool Window::initialize()
       return false;
    }
 
+   if (!configureCaptureSupport())
+   {
+      std::cout << "Error - Window::initialize - Failed to configure capture support" << "\n";
+      glfwTerminate();
+      mWindow = nullptr;
+      return false;
+   }
+
    updateBufferAndViewportSizes();
 
    setInputCallbacks();
@@ -276,12 +299,16 @@ bool Window::createMultisampleFramebuffer()
 
 void Window::clearAndBindMultisampleFramebuffer()
 {
+   PROFILE_ZONE("Window::clearAndBindMultisampleFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mMultisampleFBO);
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Window::clearMultisampleFramebuffer()
 {
+   PROFILE_ZONE("Window::clearMultisampleFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mMultisampleFBO);
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
    glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -294,6 +321,8 @@ void Window::bindMultisampleFramebuffer()
 
 void Window::generateAntiAliasedImage(unsigned int width, unsigned int height)
 {
+   PROFILE_ZONE("Window::generateAntiAliasedImage");
+
    glBindFramebuffer(GL_FRAMEBUFFER, 0);
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -308,6 +337,8 @@ void Window::generateAntiAliasedImage(unsigned int width, unsigned int height)
 
 void Window::resizeFramebuffers()
 {
+   PROFILE_ZONE("Window::resizeFramebuffers");
+
    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, mMultisampleTexture);
    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, mNumOfSamples, GL_RGB, mWidthOfFramebufferInPix, mHeightOfFramebufferInPix, GL_TRUE);
    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
@@ -331,6 +362,8 @@ void Window::resizeFramebuffers()
 
 void Window::setNumberOfSamples(unsigned int numOfSamples)
 {
+   PROFILE_ZONE("Window::setNumberOfSamples");
+
    mNumOfSamples = numOfSamples;
 
    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, mMultisampleTexture);
@@ -348,6 +381,10 @@ void Window::setNumberOfSamples(unsigned int numOfSamples)
    glBindRenderbuffer(GL_RENDERBUFFER, mMemoryRBO);
    glRenderbufferStorageMultisample(GL_RENDERBUFFER, mNumOfSamples, GL_DEPTH_COMPONENT, mWidthOfFramebufferInPix, mHeightOfFramebufferInPix);
    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+   glBindRenderbuffer(GL_RENDERBUFFER, mCaptureMultisampleRBO);
+   glRenderbufferStorageMultisample(GL_RENDERBUFFER, mNumOfSamples, GL_RGB8, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix);
+   glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
 bool Window::configureMemorySupport()
@@ -399,12 +436,16 @@ bool Window::createMemoryFramebuffer()
 
 void Window::clearAndBindMemoryFramebuffer()
 {
+   PROFILE_ZONE("Window::clearAndBindMemoryFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mMemoryFBO);
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Window::clearMemoryFramebuffer()
 {
+   PROFILE_ZONE("Window::clearMemoryFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mMemoryFBO);
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
    glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -417,6 +458,8 @@ void Window::bindMemoryFramebuffer()
 
 void Window::copyMemoryFramebufferIntoMultisampleFramebuffer(unsigned int width, unsigned int height)
 {
+   PROFILE_ZONE("Window::copyMemoryFramebufferIntoMultisampleFramebuffer");
+
    glBindFramebuffer(GL_READ_FRAMEBUFFER, mMemoryFBO);
    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mMultisampleFBO);
    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST); // TODO: Should this be GL_LINEAR?
@@ -462,12 +505,16 @@ bool Window::createGifFramebuffer()
 
 void Window::clearAndBindGifFramebuffer()
 {
+   PROFILE_ZONE("Window::clearAndBindGifFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mGifFBO);
    glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void Window::clearGifFramebuffer()
 {
+   PROFILE_ZONE("Window::clearGifFramebuffer");
+
    glBindFramebuffer(GL_FRAMEBUFFER, mGifFBO);
    glClear(GL_COLOR_BUFFER_BIT);
    glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -480,13 +527,157 @@ void Window::bindGifFramebuffer()
 
 void Window::copyMultisampleFramebufferIntoGifFramebuffer(unsigned int width, unsigned int height)
 {
+   PROFILE_ZONE("Window::copyMultisampleFramebufferIntoGifFramebuffer");
+
    glBindFramebuffer(GL_READ_FRAMEBUFFER, mMultisampleFBO);
    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mGifFBO);
    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST); // TODO: Should this be GL_LINEAR?
 }
 
+bool Window::configureCaptureSupport()
+{
+   if (!createCaptureFramebuffer())
+   {
+      return false;
+   }
+
+   return true;
+}
+
+bool Window::createCaptureFramebuffer()
+{
+   // Configure a framebuffer object with a fixed size for the recordings, which is only resized when a recording asks for a different size
+
+   glGenFramebuffers(1, &mCaptureFBO);
+
+   glBindFramebuffer(GL_FRAMEBUFFER, mCaptureFBO);
+
+   // Create a texture and use it as a color attachment
+   glGenTextures(1, &mCaptureTexture);
+
+   mWidthOfCaptureFramebufferInPix  = mWidthOfFramebufferInPix;
+   mHeightOfCaptureFramebufferInPix = mHeightOfFramebufferInPix;
+
+   glBindTexture(GL_TEXTURE_2D, mCaptureTexture);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mCaptureTexture, 0);
+
+   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+   {
+      std::cout << "Error - Window::createCaptureFramebuffer - Capture framebuffer is not complete" << "\n";
+      return false;
+   }
+
+   // Configure a multisample framebuffer object with the same size, which the world is rendered into when it's rendered at the size of the recording
+   // It's resolved into the capture framebuffer, which is what the frames are read back from
+   glGenFramebuffers(1, &mCaptureMultisampleFBO);
+
+   glBindFramebuffer(GL_FRAMEBUFFER, mCaptureMultisampleFBO);
+
+   // Create a multisample renderbuffer object and use it as a color attachment
+   glGenRenderbuffers(1, &mCaptureMultisampleRBO);
+
+   glBindRenderbuffer(GL_RENDERBUFFER, mCaptureMultisampleRBO);
+   glRenderbufferStorageMultisample(GL_RENDERBUFFER, mNumOfSamples, GL_RGB8, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix);
+   glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mCaptureMultisampleRBO);
+
+   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+   {
+      std::cout << "Error - Window::createCaptureFramebuffer - Capture multisample framebuffer is not complete" << "\n";
+      return false;
+   }
+
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+   return true;
+}
+
+void Window::resizeCaptureFramebuffer(unsigned int width, unsigned int height)
+{
+   PROFILE_ZONE("Window::resizeCaptureFramebuffer");
+
+   if ((width != mWidthOfCaptureFramebufferInPix) || (height != mHeightOfCaptureFramebufferInPix))
+   {
+      mWidthOfCaptureFramebufferInPix  = width;
+      mHeightOfCaptureFramebufferInPix = height;
+
+      glBindTexture(GL_TEXTURE_2D, mCaptureTexture);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+      glBindTexture(GL_TEXTURE_2D, 0);
+
+      glBindRenderbuffer(GL_RENDERBUFFER, mCaptureMultisampleRBO);
+      glRenderbufferStorageMultisample(GL_RENDERBUFFER, mNumOfSamples, GL_RGB8, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix);
+      glBindRenderbuffer(GL_RENDERBUFFER, 0);
+   }
+
+   // The scene is only ever copied into the same rectangle, so the bars around it are cleared once
+   glBindFramebuffer(GL_FRAMEBUFFER, mCaptureFBO);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Window::clearAndBindCaptureMultisampleFramebuffer()
+{
+   PROFILE_ZONE("Window::clearAndBindCaptureMultisampleFramebuffer");
+
+   glBindFramebuffer(GL_FRAMEBUFFER, mCaptureMultisampleFBO);
+   glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void Window::resolveCaptureMultisampleFramebuffer()
+{
+   PROFILE_ZONE("Window::resolveCaptureMultisampleFramebuffer");
+
+   // Both framebuffers have the size of the recording, so the whole of the multisample framebuffer is resolved, including the bars around the scene
+   glBindFramebuffer(GL_READ_FRAMEBUFFER, mCaptureMultisampleFBO);
+   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mCaptureFBO);
+   glBlitFramebuffer(0, 0, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix,
+                     0, 0, mWidthOfCaptureFramebufferInPix, mHeightOfCaptureFramebufferInPix,
+                     GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+void Window::bindCaptureFramebuffer()
+{
+   glBindFramebuffer(GL_FRAMEBUFFER, mCaptureFBO);
+}
+
+std::tuple<float, float, float, float> Window::calculateCaptureViewport(float widthOfViewport, float heightOfViewport) const
+{
+   float scale        = std::min(mWidthOfCaptureFramebufferInPix / widthOfViewport, mHeightOfCaptureFramebufferInPix / heightOfViewport);
+   float scaledWidth  = std::floor(widthOfViewport * scale + 0.5f);
+   float scaledHeight = std::floor(heightOfViewport * scale + 0.5f);
+   float offsetX      = std::floor((mWidthOfCaptureFramebufferInPix - scaledWidth) / 2.0f);
+   float offsetY      = std::floor((mHeightOfCaptureFramebufferInPix - scaledHeight) / 2.0f);
+
+   return std::make_tuple(offsetX, offsetY, scaledWidth, scaledHeight);
+}
+
+void Window::copyGifFramebufferIntoCaptureFramebuffer(float lowerLeftCornerOfViewportX, float lowerLeftCornerOfViewportY, float widthOfViewport, float heightOfViewport)
+{
+   PROFILE_ZONE("Window::copyGifFramebufferIntoCaptureFramebuffer");
+
+   float offsetX, offsetY, scaledWidth, scaledHeight;
+   std::tie(offsetX, offsetY, scaledWidth, scaledHeight) = calculateCaptureViewport(widthOfViewport, heightOfViewport);
+
+   int   sourceX      = static_cast<int>(lowerLeftCornerOfViewportX);
+   int   sourceY      = static_cast<int>(lowerLeftCornerOfViewportY);
+
+   // A multisample framebuffer can't be scaled while it's resolved, which is why the scene is resolved into the Gif framebuffer first
+   glBindFramebuffer(GL_READ_FRAMEBUFFER, mGifFBO);
+   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mCaptureFBO);
+   glBlitFramebuffer(sourceX, sourceY, sourceX + static_cast<int>(widthOfViewport), sourceY + static_cast<int>(heightOfViewport),
+                     static_cast<int>(offsetX), static_cast<int>(offsetY), static_cast<int>(offsetX + scaledWidth), static_cast<int>(offsetY + scaledHeight),
+                     GL_COLOR_BUFFER_BIT, GL_LINEAR);
+}
+
 void Window::updateBufferAndViewportSizes()
 {
+   PROFILE_ZONE("Window::updateBufferAndViewportSizes");
+
    glfwGetWindowSize(mWindow, &mWidthOfWindowInPix, &mHeightOfWindowInPix);
    glfwGetFramebufferSize(mWindow, &mWidthOfFramebufferInPix, &mHeightOfFramebufferInPix);
 
@@ -1,7 +1,287 @@
-#include "game.h"
 #include "world.h"
-
+#include "allocation_tracker.h"
+#include "geometry.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cfenv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <tuple>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#include <pmmintrin.h>
+#endif
+
+namespace
+{
+   // Adds the wall-clock time and the hardware counts that elapse between its construction and its destruction to the statistics of a phase
+   // The hardware counters are only read when they are given
+   class ScopedPhaseTimer
+   {
+   public:
+
+      ScopedPhaseTimer(bool                    timingIsEnabled,
+                       const HardwareCounters* hardwareCounters,
+                       World::StepStatistics&  stepStatistics,
+                       World::SimulationPhase  phase)
+         : mTimingIsEnabled(timingIsEnabled)
+         , mHardwareCounters(hardwareCounters)
+         , mStepStatistics(stepStatistics)
+         , mPhaseIndex(static_cast<unsigned int>(phase))
+      {
+         if (mTimingIsEnabled)
+         {
+            mStart = std::chrono::steady_clock::now();
+         }
+
+         if (mHardwareCounters)
+         {
+            mStartCounts = mHardwareCounters->read();
+         }
+      }
+
+      ~ScopedPhaseTimer()
+      {
+         if (mHardwareCounters)
+         {
+            mStepStatistics.phaseCounts[mPhaseIndex] += mHardwareCounters->read() - mStartCounts;
+         }
+
+         if (mTimingIsEnabled)
+         {
+            mStepStatistics.phaseDurations[mPhaseIndex] += std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+         }
+      }
+
+      ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+      ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+   private:
+
+      bool                                  mTimingIsEnabled;
+      const HardwareCounters*               mHardwareCounters;
+      World::StepStatistics&                mStepStatistics;
+      unsigned int                          mPhaseIndex;
+      std::chrono::steady_clock::time_point mStart;
+      HardwareCounterValues                 mStartCounts;
+   };
+
+   // Switches to the default floating-point environment, which rounds to nearest and keeps denormals, and restores the environment of the caller on destruction
+   class ScopedDefaultFloatingPointEnvironment
+   {
+   public:
+
+      explicit ScopedDefaultFloatingPointEnvironment(bool isEnabled)
+         : mIsEnabled(isEnabled)
+      {
+         if (mIsEnabled)
+         {
+            std::fegetenv(&mCallerEnvironment);
+            std::fesetenv(FE_DFL_ENV);
+
+            // Not every C library resets the flush-to-zero and denormals-are-zero flags of SSE in FE_DFL_ENV
+#if defined(__SSE__) || defined(_M_X64)
+            _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_OFF);
+            _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_OFF);
+#endif
+         }
+      }
+
+      ~ScopedDefaultFloatingPointEnvironment()
+      {
+         if (mIsEnabled)
+         {
+            std::fesetenv(&mCallerEnvironment);
+         }
+      }
+
+      ScopedDefaultFloatingPointEnvironment(const ScopedDefaultFloatingPointEnvironment&) = delete;
+      ScopedDefaultFloatingPointEnvironment& operator=(const ScopedDefaultFloatingPointEnvironment&) = delete;
+
+   private:
+
+      bool        mIsEnabled;
+      std::fenv_t mCallerEnvironment;
+   };
+
+   // 64-bit FNV-1a
+   const std::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+   const std::uint64_t fnvPrime       = 1099511628211ULL;
+
+   std::uint64_t hashFloat(std::uint64_t hash, float value)
+   {
+      unsigned char bytes[sizeof(float)];
+      std::memcpy(bytes, &value, sizeof(float));
+      for (unsigned char byte : bytes)
+      {
+         hash = (hash ^ byte) * fnvPrime;
+      }
+
+      return hash;
+   }
+
+   // A substep that has been halved until it's shorter than this can't get rid of a penetration, which is reported as an unresolvable penetration error
+   const float smallestSubstepSize = 1e-6f;
+
+   // A body is swept when it moves more than its smallest dimension in a single substep, because only then can it pass through something without ending the substep inside of it
+   // Slower bodies are left to the subdivision of time, which is how the simulation behaves without sweeping
+   const float fastBodyDisplacementFraction = 1.0f;
+
+   // A swept vertex stops this far short of the edge that it would cross, which is half of the distance used to detect vertex-edge collisions
+   // Stopping outside of that distance leaves the contact undetected, and the next sweep can't move the vertex any closer
+   const float sweptVertexEdgeGap = 0.05f;
+
+   // Below this, the quadratic that gives the time at which a vertex crosses an edge is solved as a linear equation
+   const float quadraticCoefficientEpsilon = 1e-6f;
+
+   // The substeps that end at a predicted body-wall contact are never shorter than this, so that a body that rests on a wall doesn't stall the step
+   const float minPredictedSubstepSize = 1e-4f;
+
+   // Coefficients of the Bogacki-Shampine method, which embeds a 2nd order method in a 3rd order one
+   // The last stage evaluates the derivative at the 3rd order solution, and the 2nd order solution uses it to give an estimate of the local error
+   const float adaptiveStageWeights[4][3]    = {{0.0f,        0.0f,        0.0f},
+                                                {1.0f / 2.0f, 0.0f,        0.0f},
+                                                {0.0f,        3.0f / 4.0f, 0.0f},
+                                                {2.0f / 9.0f, 1.0f / 3.0f, 4.0f / 9.0f}};
+   const float adaptiveErrorWeights[4]       = {(2.0f / 9.0f) - (7.0f / 24.0f), (1.0f / 3.0f) - (1.0f / 4.0f), (4.0f / 9.0f) - (1.0f / 3.0f), -1.0f / 8.0f};
+
+   // The error of each quantity is compared to a tolerance made up of an absolute and a relative part
+   const float adaptiveAbsoluteTolerance     = 1e-3f;
+   const float adaptiveRelativeTolerance     = 1e-4f;
+
+   // The local error of the 2nd order method is of order 3, and the step is changed by at most these factors at a time so that it doesn't oscillate
+   const float adaptiveErrorExponent         = -1.0f / 3.0f;
+   const float adaptiveSafetyFactor          = 0.9f;
+   const float minAdaptiveStepScaleFactor    = 0.2f;
+   const float maxAdaptiveStepScaleFactor    = 5.0f;
+
+   float calculateCrossProduct(const glm::vec2& vecA, const glm::vec2& vecB)
+   {
+      return (vecA.x * vecB.y) - (vecA.y * vecB.x);
+   }
+
+   // Returns the smallest root of a * t^2 + b * t + c = 0 that lies in the interval [0, 1]
+   // If there isn't one, a value greater than 1 is returned
+   float calculateSmallestRootInUnitInterval(float a, float b, float c)
+   {
+      float smallestRoot = 2.0f;
+
+      if (std::abs(a) < quadraticCoefficientEpsilon)
+      {
+         // The equation is linear
+         if (std::abs(b) > quadraticCoefficientEpsilon)
+         {
+            smallestRoot = -c / b;
+         }
+      }
+      else
+      {
+         float discriminant = (b * b) - (4.0f * a * c);
+         if (discriminant >= 0.0f)
+         {
+            float sqrtOfDiscriminant = std::sqrt(discriminant);
+            float rootA = (-b - sqrtOfDiscriminant) / (2.0f * a);
+            float rootB = (-b + sqrtOfDiscriminant) / (2.0f * a);
+
+            if (rootA > rootB)
+            {
+               std::swap(rootA, rootB);
+            }
+
+            smallestRoot = (rootA >= 0.0f) ? rootA : rootB;
+         }
+      }
+
+      if ((smallestRoot < 0.0f) || (smallestRoot > 1.0f))
+      {
+         return 2.0f;
+      }
+
+      return smallestRoot;
+   }
+
+   // Sweeps the vertices of the sweeping body against the edges of the swept body
+   // Both bodies are assumed to move linearly from their current state to their future state, which is a good approximation as long as they don't rotate much in a single step
+   // The returned time of impact is a fraction of the step, and it is equal to 1 if the sweeping body doesn't hit the swept body
+   float calculateVertexEdgeTimeOfImpact(const RigidBody2D& sweepingBody, const RigidBody2D& sweptBody)
+   {
+      float timeOfImpact = 1.0f;
+
+      const RigidBody2D::KinematicAndDynamicState& sweepingBodyCurrentState = sweepingBody.mStates[0];
+      const RigidBody2D::KinematicAndDynamicState& sweepingBodyFutureState  = sweepingBody.mStates[1];
+      const RigidBody2D::KinematicAndDynamicState& sweptBodyCurrentState    = sweptBody.mStates[0];
+      const RigidBody2D::KinematicAndDynamicState& sweptBodyFutureState     = sweptBody.mStates[1];
+
+      for (int sweepingVertexIndex = 0; sweepingVertexIndex < 4; ++sweepingVertexIndex)
+      {
+         glm::vec2 vertexStartPoint    = sweepingBodyCurrentState.vertices[sweepingVertexIndex];
+         glm::vec2 vertexDisplacement  = sweepingBodyFutureState.vertices[sweepingVertexIndex] - vertexStartPoint;
+
+         for (int sweptVertexIndex = 0; sweptVertexIndex < 4; ++sweptVertexIndex)
+         {
+            // Calculate a CCWISE edge using adjacent vertices
+            int nextSweptVertexIndex = (sweptVertexIndex == 3) ? 0 : (sweptVertexIndex + 1);
+
+            glm::vec2 edgeStartPointAtStart = sweptBodyCurrentState.vertices[sweptVertexIndex];
+            glm::vec2 edgeStartPointAtEnd   = sweptBodyFutureState.vertices[sweptVertexIndex];
+            glm::vec2 edgeAtStart           = sweptBodyCurrentState.vertices[nextSweptVertexIndex] - edgeStartPointAtStart;
+            glm::vec2 edgeAtEnd             = sweptBodyFutureState.vertices[nextSweptVertexIndex] - edgeStartPointAtEnd;
+
+            // The edge and the vector that goes from its start point to the vertex change linearly with time:
+            // edge(t)          = edgeAtStart + (t * edgeChange)
+            // startToVertex(t) = startToVertexAtStart + (t * startToVertexChange)
+            glm::vec2 edgeChange           = edgeAtEnd - edgeAtStart;
+            glm::vec2 startToVertexAtStart = vertexStartPoint - edgeStartPointAtStart;
+            glm::vec2 startToVertexChange  = vertexDisplacement - (edgeStartPointAtEnd - edgeStartPointAtStart);
+
+            // The vertex is to the left of the CCWISE edge when cross(edge(t), startToVertex(t)) is positive
+            // Only a vertex that starts to the right of the edge (outside of the body) can enter the body through that edge
+            float c = calculateCrossProduct(edgeAtStart, startToVertexAtStart);
+            if (c >= 0.0f)
+            {
+               continue;
+            }
+
+            float b = calculateCrossProduct(edgeAtStart, startToVertexChange) + calculateCrossProduct(edgeChange, startToVertexAtStart);
+            float a = calculateCrossProduct(edgeChange, startToVertexChange);
+
+            float timeOfCrossing = calculateSmallestRootInUnitInterval(a, b, c);
+            if (timeOfCrossing >= timeOfImpact)
+            {
+               continue;
+            }
+
+            // The vertex must cross the edge itself, not the line that contains it
+            glm::vec2 edgeAtCrossing          = edgeAtStart + (timeOfCrossing * edgeChange);
+            glm::vec2 startToVertexAtCrossing = startToVertexAtStart + (timeOfCrossing * startToVertexChange);
+            float     positionAlongEdge       = glm::dot(startToVertexAtCrossing, edgeAtCrossing) / glm::dot(edgeAtCrossing, edgeAtCrossing);
+            if ((positionAlongEdge < 0.0f) || (positionAlongEdge > 1.0f))
+            {
+               continue;
+            }
+
+            // Back off so that the vertex stops just short of the edge, inside of the distance used to detect vertex-edge collisions
+            float relativeDisplacement = glm::length(startToVertexChange - (positionAlongEdge * edgeChange));
+            float timeBeforeCrossing   = timeOfCrossing - (sweptVertexEdgeGap / relativeDisplacement);
+
+            // If the vertex is already touching the edge, the regular collision detection takes care of it
+            if (timeBeforeCrossing > 0.0f)
+            {
+               timeOfImpact = timeBeforeCrossing;
+            }
+         }
+      }
+
+      return timeOfImpact;
+   }
+}
 
 World::World(std::vector<std::vector<Wall>>&&             wallScenes,
              const std::vector<std::vector<RigidBody2D>>& rigidBodyScenes)
@@ -12,69 +292,301 @@ World::World(std::vector<std::vector<Wall>>&&             wallScenes,
    , mBodyWallCollisions(mRigidBodies.size())
    , mVertexVertexCollisions(mRigidBodies.size())
    , mVertexEdgeCollisions(mRigidBodies.size())
+   , mResolvedLinearVelocities()
+   , mResolvedAngularVelocities()
+   , mResolvedCollisionNormals()
    , mChangeScene(false)
    , mSceneIndex(0)
    , mGravityState(0)
+   , mIntegrator(Integrator::rungeKutta4)
    , mCoefficientOfRestitution(1.0f)
+   , mContinuousCollisionDetectionIsEnabled(false)
+   , mSweptStates()
+   , mSweptStateTime(0.0f)
+   , mSweptStateStatistics()
+   , mSweptStateNumSubsteps(0)
+   , mSweptStateAdaptiveStepSize(0.0f)
+   , mBodyIsMovingFast()
+   , mFastBodyIndices()
+   , mAdaptiveTimeStepIsEnabled(false)
+   , mMaxAdaptiveStepSizeScale(4.0f)
+   , mAdaptiveStepSize(0.0f)
+   , mAdaptiveLeftoverTime(0.0f)
+   , mStageDerivatives()
+   , mDeterministicModeIsEnabled(false)
+   , mStepStatistics()
+   , mPhaseTimingIsEnabled(false)
+   , mHardwareCounters()
+   , mSubdivisionDiagnosticsAreEnabled(false)
+   , mSubdivisionRecords()
+   , mLastPenetration()
+   , mMetricsSink()
+   , mStepMetrics()
+   , mStepStart()
+   , mTrajectoryRecorder()
+   , mReplayBuffer()
+   , mForceGeneratorRegistry()
+   , mBodyBatch()
 {
+   resizeCollisionBuffers();
+   resetBodyBatch();
+}
 
+int World::simulate(float deltaTime)
+{
+   ScopedDefaultFloatingPointEnvironment floatingPointEnvironment(mDeterministicModeIsEnabled);
+
+   switch (mIntegrator)
+   {
+   case Integrator::rungeKutta4:
+      switch (mGravityState)
+      {
+      case 1:  return simulate<RungeKutta4Integrator, DownwardGravity>(deltaTime);
+      case 2:  return simulate<RungeKutta4Integrator, UpwardGravity>(deltaTime);
+      default: return simulate<RungeKutta4Integrator, NoGravity>(deltaTime);
+      }
+   case Integrator::semiImplicitEuler:
+      switch (mGravityState)
+      {
+      case 1:  return simulate<SemiImplicitEulerIntegrator, DownwardGravity>(deltaTime);
+      case 2:  return simulate<SemiImplicitEulerIntegrator, UpwardGravity>(deltaTime);
+      default: return simulate<SemiImplicitEulerIntegrator, NoGravity>(deltaTime);
+      }
+   case Integrator::velocityVerlet:
+      switch (mGravityState)
+      {
+      case 1:  return simulate<VelocityVerletIntegrator, DownwardGravity>(deltaTime);
+      case 2:  return simulate<VelocityVerletIntegrator, UpwardGravity>(deltaTime);
+      default: return simulate<VelocityVerletIntegrator, NoGravity>(deltaTime);
+      }
+   }
+
+   return 0; // No error
 }
 
+template<typename TIntegrator, typename TGravity>
 int World::simulate(float deltaTime)
 {
+   PROFILE_ZONE("World::simulate");
+   ALLOCATION_SCOPE("World::simulate");
+
+   mStepStatistics.numSteps++;
+   mSubdivisionRecords.clear();
+
+   mStepMetrics = StepMetrics();
+   if (mMetricsSink)
+   {
+      mStepStart = std::chrono::steady_clock::now();
+   }
+
+   // In adaptive mode a step can end past the end of the time step, and the difference is carried over to the next call
+   float endTime             = deltaTime;
+   float maxAdaptiveStepSize = mMaxAdaptiveStepSizeScale * deltaTime;
+   if (mAdaptiveTimeStepIsEnabled)
+   {
+      // The controller starts from the time step, and its step shrinks when the time step does
+      mAdaptiveStepSize = (mAdaptiveStepSize > 0.0f) ? std::min(mAdaptiveStepSize, maxAdaptiveStepSize) : deltaTime;
+      endTime          += mAdaptiveLeftoverTime;
+   }
+
    float currentTime = 0.0f;
-   float targetTime  = deltaTime;
+   float targetTime  = mAdaptiveTimeStepIsEnabled ? calculateAdaptiveTargetTime(currentTime) : endTime;
+
+   // The step size that is proposed by the error controller after the current substep
+   float proposedStepSize = mAdaptiveStepSize;
+
+   // We only sweep the bodies once per substep
+   // If jumping to the time of impact doesn't get rid of the penetration, we fall back to subdividing time
+   bool  sweptCurrentSubstep = false;
+   bool  sweepingIsEnabled   = mContinuousCollisionDetectionIsEnabled;
 
-   while (currentTime < deltaTime)
+   // The state before the first substep that sweeping shortened, which the step goes back to if it can't resolve a penetration after sweeping
+   bool  sweptStateIsSaved   = false;
+
+   while (currentTime < endTime)
    {
-      if ((targetTime - currentTime) < 1e-6) // TODO: Make threshold a constant
+      // Rejected and subdivided substeps show up as repeated zones
+      PROFILE_ZONE("World::simulate - Substep");
+
+      std::chrono::steady_clock::time_point substepStart;
+      if (mSubdivisionDiagnosticsAreEnabled)
+      {
+         substepStart = std::chrono::steady_clock::now();
+      }
+
+      if ((targetTime - currentTime) < smallestSubstepSize)
+      {
+         if (!sweptStateIsSaved)
+         {
+            return finishStep(1); // Unresolvable penetration error
+         }
+
+         // Sweeping can leave the bodies in contact in a way that subdividing time wouldn't, so the rest of the step is simulated again without it
+         restoreSweptState();
+         currentTime       = mSweptStateTime;
+         targetTime        = mAdaptiveTimeStepIsEnabled ? calculateAdaptiveTargetTime(currentTime) : endTime;
+         sweepingIsEnabled = false;
+         sweptStateIsSaved = false;
+         continue;
+      }
+
       {
-         return 1; // Unresolvable penetration error
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::forces);
+         PROFILE_ZONE("World::simulate - Forces");
+         computeForces<TGravity>(current);
       }
 
-      computeForces();
+      if (mAdaptiveTimeStepIsEnabled)
+      {
+         float stepSize      = targetTime - currentTime;
+         float errorEstimate = 0.0f;
+         {
+            ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::integration);
+            PROFILE_ZONE("World::simulate - Integration");
+            errorEstimate = integrateAdaptive<TGravity>(stepSize);
+         }
 
-      integrate(targetTime - currentTime);
+         float scaleFactor = (errorEstimate > 0.0f) ? (adaptiveSafetyFactor * std::pow(errorEstimate, adaptiveErrorExponent)) : maxAdaptiveStepScaleFactor;
+         scaleFactor       = std::min(maxAdaptiveStepScaleFactor, std::max(minAdaptiveStepScaleFactor, scaleFactor));
+
+         if (errorEstimate > 1.0f)
+         {
+            // The local error is too large, so we reject the step and try again with a smaller one
+            mAdaptiveStepSize = stepSize * scaleFactor;
+            targetTime        = currentTime + mAdaptiveStepSize;
+            mStepStatistics.numRejectedSteps++;
+            mStepMetrics.numRejectedSteps++;
+            continue;
+         }
+
+         // A step that was shortened ahead of a contact, by sweeping or by subdividing time doesn't tell us whether a longer one would be accurate
+         // That's why it can only shrink the step of the controller
+         if (targetTime < (currentTime + mAdaptiveStepSize))
+         {
+            proposedStepSize = (scaleFactor < 1.0f) ? (stepSize * scaleFactor) : mAdaptiveStepSize;
+         }
+         else
+         {
+            proposedStepSize = std::min(maxAdaptiveStepSize, stepSize * scaleFactor);
+         }
+      }
+      else
+      {
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::integration);
+         PROFILE_ZONE("World::simulate - Integration");
+         integrate<TIntegrator>(targetTime - currentTime);
+      }
 
       // Calculate the vertices of each rigid body at the target time
-      for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
       {
-         iter->calculateVertices(future);
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::vertices);
+         PROFILE_ZONE("World::simulate - Vertices");
+         for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+         {
+            iter->calculateVertices(future);
+         }
       }
 
-      if ((checkForBodyWallPenetration() == CollisionState::penetrating) ||
-          (checkForBodyBodyPenetration() == CollisionState::penetrating))
+      if (sweepingIsEnabled && !sweptCurrentSubstep)
+      {
+         sweptCurrentSubstep = true;
+
+         // Fast bodies can tunnel through other bodies, or they can overshoot walls by so much that many subdivisions are needed to find the contact
+         // To avoid that we sweep them and jump directly to the time of impact
+         float timeOfImpact = 1.0f;
+         {
+            ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::sweeping);
+            PROFILE_ZONE("World::simulate - Sweeping");
+            timeOfImpact = calculateTimeOfImpact();
+         }
+
+         if (timeOfImpact < 1.0f)
+         {
+            if (!sweptStateIsSaved)
+            {
+               saveSweptState(currentTime);
+               sweptStateIsSaved = true;
+            }
+
+            targetTime = currentTime + ((targetTime - currentTime) * timeOfImpact);
+            continue;
+         }
+      }
+
+      bool penetrating = false;
+      {
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::penetrationChecks);
+         PROFILE_ZONE("World::simulate - Penetration checks");
+         penetrating = (checkForBodyWallPenetration() == CollisionState::penetrating) ||
+                       (checkForBodyBodyPenetration() == CollisionState::penetrating);
+      }
+
+      if (penetrating)
       {
          // We simulated too far, so subdivide time and try again
          targetTime = (currentTime + targetTime) / 2.0f;
+         mStepStatistics.numSubdivisions++;
+         mStepMetrics.numSubdivisions++;
+
+         if (mSubdivisionDiagnosticsAreEnabled)
+         {
+            recordSubdivision(targetTime - currentTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - substepStart).count());
+         }
+
          continue;
       }
 
-      CollisionState bodyWallCollisionState = checkForBodyWallCollision();
+      CollisionState bodyWallCollisionState = CollisionState::clear;
+      {
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::collisionDetection);
+         PROFILE_ZONE("World::simulate - Body-wall collision detection");
+         bodyWallCollisionState = checkForBodyWallCollision();
+      }
+
       if (bodyWallCollisionState == CollisionState::colliding)
       {
-         int errorCode = resolveAllBodyWallCollisions();
+         int errorCode = 0;
+         {
+            ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::collisionResolution);
+            PROFILE_ZONE("World::simulate - Body-wall collision resolution");
+            errorCode = resolveAllBodyWallCollisions();
+         }
+
          if (errorCode != 0)
          {
-            return errorCode;
+            return finishStep(errorCode);
          }
       }
 
-      CollisionState vertexVertexCollisionState = checkForVertexVertexCollision();
-      CollisionState vertexEdgeCollisionState   = checkForVertexEdgeCollision();
+      CollisionState vertexVertexCollisionState = CollisionState::clear;
+      CollisionState vertexEdgeCollisionState   = CollisionState::clear;
+      {
+         ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::collisionDetection);
+         PROFILE_ZONE("World::simulate - Body-body collision detection");
+         vertexVertexCollisionState = checkForVertexVertexCollision();
+         vertexEdgeCollisionState   = checkForVertexEdgeCollision();
+      }
+
       if ((vertexVertexCollisionState == CollisionState::colliding) ||
           (vertexEdgeCollisionState   == CollisionState::colliding))
       {
-         int errorCode = resolveAllBodyBodyCollisions();
+         int errorCode = 0;
+         {
+            ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::collisionResolution);
+            PROFILE_ZONE("World::simulate - Body-body collision resolution");
+            errorCode = resolveAllBodyBodyCollisions();
+         }
+
          if (errorCode != 0)
          {
-            return errorCode;
+            return finishStep(errorCode);
          }
       }
 
       // We made a successful step, so swap configurations to save the data for the next step
+      recordAcceptedStep(targetTime - currentTime);
       currentTime = targetTime;
-      targetTime = deltaTime;
+      sweptCurrentSubstep = false;
 
       for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
       {
@@ -82,9 +594,24 @@ int World::simulate(float deltaTime)
          iter->mStates[0] = iter->mStates[1];
          iter->mStates[1] = tempState;
       }
+
+      if (mAdaptiveTimeStepIsEnabled)
+      {
+         mAdaptiveStepSize = proposedStepSize;
+         targetTime        = calculateAdaptiveTargetTime(currentTime);
+      }
+      else
+      {
+         targetTime = endTime;
+      }
    }
 
-   return 0; // No error
+   if (mAdaptiveTimeStepIsEnabled)
+   {
+      mAdaptiveLeftoverTime = endTime - currentTime;
+   }
+
+   return finishStep(0); // No error
 }
 
 void World::render(const Renderer2D& renderer2D, bool wireframe)
@@ -93,9 +620,11 @@ void World::render(const Renderer2D& renderer2D, bool wireframe)
    {
       mWalls = &mWallScenes[mSceneIndex];
       mRigidBodies = mRigidBodyScenes[mSceneIndex];
-      mBodyWallCollisions.resize(mRigidBodies.size());
-      mVertexVertexCollisions.resize(mRigidBodies.size());
-      mVertexEdgeCollisions.resize(mRigidBodies.size());
+      resizeCollisionBuffers();
+      resetBodyBatch();
+      resetStepStatistics();
+      mAdaptiveStepSize     = 0.0f;
+      mAdaptiveLeftoverTime = 0.0f;
       mChangeScene = false;
    }
 
@@ -121,199 +650,724 @@ void World::resetScene()
    mChangeScene = true;
 }
 
+void World::loadScene(int index, std::vector<Wall>&& walls, const std::vector<RigidBody2D>& rigidBodies)
+{
+   mWallScenes[index]      = std::move(walls);
+   mRigidBodyScenes[index] = rigidBodies;
+}
+
+void World::loadScene(int index, std::vector<Wall>&& walls, const RigidBody2D* rigidBodies, std::size_t numRigidBodies)
+{
+   mWallScenes[index] = std::move(walls);
+   mRigidBodyScenes[index].assign(rigidBodies, rigidBodies + numRigidBodies);
+}
+
 void World::setGravityState(int state)
 {
    mGravityState = state;
 }
 
+void World::setIntegrator(Integrator integrator)
+{
+   mIntegrator = integrator;
+}
+
 void World::setCoefficientOfRestitution(float coefficientOfRestitution)
 {
    mCoefficientOfRestitution = coefficientOfRestitution;
 }
 
-void World::computeForces()
+void World::enableContinuousCollisionDetection(bool enable)
 {
-   // Clear forces
-   for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+   mContinuousCollisionDetectionIsEnabled = enable;
+}
+
+void World::enableAdaptiveTimeStep(bool enable)
+{
+   mAdaptiveTimeStepIsEnabled = enable;
+   mAdaptiveStepSize          = 0.0f;
+   mAdaptiveLeftoverTime      = 0.0f;
+}
+
+void World::setMaxAdaptiveStepSizeScale(float scale)
+{
+   mMaxAdaptiveStepSizeScale = scale;
+}
+
+void World::enablePhaseTiming(bool enable)
+{
+   mPhaseTimingIsEnabled = enable;
+}
+
+bool World::enableHardwareCounters(bool enable)
+{
+   if (!enable)
+   {
+      mHardwareCounters.reset();
+      return true;
+   }
+
+   if (!mHardwareCounters)
+   {
+      std::unique_ptr<HardwareCounters> hardwareCounters = std::make_unique<HardwareCounters>();
+      if (!hardwareCounters->open())
+      {
+         return false;
+      }
+
+      mHardwareCounters = std::move(hardwareCounters);
+   }
+
+   return true;
+}
+
+bool World::hardwareCountersAreEnabled() const
+{
+   return static_cast<bool>(mHardwareCounters);
+}
+
+void World::printPhaseTable(const StepStatistics& stepStatistics, std::ostream& stream)
+{
+   std::ios::fmtflags oldFlags     = stream.flags();
+   std::streamsize    oldPrecision = stream.precision();
+
+   stream << std::left  << std::setw(22) << "phase"
+          << std::right << std::setw(12) << "seconds"
+          << std::setw(16) << "cycles"
+          << std::setw(16) << "instructions"
+          << std::setw(8)  << "IPC"
+          << std::setw(14) << "cache misses"
+          << std::setw(14) << "branch misses" << "\n";
+
+   for (unsigned int phase = 0; phase < static_cast<unsigned int>(SimulationPhase::numPhases); ++phase)
    {
-      RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[0];
+      const HardwareCounterValues& counts = stepStatistics.phaseCounts[phase];
+
+      double instructionsPerCycle = (counts.cycles > 0) ? (static_cast<double>(counts.instructions) / counts.cycles) : 0.0;
+
+      stream << std::left  << std::setw(22) << getPhaseName(static_cast<SimulationPhase>(phase))
+             << std::right << std::setw(12) << std::fixed << std::setprecision(6) << stepStatistics.phaseDurations[phase]
+             << std::setw(16) << counts.cycles
+             << std::setw(16) << counts.instructions
+             << std::setw(8)  << std::setprecision(2) << instructionsPerCycle
+             << std::setw(14) << counts.cacheMisses
+             << std::setw(14) << counts.branchMisses << "\n";
+   }
+
+   stream.flags(oldFlags);
+   stream.precision(oldPrecision);
+}
+
+const char* World::getPhaseName(SimulationPhase phase)
+{
+   switch (phase)
+   {
+   case SimulationPhase::forces:              return "forces";
+   case SimulationPhase::integration:         return "integration";
+   case SimulationPhase::vertices:            return "vertices";
+   case SimulationPhase::sweeping:            return "sweeping";
+   case SimulationPhase::penetrationChecks:   return "penetration_checks";
+   case SimulationPhase::collisionDetection:  return "collision_detection";
+   case SimulationPhase::collisionResolution: return "collision_resolution";
+   case SimulationPhase::metrics:             return "metrics";
+   default:                                   return "unknown";
+   }
+}
+
+void World::addForceGenerator(std::unique_ptr<ForceGenerator>&& generator)
+{
+   mForceGeneratorRegistry.add(std::move(generator));
+}
+
+void World::clearForceGenerators()
+{
+   mForceGeneratorRegistry.clear();
+}
+
+const std::vector<RigidBody2D>& World::getRigidBodies() const
+{
+   return mRigidBodies;
+}
+
+void World::setMetricsSink(const std::shared_ptr<MetricsSink>& metricsSink)
+{
+   mMetricsSink = metricsSink;
+}
+
+void World::setTrajectoryRecorder(const std::shared_ptr<TrajectoryRecorder>& trajectoryRecorder)
+{
+   mTrajectoryRecorder = trajectoryRecorder;
+}
+
+void World::setReplayBuffer(const std::shared_ptr<ReplayBuffer>& replayBuffer)
+{
+   mReplayBuffer = replayBuffer;
+}
 
-      currentState.torque = 0.0f;
+const StepMetrics& World::getStepMetrics() const
+{
+   return mStepMetrics;
+}
+
+void World::enableDeterministicMode(bool enable)
+{
+   mDeterministicModeIsEnabled = enable;
+}
+
+bool World::deterministicModeIsEnabled() const
+{
+   return mDeterministicModeIsEnabled;
+}
+
+std::uint64_t World::calculateStateHash() const
+{
+   std::uint64_t hash = fnvOffsetBasis;
+   for (std::vector<RigidBody2D>::const_iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[0];
+
+      hash = hashFloat(hash, currentState.positionOfCenterOfMass.x);
+      hash = hashFloat(hash, currentState.positionOfCenterOfMass.y);
+      hash = hashFloat(hash, currentState.orientation);
+      hash = hashFloat(hash, currentState.velocityOfCenterOfMass.x);
+      hash = hashFloat(hash, currentState.velocityOfCenterOfMass.y);
+      hash = hashFloat(hash, currentState.angularVelocity);
+   }
+
+   return hash;
+}
+
+const World::StepStatistics& World::getStepStatistics() const
+{
+   return mStepStatistics;
+}
+
+void World::resetStepStatistics()
+{
+   mStepStatistics = StepStatistics();
+}
+
+void World::enableSubdivisionDiagnostics(bool enable)
+{
+   mSubdivisionDiagnosticsAreEnabled = enable;
+   mSubdivisionRecords.clear();
+}
+
+bool World::subdivisionDiagnosticsAreEnabled() const
+{
+   return mSubdivisionDiagnosticsAreEnabled;
+}
+
+const std::vector<World::SubdivisionRecord>& World::getSubdivisionRecords() const
+{
+   return mSubdivisionRecords;
+}
 
-      if (mGravityState == 0)
+std::vector<World::SubdivisionCulprit> World::getSubdivisionReport() const
+{
+   // The key is the penetration type, the index of the penetrating body and the index of the wall or body that was penetrated
+   std::map<std::tuple<unsigned int, int, int>, SubdivisionCulprit> culprits;
+
+   for (std::vector<SubdivisionRecord>::const_iterator iter = mSubdivisionRecords.begin(); iter != mSubdivisionRecords.end(); ++iter)
+   {
+      std::tuple<unsigned int, int, int> key(static_cast<unsigned int>(iter->penetrationType), iter->penetratingBodyIndex, iter->penetratedIndex);
+
+      std::map<std::tuple<unsigned int, int, int>, SubdivisionCulprit>::iterator culpritIter = culprits.find(key);
+      if (culpritIter == culprits.end())
       {
-         currentState.forceOfCenterOfMass = glm::vec2(0.0f, 0.0f);
+         SubdivisionCulprit culprit;
+         culprit.penetrationType      = iter->penetrationType;
+         culprit.penetratingBodyIndex = iter->penetratingBodyIndex;
+         culprit.penetratedIndex      = iter->penetratedIndex;
+         culprit.minSubstepSize       = iter->substepSize;
+         culpritIter = culprits.emplace(key, culprit).first;
       }
-      else if (mGravityState == 1)
+
+      SubdivisionCulprit& culprit = culpritIter->second;
+      culprit.numSubdivisions++;
+      culprit.maxPenetrationDepth = std::max(culprit.maxPenetrationDepth, iter->penetrationDepth);
+      culprit.minSubstepSize      = std::min(culprit.minSubstepSize, iter->substepSize);
+      culprit.wastedSeconds      += iter->wastedSeconds;
+   }
+
+   std::vector<SubdivisionCulprit> report;
+   report.reserve(culprits.size());
+   for (std::map<std::tuple<unsigned int, int, int>, SubdivisionCulprit>::const_iterator iter = culprits.begin(); iter != culprits.end(); ++iter)
+   {
+      report.push_back(iter->second);
+   }
+
+   std::sort(report.begin(), report.end(), [](const SubdivisionCulprit& culpritA, const SubdivisionCulprit& culpritB)
+   {
+      if (culpritA.wastedSeconds != culpritB.wastedSeconds)
       {
-         currentState.forceOfCenterOfMass = glm::vec2(0.0f, -10.0f) / iter->mOneOverMass;
+         return culpritA.wastedSeconds > culpritB.wastedSeconds;
       }
-      else if (mGravityState == 2)
+
+      return culpritA.numSubdivisions > culpritB.numSubdivisions;
+   });
+
+   return report;
+}
+
+void World::printSubdivisionReport() const
+{
+   std::vector<SubdivisionCulprit> report = getSubdivisionReport();
+
+   std::cout << "Subdivision report - step: " << mStepStatistics.numSteps << ", subdivisions: " << mSubdivisionRecords.size() << "\n";
+
+   for (std::vector<SubdivisionCulprit>::const_iterator iter = report.begin(); iter != report.end(); ++iter)
+   {
+      if (iter->penetrationType == PenetrationType::bodyWall)
       {
-         currentState.forceOfCenterOfMass = glm::vec2(0.0f, 10.0f) / iter->mOneOverMass;
+         std::cout << "   body " << iter->penetratingBodyIndex << " into wall " << iter->penetratedIndex;
       }
+      else
+      {
+         std::cout << "   body " << iter->penetratingBodyIndex << " into body " << iter->penetratedIndex;
+      }
+
+      std::cout << " - subdivisions: "         << iter->numSubdivisions
+                << ", max penetration depth: " << iter->maxPenetrationDepth
+                << ", min substep size: "      << iter->minSubstepSize
+                << ", wasted time: "           << (iter->wastedSeconds * 1000.0) << " ms\n";
    }
 }
 
-/*
-void World::integrate(float deltaTime)
+void World::resizeCollisionBuffers()
 {
-   for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+   mBodyWallCollisions.resize(mRigidBodies.size());
+   mVertexVertexCollisions.resize(mRigidBodies.size());
+   mVertexEdgeCollisions.resize(mRigidBodies.size());
+   mResolvedLinearVelocities.resize(mRigidBodies.size());
+   mResolvedAngularVelocities.resize(mRigidBodies.size());
+   mResolvedCollisionNormals.resize(mRigidBodies.size());
+   mBodyIsMovingFast.resize(mRigidBodies.size());
+   mStageDerivatives.resize(mRigidBodies.size());
+   mFastBodyIndices.reserve(mRigidBodies.size());
+
+   // The buffers are cleared but never shrunk, so reserving room for a few collisions per body up front means that
+   // simulate only allocates when a body has more simultaneous collisions than it has ever had before
+   const std::size_t initialNumCollisionsPerBody = 8;
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      mBodyWallCollisions[i].reserve(initialNumCollisionsPerBody);
+      mVertexVertexCollisions[i].reserve(initialNumCollisionsPerBody);
+      mVertexEdgeCollisions[i].reserve(initialNumCollisionsPerBody);
+      mResolvedLinearVelocities[i].reserve(initialNumCollisionsPerBody);
+      mResolvedAngularVelocities[i].reserve(initialNumCollisionsPerBody);
+      mResolvedCollisionNormals[i].reserve(initialNumCollisionsPerBody);
+   }
+}
+
+void World::resetBodyBatch()
+{
+   mBodyBatch.resize(mRigidBodies.size());
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
    {
-      RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[0];
-      RigidBody2D::KinematicAndDynamicState& futureState  = iter->mStates[1];
+      mBodyBatch.masses[i] = 1.0f / mRigidBodies[i].mOneOverMass;
+   }
+}
 
-      // Calculate new position and velocity using Euler's method
+template<typename TGravity>
+void World::computeForces(RigidBodyState state)
+{
+   if (mForceGeneratorRegistry.isEmpty())
+   {
+      for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+      {
+         RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[state];
 
-      // X_n+1 = X_n + (h * V_n)
-      futureState.positionOfCenterOfMass = currentState.positionOfCenterOfMass + (currentState.velocityOfCenterOfMass * deltaTime);
+         currentState.torque              = 0.0f;
+         currentState.forceOfCenterOfMass = TGravity::calculateForce(iter->mOneOverMass);
+      }
 
-      // F = (d/dt)P = M * A
-      // A = F / M
-      // V_n+1 = V_n + (h * A) = V_n + (h * (F / M))
-      futureState.velocityOfCenterOfMass = currentState.velocityOfCenterOfMass + ((deltaTime * iter->mOneOverMass) * currentState.forceOfCenterOfMass);
+      return;
+   }
 
-      // Calculate new orientation and angular velocity using Euler's method
+   // Gather the state of the bodies into contiguous arrays, so that each force generator can process all of them in a single pass
+   // The masses are already in the batch, because they only change with the scene
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      const RigidBody2D&                           body         = mRigidBodies[i];
+      const RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[state];
+      glm::vec2                                    gravityForce = TGravity::calculateForce(body.mOneOverMass);
+
+      mBodyBatch.positionsX[i]        = currentState.positionOfCenterOfMass.x;
+      mBodyBatch.positionsY[i]        = currentState.positionOfCenterOfMass.y;
+      mBodyBatch.velocitiesX[i]       = currentState.velocityOfCenterOfMass.x;
+      mBodyBatch.velocitiesY[i]       = currentState.velocityOfCenterOfMass.y;
+      mBodyBatch.angularVelocities[i] = currentState.angularVelocity;
+      mBodyBatch.forcesX[i]           = gravityForce.x;
+      mBodyBatch.forcesY[i]           = gravityForce.y;
+      mBodyBatch.torques[i]           = 0.0f;
+   }
 
-      // O_n+1 = O_n + (h * W_n)
-      futureState.orientation = currentState.orientation + (currentState.angularVelocity * deltaTime);
+   mForceGeneratorRegistry.applyAll(mBodyBatch);
+
+   // Scatter the accumulated forces back into the bodies
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      RigidBody2D::KinematicAndDynamicState& currentState = mRigidBodies[i].mStates[state];
 
-      // T = (d/dt)L = I * Alpha
-      // Alpha = T / I
-      // W_n+1 = W_n + (h * Alpha) = W_n + (h * (T / I))
-      futureState.angularVelocity = currentState.angularVelocity + ((deltaTime * iter->mOneOverMomentOfInertia) * currentState.torque);
+      currentState.forceOfCenterOfMass = glm::vec2(mBodyBatch.forcesX[i], mBodyBatch.forcesY[i]);
+      currentState.torque              = mBodyBatch.torques[i];
    }
 }
-*/
 
+template<typename TIntegrator>
 void World::integrate(float deltaTime)
 {
    for (std::vector<RigidBody2D>::iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
    {
-      RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[0];
-      RigidBody2D::KinematicAndDynamicState& futureState  = iter->mStates[1];
+      TIntegrator::integrate(*iter, deltaTime);
+   }
+}
+
+template<typename TGravity>
+float World::integrateAdaptive(float deltaTime)
+{
+   // The first stage uses the forces of the current state, which the forces phase has already calculated
+   // Every other stage writes its state into the future state of each body and calculates the forces there, since they can depend on the positions and the velocities of all the bodies
+   for (int stage = 0; stage < numAdaptiveStages; ++stage)
+   {
+      if (stage > 0)
+      {
+         for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+         {
+            const RigidBody2D::KinematicAndDynamicState& currentState = mRigidBodies[i].mStates[0];
+            RigidBody2D::KinematicAndDynamicState&       stageState   = mRigidBodies[i].mStates[1];
+
+            stageState = currentState;
+            for (int previousStage = 0; previousStage < stage; ++previousStage)
+            {
+               const StateDerivative& derivative = mStageDerivatives[i][previousStage];
+               float                  weight     = deltaTime * adaptiveStageWeights[stage][previousStage];
+
+               stageState.positionOfCenterOfMass += weight * derivative.velocity;
+               stageState.orientation            += weight * derivative.angularVelocity;
+               stageState.velocityOfCenterOfMass += weight * derivative.acceleration;
+               stageState.angularVelocity        += weight * derivative.angularAcceleration;
+            }
+         }
+
+         computeForces<TGravity>(future);
+      }
+
+      RigidBodyState stageStateIndex = (stage == 0) ? current : future;
+      for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+      {
+         const RigidBody2D&                           body       = mRigidBodies[i];
+         const RigidBody2D::KinematicAndDynamicState& stageState = body.mStates[stageStateIndex];
+         StateDerivative&                             derivative = mStageDerivatives[i][stage];
+
+         derivative.velocity            = stageState.velocityOfCenterOfMass;
+         derivative.angularVelocity     = stageState.angularVelocity;
+         derivative.acceleration        = body.mOneOverMass * stageState.forceOfCenterOfMass;
+         derivative.angularAcceleration = body.mOneOverMomentOfInertia * stageState.torque;
+      }
+   }
+
+   // The last stage was evaluated at the 3rd order solution, which is the one that we keep, so the future states already hold it
+   // The difference between the 3rd and the 2nd order solutions is only used to estimate the error of the step
+   float maxNormalizedError = 0.0f;
+
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      const RigidBody2D::KinematicAndDynamicState& futureState = mRigidBodies[i].mStates[1];
 
-      float midPointOfDeltaTime = deltaTime / 2.0f;
+      glm::vec2 positionError        = glm::vec2(0.0f);
+      float     orientationError     = 0.0f;
+      glm::vec2 velocityError        = glm::vec2(0.0f);
+      float     angularVelocityError = 0.0f;
+      for (int stage = 0; stage < numAdaptiveStages; ++stage)
+      {
+         const StateDerivative& derivative = mStageDerivatives[i][stage];
+         float                  weight     = deltaTime * adaptiveErrorWeights[stage];
 
-      // Calculate new position and velocity using the classical 4th order Runge-Kutta method
+         positionError        += weight * derivative.velocity;
+         orientationError     += weight * derivative.angularVelocity;
+         velocityError        += weight * derivative.acceleration;
+         angularVelocityError += weight * derivative.angularAcceleration;
+      }
 
-      // We want to solve this 2nd order ODE:
-      // F = M * X^dotdot
-      // We can solve it by writing it as a system of two 1rst order ODEs:
-      // [X^dot] = [  V  ]
-      // [V^dot]   [F / M]
-      // Where we want to find the position (X) and the velocity (V)
+      maxNormalizedError = std::max(maxNormalizedError, glm::length(positionError)     / (adaptiveAbsoluteTolerance + (adaptiveRelativeTolerance * glm::length(futureState.positionOfCenterOfMass))));
+      maxNormalizedError = std::max(maxNormalizedError, glm::length(velocityError)     / (adaptiveAbsoluteTolerance + (adaptiveRelativeTolerance * glm::length(futureState.velocityOfCenterOfMass))));
+      maxNormalizedError = std::max(maxNormalizedError, std::abs(orientationError)     / (adaptiveAbsoluteTolerance + (adaptiveRelativeTolerance * std::abs(futureState.orientation))));
+      maxNormalizedError = std::max(maxNormalizedError, std::abs(angularVelocityError) / (adaptiveAbsoluteTolerance + (adaptiveRelativeTolerance * std::abs(futureState.angularVelocity))));
+   }
 
-      glm::vec2 k1Pos                     = currentState.velocityOfCenterOfMass;
-      glm::vec2 k1Vel                     = (iter->mOneOverMass * currentState.forceOfCenterOfMass);
+   return maxNormalizedError;
+}
 
-      glm::vec2 posAtMidPointOfDeltaTime1 = currentState.positionOfCenterOfMass + (k1Pos * midPointOfDeltaTime);
-      glm::vec2 velAtMidPointOfDeltaTime1 = currentState.velocityOfCenterOfMass + (k1Vel * midPointOfDeltaTime);
+float World::calculateAdaptiveTargetTime(float currentTime) const
+{
+   float stepSize = mAdaptiveStepSize;
 
-      glm::vec2 k2Pos                     = velAtMidPointOfDeltaTime1;
-      glm::vec2 k2Vel                     = (iter->mOneOverMass * currentState.forceOfCenterOfMass);
+   // Shrink the step ahead of contacts so that it ends when the first vertex reaches a wall, instead of overshooting and subdividing time
+   float timeUntilContact = calculateTimeUntilBodyWallContact();
+   if (timeUntilContact < stepSize)
+   {
+      stepSize = std::max(timeUntilContact, minPredictedSubstepSize);
+   }
 
-      glm::vec2 posAtMidPointOfDeltaTime2 = currentState.positionOfCenterOfMass + (k2Pos * midPointOfDeltaTime);
-      glm::vec2 velAtMidPointOfDeltaTime2 = currentState.velocityOfCenterOfMass + (k2Vel * midPointOfDeltaTime);
+   return currentTime + stepSize;
+}
 
-      glm::vec2 k3Pos                     = velAtMidPointOfDeltaTime2;
-      glm::vec2 k3Vel                     = (iter->mOneOverMass * currentState.forceOfCenterOfMass);
+float World::calculateTimeUntilBodyWallContact() const
+{
+   float timeUntilContact = std::numeric_limits<float>::max();
+   float depthEpsilon     = 1.0f;
 
-      glm::vec2 posAtDeltaTime            = currentState.positionOfCenterOfMass + (k3Pos * deltaTime);
-      glm::vec2 velAtDeltaTime            = currentState.velocityOfCenterOfMass + (k3Vel * deltaTime);
+   for (std::vector<RigidBody2D>::const_iterator bodyIter = mRigidBodies.begin(); bodyIter != mRigidBodies.end(); ++bodyIter)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = bodyIter->mStates[0];
 
-      glm::vec2 k4Pos                     = velAtDeltaTime;
-      glm::vec2 k4Vel                     = (iter->mOneOverMass * currentState.forceOfCenterOfMass);
+      for (int vertexIndex = 0; vertexIndex < 4; ++vertexIndex)
+      {
+         glm::vec2 vertexPos = currentState.vertices[vertexIndex];
+         glm::vec2 CMToVertex = vertexPos - currentState.positionOfCenterOfMass;
+         glm::vec2 CMToVertexPerpendicular = glm::vec2(-CMToVertex.y, CMToVertex.x);
+         glm::vec2 vertexVelocity = currentState.velocityOfCenterOfMass + (currentState.angularVelocity * CMToVertexPerpendicular);
 
-      glm::vec2 weightedAverageOfPositionSlopes = ((k1Pos + (2.0f * k2Pos) + (2.0f * k3Pos) + k4Pos) / 6.0f);
-      glm::vec2 weightedAverageOfVelocitySlopes = ((k1Vel + (2.0f * k2Vel) + (2.0f * k3Vel) + k4Vel) / 6.0f);
+         for (std::vector<Wall>::const_iterator wallIter = mWalls->begin(); wallIter != mWalls->end(); ++wallIter)
+         {
+            // dot((Pv - Po), N) = dot(Pv, N) - dot(Po, N) = dot(Pv, N) + C
+            float distanceFromVertexToClosestPointOnWall = glm::dot(vertexPos, wallIter->getNormal()) + wallIter->getC();
+            float approachSpeed                          = -glm::dot(vertexVelocity, wallIter->getNormal());
 
-      // P_n+1 = P_n + (h * weightedAverageOfPositionSlopes)
-      futureState.positionOfCenterOfMass = currentState.positionOfCenterOfMass + (weightedAverageOfPositionSlopes * deltaTime);
+            // Vertices that are already touching a wall are handled by the collision response, so we ignore them here
+            if ((distanceFromVertexToClosestPointOnWall > depthEpsilon) && (approachSpeed > 0.0f))
+            {
+               timeUntilContact = std::min(timeUntilContact, distanceFromVertexToClosestPointOnWall / approachSpeed);
+            }
+         }
+      }
+   }
 
-      // V_n+1 = V_n + (h * weightedAverageOfVelocitySlopes)
-      futureState.velocityOfCenterOfMass = currentState.velocityOfCenterOfMass + (weightedAverageOfVelocitySlopes * deltaTime);
+   return timeUntilContact;
+}
 
-      // Calculate new orientation and angular velocity using the classical 4th order Runge-Kutta method
+int World::finishStep(int errorCode)
+{
+   if (mTrajectoryRecorder)
+   {
+      PROFILE_ZONE("World::simulate - Trajectory");
+      mTrajectoryRecorder->push(mStepStatistics.numSteps, mStepStatistics.totalSimulatedTime, mRigidBodies);
+   }
 
-      // We want to solve this 2nd order ODE:
-      // T = I * O^dotdot
-      // We can solve it by writing it as a system of two 1rst order ODEs:
-      // [O^dot] = [  W  ]
-      // [W^dot]   [T / I]
-      // Where we want to find the orientation (O) and the angular velocity (W)
+   if (mReplayBuffer)
+   {
+      PROFILE_ZONE("World::simulate - Replay");
+      mReplayBuffer->push(mStepStatistics.numSteps, mStepStatistics.totalSimulatedTime, mRigidBodies);
+   }
 
-      float k1Ori                     = currentState.angularVelocity;
-      float k1Ang                     = (iter->mOneOverMomentOfInertia * currentState.torque);
+   if (!mMetricsSink)
+   {
+      return errorCode;
+   }
 
-      float oriAtMidPointOfDeltaTime1 = currentState.orientation + (k1Ori * midPointOfDeltaTime);
-      float angAtMidPointOfDeltaTime1 = currentState.angularVelocity + (k1Ang * midPointOfDeltaTime);
+   PROFILE_ZONE("World::simulate - Metrics");
+   ScopedPhaseTimer timer(mPhaseTimingIsEnabled, mHardwareCounters.get(), mStepStatistics, SimulationPhase::metrics);
 
-      float k2Ori                     = angAtMidPointOfDeltaTime1;
-      float k2Ang                     = (iter->mOneOverMomentOfInertia * currentState.torque);
+   mStepMetrics.stepIndex        = mStepStatistics.numSteps;
+   mStepMetrics.stepDurationInNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStepStart).count();
+   mStepMetrics.simulatedTime    = mStepStatistics.totalSimulatedTime;
+   mStepMetrics.errorCode        = errorCode;
 
-      float oriAtMidPointOfDeltaTime2 = currentState.orientation + (k2Ori * midPointOfDeltaTime);
-      float angAtMidPointOfDeltaTime2 = currentState.angularVelocity + (k2Ang * midPointOfDeltaTime);
+   // After a successful substep the current state is the first one
+   for (std::vector<RigidBody2D>::const_iterator iter = mRigidBodies.begin(); iter != mRigidBodies.end(); ++iter)
+   {
+      const RigidBody2D::KinematicAndDynamicState& currentState = iter->mStates[0];
+
+      float     mass            = 1.0f / iter->mOneOverMass;
+      float     momentOfInertia = 1.0f / iter->mOneOverMomentOfInertia;
+      glm::vec2 linearMomentum  = mass * currentState.velocityOfCenterOfMass;
+
+      mStepMetrics.kineticEnergy   += 0.5f * ((mass * glm::dot(currentState.velocityOfCenterOfMass, currentState.velocityOfCenterOfMass)) +
+                                              (momentOfInertia * currentState.angularVelocity * currentState.angularVelocity));
+      mStepMetrics.linearMomentumX += linearMomentum.x;
+      mStepMetrics.linearMomentumY += linearMomentum.y;
+      mStepMetrics.angularMomentum += (currentState.positionOfCenterOfMass.x * linearMomentum.y) -
+                                      (currentState.positionOfCenterOfMass.y * linearMomentum.x) +
+                                      (momentOfInertia * currentState.angularVelocity);
+   }
 
-      float k3Ori                     = angAtMidPointOfDeltaTime2;
-      float k3Ang                     = (iter->mOneOverMomentOfInertia * currentState.torque);
+   if (mDeterministicModeIsEnabled)
+   {
+      mStepMetrics.stateHash = calculateStateHash();
+   }
 
-      float oriAtDeltaTime            = currentState.orientation + (k3Ori * deltaTime);
-      float angAtDeltaTime            = currentState.angularVelocity + (k3Ang * deltaTime);
+   mMetricsSink->push(mStepMetrics);
 
-      float k4Ori                     = angAtDeltaTime;
-      float k4Ang                     = (iter->mOneOverMomentOfInertia * currentState.torque);
+   return errorCode;
+}
 
-      float weightedAverageOfOrientationSlopes = ((k1Ori + (2.0f * k2Ori) + (2.0f * k3Ori) + k4Ori) / 6.0f);
-      float weightedAverageOfAngularVelocitySlopes = ((k1Ang + (2.0f * k2Ang) + (2.0f * k3Ang) + k4Ang) / 6.0f);
+void World::recordSubdivision(float substepSize, double wastedSeconds)
+{
+   SubdivisionRecord record = mLastPenetration;
+   record.substepSize   = substepSize;
+   record.wastedSeconds = wastedSeconds;
+   mSubdivisionRecords.push_back(record);
+}
 
-      // O_n+1 = O_n + (h * W_n)
-      futureState.orientation = currentState.orientation + (weightedAverageOfOrientationSlopes * deltaTime);
+void World::recordAcceptedStep(float stepSize)
+{
+   mStepMetrics.numSubsteps++;
 
-      // T = (d/dt)L = I * Alpha
-      // Alpha = T / I
-      // W_n+1 = W_n + (h * Alpha) = W_n + (h * (T / I))
-      futureState.angularVelocity = currentState.angularVelocity + (weightedAverageOfAngularVelocitySlopes * deltaTime);
+   if (mStepStatistics.numAcceptedSteps == 0)
+   {
+      mStepStatistics.minStepSize = stepSize;
+      mStepStatistics.maxStepSize = stepSize;
    }
+   else
+   {
+      mStepStatistics.minStepSize = std::min(mStepStatistics.minStepSize, stepSize);
+      mStepStatistics.maxStepSize = std::max(mStepStatistics.maxStepSize, stepSize);
+   }
+
+   mStepStatistics.numAcceptedSteps++;
+   mStepStatistics.totalSimulatedTime += stepSize;
 }
 
-bool doesPointProjectOntoSegment(const glm::vec2& pointToTest, const glm::vec2& segmentStartPoint, const glm::vec2& segmentEndPoint)
+void World::saveSweptState(float currentTime)
 {
-   glm::vec2 segment = segmentEndPoint - segmentStartPoint;
+   mSweptStates.resize(mRigidBodies.size());
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      mSweptStates[i] = mRigidBodies[i].mStates[0];
+   }
 
-   // Project pointToTest onto segment, computing the parameterized position d(t) = segmentStartPoint + distFromSegStartPointToProjectedPointToTest * (segmentEndPoint - segmentStartPoint)
-   float distFromSegStartPointToProjectedPointToTest = glm::dot(pointToTest - segmentStartPoint, segment) / glm::dot(segment, segment);
+   mSweptStateTime             = currentTime;
+   mSweptStateStatistics       = mStepStatistics;
+   mSweptStateNumSubsteps      = mStepMetrics.numSubsteps;
+   mSweptStateAdaptiveStepSize = mAdaptiveStepSize;
+}
 
-   // If pointToTest projects outside of the segment, distFromSegStartPointToProjectedPointToTest is smaller than 0 or greater than 1
-   if ((distFromSegStartPointToProjectedPointToTest < 0.0f) || (distFromSegStartPointToProjectedPointToTest > 1.0f))
+void World::restoreSweptState()
+{
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
    {
-      return false;
+      mRigidBodies[i].mStates[0] = mSweptStates[i];
    }
 
-   return true;
+   // The substeps after the saved state are undone, but the time that was spent on them and their subdivisions still count
+   mStepStatistics.numAcceptedSteps   = mSweptStateStatistics.numAcceptedSteps;
+   mStepStatistics.minStepSize        = mSweptStateStatistics.minStepSize;
+   mStepStatistics.maxStepSize        = mSweptStateStatistics.maxStepSize;
+   mStepStatistics.totalSimulatedTime = mSweptStateStatistics.totalSimulatedTime;
+   mStepMetrics.numSubsteps           = mSweptStateNumSubsteps;
+   mAdaptiveStepSize                  = mSweptStateAdaptiveStepSize;
 }
 
-glm::vec2 calculateClosestPointOnSegmentToPoint(const glm::vec2& pointToTest, const glm::vec2& segmentStartPoint, const glm::vec2& segmentEndPoint)
+bool World::isBodyMovingFast(const RigidBody2D& body) const
 {
-   glm::vec2 segment = segmentEndPoint - segmentStartPoint;
+   const RigidBody2D::KinematicAndDynamicState& currentState = body.mStates[0];
+   const RigidBody2D::KinematicAndDynamicState& futureState  = body.mStates[1];
+
+   // The distance travelled by the vertices is bounded by the distance travelled by the center of mass plus the arc travelled by the farthest point of the body
+   float halfDiagonal = 0.5f * std::sqrt((body.mWidth * body.mWidth) + (body.mHeight * body.mHeight));
+   float displacement = glm::length(futureState.positionOfCenterOfMass - currentState.positionOfCenterOfMass) +
+                        (std::abs(futureState.orientation - currentState.orientation) * halfDiagonal);
+
+   return displacement > (fastBodyDisplacementFraction * std::min(body.mWidth, body.mHeight));
+}
 
-   // Project pointToTest onto segment, computing the parameterized position d(t) = segmentStartPoint + distFromSegStartPointToProjectedPointToTest * (segmentEndPoint - segmentStartPoint)
-   float distFromSegStartPointToProjectedPointToTest = glm::dot(pointToTest - segmentStartPoint, segment) / glm::dot(segment, segment);
+float World::calculateTimeOfImpact()
+{
+   float timeOfImpact = 1.0f;
 
-   // If pointToTest projects outside of the segment, distFromSegStartPointToProjectedPointToTest is smaller than 0 or greater than 1
-   // If this is the case, clamp distFromSegStartPointToProjectedPointToTest to the closest endpoint
-   if (distFromSegStartPointToProjectedPointToTest < 0.0f)
+   mFastBodyIndices.clear();
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
    {
-      distFromSegStartPointToProjectedPointToTest = 0.0f;
+      mBodyIsMovingFast[i] = isBodyMovingFast(mRigidBodies[i]);
+      if (mBodyIsMovingFast[i])
+      {
+         mFastBodyIndices.push_back(static_cast<int>(i));
+      }
    }
-   else if (distFromSegStartPointToProjectedPointToTest > 1.0f)
+
+   // Slow bodies are handled well by subdividing time, so we only sweep the walls and the pairs that involve at least one fast body
+   for (std::vector<int>::const_iterator fastBodyIter = mFastBodyIndices.begin(); fastBodyIter != mFastBodyIndices.end(); ++fastBodyIter)
    {
-      distFromSegStartPointToProjectedPointToTest = 1.0f;
+      int fastBodyIndex = *fastBodyIter;
+
+      timeOfImpact = std::min(timeOfImpact, calculateBodyWallTimeOfImpact(mRigidBodies[fastBodyIndex]));
+
+      for (int otherBodyIndex = 0; otherBodyIndex < static_cast<int>(mRigidBodies.size()); ++otherBodyIndex)
+      {
+         // A pair of fast bodies is only swept once, when the first of them is the fast body
+         if ((otherBodyIndex == fastBodyIndex) || (mBodyIsMovingFast[otherBodyIndex] && (otherBodyIndex < fastBodyIndex)))
+         {
+            continue;
+         }
+
+         timeOfImpact = std::min(timeOfImpact, calculateBodyBodyTimeOfImpact(mRigidBodies[fastBodyIndex], mRigidBodies[otherBodyIndex]));
+      }
+   }
+
+   return timeOfImpact;
+}
+
+float World::calculateBodyWallTimeOfImpact(const RigidBody2D& body) const
+{
+   float timeOfImpact = 1.0f;
+   float depthEpsilon = 1.0f;
+
+   for (int vertexIndex = 0; vertexIndex < 4; ++vertexIndex)
+   {
+      glm::vec2 vertexPosAtStart = body.mStates[0].vertices[vertexIndex];
+      glm::vec2 vertexPosAtEnd   = body.mStates[1].vertices[vertexIndex];
+
+      for (std::vector<Wall>::const_iterator wallIter = mWalls->begin(); wallIter != mWalls->end(); ++wallIter)
+      {
+         // dot((Pv - Po), N) = dot(Pv, N) - dot(Po, N) = dot(Pv, N) + C
+         float distanceAtStart = glm::dot(vertexPosAtStart, wallIter->getNormal()) + wallIter->getC();
+         float distanceAtEnd   = glm::dot(vertexPosAtEnd, wallIter->getNormal()) + wallIter->getC();
+
+         // We are only interested in vertices that start in front of the wall and end up penetrating it
+         if ((distanceAtStart <= 0.0f) || (distanceAtEnd >= -depthEpsilon))
+         {
+            continue;
+         }
+
+         // Since the distance changes linearly with time, we can calculate when the vertex touches the wall
+         // That time places the vertex in the middle of the region where collisions are detected
+         timeOfImpact = std::min(timeOfImpact, distanceAtStart / (distanceAtStart - distanceAtEnd));
+      }
+   }
+
+   return timeOfImpact;
+}
+
+float World::calculateBodyBodyTimeOfImpact(const RigidBody2D& bodyA, const RigidBody2D& bodyB) const
+{
+   // Calculate the bounding boxes of the volumes swept by the two bodies
+   glm::vec2 bodyAMin = bodyA.mStates[0].vertices[0];
+   glm::vec2 bodyAMax = bodyA.mStates[0].vertices[0];
+   glm::vec2 bodyBMin = bodyB.mStates[0].vertices[0];
+   glm::vec2 bodyBMax = bodyB.mStates[0].vertices[0];
+   for (int stateIndex = 0; stateIndex < 2; ++stateIndex)
+   {
+      for (int vertexIndex = 0; vertexIndex < 4; ++vertexIndex)
+      {
+         bodyAMin = glm::min(bodyAMin, bodyA.mStates[stateIndex].vertices[vertexIndex]);
+         bodyAMax = glm::max(bodyAMax, bodyA.mStates[stateIndex].vertices[vertexIndex]);
+         bodyBMin = glm::min(bodyBMin, bodyB.mStates[stateIndex].vertices[vertexIndex]);
+         bodyBMax = glm::max(bodyBMax, bodyB.mStates[stateIndex].vertices[vertexIndex]);
+      }
    }
 
-   glm::vec2 closestPointOnSegmentToPoint = segmentStartPoint + (distFromSegStartPointToProjectedPointToTest * segment);
+   // If the swept volumes don't overlap, the bodies can't collide
+   if ((bodyAMax.x < bodyBMin.x) || (bodyBMax.x < bodyAMin.x) ||
+       (bodyAMax.y < bodyBMin.y) || (bodyBMax.y < bodyAMin.y))
+   {
+      return 1.0f;
+   }
 
-   return closestPointOnSegmentToPoint;
+   // A vertex of body A can hit an edge of body B and vice versa
+   return std::min(calculateVertexEdgeTimeOfImpact(bodyA, bodyB),
+                   calculateVertexEdgeTimeOfImpact(bodyB, bodyA));
 }
 
 World::CollisionState World::checkForBodyWallPenetration()
@@ -356,6 +1410,12 @@ World::CollisionState World::checkForBodyWallPenetration()
                 (glm::length(vertexPos - closestPointOnWall) < depthEpsilon) &&
                 doesPointProjectOntoSegment(vertexPos, wallIter->getStartPoint(), wallIter->getEndPoint())*/) // TODO: Concave shape support
             {
+               mLastPenetration.penetrationType        = PenetrationType::bodyWall;
+               mLastPenetration.penetratingBodyIndex   = static_cast<int>(bodyIter - mRigidBodies.begin());
+               mLastPenetration.penetratingVertexIndex = vertexIndex;
+               mLastPenetration.penetratedIndex        = static_cast<int>(wallIter - mWalls->begin());
+               mLastPenetration.penetrationDepth       = -distanceFromVertexToClosestPointOnWall;
+
                return CollisionState::penetrating;
             }
          }
@@ -444,9 +1504,15 @@ int World::resolveAllBodyWallCollisions()
          continue;
       }
 
-      std::vector<glm::vec2> linearVelocities;
-      std::vector<float>     angularVelocities;
-      std::vector<glm::vec2> collisionNormals;
+      int collidingBodyIndex = static_cast<int>(bodyIter - mBodyWallCollisions.begin());
+
+      // The buffers are members that keep their capacity, so resolving collisions doesn't allocate once they have grown
+      std::vector<glm::vec2>& linearVelocities  = mResolvedLinearVelocities[collidingBodyIndex];
+      std::vector<float>&     angularVelocities = mResolvedAngularVelocities[collidingBodyIndex];
+      std::vector<glm::vec2>& collisionNormals  = mResolvedCollisionNormals[collidingBodyIndex];
+      linearVelocities.clear();
+      angularVelocities.clear();
+      collisionNormals.clear();
 
       // Loop over all the body-wall collisions of the current body
       for (bodyWallCollisionIter = bodyIter->begin(); bodyWallCollisionIter != bodyIter->end(); ++bodyWallCollisionIter)
@@ -464,6 +1530,9 @@ int World::resolveAllBodyWallCollisions()
             numTimesCollisionHasBeenResolved++;
          }
 
+         mStepMetrics.numBodyWallContacts++;
+         mStepMetrics.numSolverIterations += numTimesCollisionHasBeenResolved;
+
          if (numTimesCollisionHasBeenResolved >= 100)
          {
             return 2; // Unresolvable body-wall collision error
@@ -476,7 +1545,6 @@ int World::resolveAllBodyWallCollisions()
          collisionNormals.push_back((*bodyWallCollisionIter).collisionNormal);
       }
 
-      int collidingBodyIndex   = static_cast<int>(bodyIter - mBodyWallCollisions.begin());
       RigidBody2D& currentBody = mRigidBodies[collidingBodyIndex];
 
       // Compute the new direction of the body and the linear kinetic energy
@@ -511,7 +1579,7 @@ int World::resolveAllBodyWallCollisions()
       for (std::vector<float>::iterator angularVelocityIter = angularVelocities.begin(); angularVelocityIter != angularVelocities.end(); ++angularVelocityIter)
       {
          totalAngularVelocity    += *angularVelocityIter;
-         absTotalAngularVelocity += abs(*angularVelocityIter);
+         absTotalAngularVelocity += std::abs(*angularVelocityIter);
 
          float angularKineticEnergy = ((1 / 2.0f) * (1 / currentBody.mOneOverMomentOfInertia) * ((*angularVelocityIter) * (*angularVelocityIter)));
          if (*angularVelocityIter >= 0.0f)
@@ -535,7 +1603,7 @@ int World::resolveAllBodyWallCollisions()
 
       // This check prevents a body from rotating because of small precision errors
       // TODO: Use a constant for the threshold
-      if ((currentBody.mStates[1].angularVelocity == 0.0f) && (abs(avgAngularKineticEnergy) < 0.01f))
+      if ((currentBody.mStates[1].angularVelocity == 0.0f) && (std::abs(avgAngularKineticEnergy) < 0.01f))
       {
          avgAngularKineticEnergy = 0.0f;
       }
@@ -544,12 +1612,12 @@ int World::resolveAllBodyWallCollisions()
       float energyLostThroughCancellations = 0.0f;
       if (angularVelocities.size() > 1)
       {
-         energyLostThroughCancellations = absAvgAngularKineticEnergy - abs(avgAngularKineticEnergy); // TODO: Is abs necessary here?
+         energyLostThroughCancellations = absAvgAngularKineticEnergy - std::abs(avgAngularKineticEnergy); // TODO: Is abs necessary here?
       }
 
       // Update the linear and angular velocities of the body
-      currentBody.mStates[1].velocityOfCenterOfMass = sqrt(2 * (avgLinearKineticEnergy + energyLostThroughCancellations) * currentBody.mOneOverMass) * linearVelocityDirection;
-      currentBody.mStates[1].angularVelocity        = sqrt(2 * abs(avgAngularKineticEnergy) * currentBody.mOneOverMomentOfInertia) * (ccwiseRotation ? 1.0f : -1.0f);
+      currentBody.mStates[1].velocityOfCenterOfMass = std::sqrt(2 * (avgLinearKineticEnergy + energyLostThroughCancellations) * currentBody.mOneOverMass) * linearVelocityDirection;
+      currentBody.mStates[1].angularVelocity        = std::sqrt(2 * std::abs(avgAngularKineticEnergy) * currentBody.mOneOverMomentOfInertia) * (ccwiseRotation ? 1.0f : -1.0f);
 
       // Since all the body-wall collisions of the current body have been resolved we can delete them
       mBodyWallCollisions[collidingBodyIndex].clear();
@@ -721,6 +1789,24 @@ World::CollisionState World::checkForBodyBodyPenetration()
 
             if (penetrating)
             {
+               // The penetration depth is the distance from the vertex to the closest edge of body B
+               float penetrationDepth = std::numeric_limits<float>::max();
+               for (int bodyBVertexIndex = 0; bodyBVertexIndex < 4; ++bodyBVertexIndex)
+               {
+                  glm::vec2 edgeStart = bodyIterB->mStates[1].vertices[bodyBVertexIndex];
+                  glm::vec2 edgeEnd   = bodyIterB->mStates[1].vertices[(bodyBVertexIndex + 1) % 4];
+                  glm::vec2 edge      = edgeEnd - edgeStart;
+
+                  float distanceToEdge = glm::dot(bodyIterA->mStates[1].vertices[bodyAVertexIndex] - edgeStart, glm::vec2(-edge.y, edge.x)) / glm::length(edge);
+                  penetrationDepth = std::min(penetrationDepth, distanceToEdge);
+               }
+
+               mLastPenetration.penetrationType        = PenetrationType::bodyBody;
+               mLastPenetration.penetratingBodyIndex   = static_cast<int>(bodyIterA - mRigidBodies.begin());
+               mLastPenetration.penetratingVertexIndex = bodyAVertexIndex;
+               mLastPenetration.penetratedIndex        = static_cast<int>(bodyIterB - mRigidBodies.begin());
+               mLastPenetration.penetrationDepth       = penetrationDepth;
+
                return CollisionState::penetrating;
             }
          }
@@ -920,9 +2006,16 @@ int World::resolveAllBodyBodyCollisions()
    std::vector<VertexVertexCollision>::iterator vertexVertexCollisionIter;
    std::vector<VertexEdgeCollision>::iterator   vertexEdgeCollisionIter;
 
-   std::vector<std::vector<glm::vec2>> linearVelocities(mRigidBodies.size());
-   std::vector<std::vector<float>>     angularVelocities(mRigidBodies.size());
-   std::vector<std::vector<glm::vec2>> collisionNormals(mRigidBodies.size());
+   // The buffers are members that keep their capacity, so resolving collisions doesn't allocate once they have grown
+   std::vector<std::vector<glm::vec2>>& linearVelocities  = mResolvedLinearVelocities;
+   std::vector<std::vector<float>>&     angularVelocities = mResolvedAngularVelocities;
+   std::vector<std::vector<glm::vec2>>& collisionNormals  = mResolvedCollisionNormals;
+   for (std::size_t i = 0; i < mRigidBodies.size(); ++i)
+   {
+      linearVelocities[i].clear();
+      angularVelocities[i].clear();
+      collisionNormals[i].clear();
+   }
 
    // Loop over all the bodies
    for (int bodyIndex = 0; bodyIndex < mRigidBodies.size(); ++bodyIndex)
@@ -960,6 +2053,9 @@ int World::resolveAllBodyBodyCollisions()
             numTimesCollisionHasBeenResolved++;
          }
 
+         mStepMetrics.numBodyBodyContacts++;
+         mStepMetrics.numSolverIterations += numTimesCollisionHasBeenResolved;
+
          if (numTimesCollisionHasBeenResolved >= 100)
          {
             return 3; // Unresolvable vertex-vertex collision error
@@ -1005,6 +2101,9 @@ int World::resolveAllBodyBodyCollisions()
             numTimesCollisionHasBeenResolved++;
          }
 
+         mStepMetrics.numBodyBodyContacts++;
+         mStepMetrics.numSolverIterations += numTimesCollisionHasBeenResolved;
+
          if (numTimesCollisionHasBeenResolved >= 100)
          {
             return 4; // Unresolvable vertex-edge collision error
@@ -1077,7 +2176,7 @@ int World::resolveAllBodyBodyCollisions()
       for (std::vector<float>::iterator angularVelocityIter = angularVelocities[bodyIndex].begin(); angularVelocityIter != angularVelocities[bodyIndex].end(); ++angularVelocityIter)
       {
          totalAngularVelocity    += *angularVelocityIter;
-         absTotalAngularVelocity += abs(*angularVelocityIter);
+         absTotalAngularVelocity += std::abs(*angularVelocityIter);
 
          float angularKineticEnergy = ((1 / 2.0f) * (1 / currentBody.mOneOverMomentOfInertia) * ((*angularVelocityIter) * (*angularVelocityIter)));
          if (*angularVelocityIter >= 0.0f)
@@ -1101,7 +2200,7 @@ int World::resolveAllBodyBodyCollisions()
 
       // This check prevents a body from rotating because of small precision errors
       // TODO: Use a constant for the threshold
-      if ((currentBody.mStates[1].angularVelocity == 0.0f) && (abs(avgAngularKineticEnergy) < 0.01f))
+      if ((currentBody.mStates[1].angularVelocity == 0.0f) && (std::abs(avgAngularKineticEnergy) < 0.01f))
       {
          avgAngularKineticEnergy = 0.0f;
       }
@@ -1110,12 +2209,12 @@ int World::resolveAllBodyBodyCollisions()
       float energyLostThroughCancellations = 0.0f;
       if (angularVelocities[bodyIndex].size() > 1)
       {
-         energyLostThroughCancellations = absAvgAngularKineticEnergy - abs(avgAngularKineticEnergy); // TODO: Is abs necessary here?
+         energyLostThroughCancellations = absAvgAngularKineticEnergy - std::abs(avgAngularKineticEnergy); // TODO: Is abs necessary here?
       }
 
       // Update the linear and angular velocities of the body
-      currentBody.mStates[1].velocityOfCenterOfMass = sqrt(2 * (avgLinearKineticEnergy + energyLostThroughCancellations) * currentBody.mOneOverMass) * linearVelocityDirection;
-      currentBody.mStates[1].angularVelocity        = sqrt(2 * abs(avgAngularKineticEnergy) * currentBody.mOneOverMomentOfInertia) * (ccwiseRotation ? 1.0f : -1.0f);
+      currentBody.mStates[1].velocityOfCenterOfMass = std::sqrt(2 * (avgLinearKineticEnergy + energyLostThroughCancellations) * currentBody.mOneOverMass) * linearVelocityDirection;
+      currentBody.mStates[1].angularVelocity        = std::sqrt(2 * std::abs(avgAngularKineticEnergy) * currentBody.mOneOverMomentOfInertia) * (ccwiseRotation ? 1.0f : -1.0f);
    }
 
    return 0; // No error
@@ -1429,6 +2528,44 @@ bool World::isVertexEdgeCollisionResolved(const VertexEdgeCollision& vertexEdgeC
    return true;
 }
 
+World::StepStatistics::StepStatistics()
+   : numSteps(0)
+   , numAcceptedSteps(0)
+   , numRejectedSteps(0)
+   , numSubdivisions(0)
+   , minStepSize(0.0f)
+   , maxStepSize(0.0f)
+   , totalSimulatedTime(0.0f)
+   , phaseDurations()
+   , phaseCounts()
+{
+
+}
+
+World::SubdivisionRecord::SubdivisionRecord()
+   : penetrationType(PenetrationType::bodyWall)
+   , penetratingBodyIndex(-1)
+   , penetratingVertexIndex(-1)
+   , penetratedIndex(-1)
+   , penetrationDepth(0.0f)
+   , substepSize(0.0f)
+   , wastedSeconds(0.0)
+{
+
+}
+
+World::SubdivisionCulprit::SubdivisionCulprit()
+   : penetrationType(PenetrationType::bodyWall)
+   , penetratingBodyIndex(-1)
+   , penetratedIndex(-1)
+   , numSubdivisions(0)
+   , maxPenetrationDepth(0.0f)
+   , minSubstepSize(0.0f)
+   , wastedSeconds(0.0)
+{
+
+}
+
 World::BodyWallCollision::BodyWallCollision()
    : collisionNormal(glm::vec2(0.0f))
    , collidingBodyIndex(0)
@@ -1497,3 +2634,16 @@ World::VertexEdgeCollision::VertexEdgeCollision(const glm::vec2& collisionNormal
 {
 
 }
+
+template int World::simulate<RungeKutta4Integrator,       NoGravity>(float deltaTime);
+template int World::simulate<RungeKutta4Integrator,       DownwardGravity>(float deltaTime);
+template int World::simulate<RungeKutta4Integrator,       UpwardGravity>(float deltaTime);
+template int World::simulate<SemiImplicitEulerIntegrator, NoGravity>(float deltaTime);
+template int World::simulate<SemiImplicitEulerIntegrator, DownwardGravity>(float deltaTime);
+template int World::simulate<SemiImplicitEulerIntegrator, UpwardGravity>(float deltaTime);
+template int World::simulate<VelocityVerletIntegrator,    NoGravity>(float deltaTime);
+template int World::simulate<VelocityVerletIntegrator,    DownwardGravity>(float deltaTime);
+template int World::simulate<VelocityVerletIntegrator,    UpwardGravity>(float deltaTime);
+
+// The primitive microbenchmark measures the forces phase on its own
+template void World::computeForces<NoGravity>(RigidBodyState state);
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gravity.h"
+#include "world.h"
+
+// This benchmark compares the accuracy and the cost of each integrator policy in two situations:
+// - Free flight under gravity, where the exact trajectory of each body is known
+// - A box full of bouncing bodies, where the drift of the total energy measures the accuracy
+
+namespace
+{
+   // The acceleration of a body under DownwardGravity, which is the same for any mass
+   const glm::vec2 gravitationalAcceleration = DownwardGravity::calculateForce(1.0f);
+
+   std::vector<RigidBody2D> createFreeFlightBodies(int numBodies)
+   {
+      std::vector<RigidBody2D> bodies;
+      bodies.reserve(numBodies);
+
+      // All the bodies move with the same linear velocity and are far apart, so they never collide
+      for (int i = 0; i < numBodies; ++i)
+      {
+         glm::vec2 position(200.0f * (i % 32), 200.0f * (i / 32));
+         float     angularVelocity = 0.1f * static_cast<float>(i % 7);
+         bodies.push_back(RigidBody2D(10.0f, 40.0f, 20.0f, 1.0f, position, 0.0f, glm::vec2(30.0f, 50.0f), angularVelocity, glm::vec3(1.0f)));
+      }
+
+      return bodies;
+   }
+
+   std::vector<RigidBody2D> createBouncingBodies(int numBodiesPerSide)
+   {
+      std::vector<RigidBody2D> bodies;
+      bodies.reserve(numBodiesPerSide * numBodiesPerSide);
+
+      for (int i = 0; i < numBodiesPerSide; ++i)
+      {
+         for (int j = 0; j < numBodiesPerSide; ++j)
+         {
+            glm::vec2 position(-150.0f + (300.0f * i / (numBodiesPerSide - 1)), -150.0f + (300.0f * j / (numBodiesPerSide - 1)));
+            glm::vec2 velocity(40.0f * std::cos(static_cast<float>(i + (3 * j))), 40.0f * std::sin(static_cast<float>((2 * i) + j)));
+            bodies.push_back(RigidBody2D(10.0f, 20.0f, 10.0f, 1.0f, position, 0.3f * (i + j), velocity, 0.0f, glm::vec3(1.0f)));
+         }
+      }
+
+      return bodies;
+   }
+
+   std::vector<Wall> createBox(float halfSize)
+   {
+      std::vector<Wall> walls;
+      walls.push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2(-halfSize,  halfSize), glm::vec2( halfSize,  halfSize))); // Top
+      walls.push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2( halfSize, -halfSize), glm::vec2(-halfSize, -halfSize))); // Bottom
+      walls.push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2( halfSize,  halfSize), glm::vec2( halfSize, -halfSize))); // Right
+      walls.push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2(-halfSize, -halfSize), glm::vec2(-halfSize,  halfSize))); // Left
+      return walls;
+   }
+
+   float calculateTotalEnergy(const std::vector<RigidBody2D>& bodies)
+   {
+      float totalEnergy = 0.0f;
+
+      for (std::vector<RigidBody2D>::const_iterator iter = bodies.begin(); iter != bodies.end(); ++iter)
+      {
+         const RigidBody2D::KinematicAndDynamicState& state = iter->mStates[0];
+
+         float mass             = 1.0f / iter->mOneOverMass;
+         float momentOfInertia  = 1.0f / iter->mOneOverMomentOfInertia;
+
+         totalEnergy += 0.5f * mass * glm::dot(state.velocityOfCenterOfMass, state.velocityOfCenterOfMass);
+         totalEnergy += 0.5f * momentOfInertia * state.angularVelocity * state.angularVelocity;
+         totalEnergy -= mass * glm::dot(gravitationalAcceleration, state.positionOfCenterOfMass);
+      }
+
+      return totalEnergy;
+   }
+
+   // Measures the cost of the integrator on its own, without the collision detection and response that surrounds it in World::simulate
+   template<typename TIntegrator>
+   double measureNanosecondsPerBodyStep(int numBodies, int numSteps, float timeStep)
+   {
+      std::vector<RigidBody2D> bodies = createFreeFlightBodies(numBodies);
+      for (std::vector<RigidBody2D>::iterator iter = bodies.begin(); iter != bodies.end(); ++iter)
+      {
+         iter->mStates[0].forceOfCenterOfMass = DownwardGravity::calculateForce(iter->mOneOverMass);
+         iter->mStates[0].torque              = 0.0f;
+      }
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      for (int step = 0; step < numSteps; ++step)
+      {
+         for (std::vector<RigidBody2D>::iterator iter = bodies.begin(); iter != bodies.end(); ++iter)
+         {
+            TIntegrator::integrate(*iter, timeStep);
+            iter->mStates[0].positionOfCenterOfMass = iter->mStates[1].positionOfCenterOfMass;
+            iter->mStates[0].velocityOfCenterOfMass = iter->mStates[1].velocityOfCenterOfMass;
+            iter->mStates[0].orientation            = iter->mStates[1].orientation;
+            iter->mStates[0].angularVelocity        = iter->mStates[1].angularVelocity;
+         }
+      }
+
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      // Use the result so that the compiler can't discard the loop
+      volatile float sink = bodies[0].mStates[0].positionOfCenterOfMass.x;
+      (void)sink;
+
+      return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(numBodies) * numSteps);
+   }
+
+   template<typename TIntegrator>
+   void runFreeFlight(const std::string& name, float timeStep, float duration)
+   {
+      const int numBodies = 64;
+
+      std::vector<std::vector<Wall>>        wallScenes(1);
+      std::vector<std::vector<RigidBody2D>> rigidBodyScenes(1, createFreeFlightBodies(numBodies));
+
+      World world(std::move(wallScenes), rigidBodyScenes);
+
+      int numSteps  = static_cast<int>(std::round(duration / timeStep));
+      int errorCode = 0;
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      for (int step = 0; (step < numSteps) && (errorCode == 0); ++step)
+      {
+         errorCode = world.simulate<TIntegrator, DownwardGravity>(timeStep);
+      }
+
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      // X(t) = X_0 + (V_0 * t) + ((G * t^2) / 2)
+      float simulatedTime   = numSteps * timeStep;
+      float maxPositionError = 0.0f;
+      for (int i = 0; i < numBodies; ++i)
+      {
+         const RigidBody2D::KinematicAndDynamicState& initialState = rigidBodyScenes[0][i].mStates[0];
+         glm::vec2 exactPosition = initialState.positionOfCenterOfMass +
+                                   (initialState.velocityOfCenterOfMass * simulatedTime) +
+                                   (gravitationalAcceleration * (0.5f * simulatedTime * simulatedTime));
+
+         maxPositionError = std::max(maxPositionError, glm::length(world.getRigidBodies()[i].mStates[0].positionOfCenterOfMass - exactPosition));
+      }
+
+      double microsecondsPerStep = std::chrono::duration<double, std::micro>(end - start).count() / numSteps;
+
+      std::cout << std::left  << std::setw(22) << name
+                << std::right << std::setw(10) << timeStep
+                << std::setw(16) << maxPositionError
+                << std::setw(16) << microsecondsPerStep
+                << std::setw(8)  << errorCode << "\n";
+   }
+
+   template<typename TIntegrator>
+   void runBouncingBox(const std::string& name, float timeStep, float duration)
+   {
+      std::vector<std::vector<Wall>> wallScenes(1);
+      wallScenes[0] = createBox(200.0f);
+
+      std::vector<std::vector<RigidBody2D>> rigidBodyScenes(1, createBouncingBodies(6));
+
+      World world(std::move(wallScenes), rigidBodyScenes);
+      world.setCoefficientOfRestitution(1.0f);
+
+      float initialEnergy = calculateTotalEnergy(world.getRigidBodies());
+
+      int numSteps  = static_cast<int>(std::round(duration / timeStep));
+      int errorCode = 0;
+      int step      = 0;
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      for (; (step < numSteps) && (errorCode == 0); ++step)
+      {
+         errorCode = world.simulate<TIntegrator, DownwardGravity>(timeStep);
+      }
+
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      float finalEnergy         = calculateTotalEnergy(world.getRigidBodies());
+      float relativeEnergyDrift = std::abs(finalEnergy - initialEnergy) / std::abs(initialEnergy);
+
+      double microsecondsPerStep = std::chrono::duration<double, std::micro>(end - start).count() / step;
+
+      std::cout << std::left  << std::setw(22) << name
+                << std::right << std::setw(10) << timeStep
+                << std::setw(16) << relativeEnergyDrift
+                << std::setw(16) << microsecondsPerStep
+                << std::setw(8)  << errorCode << "\n";
+   }
+
+   void printHeader(const std::string& title, const std::string& errorColumn)
+   {
+      std::cout << "\n" << title << "\n";
+      std::cout << std::left  << std::setw(22) << "Integrator"
+                << std::right << std::setw(10) << "Step"
+                << std::setw(16) << errorColumn
+                << std::setw(16) << "us/step"
+                << std::setw(8)  << "Error" << "\n";
+   }
+}
+
+int main()
+{
+   std::cout << std::setprecision(4);
+
+   const int numBodies = 1024;
+   const int numSteps  = 2000;
+
+   std::cout << "Integration only (" << numBodies << " bodies, " << numSteps << " steps)\n";
+   std::cout << std::left  << std::setw(22) << "Integrator" << std::right << std::setw(16) << "ns/body-step" << "\n";
+   std::cout << std::left  << std::setw(22) << "Runge-Kutta 4"       << std::right << std::setw(16) << measureNanosecondsPerBodyStep<RungeKutta4Integrator>(numBodies, numSteps, 0.02f)       << "\n";
+   std::cout << std::left  << std::setw(22) << "Semi-Implicit Euler" << std::right << std::setw(16) << measureNanosecondsPerBodyStep<SemiImplicitEulerIntegrator>(numBodies, numSteps, 0.02f) << "\n";
+   std::cout << std::left  << std::setw(22) << "Velocity Verlet"     << std::right << std::setw(16) << measureNanosecondsPerBodyStep<VelocityVerletIntegrator>(numBodies, numSteps, 0.02f)    << "\n";
+
+   const float timeSteps[] = {0.005f, 0.02f, 0.05f};
+
+   printHeader("Free flight under gravity (64 bodies, 10 seconds)", "Max pos error");
+   for (float timeStep : timeSteps)
+   {
+      runFreeFlight<RungeKutta4Integrator>("Runge-Kutta 4", timeStep, 10.0f);
+      runFreeFlight<SemiImplicitEulerIntegrator>("Semi-Implicit Euler", timeStep, 10.0f);
+      runFreeFlight<VelocityVerletIntegrator>("Velocity Verlet", timeStep, 10.0f);
+   }
+
+   printHeader("Bouncing bodies in a box under gravity (36 bodies, 20 seconds)", "Energy drift");
+   for (float timeStep : timeSteps)
+   {
+      runBouncingBox<RungeKutta4Integrator>("Runge-Kutta 4", timeStep, 20.0f);
+      runBouncingBox<SemiImplicitEulerIntegrator>("Semi-Implicit Euler", timeStep, 20.0f);
+      runBouncingBox<VelocityVerletIntegrator>("Velocity Verlet", timeStep, 20.0f);
+   }
+
+   return 0;
+}
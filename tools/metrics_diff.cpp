@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "metrics_sink.h"
+
+// This tool compares two metrics files that were recorded in deterministic mode, and reports the first step where the states of the two runs diverge
+// The records are compared in the order in which they were written, so the two runs must simulate the same scenes with the same time step for the same number of steps
+// The files can be in either metrics format, and they don't need to be in the same one
+//
+// Usage: MetricsDiff reference.csv|reference.bin candidate.csv|candidate.bin
+//
+// The exit code is 0 when the runs are identical, 1 when they diverge and 2 when the files can't be compared
+
+namespace
+{
+   void printRecord(const std::string& label, const StepMetrics& metrics)
+   {
+      std::cout << std::left << std::setw(12) << label << std::right
+                << " state hash "       << std::hex << std::setw(16) << std::setfill('0') << metrics.stateHash << std::dec << std::setfill(' ')
+                << ", simulated time "  << metrics.simulatedTime
+                << ", kinetic energy "  << metrics.kineticEnergy
+                << ", linear momentum " << metrics.linearMomentumX << " " << metrics.linearMomentumY
+                << ", angular momentum " << metrics.angularMomentum
+                << ", contacts "         << metrics.numBodyWallContacts << " " << metrics.numBodyBodyContacts
+                << ", substeps "         << metrics.numSubsteps
+                << ", subdivisions "     << metrics.numSubdivisions
+                << ", rejected steps "   << metrics.numRejectedSteps
+                << ", error code "       << metrics.errorCode << "\n";
+   }
+
+   bool containsStateHashes(const std::vector<StepMetrics>& records)
+   {
+      for (const StepMetrics& metrics : records)
+      {
+         if (metrics.stateHash != 0)
+         {
+            return true;
+         }
+      }
+
+      return false;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   if (argc != 3)
+   {
+      std::cout << "Usage: MetricsDiff reference.csv|reference.bin candidate.csv|candidate.bin" << "\n";
+      return 2;
+   }
+
+   std::vector<StepMetrics> referenceRecords;
+   std::vector<StepMetrics> candidateRecords;
+   if (!MetricsSink::read(argv[1], referenceRecords) || !MetricsSink::read(argv[2], candidateRecords))
+   {
+      return 2;
+   }
+
+   if (!containsStateHashes(referenceRecords) || !containsStateHashes(candidateRecords))
+   {
+      std::cout << "Error - MetricsDiff - Both runs must be recorded in deterministic mode, since otherwise the records don't contain state hashes" << "\n";
+      return 2;
+   }
+
+   std::size_t numCommonRecords = std::min(referenceRecords.size(), candidateRecords.size());
+   for (std::size_t i = 0; i < numCommonRecords; ++i)
+   {
+      const StepMetrics& reference = referenceRecords[i];
+      const StepMetrics& candidate = candidateRecords[i];
+
+      // Dropped records or different step budgets make the two streams go out of step
+      if (reference.stepIndex != candidate.stepIndex)
+      {
+         std::cout << "Error - MetricsDiff - Record " << i << " is step " << reference.stepIndex << " in the reference and step " << candidate.stepIndex << " in the candidate" << "\n";
+         return 2;
+      }
+
+      if (reference.stateHash != candidate.stateHash)
+      {
+         std::cout << "The runs diverge at step " << reference.stepIndex << " (record " << i << ")\n";
+         printRecord("Reference:", reference);
+         printRecord("Candidate:", candidate);
+
+         if (i > 0)
+         {
+            std::cout << "The previous step " << referenceRecords[i - 1].stepIndex << " is identical in both runs\n";
+         }
+
+         return 1;
+      }
+   }
+
+   std::cout << "The runs are identical for " << numCommonRecords << " steps\n";
+
+   if (referenceRecords.size() != candidateRecords.size())
+   {
+      std::cout << "The reference has " << referenceRecords.size() << " records and the candidate has " << candidateRecords.size() << "\n";
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,273 @@
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scene.h"
+#include "software_renderer_2D.h"
+#include "stb_image_write.h"
+#include "trajectory_reader.h"
+
+// This tool renders the frames of a recorded trajectory to PNG files without a window or an OpenGL context
+// The walls, the sizes and the colors of the bodies come from the scene that was recorded, and the positions and the orientations come from the trajectory
+// The frames are split into one contiguous range per thread, so each thread decodes its range in order from a single keyframe
+// The PNG files are numbered from 0, so they can be turned into a GIF at the frame rate of the Record GIF checkbox with:
+//
+//    ffmpeg -y -framerate 50 -i output_directory/%d.png output.gif
+//
+// Usage: OfflineRenderer scene.scene|scene.bin input.traj output_directory [--width W] [--height H] [--samples N] [--threads N] [--first F] [--last L] [--every N] [--line-width W]
+//
+// The image has the dimensions of the scene by default, and if only one of --width and --height is given the other one follows the aspect ratio of the scene
+// --samples is the number of antialiasing samples per pixel, which is rounded down to a square number
+// --first, --last and --every select the frames of the trajectory, so --every 2 renders every other step
+// --line-width is the width of the walls in pixels, which by default grows with the resolution so that the walls look like they do in the window
+
+namespace
+{
+   struct Options
+   {
+      std::string   sceneFilePath;
+      std::string   trajectoryFilePath;
+      std::string   outputDirectory;
+      int           widthInPix      = 0;
+      int           heightInPix     = 0;
+      int           samplesPerPixel = 16;
+      int           numThreads      = 0;
+      std::uint64_t firstFrame      = 0;
+      std::uint64_t lastFrame       = ~std::uint64_t(0);
+      std::uint64_t frameInterval   = 1;
+      float         lineWidthInPix  = 0.0f;
+   };
+
+   bool parseOptions(int argc, char* argv[], Options& options)
+   {
+      if (argc < 4)
+      {
+         return false;
+      }
+
+      options.sceneFilePath      = argv[1];
+      options.trajectoryFilePath = argv[2];
+      options.outputDirectory    = argv[3];
+
+      for (int i = 4; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+         if (i + 1 >= argc)
+         {
+            std::cout << "Error - OfflineRenderer - Missing value for " << argument << "\n";
+            return false;
+         }
+
+         std::string value = argv[++i];
+         if (argument == "--width")
+         {
+            options.widthInPix = std::atoi(value.c_str());
+         }
+         else if (argument == "--height")
+         {
+            options.heightInPix = std::atoi(value.c_str());
+         }
+         else if (argument == "--samples")
+         {
+            options.samplesPerPixel = std::atoi(value.c_str());
+         }
+         else if (argument == "--threads")
+         {
+            options.numThreads = std::atoi(value.c_str());
+         }
+         else if (argument == "--first")
+         {
+            options.firstFrame = std::strtoull(value.c_str(), nullptr, 10);
+         }
+         else if (argument == "--last")
+         {
+            options.lastFrame = std::strtoull(value.c_str(), nullptr, 10);
+         }
+         else if (argument == "--every")
+         {
+            options.frameInterval = std::max(std::strtoull(value.c_str(), nullptr, 10), 1ull);
+         }
+         else if (argument == "--line-width")
+         {
+            options.lineWidthInPix = static_cast<float>(std::atof(value.c_str()));
+         }
+         else
+         {
+            std::cout << "Error - OfflineRenderer - Unknown argument " << argument << "\n";
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // Renders the frames from firstOutputIndex to lastOutputIndex, and returns the number of frames that failed
+   int renderFrames(const Options& options, const Scene& scene, const std::vector<std::uint64_t>& frameIndices, std::size_t firstOutputIndex, std::size_t lastOutputIndex, std::atomic<int>& numRenderedFrames)
+   {
+      // Each thread has its own reader, since a reader keeps the state of its decoder
+      TrajectoryReader reader;
+      if (!reader.open(options.trajectoryFilePath))
+      {
+         return static_cast<int>(lastOutputIndex - firstOutputIndex);
+      }
+
+      SoftwareRenderer2D renderer(options.widthInPix, options.heightInPix, scene.dimensions, options.samplesPerPixel);
+      TrajectoryFrame    frame;
+      int                numFailedFrames = 0;
+
+      for (std::size_t outputIndex = firstOutputIndex; outputIndex < lastOutputIndex; ++outputIndex)
+      {
+         if (!reader.readFrame(frameIndices[outputIndex], frame))
+         {
+            ++numFailedFrames;
+            continue;
+         }
+
+         if (frame.positions.size() != scene.rigidBodies.size())
+         {
+            std::cout << "Error - OfflineRenderer - Frame " << frame.frameIndex << " has " << frame.positions.size() << " bodies, but the scene has " << scene.rigidBodies.size() << "\n";
+            ++numFailedFrames;
+            continue;
+         }
+
+         renderer.clear();
+
+         for (const Wall& wall : scene.walls)
+         {
+            renderer.renderLine(wall.getStartPoint(), wall.getEndPoint(), options.lineWidthInPix);
+         }
+
+         for (std::size_t i = 0; i < frame.positions.size(); ++i)
+         {
+            const RigidBody2D& rigidBody = scene.rigidBodies[i];
+            renderer.renderRigidBody(frame.positions[i], frame.orientations[i], rigidBody.mWidth, rigidBody.mHeight, rigidBody.mColor);
+         }
+
+         std::string imageFilePath = options.outputDirectory + "/" + std::to_string(outputIndex) + ".png";
+         if (!stbi_write_png(imageFilePath.c_str(), renderer.getWidthInPix(), renderer.getHeightInPix(), 3, renderer.getPixels().data(), renderer.getWidthInPix() * 3))
+         {
+            std::cout << "Error - OfflineRenderer - Failed to write " << imageFilePath << "\n";
+            ++numFailedFrames;
+            continue;
+         }
+
+         numRenderedFrames.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      return numFailedFrames;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   Options options;
+   if (!parseOptions(argc, argv, options))
+   {
+      std::cout << "Usage: OfflineRenderer scene.scene|scene.bin input.traj output_directory [--width W] [--height H] [--samples N] [--threads N] [--first F] [--last L] [--every N] [--line-width W]" << "\n";
+      return 1;
+   }
+
+   Scene scene;
+   if (!scene.load(options.sceneFilePath))
+   {
+      return 1;
+   }
+
+   TrajectoryReader reader;
+   if (!reader.open(options.trajectoryFilePath))
+   {
+      return 1;
+   }
+
+   // Fit the image to the aspect ratio of the scene when only one of its dimensions is given
+   if ((options.widthInPix <= 0) && (options.heightInPix <= 0))
+   {
+      options.widthInPix  = static_cast<int>(scene.dimensions.x);
+      options.heightInPix = static_cast<int>(scene.dimensions.y);
+   }
+   else if (options.heightInPix <= 0)
+   {
+      options.heightInPix = static_cast<int>(options.widthInPix * (scene.dimensions.y / scene.dimensions.x));
+   }
+   else if (options.widthInPix <= 0)
+   {
+      options.widthInPix = static_cast<int>(options.heightInPix * (scene.dimensions.x / scene.dimensions.y));
+   }
+
+   // The window draws lines one pixel wide at the size of the scene
+   if (options.lineWidthInPix <= 0.0f)
+   {
+      options.lineWidthInPix = std::max(std::min(options.widthInPix / scene.dimensions.x, options.heightInPix / scene.dimensions.y), 1.0f);
+   }
+
+   std::vector<std::uint64_t> frameIndices;
+   std::uint64_t              lastFrame = std::min(options.lastFrame, reader.getNumFrames() - 1);
+   for (std::uint64_t frameIndex = options.firstFrame; frameIndex <= lastFrame; frameIndex += options.frameInterval)
+   {
+      frameIndices.push_back(frameIndex);
+   }
+
+   if (frameIndices.empty())
+   {
+      std::cout << "Error - OfflineRenderer - The trajectory has " << reader.getNumFrames() << " frames, so there is nothing to render" << "\n";
+      return 1;
+   }
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+   _mkdir(options.outputDirectory.c_str());
+#else
+   mkdir(options.outputDirectory.c_str(), 0775);
+#endif
+
+   // The frames are flat colors, so skipping the per-row filter search makes the PNG files both faster to write and smaller
+   stbi_write_force_png_filter = 0;
+
+   int numThreads = (options.numThreads > 0) ? options.numThreads : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+   numThreads     = std::min(numThreads, static_cast<int>(frameIndices.size()));
+
+   std::cout << "Rendering " << frameIndices.size() << " frames at " << options.widthInPix << "x" << options.heightInPix << " with " << options.samplesPerPixel << " samples per pixel on " << numThreads << " threads" << "\n";
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   std::atomic<int>         numRenderedFrames(0);
+   std::vector<int>         numFailedFrames(numThreads, 0);
+   std::vector<std::thread> threads;
+   for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+   {
+      std::size_t firstOutputIndex = (frameIndices.size() * threadIndex) / numThreads;
+      std::size_t lastOutputIndex  = (frameIndices.size() * (threadIndex + 1)) / numThreads;
+      threads.emplace_back([&options, &scene, &frameIndices, firstOutputIndex, lastOutputIndex, &numRenderedFrames, &numFailedFrames, threadIndex]()
+      {
+         numFailedFrames[threadIndex] = renderFrames(options, scene, frameIndices, firstOutputIndex, lastOutputIndex, numRenderedFrames);
+      });
+   }
+
+   for (std::thread& thread : threads)
+   {
+      thread.join();
+   }
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "Rendered " << numRenderedFrames.load() << " frames in " << seconds << " seconds, " << (numRenderedFrames.load() / seconds) << " frames per second" << "\n";
+
+   for (int failedFrames : numFailedFrames)
+   {
+      if (failedFrames != 0)
+      {
+         return 1;
+      }
+   }
+
+   return 0;
+}
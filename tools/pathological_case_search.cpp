@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "scene.h"
+#include "scene_library.h"
+#include "world.h"
+
+// This tool searches for initial conditions of the scenes in resources/scenes, or in another scene directory, that make World::simulate expensive
+// Each trial randomizes the positions, orientations and velocities of the bodies of a scene, without overlaps and without crossing a wall, and simulates it for a number of steps
+// The cost of a step is the number of substeps that were accepted, rejected or subdivided, plus the number of iterations of the loops that resolve collisions
+// The trials with the most expensive worst step are saved as scene files in a corpus directory, along with a corpus.csv file that describes them
+// Each trial is simulated from the text that is saved, so the files reproduce the trials exactly
+//
+// Usage: PathologicalCaseSearch [--help] [--scene-directory directory] [--scenes Hexagon,Octagon] [--trials N] [--steps N] [--gravity random|0|1|2] [--max-speed S] [--max-angular-speed W] [--seed N] [--keep N] [--corpus directory]
+//        PathologicalCaseSearch --replay file.scene[,file.scene] [--steps N]
+//
+// Without --scenes, every scene of the scene directory is searched
+// With --keep, the N most expensive trials of each scene that simulate every step without an error are kept
+// A trial that stops with an error is a failure of the simulation rather than an expensive case, so it's only reported, with the trial index that repeats it
+// With --replay, the given scene files are simulated and their costs are written as CSV rows, which makes a corpus usable as a performance regression test
+
+namespace
+{
+   struct Options
+   {
+      std::string              sceneDirectory  = "resources/scenes";
+      std::vector<std::string> sceneNames;
+      int                      numTrials       = 200;
+      int                      numSteps        = 150;
+      std::string              gravity         = "random";
+      float                    maxSpeed        = 200.0f;
+      float                    maxAngularSpeed = 5.0f;
+      unsigned int             seed            = 1;
+      int                      numKept         = 5;
+      std::string              corpusDirectory = "corpus";
+      std::vector<std::string> replayFilePaths;
+   };
+
+   struct TrialCost
+   {
+      TrialCost()
+         : numSteps(0)
+         , errorCode(0)
+         , worstStep(0)
+         , worstStepWork(0)
+         , worstStepSubsteps(0)
+         , worstStepSubdivisions(0)
+         , worstStepSolverIterations(0)
+         , worstStepSeconds(0.0)
+         , totalWork(0)
+      {
+
+      }
+
+      int           numSteps;
+      int           errorCode;
+      int           worstStep;
+      std::uint64_t worstStepWork;
+      std::uint32_t worstStepSubsteps;
+      std::uint32_t worstStepSubdivisions;
+      std::uint32_t worstStepSolverIterations;
+      double        worstStepSeconds;
+      std::uint64_t totalWork;
+   };
+
+   struct Trial
+   {
+      int         trialIndex;
+      int         gravityState;
+      std::string sceneText;
+      TrialCost   cost;
+   };
+
+   std::vector<std::string> split(const std::string& list)
+   {
+      std::vector<std::string> items;
+      std::stringstream        stream(list);
+      std::string              item;
+      while (std::getline(stream, item, ','))
+      {
+         if (!item.empty())
+         {
+            items.push_back(item);
+         }
+      }
+
+      return items;
+   }
+
+   void printUsage()
+   {
+      std::cout << "Usage: PathologicalCaseSearch [--help] [--scene-directory directory] [--scenes Hexagon,Octagon] [--trials N] [--steps N] [--gravity random|0|1|2]"
+                   " [--max-speed S] [--max-angular-speed W] [--seed N] [--keep N] [--corpus directory]\n"
+                   "       PathologicalCaseSearch --replay file.scene[,file.scene] [--steps N]\n";
+   }
+
+   // Returns false if the search shouldn't run, and sets exitCode to what it should return instead
+   bool parseOptions(int argc, char* argv[], Options& options, int& exitCode)
+   {
+      exitCode = 1;
+
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+         if ((argument == "--help") || (argument == "-h"))
+         {
+            printUsage();
+            exitCode = 0;
+            return false;
+         }
+      }
+
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+         if (i + 1 >= argc)
+         {
+            std::cout << "Error - PathologicalCaseSearch - Missing value for " << argument << "\n";
+            printUsage();
+            return false;
+         }
+
+         std::string value = argv[++i];
+         if (argument == "--scene-directory")
+         {
+            options.sceneDirectory = value;
+         }
+         else if (argument == "--scenes")
+         {
+            options.sceneNames = split(value);
+         }
+         else if (argument == "--trials")
+         {
+            options.numTrials = std::atoi(value.c_str());
+         }
+         else if (argument == "--steps")
+         {
+            options.numSteps = std::atoi(value.c_str());
+         }
+         else if (argument == "--gravity")
+         {
+            options.gravity = value;
+         }
+         else if (argument == "--max-speed")
+         {
+            options.maxSpeed = static_cast<float>(std::atof(value.c_str()));
+         }
+         else if (argument == "--max-angular-speed")
+         {
+            options.maxAngularSpeed = static_cast<float>(std::atof(value.c_str()));
+         }
+         else if (argument == "--seed")
+         {
+            options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+         }
+         else if (argument == "--keep")
+         {
+            options.numKept = std::atoi(value.c_str());
+         }
+         else if (argument == "--corpus")
+         {
+            options.corpusDirectory = value;
+         }
+         else if (argument == "--replay")
+         {
+            options.replayFilePaths = split(value);
+         }
+         else
+         {
+            std::cout << "Error - PathologicalCaseSearch - Unknown argument " << argument << "\n";
+            printUsage();
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // Hexagon becomes hexagon and Stack Being Hit becomes stack_being_hit
+   std::string toFileName(const std::string& sceneName)
+   {
+      std::string fileName;
+      for (char character : sceneName)
+      {
+         fileName += (character == ' ') ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+      }
+
+      return fileName;
+   }
+
+   // The gap that is left between the bodies and between the bodies and the walls, so that they don't start in contact
+   const float placementGap = 1.0f;
+
+   // Walls are treated as infinite lines by the simulation, so a body is inside of a scene when its vertices are on the inner side of every wall
+   bool isBodyInsideWalls(const std::vector<Wall>& walls, const RigidBody2D& body)
+   {
+      for (const Wall& wall : walls)
+      {
+         for (const glm::vec2& vertex : body.mStates[0].vertices)
+         {
+            if ((glm::dot(vertex, wall.getNormal()) + wall.getC()) <= placementGap)
+            {
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
+
+   // Two rectangles don't overlap when the projections of their vertices onto one of their edge normals are separated
+   bool doBodiesOverlap(const RigidBody2D& bodyA, const RigidBody2D& bodyB)
+   {
+      const std::array<glm::vec2, 4>& verticesA = bodyA.mStates[0].vertices;
+      const std::array<glm::vec2, 4>& verticesB = bodyB.mStates[0].vertices;
+
+      for (int polygon = 0; polygon < 2; ++polygon)
+      {
+         const std::array<glm::vec2, 4>& edgeVertices = (polygon == 0) ? verticesA : verticesB;
+         for (std::size_t i = 0; i < 2; ++i)
+         {
+            glm::vec2 edge = edgeVertices[i + 1] - edgeVertices[i];
+            glm::vec2 axis = glm::normalize(glm::vec2(-edge.y, edge.x));
+
+            float minA =  std::numeric_limits<float>::max();
+            float maxA = -std::numeric_limits<float>::max();
+            float minB =  std::numeric_limits<float>::max();
+            float maxB = -std::numeric_limits<float>::max();
+            for (std::size_t j = 0; j < 4; ++j)
+            {
+               float projectionA = glm::dot(verticesA[j], axis);
+               float projectionB = glm::dot(verticesB[j], axis);
+               minA = std::min(minA, projectionA);
+               maxA = std::max(maxA, projectionA);
+               minB = std::min(minB, projectionB);
+               maxB = std::max(maxB, projectionB);
+            }
+
+            if (((minB - maxA) > placementGap) || ((minA - maxB) > placementGap))
+            {
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
+
+   // The bodies are placed one at a time at random positions that don't overlap the walls or the bodies that were placed before them
+   // If no position is found for a body it keeps its original position, as long as that doesn't overlap either
+   bool randomizeScene(Scene& scene, const Options& options, std::mt19937& generator)
+   {
+      glm::vec2 minCorner( std::numeric_limits<float>::max());
+      glm::vec2 maxCorner(-std::numeric_limits<float>::max());
+      for (const Wall& wall : scene.walls)
+      {
+         minCorner = glm::min(minCorner, glm::min(wall.getStartPoint(), wall.getEndPoint()));
+         maxCorner = glm::max(maxCorner, glm::max(wall.getStartPoint(), wall.getEndPoint()));
+      }
+
+      std::uniform_real_distribution<float> xDistribution(minCorner.x, maxCorner.x);
+      std::uniform_real_distribution<float> yDistribution(minCorner.y, maxCorner.y);
+      std::uniform_real_distribution<float> angleDistribution(0.0f, 6.2831853f);
+      std::uniform_real_distribution<float> speedDistribution(0.0f, options.maxSpeed);
+      std::uniform_real_distribution<float> angularVelocityDistribution(-options.maxAngularSpeed, options.maxAngularSpeed);
+
+      const int maxNumAttempts = 1000;
+
+      for (std::size_t bodyIndex = 0; bodyIndex < scene.rigidBodies.size(); ++bodyIndex)
+      {
+         RigidBody2D& body = scene.rigidBodies[bodyIndex];
+
+         float orientation     = angleDistribution(generator);
+         float direction       = angleDistribution(generator);
+         float speed           = speedDistribution(generator);
+         float angularVelocity = angularVelocityDistribution(generator);
+         float mass            = 1.0f / body.mOneOverMass;
+
+         auto createCandidate = [&](const glm::vec2& position)
+         {
+            RigidBody2D candidate(mass, body.mWidth, body.mHeight, body.mCoefficientOfRestitution, position, orientation,
+                                  speed * glm::vec2(std::cos(direction), std::sin(direction)), angularVelocity, body.mColor);
+            candidate.calculateVertices(current);
+            return candidate;
+         };
+
+         auto isFree = [&](const RigidBody2D& candidate)
+         {
+            if (!isBodyInsideWalls(scene.walls, candidate))
+            {
+               return false;
+            }
+
+            for (std::size_t i = 0; i < bodyIndex; ++i)
+            {
+               if (doBodiesOverlap(candidate, scene.rigidBodies[i]))
+               {
+                  return false;
+               }
+            }
+
+            return true;
+         };
+
+         bool isPlaced = false;
+         for (int attempt = 0; (attempt < maxNumAttempts) && !isPlaced; ++attempt)
+         {
+            glm::vec2 position;
+            position.x = xDistribution(generator);
+            position.y = yDistribution(generator);
+
+            RigidBody2D candidate = createCandidate(position);
+            if (isFree(candidate))
+            {
+               body     = candidate;
+               isPlaced = true;
+            }
+         }
+
+         if (!isPlaced)
+         {
+            RigidBody2D candidate = createCandidate(body.mStates[0].positionOfCenterOfMass);
+            if (!isFree(candidate))
+            {
+               return false;
+            }
+
+            body = candidate;
+         }
+      }
+
+      return true;
+   }
+
+   TrialCost simulateScene(Scene&& scene, int numSteps)
+   {
+      std::vector<std::vector<Wall>> wallScenes(1);
+      wallScenes[0] = std::move(scene.walls);
+
+      World world(std::move(wallScenes), std::vector<std::vector<RigidBody2D>>(1, std::move(scene.rigidBodies)));
+      world.setGravityState(scene.gravityState);
+
+      TrialCost cost;
+      while ((cost.numSteps < numSteps) && (cost.errorCode == 0))
+      {
+         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+         cost.errorCode = world.simulate(scene.timeStep);
+         double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         ++cost.numSteps;
+
+         const StepMetrics& metrics = world.getStepMetrics();
+         std::uint64_t      work    = metrics.numSubsteps + metrics.numRejectedSteps + metrics.numSubdivisions + metrics.numSolverIterations;
+
+         cost.totalWork += work;
+         if (work > cost.worstStepWork)
+         {
+            cost.worstStep                 = cost.numSteps;
+            cost.worstStepWork             = work;
+            cost.worstStepSubsteps         = metrics.numSubsteps;
+            cost.worstStepSubdivisions     = metrics.numSubdivisions;
+            cost.worstStepSolverIterations = metrics.numSolverIterations;
+            cost.worstStepSeconds          = seconds;
+         }
+      }
+
+      return cost;
+   }
+
+   // The most expensive worst step comes first, and the total work breaks ties
+   bool isMoreExpensive(const Trial& trialA, const Trial& trialB)
+   {
+      if (trialA.cost.worstStepWork != trialB.cost.worstStepWork)
+      {
+         return trialA.cost.worstStepWork > trialB.cost.worstStepWork;
+      }
+
+      return trialA.cost.totalWork > trialB.cost.totalWork;
+   }
+
+   void writeCostHeader(std::ostream& stream)
+   {
+      stream << "steps,error_code,worst_step,worst_step_work,worst_step_substeps,worst_step_subdivisions,worst_step_solver_iterations,worst_step_seconds,total_work";
+   }
+
+   void writeCost(std::ostream& stream, const TrialCost& cost)
+   {
+      stream << cost.numSteps << ","
+             << cost.errorCode << ","
+             << cost.worstStep << ","
+             << cost.worstStepWork << ","
+             << cost.worstStepSubsteps << ","
+             << cost.worstStepSubdivisions << ","
+             << cost.worstStepSolverIterations << ","
+             << cost.worstStepSeconds << ","
+             << cost.totalWork;
+   }
+
+   int replay(const Options& options)
+   {
+      std::cout << "file,";
+      writeCostHeader(std::cout);
+      std::cout << "\n";
+
+      for (const std::string& filePath : options.replayFilePaths)
+      {
+         Scene scene;
+         if (!scene.load(filePath))
+         {
+            return 1;
+         }
+
+         std::cout << filePath << ",";
+         writeCost(std::cout, simulateScene(std::move(scene), options.numSteps));
+         std::cout << "\n";
+      }
+
+      return 0;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   Options options;
+   int     exitCode = 0;
+   if (!parseOptions(argc, argv, options, exitCode))
+   {
+      return exitCode;
+   }
+
+   if (!options.replayFilePaths.empty())
+   {
+      return replay(options);
+   }
+
+   SceneLibrary sceneLibrary;
+   if (!sceneLibrary.open(options.sceneDirectory))
+   {
+      return 1;
+   }
+
+   std::vector<std::string> libraryNames;
+   for (int i = 0; i < sceneLibrary.getNumScenes(); ++i)
+   {
+      libraryNames.push_back(sceneLibrary.getSceneName(i));
+   }
+
+   if (options.sceneNames.empty())
+   {
+      options.sceneNames = libraryNames;
+   }
+
+   std::ofstream indexFile(options.corpusDirectory + "/corpus.csv");
+   if (!indexFile)
+   {
+      std::cout << "Error - PathologicalCaseSearch - Failed to open " << options.corpusDirectory << "/corpus.csv, and the corpus directory must exist" << "\n";
+      return 1;
+   }
+
+   indexFile << "file,scene,seed,trial,gravity,";
+   writeCostHeader(indexFile);
+   indexFile << "\n";
+
+   for (const std::string& sceneName : options.sceneNames)
+   {
+      std::vector<std::string>::const_iterator nameIter = std::find(libraryNames.begin(), libraryNames.end(), sceneName);
+      if (nameIter == libraryNames.end())
+      {
+         std::cout << "Error - PathologicalCaseSearch - Unknown scene " << sceneName << "\n";
+         return 1;
+      }
+
+      std::size_t sceneIndex = nameIter - libraryNames.begin();
+
+      Scene originalScene;
+      if (!sceneLibrary.loadScene(static_cast<int>(sceneIndex), originalScene))
+      {
+         return 1;
+      }
+
+      std::vector<Trial> keptTrials;
+      std::vector<Trial> failedTrials;
+      int                numSkippedTrials = 0;
+
+      for (int trialIndex = 0; trialIndex < options.numTrials; ++trialIndex)
+      {
+         // Every trial has its own generator, so a trial can be repeated without repeating the ones before it
+         std::seed_seq seedSequence{options.seed, static_cast<unsigned int>(sceneIndex), static_cast<unsigned int>(trialIndex)};
+         std::mt19937  generator(seedSequence);
+
+         Scene scene;
+         scene.name       = sceneName;
+         scene.dimensions = originalScene.dimensions;
+         scene.timeStep   = originalScene.timeStep;
+         for (const Wall& wall : originalScene.walls)
+         {
+            scene.walls.push_back(Wall(wall.getNormal(), wall.getStartPoint(), wall.getEndPoint()));
+         }
+         scene.rigidBodies = originalScene.rigidBodies;
+
+         if (options.gravity == "random")
+         {
+            scene.gravityState = std::uniform_int_distribution<int>(0, 2)(generator);
+         }
+         else
+         {
+            scene.gravityState = std::atoi(options.gravity.c_str());
+         }
+
+         if (!randomizeScene(scene, options, generator))
+         {
+            ++numSkippedTrials;
+            continue;
+         }
+
+         // The trial is simulated from its own text, so that saving it loses nothing
+         Trial trial;
+         trial.trialIndex   = trialIndex;
+         trial.gravityState = scene.gravityState;
+
+         std::ostringstream sceneStream;
+         scene.write(sceneStream);
+         trial.sceneText = sceneStream.str();
+
+         Scene              reloadedScene;
+         std::istringstream reloadStream(trial.sceneText);
+         reloadedScene.read(reloadStream);
+         trial.cost = simulateScene(std::move(reloadedScene), options.numSteps);
+
+         if (trial.cost.errorCode != 0)
+         {
+            failedTrials.push_back(trial);
+            continue;
+         }
+
+         keptTrials.push_back(trial);
+         std::sort(keptTrials.begin(), keptTrials.end(), isMoreExpensive);
+         if (static_cast<int>(keptTrials.size()) > options.numKept)
+         {
+            keptTrials.pop_back();
+         }
+      }
+
+      std::cout << sceneName << ": " << options.numTrials << " trials";
+      if (numSkippedTrials > 0)
+      {
+         std::cout << " (" << numSkippedTrials << " skipped because the bodies didn't fit)";
+      }
+      std::cout << "\n";
+
+      for (const Trial& trial : failedTrials)
+      {
+         std::cout << "   Trial " << trial.trialIndex << " with gravity " << trial.gravityState
+                   << " stopped at step " << trial.cost.numSteps << " with error code " << trial.cost.errorCode << "\n";
+      }
+
+      for (std::size_t rank = 0; rank < keptTrials.size(); ++rank)
+      {
+         const Trial& trial    = keptTrials[rank];
+         std::string  fileName = toFileName(sceneName) + "_" + std::to_string(rank + 1) + ".scene";
+
+         std::ofstream sceneFile(options.corpusDirectory + "/" + fileName);
+         sceneFile << trial.sceneText;
+         if (!sceneFile)
+         {
+            std::cout << "Error - PathologicalCaseSearch - Failed to write " << options.corpusDirectory << "/" << fileName << "\n";
+            return 1;
+         }
+
+         indexFile << fileName << "," << sceneName << "," << options.seed << "," << trial.trialIndex << "," << trial.gravityState << ",";
+         writeCost(indexFile, trial.cost);
+         indexFile << "\n";
+
+         std::cout << "   " << fileName << ": worst step " << trial.cost.worstStep
+                   << " with " << trial.cost.worstStepWork << " units of work ("
+                   << trial.cost.worstStepSubsteps << " substeps, "
+                   << trial.cost.worstStepSubdivisions << " subdivisions, "
+                   << trial.cost.worstStepSolverIterations << " solver iterations)" << "\n";
+      }
+   }
+
+   return 0;
+}
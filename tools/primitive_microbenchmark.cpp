@@ -0,0 +1,521 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "geometry.h"
+#include "world.h"
+
+// This benchmark measures the narrow-phase and integration primitives on their own, so that rewrites of them can be judged without the noise of a whole simulation
+// Each primitive runs over a few thousand random inputs in a loop for at least the minimum time, and this is repeated several times
+// The reported time per operation is the median of the repetitions, and the minimum is reported too because it is the least affected by other processes
+//
+// The forces entries report the time per body, so the batched force generators of World::computeForces can be compared with a single loop that computes the same forces body by body
+//
+// Usage: PrimitiveMicrobenchmark [--filter substring] [--min-seconds S] [--repetitions N] [--seed N]
+
+// Declared as a friend of World, which lets the benchmark call the private narrow-phase methods and the forces phase
+class WorldPrimitives
+{
+public:
+
+   typedef World::BodyWallCollision   BodyWallCollision;
+   typedef World::VertexEdgeCollision VertexEdgeCollision;
+
+   static BodyWallCollision createBodyWallCollision(const World& world, int bodyIndex, int vertexIndex, int wallIndex)
+   {
+      return BodyWallCollision(world.mWalls->at(wallIndex).getNormal(), bodyIndex, vertexIndex, wallIndex);
+   }
+
+   static VertexEdgeCollision createVertexEdgeCollision(const glm::vec2& collisionNormal, int bodyAIndex, int bodyBIndex, int vertexAIndex, const glm::vec2& bodyBPoint)
+   {
+      return VertexEdgeCollision(collisionNormal, bodyAIndex, bodyBIndex, vertexAIndex, bodyBPoint);
+   }
+
+   static std::tuple<glm::vec2, float> resolveBodyWallCollision(World& world, const BodyWallCollision& collision)
+   {
+      return world.resolveBodyWallCollision(collision);
+   }
+
+   static bool isBodyWallCollisionResolved(World& world, const BodyWallCollision& collision, const glm::vec2& linearVelocity, float angularVelocity)
+   {
+      return world.isBodyWallCollisionResolved(collision, linearVelocity, angularVelocity);
+   }
+
+   static std::tuple<glm::vec2, float, glm::vec2, float> resolveVertexEdgeCollision(World& world, const VertexEdgeCollision& collision)
+   {
+      return world.resolveVertexEdgeCollision(collision);
+   }
+
+   static bool isVertexEdgeCollisionResolved(World& world, const VertexEdgeCollision& collision, const glm::vec2& bodyALinearVelocity, float bodyAAngularVelocity, const glm::vec2& bodyBLinearVelocity, float bodyBAngularVelocity)
+   {
+      return world.isVertexEdgeCollisionResolved(collision, bodyALinearVelocity, bodyAAngularVelocity, bodyBLinearVelocity, bodyBAngularVelocity);
+   }
+
+   static std::vector<RigidBody2D>& getRigidBodies(World& world)
+   {
+      return world.mRigidBodies;
+   }
+
+   static void computeForces(World& world)
+   {
+      world.computeForces<NoGravity>(current);
+   }
+};
+
+namespace
+{
+   struct Options
+   {
+      std::string  filter;
+      double       minSeconds  = 0.1;
+      int          repetitions = 5;
+      unsigned int seed        = 1;
+   };
+
+   // The number of random inputs of each primitive, which is a power of two so that the input index can be wrapped with a mask
+   const std::size_t numInputs = 4096;
+
+   // Keeps the compiler from removing the computation of a value that is never used
+   template<typename T>
+   inline void doNotOptimizeAway(const T& value)
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : "g"(&value) : "memory");
+#else
+      static volatile const void* sink;
+      sink = &value;
+#endif
+   }
+
+   bool parseOptions(int argc, char* argv[], Options& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+         if (i + 1 >= argc)
+         {
+            std::cout << "Error - PrimitiveMicrobenchmark - Missing value for " << argument << "\n";
+            return false;
+         }
+
+         std::string value = argv[++i];
+         if (argument == "--filter")
+         {
+            options.filter = value;
+         }
+         else if (argument == "--min-seconds")
+         {
+            options.minSeconds = std::atof(value.c_str());
+         }
+         else if (argument == "--repetitions")
+         {
+            options.repetitions = std::max(1, std::atoi(value.c_str()));
+         }
+         else if (argument == "--seed")
+         {
+            options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+         }
+         else
+         {
+            std::cout << "Error - PrimitiveMicrobenchmark - Unknown argument " << argument << "\n";
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // Runs an operation on input indices that wrap around the inputs, and returns the time per operation in nanoseconds for each repetition
+   std::vector<double> measure(const std::function<void(std::size_t)>& runBatch, const Options& options)
+   {
+      // Warm up the caches and the branch predictors
+      runBatch(numInputs);
+
+      std::vector<double> nanosecondsPerOperation;
+      for (int repetition = 0; repetition < options.repetitions; ++repetition)
+      {
+         std::size_t                           numOperations = 0;
+         double                                elapsedSeconds = 0.0;
+         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+         while (elapsedSeconds < options.minSeconds)
+         {
+            runBatch(numInputs);
+            numOperations += numInputs;
+            elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         }
+
+         nanosecondsPerOperation.push_back((elapsedSeconds * 1e9) / numOperations);
+      }
+
+      return nanosecondsPerOperation;
+   }
+
+   // The loop over the inputs is inside of the function object, so that calling it doesn't add to the cost of each operation
+   template<typename TOperation>
+   std::function<void(std::size_t)> createBatch(TOperation operation)
+   {
+      return [operation](std::size_t numOperations) mutable
+      {
+         for (std::size_t i = 0; i < numOperations; ++i)
+         {
+            operation(i & (numInputs - 1));
+         }
+      };
+   }
+
+   void report(const std::string& name, const std::function<void(std::size_t)>& runBatch, const Options& options)
+   {
+      if (!options.filter.empty() && (name.find(options.filter) == std::string::npos))
+      {
+         return;
+      }
+
+      std::vector<double> nanosecondsPerOperation = measure(runBatch, options);
+      std::sort(nanosecondsPerOperation.begin(), nanosecondsPerOperation.end());
+
+      double median  = nanosecondsPerOperation[nanosecondsPerOperation.size() / 2];
+      double minimum = nanosecondsPerOperation.front();
+
+      std::cout << std::left  << std::setw(40) << name
+                << std::right << std::setw(12) << std::fixed << std::setprecision(2) << median
+                << std::setw(12) << minimum
+                << std::setw(16) << std::setprecision(0) << (1e9 / median) << "\n";
+   }
+
+   std::vector<Wall> createBox(float halfSize)
+   {
+      std::vector<Wall> walls;
+      walls.push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2(-halfSize,  halfSize), glm::vec2( halfSize,  halfSize))); // Top
+      walls.push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2( halfSize, -halfSize), glm::vec2(-halfSize, -halfSize))); // Bottom
+      walls.push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2( halfSize,  halfSize), glm::vec2( halfSize, -halfSize))); // Right
+      walls.push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2(-halfSize, -halfSize), glm::vec2(-halfSize,  halfSize))); // Left
+      return walls;
+   }
+
+   // The forces of the forces benchmarks, with the parameters of the generators configuration of ScalabilityBenchmark
+   struct ForceParameters
+   {
+      bool      hasUniformField          = true;
+      glm::vec2 fieldAcceleration        = glm::vec2(0.0f, -1.0f);
+      bool      hasLinearDrag            = true;
+      float     linearDragCoefficient    = 10.0f;
+      bool      hasQuadraticDrag         = true;
+      float     quadraticDragCoefficient = 0.01f;
+      bool      hasAttractor             = true;
+      glm::vec2 attractorPosition        = glm::vec2(0.0f);
+      float     attractorStrength        = 5000.0f;
+      float     attractorSofteningLength = 40.0f;
+      bool      hasSprings               = true;
+      float     springRestLength         = 40.0f;
+      float     springStiffness          = 10.0f;
+      float     springDamping            = 1.0f;
+   };
+
+   // The springs connect each body to the next one in a chain
+   void addForceGenerators(World& world, int numBodies, const ForceParameters& parameters)
+   {
+      std::unique_ptr<SpringNetwork> springNetwork = std::make_unique<SpringNetwork>();
+      for (int i = 0; i + 1 < numBodies; ++i)
+      {
+         springNetwork->addSpring(i, i + 1, parameters.springRestLength, parameters.springStiffness, parameters.springDamping);
+      }
+
+      world.addForceGenerator(std::make_unique<UniformForceField>(parameters.fieldAcceleration));
+      world.addForceGenerator(std::make_unique<LinearDrag>(parameters.linearDragCoefficient, parameters.linearDragCoefficient));
+      world.addForceGenerator(std::make_unique<QuadraticDrag>(parameters.quadraticDragCoefficient, parameters.quadraticDragCoefficient));
+      world.addForceGenerator(std::make_unique<PointAttractor>(parameters.attractorPosition, parameters.attractorStrength, parameters.attractorSofteningLength));
+      world.addForceGenerator(std::move(springNetwork));
+   }
+
+   glm::vec2 calculateSpringForce(const RigidBody2D::KinematicAndDynamicState& state, const RigidBody2D::KinematicAndDynamicState& otherEndState, const ForceParameters& parameters)
+   {
+      glm::vec2 displacement = state.positionOfCenterOfMass - otherEndState.positionOfCenterOfMass;
+      float     length       = glm::length(displacement);
+      if (length < 1e-6f)
+      {
+         return glm::vec2(0.0f);
+      }
+
+      glm::vec2 direction        = displacement / length;
+      glm::vec2 relativeVelocity = state.velocityOfCenterOfMass - otherEndState.velocityOfCenterOfMass;
+      return -((parameters.springStiffness * (length - parameters.springRestLength)) + (parameters.springDamping * glm::dot(relativeVelocity, direction))) * direction;
+   }
+
+   // The same forces as the generators of addForceGenerators, computed by one loop over the bodies that handles every kind of force for each body in turn
+   // This is what World::computeForces would look like if each new kind of force were added as another branch of its loop
+   void computeForcesPerBody(std::vector<RigidBody2D>& bodies, std::size_t bodyIndex, const ForceParameters& parameters)
+   {
+      RigidBody2D::KinematicAndDynamicState& state  = bodies[bodyIndex].mStates[0];
+      float                                  mass   = 1.0f / bodies[bodyIndex].mOneOverMass;
+      glm::vec2                              force  = glm::vec2(0.0f);
+      float                                  torque = 0.0f;
+
+      if (parameters.hasUniformField)
+      {
+         force += mass * parameters.fieldAcceleration;
+      }
+
+      if (parameters.hasLinearDrag)
+      {
+         force  -= parameters.linearDragCoefficient * state.velocityOfCenterOfMass;
+         torque -= parameters.linearDragCoefficient * state.angularVelocity;
+      }
+
+      if (parameters.hasQuadraticDrag)
+      {
+         force  -= parameters.quadraticDragCoefficient * glm::length(state.velocityOfCenterOfMass) * state.velocityOfCenterOfMass;
+         torque -= parameters.quadraticDragCoefficient * std::abs(state.angularVelocity) * state.angularVelocity;
+      }
+
+      if (parameters.hasAttractor)
+      {
+         glm::vec2 toAttractor     = parameters.attractorPosition - state.positionOfCenterOfMass;
+         float     distanceSquared = glm::dot(toAttractor, toAttractor) + (parameters.attractorSofteningLength * parameters.attractorSofteningLength);
+         force += ((parameters.attractorStrength * mass) / (distanceSquared * std::sqrt(distanceSquared))) * toAttractor;
+      }
+
+      if (parameters.hasSprings && (bodyIndex > 0))
+      {
+         force += calculateSpringForce(state, bodies[bodyIndex - 1].mStates[0], parameters);
+      }
+
+      if (parameters.hasSprings && (bodyIndex + 1 < bodies.size()))
+      {
+         force += calculateSpringForce(state, bodies[bodyIndex + 1].mStates[0], parameters);
+      }
+
+      state.forceOfCenterOfMass = force;
+      state.torque              = torque;
+   }
+
+   std::vector<RigidBody2D> createRandomBodies(std::size_t numBodies, float halfSize, std::mt19937& generator)
+   {
+      std::uniform_real_distribution<float> positionDistribution(-halfSize, halfSize);
+      std::uniform_real_distribution<float> sizeDistribution(8.0f, 40.0f);
+      std::uniform_real_distribution<float> angleDistribution(0.0f, 6.2831853f);
+      std::uniform_real_distribution<float> velocityDistribution(-80.0f, 80.0f);
+      std::uniform_real_distribution<float> angularVelocityDistribution(-3.0f, 3.0f);
+
+      std::vector<RigidBody2D> bodies;
+      bodies.reserve(numBodies);
+
+      // The random numbers are drawn one statement at a time, because the order in which function arguments are evaluated is unspecified
+      for (std::size_t i = 0; i < numBodies; ++i)
+      {
+         float positionX       = positionDistribution(generator);
+         float positionY       = positionDistribution(generator);
+         float width           = sizeDistribution(generator);
+         float height          = sizeDistribution(generator);
+         float orientation     = angleDistribution(generator);
+         float velocityX       = velocityDistribution(generator);
+         float velocityY       = velocityDistribution(generator);
+         float angularVelocity = angularVelocityDistribution(generator);
+
+         bodies.push_back(RigidBody2D(10.0f, width, height, 1.0f, glm::vec2(positionX, positionY), orientation, glm::vec2(velocityX, velocityY), angularVelocity, glm::vec3(1.0f)));
+      }
+
+      return bodies;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   Options options;
+   if (!parseOptions(argc, argv, options))
+   {
+      return 1;
+   }
+
+   std::mt19937 generator(options.seed);
+
+   std::uniform_real_distribution<float> coordinateDistribution(-100.0f, 100.0f);
+   std::uniform_real_distribution<float> velocityDistribution(-80.0f, 80.0f);
+   std::uniform_real_distribution<float> angularVelocityDistribution(-3.0f, 3.0f);
+   std::uniform_real_distribution<float> angleDistribution(0.0f, 6.2831853f);
+   std::uniform_int_distribution<int>    vertexIndexDistribution(0, 3);
+
+   // Points and segments for the geometry helpers
+   std::vector<glm::vec2> points(numInputs);
+   std::vector<glm::vec2> segmentStartPoints(numInputs);
+   std::vector<glm::vec2> segmentEndPoints(numInputs);
+   for (std::size_t i = 0; i < numInputs; ++i)
+   {
+      points[i].x             = coordinateDistribution(generator);
+      points[i].y             = coordinateDistribution(generator);
+      segmentStartPoints[i].x = coordinateDistribution(generator);
+      segmentStartPoints[i].y = coordinateDistribution(generator);
+      segmentEndPoints[i].x   = coordinateDistribution(generator);
+      segmentEndPoints[i].y   = coordinateDistribution(generator);
+   }
+
+   // Bodies for the integrators and for RigidBody2D::calculateVertices
+   const float              halfSize = 500.0f;
+   std::vector<RigidBody2D> bodies   = createRandomBodies(numInputs, halfSize, generator);
+
+   // A world for the collision methods, with a small number of bodies so that they stay in the cache like the bodies of a real scene
+   const int                numWorldBodies = 64;
+   std::vector<std::vector<Wall>> wallScenes(1);
+   wallScenes[0] = createBox(halfSize);
+   World world(std::move(wallScenes), std::vector<std::vector<RigidBody2D>>(1, createRandomBodies(numWorldBodies, halfSize, generator)));
+
+   std::vector<RigidBody2D>& worldBodies = WorldPrimitives::getRigidBodies(world);
+   for (std::vector<RigidBody2D>::iterator iter = worldBodies.begin(); iter != worldBodies.end(); ++iter)
+   {
+      iter->calculateVertices(current);
+      iter->calculateVertices(future);
+   }
+
+   // Worlds for the forces benchmarks, with one body per input so that each operation computes the forces of one body
+   std::vector<std::vector<Wall>> gravityWallScenes(1);
+   gravityWallScenes[0] = createBox(halfSize);
+   World gravityWorld(std::move(gravityWallScenes), std::vector<std::vector<RigidBody2D>>(1, bodies));
+
+   std::vector<std::vector<Wall>> generatorWallScenes(1);
+   generatorWallScenes[0] = createBox(halfSize);
+   World generatorWorld(std::move(generatorWallScenes), std::vector<std::vector<RigidBody2D>>(1, bodies));
+   // The parameters are hidden from the optimizer, because a real scene sets them at run time, and the per-body loop shouldn't get to fold them into its code
+   ForceParameters forceParameters;
+   doNotOptimizeAway(forceParameters);
+   addForceGenerators(generatorWorld, static_cast<int>(numInputs), forceParameters);
+
+   std::vector<RigidBody2D> perBodyForceBodies = bodies;
+
+   std::uniform_int_distribution<int> bodyIndexDistribution(0, numWorldBodies - 1);
+   std::uniform_int_distribution<int> wallIndexDistribution(0, 3);
+   std::uniform_real_distribution<float> edgeParameterDistribution(0.0f, 1.0f);
+
+   std::vector<WorldPrimitives::BodyWallCollision>   bodyWallCollisions;
+   std::vector<WorldPrimitives::VertexEdgeCollision> vertexEdgeCollisions;
+   std::vector<glm::vec2>                            linearVelocitiesA(numInputs);
+   std::vector<float>                                angularVelocitiesA(numInputs);
+   std::vector<glm::vec2>                            linearVelocitiesB(numInputs);
+   std::vector<float>                                angularVelocitiesB(numInputs);
+   bodyWallCollisions.reserve(numInputs);
+   vertexEdgeCollisions.reserve(numInputs);
+
+   for (std::size_t i = 0; i < numInputs; ++i)
+   {
+      int bodyIndex   = bodyIndexDistribution(generator);
+      int vertexIndex = vertexIndexDistribution(generator);
+      int wallIndex   = wallIndexDistribution(generator);
+      bodyWallCollisions.push_back(WorldPrimitives::createBodyWallCollision(world, bodyIndex, vertexIndex, wallIndex));
+
+      int bodyAIndex = bodyIndexDistribution(generator);
+      int bodyBIndex = (bodyAIndex + 1 + (bodyIndexDistribution(generator) % (numWorldBodies - 1))) % numWorldBodies;
+      int edgeIndex  = vertexIndexDistribution(generator);
+      int vertexAIndex = vertexIndexDistribution(generator);
+      float edgeParameter = edgeParameterDistribution(generator);
+      float normalAngle   = angleDistribution(generator);
+
+      const RigidBody2D::KinematicAndDynamicState& bodyBState = worldBodies[bodyBIndex].mStates[1];
+      glm::vec2 bodyBPoint = bodyBState.vertices[edgeIndex] + (edgeParameter * (bodyBState.vertices[(edgeIndex + 1) % 4] - bodyBState.vertices[edgeIndex]));
+      vertexEdgeCollisions.push_back(WorldPrimitives::createVertexEdgeCollision(glm::vec2(std::cos(normalAngle), std::sin(normalAngle)), bodyAIndex, bodyBIndex, vertexAIndex, bodyBPoint));
+
+      linearVelocitiesA[i].x = velocityDistribution(generator);
+      linearVelocitiesA[i].y = velocityDistribution(generator);
+      angularVelocitiesA[i]  = angularVelocityDistribution(generator);
+      linearVelocitiesB[i].x = velocityDistribution(generator);
+      linearVelocitiesB[i].y = velocityDistribution(generator);
+      angularVelocitiesB[i]  = angularVelocityDistribution(generator);
+   }
+
+   std::cout << std::left  << std::setw(40) << "Primitive"
+             << std::right << std::setw(12) << "ns/op"
+             << std::setw(12) << "min ns/op"
+             << std::setw(16) << "ops/sec" << "\n";
+
+   report("doesPointProjectOntoSegment", createBatch([&](std::size_t i)
+   {
+      bool result = doesPointProjectOntoSegment(points[i], segmentStartPoints[i], segmentEndPoints[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   report("calculateClosestPointOnSegmentToPoint", createBatch([&](std::size_t i)
+   {
+      glm::vec2 result = calculateClosestPointOnSegmentToPoint(points[i], segmentStartPoints[i], segmentEndPoints[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   report("RigidBody2D::calculateVertices", createBatch([&](std::size_t i)
+   {
+      bodies[i].calculateVertices(future);
+      doNotOptimizeAway(bodies[i].mStates[1].vertices);
+   }), options);
+
+   report("RungeKutta4Integrator::integrate", createBatch([&](std::size_t i)
+   {
+      RungeKutta4Integrator::integrate(bodies[i], 0.02f);
+      doNotOptimizeAway(bodies[i].mStates[1]);
+   }), options);
+
+   report("SemiImplicitEulerIntegrator::integrate", createBatch([&](std::size_t i)
+   {
+      SemiImplicitEulerIntegrator::integrate(bodies[i], 0.02f);
+      doNotOptimizeAway(bodies[i].mStates[1]);
+   }), options);
+
+   report("VelocityVerletIntegrator::integrate", createBatch([&](std::size_t i)
+   {
+      VelocityVerletIntegrator::integrate(bodies[i], 0.02f);
+      doNotOptimizeAway(bodies[i].mStates[1]);
+   }), options);
+
+   // The batched path runs over all of the bodies at once, so a batch of operations is a whole number of calls to World::computeForces
+   report("World::computeForces - gravity", [&](std::size_t numOperations)
+   {
+      for (std::size_t i = 0; i < numOperations; i += numInputs)
+      {
+         WorldPrimitives::computeForces(gravityWorld);
+      }
+   }, options);
+
+   report("World::computeForces - generators", [&](std::size_t numOperations)
+   {
+      for (std::size_t i = 0; i < numOperations; i += numInputs)
+      {
+         WorldPrimitives::computeForces(generatorWorld);
+      }
+   }, options);
+
+   report("Forces - per-body loop", createBatch([&](std::size_t i)
+   {
+      computeForcesPerBody(perBodyForceBodies, i, forceParameters);
+      doNotOptimizeAway(perBodyForceBodies[i].mStates[0]);
+   }), options);
+
+   report("World::resolveBodyWallCollision", createBatch([&](std::size_t i)
+   {
+      std::tuple<glm::vec2, float> result = WorldPrimitives::resolveBodyWallCollision(world, bodyWallCollisions[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   report("World::isBodyWallCollisionResolved", createBatch([&](std::size_t i)
+   {
+      bool result = WorldPrimitives::isBodyWallCollisionResolved(world, bodyWallCollisions[i], linearVelocitiesA[i], angularVelocitiesA[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   report("World::resolveVertexEdgeCollision", createBatch([&](std::size_t i)
+   {
+      std::tuple<glm::vec2, float, glm::vec2, float> result = WorldPrimitives::resolveVertexEdgeCollision(world, vertexEdgeCollisions[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   report("World::isVertexEdgeCollisionResolved", createBatch([&](std::size_t i)
+   {
+      bool result = WorldPrimitives::isVertexEdgeCollisionResolved(world, vertexEdgeCollisions[i], linearVelocitiesA[i], angularVelocitiesA[i], linearVelocitiesB[i], angularVelocitiesB[i]);
+      doNotOptimizeAway(result);
+   }), options);
+
+   return 0;
+}
@@ -0,0 +1,604 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "allocation_tracker.h"
+#include "procedural_scenes.h"
+#include "profiler.h"
+#include "world.h"
+
+// This benchmark measures how World::simulate scales with the number of bodies
+// It generates scenes of boxes in three configurations using a seeded random number generator:
+// - gas:   boxes that move in random directions without gravity
+// - stack: columns of boxes that rest on the floor under gravity
+// - pile:  boxes that are dropped from random orientations under gravity
+// - generators: the boxes of the gas, which are pushed by one force generator of each kind, so that the forces phase measures the batched path of World::computeForces
+// The identifiers of procedural_scenes.h, like brick_wall or funnel, can be used as configurations too
+// For each scene it writes one CSV row with the time spent in each phase of World::simulate, the number of steps per second, the number of substeps per step and the memory use
+// The memory use is the resident set size after the scene, and the peak increase of the resident set size while the scene is created and simulated
+// The peak is reset before each scene through /proc/self/clear_refs, and the increase is -1 when that isn't possible, since the peak of the process would include the earlier scenes
+//
+// Usage: ScalabilityBenchmark [--help] [--sizes 10,100,1000] [--configurations gas,stack,pile] [--steps N] [--max-seconds S] [--time-step H] [--seed N] [--output file.csv] [--trace file.json] [--subdivisions file.csv] [--metrics file.csv|file.bin] [--counters] [--deterministic] [--check-allocations]
+//
+// With --trace, the profiler zones of World::simulate are recorded and exported as a Chrome trace
+// With --metrics, every step pushes a record into a metrics sink, and the time that takes is reported in the metrics_seconds column
+// With --counters, the CPU cycles, instructions, cache misses and branch misses of each phase are measured with perf_event_open and printed as a table for each scene
+// The tables go to the standard error stream when the CSV rows go to the standard output stream
+// With --deterministic, the scenes are simulated in deterministic mode and the metrics records carry a hash of the state of each step, so MetricsDiff can compare two builds
+// In that case --max-seconds should be large enough for every scene to run all of its steps, since otherwise the two runs can record different numbers of steps
+// With --check-allocations, the heap allocations of each scope are printed as a table for each scene, and the benchmark fails if World::simulate allocates after the warm-up steps
+// This needs a build with TRACK_ALLOCATIONS, and the first steps are excluded because the collision buffers grow to their working size during them
+// With --subdivisions, every step that subdivided time writes one CSV row per wall or body pair that caused the subdivisions
+// A scene that stops with an error before its last step is reported as an error, and the benchmark fails, since its row doesn't measure the same work as the others
+//
+// The time budget is only checked between steps, and the body-body collision checks are quadratic in the number of bodies
+// That's why scenes of 10k and 100k bodies have to be requested explicitly with --sizes, since a single step can take minutes or hours
+
+namespace
+{
+   struct Options
+   {
+      std::vector<int>         sizes          = {10, 100, 1000};
+      std::vector<std::string> configurations = {"gas", "stack", "pile"};
+      int                      numSteps       = 200;
+      double                   maxSeconds     = 30.0;
+      float                    timeStep       = 0.02f;
+      unsigned int             seed           = 1;
+      std::string              outputFilePath;
+      std::string              traceFilePath;
+      std::string              subdivisionsFilePath;
+      std::string              metricsFilePath;
+      bool                     hardwareCounters = false;
+      bool                     deterministic    = false;
+      bool                     checkAllocations = false;
+   };
+
+   // The number of steps after which World::simulate shouldn't allocate anymore
+   const int numAllocationWarmUpSteps = 20;
+
+   struct GeneratedScene
+   {
+      std::vector<Wall>                            walls;
+      std::vector<RigidBody2D>                     bodies;
+      int                                          gravityState;
+      std::vector<std::unique_ptr<ForceGenerator>> forceGenerators;
+   };
+
+   std::vector<std::string> split(const std::string& list)
+   {
+      std::vector<std::string> items;
+      std::stringstream        stream(list);
+      std::string              item;
+      while (std::getline(stream, item, ','))
+      {
+         if (!item.empty())
+         {
+            items.push_back(item);
+         }
+      }
+
+      return items;
+   }
+
+   void printUsage()
+   {
+      std::cout << "Usage: ScalabilityBenchmark [--help] [--sizes 10,100,1000] [--configurations gas,stack,pile] [--steps N] [--max-seconds S] [--time-step H] [--seed N]"
+                   " [--output file.csv] [--trace file.json] [--subdivisions file.csv] [--metrics file.csv|file.bin] [--counters] [--deterministic] [--check-allocations]\n";
+   }
+
+   // Returns false if the benchmark shouldn't run, and sets exitCode to what it should return instead
+   bool parseOptions(int argc, char* argv[], Options& options, int& exitCode)
+   {
+      exitCode = 1;
+
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+
+         if ((argument == "--help") || (argument == "-h"))
+         {
+            printUsage();
+            exitCode = 0;
+            return false;
+         }
+      }
+
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string argument = argv[i];
+
+         // Flags don't take a value
+         if (argument == "--counters")
+         {
+            options.hardwareCounters = true;
+            continue;
+         }
+
+         if (argument == "--deterministic")
+         {
+            options.deterministic = true;
+            continue;
+         }
+
+         if (argument == "--check-allocations")
+         {
+            options.checkAllocations = true;
+            continue;
+         }
+
+         if (i + 1 >= argc)
+         {
+            std::cout << "Error - ScalabilityBenchmark - Missing value for " << argument << "\n";
+            printUsage();
+            return false;
+         }
+
+         std::string value = argv[++i];
+         if (argument == "--sizes")
+         {
+            options.sizes.clear();
+            for (const std::string& size : split(value))
+            {
+               options.sizes.push_back(std::atoi(size.c_str()));
+            }
+         }
+         else if (argument == "--configurations")
+         {
+            options.configurations = split(value);
+         }
+         else if (argument == "--steps")
+         {
+            options.numSteps = std::atoi(value.c_str());
+         }
+         else if (argument == "--max-seconds")
+         {
+            options.maxSeconds = std::atof(value.c_str());
+         }
+         else if (argument == "--time-step")
+         {
+            options.timeStep = static_cast<float>(std::atof(value.c_str()));
+         }
+         else if (argument == "--seed")
+         {
+            options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+         }
+         else if (argument == "--output")
+         {
+            options.outputFilePath = value;
+         }
+         else if (argument == "--trace")
+         {
+            options.traceFilePath = value;
+         }
+         else if (argument == "--subdivisions")
+         {
+            options.subdivisionsFilePath = value;
+         }
+         else if (argument == "--metrics")
+         {
+            options.metricsFilePath = value;
+         }
+         else
+         {
+            std::cout << "Error - ScalabilityBenchmark - Unknown argument " << argument << "\n";
+            printUsage();
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   std::vector<Wall> createBox(float halfWidth, float halfHeight)
+   {
+      std::vector<Wall> walls;
+      walls.push_back(Wall(glm::vec2( 0.0f, -1.0f), glm::vec2(-halfWidth,  halfHeight), glm::vec2( halfWidth,  halfHeight))); // Top
+      walls.push_back(Wall(glm::vec2( 0.0f,  1.0f), glm::vec2( halfWidth, -halfHeight), glm::vec2(-halfWidth, -halfHeight))); // Bottom
+      walls.push_back(Wall(glm::vec2(-1.0f,  0.0f), glm::vec2( halfWidth,  halfHeight), glm::vec2( halfWidth, -halfHeight))); // Right
+      walls.push_back(Wall(glm::vec2( 1.0f,  0.0f), glm::vec2(-halfWidth, -halfHeight), glm::vec2(-halfWidth,  halfHeight))); // Left
+      return walls;
+   }
+
+   // Each body is placed in its own cell of a grid, so the bodies never overlap at the start
+   GeneratedScene generateGas(int numBodies, std::mt19937& generator)
+   {
+      const float cellSize   = 40.0f;
+      int         numColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numBodies))));
+      float       halfSize   = (numColumns * cellSize) / 2.0f;
+
+      GeneratedScene scene;
+      scene.walls        = createBox(halfSize, halfSize);
+      scene.gravityState = 0;
+      scene.bodies.reserve(numBodies);
+
+      for (int i = 0; i < numBodies; ++i)
+      {
+         // The random numbers are drawn one statement at a time, because the order in which function arguments are evaluated is unspecified
+         glm::vec2 cellCenter(-halfSize + ((i % numColumns) + 0.5f) * cellSize, -halfSize + ((i / numColumns) + 0.5f) * cellSize);
+         float     jitterX         = generateRandomFloat(generator, -4.0f, 4.0f);
+         float     jitterY         = generateRandomFloat(generator, -4.0f, 4.0f);
+         float     width           = generateRandomFloat(generator, 8.0f, 18.0f);
+         float     height          = generateRandomFloat(generator, 8.0f, 18.0f);
+         float     orientation     = generateRandomFloat(generator, 0.0f, 6.2831853f);
+         float     direction       = generateRandomFloat(generator, 0.0f, 6.2831853f);
+         float     speed           = generateRandomFloat(generator, 20.0f, 80.0f);
+         float     angularVelocity = generateRandomFloat(generator, -1.0f, 1.0f);
+         glm::vec2 velocity        = speed * glm::vec2(std::cos(direction), std::sin(direction));
+
+         scene.bodies.push_back(RigidBody2D(10.0f, width, height, 1.0f, cellCenter + glm::vec2(jitterX, jitterY), orientation, velocity, angularVelocity, glm::vec3(1.0f)));
+      }
+
+      return scene;
+   }
+
+   // The gas with a uniform field, both kinds of drag, an attractor in the middle of the arena and springs between the neighbors of each row
+   // The drag calms the gas down within a second, and the field and the attractor are weak enough that the boxes don't pile up on the floor or in the middle
+   GeneratedScene generateGasWithForceGenerators(int numBodies, std::mt19937& generator)
+   {
+      const float cellSize   = 40.0f;
+      int         numColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numBodies))));
+
+      GeneratedScene scene = generateGas(numBodies, generator);
+
+      std::unique_ptr<SpringNetwork> springNetwork = std::make_unique<SpringNetwork>();
+      for (int i = 0; i + 1 < numBodies; ++i)
+      {
+         if (((i + 1) % numColumns) != 0)
+         {
+            springNetwork->addSpring(i, i + 1, cellSize, 10.0f, 1.0f);
+         }
+      }
+
+      scene.forceGenerators.push_back(std::make_unique<UniformForceField>(glm::vec2(0.0f, -1.0f)));
+      scene.forceGenerators.push_back(std::make_unique<LinearDrag>(10.0f, 10.0f));
+      scene.forceGenerators.push_back(std::make_unique<QuadraticDrag>(0.01f, 0.01f));
+      scene.forceGenerators.push_back(std::make_unique<PointAttractor>(glm::vec2(0.0f), 5000.0f, cellSize));
+      scene.forceGenerators.push_back(std::move(springNetwork));
+
+      return scene;
+   }
+
+   // Columns of boxes that start apart like the bricks of the Stack scene, so that each box lands on the one below it before the next one arrives
+   // Boxes that start within the collision distance of each other or of the floor end in an unresolvable penetration error as soon as they touch
+   // The random offset is drawn per column, because a box that lands off-center on the box below it topples and ends the simulation with an error
+   GeneratedScene generateStack(int numBodies, std::mt19937& generator)
+   {
+      const float boxWidth     = 20.0f;
+      const float boxHeight    = 10.0f;
+      const float columnWidth  = 40.0f;
+      const float rowGap       = 10.0f;
+      const float rowHeight    = boxHeight + rowGap;
+      int         numColumns   = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numBodies))));
+      int         numRows      = (numBodies + numColumns - 1) / numColumns;
+      float       halfWidth    = (numColumns * columnWidth) / 2.0f;
+      float       halfHeight   = ((numRows * rowHeight) / 2.0f) + 20.0f;
+
+      GeneratedScene scene;
+      scene.walls        = createBox(halfWidth, halfHeight);
+      scene.gravityState = 1;
+      scene.bodies.reserve(numBodies);
+
+      std::vector<float> columnOffsets(numColumns);
+      for (float& columnOffset : columnOffsets)
+      {
+         columnOffset = generateRandomFloat(generator, -1.0f, 1.0f);
+      }
+
+      for (int i = 0; i < numBodies; ++i)
+      {
+         glm::vec2 position(-halfWidth + ((i % numColumns) + 0.5f) * columnWidth + columnOffsets[i % numColumns],
+                            -halfHeight + rowGap + (0.5f * boxHeight) + ((i / numColumns) * rowHeight));
+
+         scene.bodies.push_back(RigidBody2D(10.0f, boxWidth, boxHeight, 0.5f, position, 0.0f, glm::vec2(0.0f), 0.0f, glm::vec3(1.0f)));
+      }
+
+      return scene;
+   }
+
+   // Boxes that start in the upper half of the arena and fall onto the floor
+   GeneratedScene generatePile(int numBodies, std::mt19937& generator)
+   {
+      const float cellSize   = 30.0f;
+      int         numColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numBodies))));
+      float       halfSize   = (numColumns * cellSize) / 2.0f;
+
+      GeneratedScene scene;
+      scene.walls        = createBox(halfSize, 2.0f * halfSize);
+      scene.gravityState = 1;
+      scene.bodies.reserve(numBodies);
+
+      for (int i = 0; i < numBodies; ++i)
+      {
+         glm::vec2 cellCenter(-halfSize + ((i % numColumns) + 0.5f) * cellSize, ((i / numColumns) + 0.5f) * cellSize);
+         float     jitterX     = generateRandomFloat(generator, -3.0f, 3.0f);
+         float     jitterY     = generateRandomFloat(generator, -3.0f, 3.0f);
+         float     velocityX   = generateRandomFloat(generator, -10.0f, 10.0f);
+         float     velocityY   = generateRandomFloat(generator, -10.0f, 10.0f);
+         float     width       = generateRandomFloat(generator, 8.0f, 16.0f);
+         float     height      = generateRandomFloat(generator, 8.0f, 16.0f);
+         float     orientation = generateRandomFloat(generator, 0.0f, 6.2831853f);
+
+         scene.bodies.push_back(RigidBody2D(10.0f, width, height, 0.8f, cellCenter + glm::vec2(jitterX, jitterY), orientation, glm::vec2(velocityX, velocityY), 0.0f, glm::vec3(1.0f)));
+      }
+
+      return scene;
+   }
+
+   // Returns the value of a field of /proc/self/status in KiB, or -1 if it is not available
+   long readProcessStatusField(const std::string& fieldName)
+   {
+      std::ifstream statusFile("/proc/self/status");
+      std::string   line;
+      while (std::getline(statusFile, line))
+      {
+         if (line.compare(0, fieldName.size(), fieldName) == 0)
+         {
+            return std::atol(line.c_str() + fieldName.size() + 1);
+         }
+      }
+
+      return -1;
+   }
+
+   // Resets the peak resident set size of the process to its current resident set size, which needs Linux 4.0 or later
+   bool resetPeakResidentSetSize()
+   {
+      std::ofstream clearRefsFile("/proc/self/clear_refs");
+      clearRefsFile << "5";
+      clearRefsFile.flush();
+      return static_cast<bool>(clearRefsFile);
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   Options options;
+   int     exitCode = 0;
+   if (!parseOptions(argc, argv, options, exitCode))
+   {
+      return exitCode;
+   }
+
+   std::ofstream outputFile;
+   if (!options.outputFilePath.empty())
+   {
+      outputFile.open(options.outputFilePath);
+      if (!outputFile)
+      {
+         std::cout << "Error - ScalabilityBenchmark - Failed to open " << options.outputFilePath << "\n";
+         return 1;
+      }
+   }
+
+   std::ostream& output = options.outputFilePath.empty() ? std::cout : outputFile;
+
+   if (options.checkAllocations && !AllocationTracker::isEnabled())
+   {
+      std::cout << "Error - ScalabilityBenchmark - --check-allocations needs a build with TRACK_ALLOCATIONS\n";
+      return 1;
+   }
+
+   bool allocationCheckFailed = false;
+   bool simulationFailed      = false;
+
+   std::ofstream subdivisionsFile;
+   if (!options.subdivisionsFilePath.empty())
+   {
+      subdivisionsFile.open(options.subdivisionsFilePath);
+      if (!subdivisionsFile)
+      {
+         std::cout << "Error - ScalabilityBenchmark - Failed to open " << options.subdivisionsFilePath << "\n";
+         return 1;
+      }
+
+      subdivisionsFile << "configuration,bodies,step,penetration_type,body,penetrated,subdivisions,max_penetration_depth,min_substep_size,wasted_seconds\n";
+   }
+
+   output << "configuration,bodies,seed,time_step,steps,error_code,wall_seconds,steps_per_second,substeps_per_step,subdivisions_per_step";
+   for (unsigned int phase = 0; phase < static_cast<unsigned int>(World::SimulationPhase::numPhases); ++phase)
+   {
+      output << "," << World::getPhaseName(static_cast<World::SimulationPhase>(phase)) << "_seconds";
+   }
+   output << ",rss_kib,peak_rss_increase_kib\n";
+
+   if (!options.traceFilePath.empty())
+   {
+      Profiler::setThreadName("Benchmark");
+      Profiler::enable(true);
+   }
+
+   // The records of all the scenes go into the same stream, and the step index restarts for each scene
+   std::shared_ptr<MetricsSink> metricsSink;
+   if (!options.metricsFilePath.empty())
+   {
+      metricsSink = std::make_shared<MetricsSink>();
+      if (!metricsSink->open(options.metricsFilePath, MetricsSink::getFormatOfFile(options.metricsFilePath)))
+      {
+         return 1;
+      }
+   }
+
+   for (const std::string& configuration : options.configurations)
+   {
+      for (int numBodies : options.sizes)
+      {
+         // The scene is created after the peak is reset, so that its bodies and its collision buffers count towards the increase
+         bool peakWasReset       = resetPeakResidentSetSize();
+         long residentSetSizeKiB = readProcessStatusField("VmRSS:");
+
+         std::mt19937 generator(options.seed);
+
+         GeneratedScene      scene;
+         ProceduralSceneType proceduralSceneType;
+         if (configuration == "gas")
+         {
+            scene = generateGas(numBodies, generator);
+         }
+         else if (configuration == "stack")
+         {
+            scene = generateStack(numBodies, generator);
+         }
+         else if (configuration == "pile")
+         {
+            scene = generatePile(numBodies, generator);
+         }
+         else if (configuration == "generators")
+         {
+            scene = generateGasWithForceGenerators(numBodies, generator);
+         }
+         else if (findProceduralSceneType(configuration, proceduralSceneType))
+         {
+            Scene proceduralScene = generateProceduralScene(proceduralSceneType, numBodies, options.seed);
+            scene.walls           = std::move(proceduralScene.walls);
+            scene.bodies          = std::move(proceduralScene.rigidBodies);
+            scene.gravityState    = proceduralScene.gravityState;
+         }
+         else
+         {
+            std::cout << "Error - ScalabilityBenchmark - Unknown configuration " << configuration << "\n";
+            return 1;
+         }
+
+         std::vector<std::vector<Wall>> wallScenes(1);
+         wallScenes[0] = std::move(scene.walls);
+
+         World world(std::move(wallScenes), std::vector<std::vector<RigidBody2D>>(1, std::move(scene.bodies)));
+         world.setGravityState(scene.gravityState);
+         world.enablePhaseTiming(true);
+
+         for (std::unique_ptr<ForceGenerator>& forceGenerator : scene.forceGenerators)
+         {
+            world.addForceGenerator(std::move(forceGenerator));
+         }
+
+         world.enableSubdivisionDiagnostics(subdivisionsFile.is_open());
+         world.setMetricsSink(metricsSink);
+         world.enableDeterministicMode(options.deterministic);
+
+         if (options.hardwareCounters && !world.enableHardwareCounters(true))
+         {
+            return 1;
+         }
+
+         int    errorCode   = 0;
+         int    step        = 0;
+         double wallSeconds = 0.0;
+
+         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+         // Large scenes can take a long time per step, so we also stop when the time budget runs out
+         AllocationTracker::resetScopeCounts();
+
+         while ((step < options.numSteps) && (errorCode == 0) && (wallSeconds < options.maxSeconds))
+         {
+            errorCode = world.simulate(options.timeStep);
+            ++step;
+
+            if (step == numAllocationWarmUpSteps)
+            {
+               AllocationTracker::resetScopeCounts();
+            }
+
+            if (subdivisionsFile.is_open())
+            {
+               std::vector<World::SubdivisionCulprit> report = world.getSubdivisionReport();
+               for (const World::SubdivisionCulprit& culprit : report)
+               {
+                  subdivisionsFile << configuration << ","
+                                   << numBodies << ","
+                                   << step << ","
+                                   << ((culprit.penetrationType == World::PenetrationType::bodyWall) ? "body_wall" : "body_body") << ","
+                                   << culprit.penetratingBodyIndex << ","
+                                   << culprit.penetratedIndex << ","
+                                   << culprit.numSubdivisions << ","
+                                   << culprit.maxPenetrationDepth << ","
+                                   << culprit.minSubstepSize << ","
+                                   << culprit.wastedSeconds << "\n";
+               }
+            }
+            wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         }
+
+         // A scene that fails stops early, so its row measures fewer and different steps than the rows of the scenes that don't
+         if (errorCode != 0)
+         {
+            std::ostream& errorStream = options.outputFilePath.empty() ? std::cerr : std::cout;
+            errorStream << "Error - ScalabilityBenchmark - " << configuration << " with " << numBodies << " bodies stopped at step " << step
+                        << " of " << options.numSteps << " with error code " << errorCode << "\n";
+            simulationFailed = true;
+         }
+
+         const World::StepStatistics& stepStatistics = world.getStepStatistics();
+
+         output << configuration << ","
+                << numBodies << ","
+                << options.seed << ","
+                << options.timeStep << ","
+                << step << ","
+                << errorCode << ","
+                << wallSeconds << ","
+                << (step / wallSeconds) << ","
+                << (static_cast<double>(stepStatistics.numAcceptedSteps) / step) << ","
+                << (static_cast<double>(stepStatistics.numSubdivisions) / step);
+         for (double phaseDuration : stepStatistics.phaseDurations)
+         {
+            output << "," << phaseDuration;
+         }
+         long peakResidentSetSizeKiB = readProcessStatusField("VmHWM:");
+         long peakIncreaseKiB        = (peakWasReset && (residentSetSizeKiB >= 0) && (peakResidentSetSizeKiB >= 0)) ? (peakResidentSetSizeKiB - residentSetSizeKiB) : -1;
+         output << "," << readProcessStatusField("VmRSS:") << "," << peakIncreaseKiB << "\n";
+         output.flush();
+
+         if (options.hardwareCounters)
+         {
+            std::ostream& tableStream = options.outputFilePath.empty() ? std::cerr : std::cout;
+            tableStream << "\n" << configuration << " with " << numBodies << " bodies and " << step << " steps\n";
+            World::printPhaseTable(stepStatistics, tableStream);
+         }
+
+         if (options.checkAllocations)
+         {
+            std::ostream& tableStream = options.outputFilePath.empty() ? std::cerr : std::cout;
+            tableStream << "\n" << configuration << " with " << numBodies << " bodies, allocations after " << numAllocationWarmUpSteps << " warm-up steps\n";
+            AllocationTracker::printScopeTable(tableStream);
+
+            AllocationScopeCounts simulateCounts = AllocationTracker::getScopeCounts("World::simulate");
+            if ((step > numAllocationWarmUpSteps) && (simulateCounts.counts.numAllocations != 0))
+            {
+               std::cout << "Error - ScalabilityBenchmark - World::simulate made " << simulateCounts.counts.numAllocations << " allocations of "
+                         << simulateCounts.counts.numBytes << " bytes in " << simulateCounts.numEntries << " steps of " << configuration
+                         << " with " << numBodies << " bodies\n";
+               allocationCheckFailed = true;
+            }
+         }
+      }
+   }
+
+   if (metricsSink)
+   {
+      metricsSink->close();
+      if (metricsSink->getNumDroppedRecords() != 0)
+      {
+         std::cout << "Error - ScalabilityBenchmark - The metrics sink dropped " << metricsSink->getNumDroppedRecords() << " records\n";
+      }
+   }
+
+   if (!options.traceFilePath.empty())
+   {
+      Profiler::enable(false);
+      if (!Profiler::exportChromeTrace(options.traceFilePath))
+      {
+         return 1;
+      }
+   }
+
+   return (allocationCheckFailed || simulationFailed) ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#include <iostream>
+#include <string>
+
+#include "scene.h"
+
+// This tool converts scene files between the text format, which is meant for editing, and the binary format, which is faster to load
+// The format of the input is detected from its contents, and the format of the output is chosen by its name
+//
+// Usage: SceneConverter input.scene output.bin
+//        SceneConverter input.bin output.scene
+
+int main(int argc, char* argv[])
+{
+   if (argc != 3)
+   {
+      std::cout << "Usage: SceneConverter input output" << "\n";
+      return 1;
+   }
+
+   Scene scene;
+   if (!scene.load(argv[1]))
+   {
+      return 1;
+   }
+
+   if (!scene.save(argv[2]))
+   {
+      return 1;
+   }
+
+   std::cout << "Converted " << scene.name << " with " << scene.walls.size() << " walls and " << scene.rigidBodies.size() << " bodies" << "\n";
+
+   return 0;
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "replay_buffer.h"
+#include "scene.h"
+#include "trajectory_reader.h"
+#include "trajectory_recorder.h"
+#include "world.h"
+
+// This tool records the trajectory of a scene without the UI, and prints the contents of trajectory files
+// When recording, every sampled step is read back from the finished file and compared with the state that was simulated, to check the quantization error
+// The replay command measures the steady-state cost of the instant replay, by simulating the scene with and without a ReplayBuffer, and then saves the replay
+//
+// Usage: TrajectoryTool record scene.scene|scene.bin output.traj [steps]
+//        TrajectoryTool replay scene.scene|scene.bin output.traj [steps] [seconds]
+//        TrajectoryTool info input.traj
+//        TrajectoryTool dump input.traj frame
+
+namespace
+{
+   // Every step whose index is a multiple of this is kept in memory and compared with the file after the recording
+   const int sampleInterval = 97;
+
+   struct SampledStep
+   {
+      std::uint64_t            frameIndex;
+      std::vector<RigidBody2D> rigidBodies;
+   };
+
+   float calculateOrientationError(float recordedOrientation, float simulatedOrientation)
+   {
+      const float twoPi = 6.28318530718f;
+
+      float difference = std::fmod(std::abs(recordedOrientation - simulatedOrientation), twoPi);
+      return std::min(difference, twoPi - difference);
+   }
+
+   int record(const std::string& sceneFilePath, const std::string& trajectoryFilePath, int numSteps)
+   {
+      Scene scene;
+      if (!scene.load(sceneFilePath))
+      {
+         return 1;
+      }
+
+      std::vector<std::vector<Wall>> wallScenes(1);
+      wallScenes[0] = std::move(scene.walls);
+
+      World world(std::move(wallScenes), std::vector<std::vector<RigidBody2D>>(1, scene.rigidBodies));
+      world.setGravityState(scene.gravityState);
+
+      std::shared_ptr<TrajectoryRecorder> recorder = std::make_shared<TrajectoryRecorder>();
+      if (!recorder->open(trajectoryFilePath))
+      {
+         return 1;
+      }
+
+      world.setTrajectoryRecorder(recorder);
+
+      std::vector<SampledStep> sampledSteps;
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      int errorCode = 0;
+      int step      = 0;
+      for (; (step < numSteps) && (errorCode == 0); ++step)
+      {
+         errorCode = world.simulate(scene.timeStep);
+
+         if (step % sampleInterval == 0)
+         {
+            SampledStep sampledStep;
+            sampledStep.frameIndex  = static_cast<std::uint64_t>(step);
+            sampledStep.rigidBodies = world.getRigidBodies();
+            sampledSteps.push_back(std::move(sampledStep));
+         }
+      }
+
+      recorder->close();
+
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      if (errorCode != 0)
+      {
+         std::cout << "The simulation stopped with error code " << errorCode << " after " << step << " steps" << "\n";
+      }
+
+      // Three floats per body and step is what storing the poses without compression costs
+      double uncompressedBytes = 3.0 * sizeof(float) * scene.rigidBodies.size() * step;
+      std::cout << "Recorded " << recorder->getNumWrittenFrames() << " frames of " << scene.rigidBodies.size() << " bodies in " << seconds << " seconds" << "\n"
+                << "File size:       " << recorder->getNumWrittenBytes() << " bytes, " << (recorder->getNumWrittenBytes() / std::max(step, 1)) << " bytes per frame" << "\n"
+                << "Compression:     " << (uncompressedBytes / recorder->getNumWrittenBytes()) << "x compared to the raw poses" << "\n"
+                << "Writer stalls:   " << recorder->getNumStalls() << "\n";
+
+      TrajectoryReader reader;
+      if (!reader.open(trajectoryFilePath))
+      {
+         return 1;
+      }
+
+      float           maxPositionError    = 0.0f;
+      float           maxOrientationError = 0.0f;
+      TrajectoryFrame frame;
+      for (const SampledStep& sampledStep : sampledSteps)
+      {
+         if (!reader.readFrame(sampledStep.frameIndex, frame) || (frame.positions.size() != sampledStep.rigidBodies.size()))
+         {
+            std::cout << "Error - TrajectoryTool - Failed to read back frame " << sampledStep.frameIndex << "\n";
+            return 1;
+         }
+
+         for (std::size_t i = 0; i < frame.positions.size(); ++i)
+         {
+            const RigidBody2D::KinematicAndDynamicState& simulatedState = sampledStep.rigidBodies[i].mStates[0];
+
+            glm::vec2 positionError = glm::abs(frame.positions[i] - simulatedState.positionOfCenterOfMass);
+            maxPositionError    = std::max(maxPositionError, std::max(positionError.x, positionError.y));
+            maxOrientationError = std::max(maxOrientationError, calculateOrientationError(frame.orientations[i], simulatedState.orientation));
+         }
+      }
+
+      std::cout << "Max errors:      " << maxPositionError << " pixels and " << maxOrientationError << " radians in " << sampledSteps.size() << " sampled frames" << "\n";
+
+      return 0;
+   }
+
+   int printInfo(const std::string& trajectoryFilePath)
+   {
+      TrajectoryReader reader;
+      if (!reader.open(trajectoryFilePath))
+      {
+         return 1;
+      }
+
+      TrajectoryFrame firstFrame;
+      TrajectoryFrame lastFrame;
+      if (!reader.readFrame(0, firstFrame) || !reader.readFrame(reader.getNumFrames() - 1, lastFrame))
+      {
+         return 1;
+      }
+
+      std::cout << "Frames:           " << reader.getNumFrames() << "\n"
+                << "Keyframes:        " << reader.getNumKeyframes() << "\n"
+                << "Position quantum: " << reader.getPositionQuantum() << " pixels" << "\n"
+                << "First frame:      step " << firstFrame.stepIndex << " at " << firstFrame.simulatedTime << " seconds with " << firstFrame.positions.size() << " bodies" << "\n"
+                << "Last frame:       step " << lastFrame.stepIndex << " at " << lastFrame.simulatedTime << " seconds with " << lastFrame.positions.size() << " bodies" << "\n";
+
+      return 0;
+   }
+
+   // Returns the time that the steps took in seconds, or a negative value if the scene couldn't be loaded or simulated
+   double simulateScene(const std::string& sceneFilePath, const std::shared_ptr<ReplayBuffer>& replayBuffer, int numSteps)
+   {
+      Scene scene;
+      if (!scene.load(sceneFilePath))
+      {
+         return -1.0;
+      }
+
+      std::vector<std::vector<Wall>> wallScenes(1);
+      wallScenes[0] = std::move(scene.walls);
+
+      World world(std::move(wallScenes), std::vector<std::vector<RigidBody2D>>(1, scene.rigidBodies));
+      world.setGravityState(scene.gravityState);
+      world.setReplayBuffer(replayBuffer);
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      for (int step = 0; step < numSteps; ++step)
+      {
+         int errorCode = world.simulate(scene.timeStep);
+         if (errorCode != 0)
+         {
+            std::cout << "The simulation stopped with error code " << errorCode << " after " << step << " steps" << "\n";
+            return -1.0;
+         }
+      }
+
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+
+   int measureReplay(const std::string& sceneFilePath, const std::string& trajectoryFilePath, int numSteps, float durationInSeconds)
+   {
+      double secondsWithoutReplay = simulateScene(sceneFilePath, nullptr, numSteps);
+
+      std::shared_ptr<ReplayBuffer> replayBuffer = std::make_shared<ReplayBuffer>(durationInSeconds);
+      double secondsWithReplay = simulateScene(sceneFilePath, replayBuffer, numSteps);
+
+      if ((secondsWithoutReplay < 0.0) || (secondsWithReplay < 0.0))
+      {
+         return 1;
+      }
+
+      // Wait for the encoder to catch up, so that the saved replay ends with the last step
+      while (replayBuffer->getNumEncodedFrames() + replayBuffer->getNumDroppedFrames() < static_cast<std::uint64_t>(numSteps))
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      if (!replayBuffer->save(trajectoryFilePath))
+      {
+         return 1;
+      }
+
+      // The simulation thread only pays for the copies of the poses, while the encoding happens on the background thread
+      std::uint64_t numEncodedFrames = std::max<std::uint64_t>(replayBuffer->getNumEncodedFrames(), 1);
+      double        bytesPerSecond   = replayBuffer->getNumBytes() / std::max(static_cast<double>(replayBuffer->getDuration()), 1.0e-6);
+      std::cout << "Step time:       " << (secondsWithoutReplay * 1.0e6 / numSteps) << " us without the replay and " << (secondsWithReplay * 1.0e6 / numSteps) << " us with it" << "\n"
+                << "Encoding time:   " << (replayBuffer->getEncodingTimeInSeconds() * 1.0e6 / numEncodedFrames) << " us per frame on the background thread" << "\n"
+                << "Memory:          " << replayBuffer->getNumBytes() << " bytes for " << replayBuffer->getDuration() << " seconds in " << replayBuffer->getNumFrames() << " frames, " << bytesPerSecond << " bytes per simulated second" << "\n"
+                << "Dropped frames:  " << replayBuffer->getNumDroppedFrames() << "\n";
+
+      return printInfo(trajectoryFilePath);
+   }
+
+   int dumpFrame(const std::string& trajectoryFilePath, std::uint64_t frameIndex)
+   {
+      TrajectoryReader reader;
+      if (!reader.open(trajectoryFilePath))
+      {
+         return 1;
+      }
+
+      TrajectoryFrame frame;
+      if (!reader.readFrame(frameIndex, frame))
+      {
+         std::cout << "Error - TrajectoryTool - The trajectory only has " << reader.getNumFrames() << " frames" << "\n";
+         return 1;
+      }
+
+      std::cout << "Frame " << frame.frameIndex << ", step " << frame.stepIndex << ", simulated time " << frame.simulatedTime << "\n";
+      for (std::size_t i = 0; i < frame.positions.size(); ++i)
+      {
+         std::cout << i << " " << frame.positions[i].x << " " << frame.positions[i].y << " " << frame.orientations[i] << "\n";
+      }
+
+      return 0;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   std::string command = (argc > 1) ? argv[1] : "";
+
+   if ((command == "record") && ((argc == 4) || (argc == 5)))
+   {
+      return record(argv[2], argv[3], (argc == 5) ? std::atoi(argv[4]) : 1000);
+   }
+
+   if ((command == "replay") && (argc >= 4) && (argc <= 6))
+   {
+      return measureReplay(argv[2], argv[3], (argc >= 5) ? std::atoi(argv[4]) : 1000, (argc == 6) ? static_cast<float>(std::atof(argv[5])) : 10.0f);
+   }
+
+   if ((command == "info") && (argc == 3))
+   {
+      return printInfo(argv[2]);
+   }
+
+   if ((command == "dump") && (argc == 4))
+   {
+      return dumpFrame(argv[2], std::strtoull(argv[3], nullptr, 10));
+   }
+
+   std::cout << "Usage: TrajectoryTool record scene.scene|scene.bin output.traj [steps]" << "\n"
+             << "       TrajectoryTool replay scene.scene|scene.bin output.traj [steps] [seconds]" << "\n"
+             << "       TrajectoryTool info input.traj" << "\n"
+             << "       TrajectoryTool dump input.traj frame" << "\n";
+
+   return 1;
+}